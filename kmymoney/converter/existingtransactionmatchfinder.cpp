@@ -22,14 +22,23 @@
 #include "mymoneymoney.h"
 #include "mymoneyfile.h"
 #include "mymoneytransactionfilter.h"
+#include "existingtransactionmatchindex.h"
 
-ExistingTransactionMatchFinder::ExistingTransactionMatchFinder(int matchWindow)
-    : TransactionMatchFinder(matchWindow)
+ExistingTransactionMatchFinder::ExistingTransactionMatchFinder(int matchWindow, ExistingTransactionMatchIndex* index)
+    : TransactionMatchFinder(matchWindow),
+    m_index(index)
 {
 }
 
 void ExistingTransactionMatchFinder::createListOfMatchCandidates()
 {
+  if (m_index) {
+    listOfMatchCandidates = m_index->matchCandidates(m_importedSplit.accountId(), m_importedSplit.shares(),
+                                                     importedTransaction.postDate().addDays(-m_matchWindow), importedTransaction.postDate().addDays(m_matchWindow));
+    qDebug() << "Considering" << listOfMatchCandidates.size() << "existing transaction(s) for matching";
+    return;
+  }
+
   MyMoneyTransactionFilter filter(m_importedSplit.accountId());
   filter.setReportAllSplits(false);
   filter.setDateFilter(importedTransaction.postDate().addDays(-m_matchWindow), importedTransaction.postDate().addDays(m_matchWindow));
@@ -22,6 +22,8 @@
 
 #include "transactionmatchfinder.h"
 
+class ExistingTransactionMatchIndex;
+
 /** Implements searching for a matching transaction in the ledger
  */
 class ExistingTransactionMatchFinder : public TransactionMatchFinder
@@ -29,12 +31,14 @@ class ExistingTransactionMatchFinder : public TransactionMatchFinder
 public:
   /** Ctor, initializes the match finder
    * @param matchWindow max number of days the transactions may vary and still be considered to be matching
+   * @param index optional index used to look up the match candidates instead of filtering the whole ledger
    */
-  explicit ExistingTransactionMatchFinder(int m_matchWindow = 3);
+  explicit ExistingTransactionMatchFinder(int m_matchWindow = 3, ExistingTransactionMatchIndex* index = nullptr);
 
 protected:
   typedef QPair<MyMoneyTransaction, MyMoneySplit> TransactionAndSplitPair;
   QList<TransactionAndSplitPair> listOfMatchCandidates;
+  ExistingTransactionMatchIndex* m_index;
 
   /** Creates a list of transactions within matchWindow range and with the same amount as the imported transaction we're trying to match
    */
@@ -0,0 +1,106 @@
+/***************************************************************************
+    KMyMoney transaction importing module - index of existing transactions used for matching
+
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "existingtransactionmatchindex.h"
+
+#include <QDate>
+
+#include "mymoneymoney.h"
+#include "mymoneyfile.h"
+#include "mymoneyexception.h"
+#include "mymoneytransactionfilter.h"
+
+void ExistingTransactionMatchIndex::addAccount(const QString& accountId)
+{
+  if (accountId.isEmpty() || m_accounts.contains(accountId))
+    return;
+  m_accounts.insert(accountId);
+
+  MyMoneyTransactionFilter filter(accountId);
+  filter.setReportAllSplits(false);
+  QList<MyMoneyTransaction> list;
+  MyMoneyFile::instance()->transactionList(list, filter);
+  foreach (const MyMoneyTransaction& transaction, list)
+    addTransaction(transaction);
+}
+
+void ExistingTransactionMatchIndex::addTransaction(const MyMoneyTransaction& transaction)
+{
+  const QString sortKey = transaction.uniqueSortKey();
+  foreach (const MyMoneySplit& split, transaction.splits()) {
+    // the amount filter accepts a split if either its shares or its value match
+    m_index[indexKey(split.accountId(), split.shares())].insert(sortKey, transaction.id());
+    if (split.value().abs() != split.shares().abs())
+      m_index[indexKey(split.accountId(), split.value())].insert(sortKey, transaction.id());
+  }
+}
+
+QList<ExistingTransactionMatchIndex::TransactionAndSplitPair> ExistingTransactionMatchIndex::matchCandidates(const QString& accountId, const MyMoneyMoney& amount, const QDate& from, const QDate& to)
+{
+  addAccount(accountId);
+
+  QList<TransactionAndSplitPair> list;
+  const auto it_i = m_index.constFind(indexKey(accountId, amount));
+  if (it_i == m_index.constEnd())
+    return list;
+
+  MyMoneyTransactionFilter filter(accountId);
+  filter.setReportAllSplits(false);
+  filter.setDateFilter(from, to);
+  filter.setAmountFilter(amount, amount);
+
+  const auto file = MyMoneyFile::instance();
+  QSet<QString> seen;
+  const auto end = it_i->lowerBound(dateKey(to.addDays(1)));
+  for (auto it = it_i->lowerBound(dateKey(from)); it != end; ++it) {
+    // a transaction that changed its date is indexed more than once
+    if (seen.contains(*it))
+      continue;
+    seen.insert(*it);
+
+    MyMoneyTransaction transaction;
+    try {
+      transaction = file->transaction(*it);
+    } catch (const MyMoneyException &) {
+      // the transaction has been removed in the meantime
+      continue;
+    }
+
+    // the transaction might have been modified since it was indexed
+    const auto& splits = filter.matchingSplits(transaction);
+    foreach (const MyMoneySplit& split, splits)
+      list.append(qMakePair(transaction, split));
+  }
+  return list;
+}
+
+void ExistingTransactionMatchIndex::clear()
+{
+  m_index.clear();
+  m_accounts.clear();
+}
+
+QString ExistingTransactionMatchIndex::indexKey(const QString& accountId, const MyMoneyMoney& amount)
+{
+  return accountId + QLatin1Char('|') + amount.abs().toString();
+}
+
+QString ExistingTransactionMatchIndex::dateKey(const QDate& date)
+{
+  // same layout as the date part of MyMoneyTransaction::uniqueSortKey()
+  return QString::fromLatin1("%1-%2-%3")
+         .arg(date.year(), 4, 10, QLatin1Char('0'))
+         .arg(date.month(), 2, 10, QLatin1Char('0'))
+         .arg(date.day(), 2, 10, QLatin1Char('0'));
+}
@@ -0,0 +1,76 @@
+/***************************************************************************
+    KMyMoney transaction importing module - index of existing transactions used for matching
+
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef EXISTINGTRANSACTIONMATCHINDEX_H
+#define EXISTINGTRANSACTIONMATCHINDEX_H
+
+#include <QPair>
+#include <QList>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+#include "mymoneytransaction.h"
+#include "mymoneysplit.h"
+
+class QDate;
+class MyMoneyMoney;
+
+/** Keeps the existing transactions of the accounts an import touches indexed
+ * by account and absolute amount, ordered by post date.
+ *
+ * The index is filled once per account and then kept up to date by the
+ * statement reader with every transaction it adds or modifies, so that
+ * looking up match candidates does not need to scan the ledger for every
+ * imported transaction. Entries only store transaction ids: the candidates
+ * are always read from the engine and checked again, so stale entries of
+ * modified or removed transactions do no harm.
+ */
+class ExistingTransactionMatchIndex
+{
+public:
+  typedef QPair<MyMoneyTransaction, MyMoneySplit> TransactionAndSplitPair;
+
+  /** Loads all transactions of account @a accountId into the index.
+   * Accounts which are already indexed are not loaded again.
+   */
+  void addAccount(const QString& accountId);
+
+  /** Adds all splits of @a transaction to the index. Adding a transaction
+   * again (e.g. after it has been modified) is allowed.
+   */
+  void addTransaction(const MyMoneyTransaction& transaction);
+
+  /** Returns the transactions which have a split in account @a accountId with
+   * the absolute value of @a amount and are posted between @a from and @a to.
+   * The result is the same as the one of MyMoneyFile::transactionList() using
+   * an account, date and amount filter. The account is indexed on first use.
+   */
+  QList<TransactionAndSplitPair> matchCandidates(const QString& accountId, const MyMoneyMoney& amount, const QDate& from, const QDate& to);
+
+  /** Drops all indexed information
+   */
+  void clear();
+
+private:
+  static QString indexKey(const QString& accountId, const MyMoneyMoney& amount);
+  static QString dateKey(const QDate& date);
+
+  /// account/amount key -> MyMoneyTransaction::uniqueSortKey() -> transaction id
+  QHash<QString, QMap<QString, QString> > m_index;
+  QSet<QString>                           m_accounts;
+};
+
+#endif // EXISTINGTRANSACTIONMATCHINDEX_H
@@ -67,6 +67,8 @@
 #include "accountsmodel.h"
 #include "models.h"
 #include "existingtransactionmatchfinder.h"
+#include "existingtransactionmatchindex.h"
+#include "payeematchfinder.h"
 #include "scheduledtransactionmatchfinder.h"
 #include "dialogenums.h"
 #include "mymoneyenums.h"
@@ -80,6 +82,26 @@ bool matchNotEmpty(const QString &l, const QString &r)
   return !l.isEmpty() && QString::compare(l, r, Qt::CaseInsensitive) == 0;
 }
 
+/**
+ * Returns the security whose trading symbol matches @a symbol or whose
+ * name matches @a name, both ignoring the case. If there is more than
+ * one, the one with the lowest id is returned, which is the first one
+ * in MyMoneyFile::securityList().
+ */
+static MyMoneySecurity findSecurity(const QString& symbol, const QString& name)
+{
+  const auto file = MyMoneyFile::instance();
+  auto list = file->securitiesBySymbol(symbol);
+  list += file->securitiesByName(name, Qt::CaseInsensitive);
+
+  MyMoneySecurity security;
+  for (const auto& sec : list) {
+    if (security.id().isEmpty() || sec.id() < security.id())
+      security = sec;
+  }
+  return security;
+}
+
 Q_GLOBAL_STATIC(QStringList, globalResultMessages);
 
 class MyMoneyStatementReader::Private
@@ -114,6 +136,8 @@ public:
   QMap<QString, bool>            uniqIds;
   QMap<QString, MyMoneySecurity> securitiesBySymbol;
   QMap<QString, MyMoneySecurity> securitiesByName;
+  ExistingTransactionMatchIndex  matchIndex;
+  PayeeMatchFinder               payeeMatchFinder;
   bool                           m_skipCategoryMatching;
   void (*m_progressCallback)(int, int, const QString&);
 private:
@@ -464,6 +488,15 @@ bool MyMoneyStatementReader::import(const MyMoneyStatement& s, QStringList& mess
   // open an engine transaction
   m_ft = new MyMoneyFileTransaction();
 
+  // index the existing transactions of the account once, so that
+  // matching each imported transaction does not scan the whole ledger
+  d->matchIndex.clear();
+  if (!m_userAbort)
+    d->matchIndex.addAccount(d->m_account.id());
+
+  // compile the matching information of all payees once for all transactions
+  d->payeeMatchFinder.setPayees(MyMoneyFile::instance()->payeeList());
+
   // see if we need to update some values stored with the account
   const auto statementEndDate = s.statementEndDate();
   if (d->m_account.value("lastStatementBalance") != s.m_closingBalance.toString()
@@ -609,16 +642,7 @@ void MyMoneyStatementReader::processSecurityEntry(const MyMoneyStatement::Securi
   // check if we already have the security
   // In a statement, we do not know what type of security this is, so we will
   // not use type as a matching factor.
-  MyMoneySecurity security;
-  QList<MyMoneySecurity> list = file->securityList();
-  QList<MyMoneySecurity>::ConstIterator it = list.constBegin();
-  while (it != list.constEnd() && security.id().isEmpty()) {
-    if (matchNotEmpty(sec_in.m_strSymbol, (*it).tradingSymbol()) ||
-        matchNotEmpty(sec_in.m_strName, (*it).name())) {
-      security = *it;
-    }
-    ++it;
-  }
+  MyMoneySecurity security = findSecurity(sec_in.m_strSymbol, sec_in.m_strName);
 
   // if the security was not found, we have to create it while not forgetting
   // to setup the type
@@ -736,16 +760,7 @@ void MyMoneyStatementReader::processTransactionEntry(const MyMoneyStatement::Tra
           KMessageBox::information(0, i18n("This imported statement contains investment transactions with no security.  These transactions will be ignored."), i18n("Security not found"), QString("BlankSecurity"));
           return;
         } else {
-          MyMoneySecurity security;
-          QList<MyMoneySecurity> list = MyMoneyFile::instance()->securityList();
-          QList<MyMoneySecurity>::ConstIterator it = list.constBegin();
-          while (it != list.constEnd() && security.id().isEmpty()) {
-            if (matchNotEmpty(statementTransactionUnderImport.m_strSymbol, (*it).tradingSymbol()) ||
-                matchNotEmpty(statementTransactionUnderImport.m_strSecurity, (*it).name())) {
-              security = *it;
-            }
-            ++it;
-          }
+          MyMoneySecurity security = findSecurity(statementTransactionUnderImport.m_strSymbol, statementTransactionUnderImport.m_strSecurity);
           if (!security.id().isEmpty()) {
             thisaccount = MyMoneyAccount();
             thisaccount.setName(security.name());
@@ -939,56 +954,9 @@ void MyMoneyStatementReader::processTransactionEntry(const MyMoneyStatement::Tra
     qDebug() << QLatin1String("Start matching payee") << payeename;
     QString payeeid;
     try {
-      QList<MyMoneyPayee> pList = file->payeeList();
-      QList<MyMoneyPayee>::const_iterator it_p;
-      QMap<int, QString> matchMap;
-      for (it_p = pList.constBegin(); it_p != pList.constEnd(); ++it_p) {
-        bool ignoreCase;
-        QStringList keys;
-        QStringList::const_iterator it_s;
-        const auto matchType = (*it_p).matchData(ignoreCase, keys);
-        switch (matchType) {
-          case eMyMoney::Payee::MatchType::Disabled:
-            break;
-
-          case eMyMoney::Payee::MatchType::Name:
-          case eMyMoney::Payee::MatchType::NameExact:
-            keys << QString("%1").arg(QRegExp::escape((*it_p).name()));
-            if(matchType == eMyMoney::Payee::MatchType::NameExact) {
-              keys.clear();
-              keys << QString("^%1$").arg(QRegExp::escape((*it_p).name()));
-            }
-            // intentional fall through
-
-          case eMyMoney::Payee::MatchType::Key:
-            for (it_s = keys.constBegin(); it_s != keys.constEnd(); ++it_s) {
-              QRegExp exp(*it_s, ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive);
-              if (exp.indexIn(payeename) != -1) {
-                qDebug("Found match with '%s' on '%s'", qPrintable(payeename), qPrintable((*it_p).name()));
-                matchMap[exp.matchedLength()] = (*it_p).id();
-              }
-            }
-            break;
-        }
-      }
-
-      // at this point we can have several scenarios:
-      // a) multiple matches
-      // b) a single match
-      // c) no match at all
-      //
-      // for c) we just do nothing, for b) we take the one we found
-      // in case of a) we take the one with the largest matchedLength()
-      // which happens to be the last one in the map
-      if (matchMap.count() > 1) {
-        qDebug("Multiple matches");
-        QMap<int, QString>::const_iterator it_m = matchMap.constEnd();
-        --it_m;
-        payeeid = *it_m;
-      } else if (matchMap.count() == 1) {
-        qDebug("Single matches");
-        payeeid = *(matchMap.constBegin());
-      }
+      payeeid = d->payeeMatchFinder.findMatch(payeename);
+      if (!payeeid.isEmpty())
+        qDebug("Found match with '%s' on '%s'", qPrintable(payeename), qPrintable(file->payee(payeeid).name()));
 
       // if we did not find a matching payee, we throw an exception and try to create it
       if (payeeid.isEmpty())
@@ -1087,6 +1055,7 @@ void MyMoneyStatementReader::processTransactionEntry(const MyMoneyStatement::Tra
           file->addPayee(payee);
           qDebug("Payee '%s' created", qPrintable(payee.name()));
           d->payees << payee;
+          d->payeeMatchFinder.addPayee(payee);
           payeeid = payee.id();
           s1.setPayeeId(payeeid);
 
@@ -1276,7 +1245,7 @@ void MyMoneyStatementReader::processTransactionEntry(const MyMoneyStatement::Tra
     TransactionMatcher matcher(thisaccount);
     d->transactionsCount++;
 
-    ExistingTransactionMatchFinder existingTrMatchFinder(KMyMoneySettings::matchInterval());
+    ExistingTransactionMatchFinder existingTrMatchFinder(KMyMoneySettings::matchInterval(), &d->matchIndex);
     result = existingTrMatchFinder.findMatch(transactionUnderImport, s1);
     if (result != TransactionMatchFinder::MatchNotFound) {
       MyMoneyTransaction matchedTransaction = existingTrMatchFinder.getMatchedTransaction();
@@ -1335,24 +1304,12 @@ bool MyMoneyStatementReader::selectOrCreateAccount(const SelectCreateMode /*mode
 
   QString accountNumber = account.number();
   if (! accountNumber.isEmpty()) {
-    // Get a list of all accounts
-    QList<MyMoneyAccount> accounts;
-    file->accountList(accounts);
-
-    // Iterate through them
-    QList<MyMoneyAccount>::const_iterator it_account = accounts.constBegin();
-    while (it_account != accounts.constEnd()) {
-      if (
-        ((*it_account).value("StatementKey") == accountNumber) ||
-        ((*it_account).number() == accountNumber)
-      ) {
-        MyMoneyAccount newAccount((*it_account).id(), account);
-        account = newAccount;
-        accountId = (*it_account).id();
-        break;
-      }
-
-      ++it_account;
+    // Both are looked up in the same index
+    const auto accounts = file->accountsByNumber(accountNumber);
+    if (!accounts.isEmpty()) {
+      MyMoneyAccount newAccount(accounts.first().id(), account);
+      account = newAccount;
+      accountId = accounts.first().id();
     }
   }
 
@@ -1469,6 +1426,7 @@ void MyMoneyStatementReader::handleMatchingOfExistingTransaction(TransactionMatc
       addTransaction(importedTransaction);
       qDebug("Detected as match to transaction '%s'", qPrintable(matchedTransaction.id()));
       matcher.match(matchedTransaction, matchedSplit, importedTransaction, importedSplit, true);
+      d->matchIndex.addTransaction(MyMoneyFile::instance()->transaction(matchedTransaction.id()));
       d->transactionsMatched++;
       break;
   }
@@ -1529,6 +1487,8 @@ void MyMoneyStatementReader::handleMatchingOfScheduledTransaction(TransactionMat
 
         // now match the two transactions
         matcher.match(torig, matchedSplit, importedTransaction, importedSplit);
+        if (!torig.id().isEmpty())
+          d->matchIndex.addTransaction(MyMoneyFile::instance()->transaction(torig.id()));
         d->transactionsMatched++;
 
       } catch (const MyMoneyException &) {
@@ -1548,6 +1508,7 @@ void MyMoneyStatementReader::addTransaction(MyMoneyTransaction& transaction)
   MyMoneyFile* file = MyMoneyFile::instance();
 
   file->addTransaction(transaction);
+  d->matchIndex.addTransaction(transaction);
   d->transactionsAdded++;
 }
 
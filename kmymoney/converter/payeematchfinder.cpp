@@ -0,0 +1,229 @@
+/***************************************************************************
+    KMyMoney transaction importing module - searches for the payee matching an imported name
+
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "payeematchfinder.h"
+
+#include <QDebug>
+#include <QRegExp>
+
+#include "mymoneypayee.h"
+#include "mymoneyenums.h"
+
+PayeeMatchFinder::PayeeMatchFinder() :
+    m_combinedDirty(false),
+    m_order(0)
+{
+}
+
+void PayeeMatchFinder::setPayees(const QList<MyMoneyPayee>& payees)
+{
+  m_exact.clear();
+  m_exactFolded.clear();
+  m_literals.clear();
+  m_patterns.clear();
+  m_alternatives.clear();
+  m_combined = QRegularExpression();
+  m_combinedDirty = false;
+  m_order = 0;
+
+  foreach (const MyMoneyPayee& payee, payees)
+    addPayee(payee);
+}
+
+void PayeeMatchFinder::addPayee(const MyMoneyPayee& payee)
+{
+  bool ignoreCase;
+  QStringList keys;
+  const auto matchType = payee.matchData(ignoreCase, keys);
+  switch (matchType) {
+    case eMyMoney::Payee::MatchType::Disabled:
+      break;
+
+    case eMyMoney::Payee::MatchType::Name:
+      addKey(QRegExp::escape(payee.name()), ignoreCase, payee.id());
+      break;
+
+    case eMyMoney::Payee::MatchType::NameExact:
+      addKey(QString("^%1$").arg(QRegExp::escape(payee.name())), ignoreCase, payee.id());
+      break;
+
+    case eMyMoney::Payee::MatchType::Key:
+      foreach (const QString& key, keys)
+        addKey(key, ignoreCase, payee.id());
+      break;
+  }
+}
+
+void PayeeMatchFinder::addKey(const QString& key, bool ignoreCase, const QString& payeeId)
+{
+  const Candidate candidate(payeeId, m_order++);
+  const auto cs = ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive;
+
+  QString text;
+  bool exact;
+  if (isLiteral(key, text, exact)) {
+    if (exact) {
+      // later keys win over earlier ones with the same match length
+      if (ignoreCase)
+        m_exactFolded[text.toCaseFolded()] = candidate;
+      else
+        m_exact[text] = candidate;
+      return;
+    }
+    LiteralKey literal;
+    literal.text = text;
+    literal.cs = cs;
+    literal.candidate = candidate;
+    m_literals.append(literal);
+    m_alternatives.append(QString("(?%1:%2)").arg(ignoreCase ? "i" : "").arg(QRegularExpression::escape(text)));
+    m_combinedDirty = true;
+    return;
+  }
+
+  PatternKey pattern;
+  pattern.exp = QRegExp(key, cs);
+  if (!pattern.exp.isValid()) {
+    qDebug("Ignoring invalid match key '%s'", qPrintable(key));
+    return;
+  }
+  pattern.candidate = candidate;
+  m_patterns.append(pattern);
+
+  // keys which QRegularExpression reads differently
+  // have to be tried on their own for every name
+  if (isPortable(key)) {
+    m_alternatives.append(QString("(?%1:%2)").arg(ignoreCase ? "i" : "").arg(key));
+    m_combinedDirty = true;
+  }
+}
+
+void PayeeMatchFinder::updateCombinedExpression() const
+{
+  if (!m_combinedDirty)
+    return;
+  m_combinedDirty = false;
+
+  const auto alternativeCount = m_alternatives.count();
+  const auto patternCount = m_literals.count() + m_patterns.count();
+  m_combined = QRegularExpression();
+  if (alternativeCount == 0 || alternativeCount != patternCount)
+    return;
+
+  // QRegExp matches \w, \s and . against any unicode character
+  m_combined = QRegularExpression(m_alternatives.join(QLatin1Char('|')),
+                                  QRegularExpression::DontCaptureOption
+                                  | QRegularExpression::UseUnicodePropertiesOption
+                                  | QRegularExpression::DotMatchesEverythingOption);
+  if (!m_combined.isValid()) {
+    // e.g. too many keys for a single expression: try them one by one
+    m_combined = QRegularExpression();
+    return;
+  }
+  m_combined.optimize();
+}
+
+QString PayeeMatchFinder::findMatch(const QString& name) const
+{
+  int bestLength = -1;
+  Candidate best;
+  const auto consider = [&](int length, const Candidate& candidate) {
+    if (length > bestLength || (length == bestLength && candidate.order > best.order)) {
+      bestLength = length;
+      best = candidate;
+    }
+  };
+
+  auto it = m_exact.constFind(name);
+  if (it != m_exact.constEnd())
+    consider(name.length(), *it);
+  it = m_exactFolded.constFind(name.toCaseFolded());
+  if (it != m_exactFolded.constEnd())
+    consider(name.length(), *it);
+
+  updateCombinedExpression();
+  if (!m_combined.pattern().isEmpty() && !m_combined.match(name).hasMatch())
+    return best.payeeId;
+
+  foreach (const LiteralKey& literal, m_literals) {
+    if (name.indexOf(literal.text, 0, literal.cs) != -1)
+      consider(literal.text.length(), literal.candidate);
+  }
+
+  foreach (const PatternKey& pattern, m_patterns) {
+    if (pattern.exp.indexIn(name) != -1)
+      consider(pattern.exp.matchedLength(), pattern.candidate);
+  }
+
+  return best.payeeId;
+}
+
+bool PayeeMatchFinder::isLiteral(const QString& pattern, QString& text, bool& exact)
+{
+  static const QString metaCharacters = QStringLiteral(".^$|()[]{}*+?");
+
+  text.clear();
+  auto anchoredStart = false;
+  auto anchoredEnd = false;
+  const auto length = pattern.length();
+  for (auto i = 0; i < length; ++i) {
+    const auto c = pattern.at(i);
+    if (c == QLatin1Char('\\')) {
+      // only escaped punctuation is literal, \d, \b and friends are not
+      if (i + 1 >= length || pattern.at(i + 1).isLetterOrNumber())
+        return false;
+      text.append(pattern.at(++i));
+    } else if (c == QLatin1Char('^') && i == 0) {
+      anchoredStart = true;
+    } else if (c == QLatin1Char('$') && i == length - 1) {
+      anchoredEnd = true;
+    } else if (metaCharacters.contains(c)) {
+      return false;
+    } else {
+      text.append(c);
+    }
+  }
+
+  exact = anchoredStart && anchoredEnd;
+  return anchoredStart == anchoredEnd;
+}
+
+bool PayeeMatchFinder::isPortable(const QString& pattern)
+{
+  // the escapes both syntaxes read alike. Back references are not among
+  // them, as they change their meaning once combined with other keys
+  static const QString escapes = QStringLiteral("bBdDsSwWfnrt");
+
+  const auto length = pattern.length();
+  for (auto i = 0; i < length; ++i) {
+    const auto c = pattern.at(i);
+    const auto next = (i + 1 < length) ? pattern.at(i + 1) : QChar();
+    if (c == QLatin1Char('\\')) {
+      // QRegExp reads e.g. \x0041 and \0101 differently
+      if (next.isLetterOrNumber() && !escapes.contains(next))
+        return false;
+      ++i;
+    } else if (c == QLatin1Char('[') && next == QLatin1Char(':')) {
+      return false;
+    } else if (c == QLatin1Char('{') && next == QLatin1Char(',')) {
+      return false;
+    } else if (c == QLatin1Char('(') && next == QLatin1Char('?')) {
+      const auto kind = (i + 2 < length) ? pattern.at(i + 2) : QChar();
+      if (kind != QLatin1Char(':') && kind != QLatin1Char('=') && kind != QLatin1Char('!'))
+        return false;
+    } else if (QStringLiteral("*+?}").contains(c) && (next == QLatin1Char('?') || next == QLatin1Char('+'))) {
+      return false;
+    }
+  }
+  return true;
+}
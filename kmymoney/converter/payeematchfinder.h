@@ -0,0 +1,109 @@
+/***************************************************************************
+    KMyMoney transaction importing module - searches for the payee matching an imported name
+
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PAYEEMATCHFINDER_H
+#define PAYEEMATCHFINDER_H
+
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include <QRegExp>
+#include <QRegularExpression>
+
+class MyMoneyPayee;
+
+/** Finds the payee whose matching information fits a payee name found in an imported statement.
+ *
+ * The match keys of all payees are compiled once: keys which match the whole name literally
+ * are kept in hash tables, other literal keys are searched as plain sub-strings and only the
+ * remaining keys are evaluated as regular expressions. Stored keys use the QRegExp syntax,
+ * so they are evaluated by QRegExp. All sub-string and regular expression keys are also
+ * combined into a single QRegularExpression which is used to skip them at once for names
+ * that do not match any of them. This is only done if every key has the same meaning in
+ * both syntaxes, see isPortable().
+ *
+ * The winner is the same as if every key is tried as regular expression in the order
+ * of the payee list: the key with the longest match wins, ties go to the last one tried.
+ */
+class PayeeMatchFinder
+{
+public:
+  PayeeMatchFinder();
+
+  /** Compiles the matching information of @a payees, dropping any previously added payee
+   * @param payees list of payees as returned by MyMoneyFile::payeeList()
+   */
+  void setPayees(const QList<MyMoneyPayee>& payees);
+
+  /** Adds the matching information of @a payee. It ranks behind all payees added before.
+   */
+  void addPayee(const MyMoneyPayee& payee);
+
+  /** Searches for the payee matching @a name
+   * @param name the payee name found in the imported transaction
+   * @return the id of the matching payee or an empty string if no payee matches
+   */
+  QString findMatch(const QString& name) const;
+
+private:
+  struct Candidate {
+    Candidate() : order(-1) {}
+    Candidate(const QString& id, int o) : payeeId(id), order(o) {}
+    QString payeeId;
+    int     order;      ///< position in which the key would have been tried
+  };
+
+  struct LiteralKey {
+    QString              text;
+    Qt::CaseSensitivity  cs;
+    Candidate            candidate;
+  };
+
+  struct PatternKey {
+    QRegExp              exp;
+    Candidate            candidate;
+  };
+
+  void addKey(const QString& key, bool ignoreCase, const QString& payeeId);
+  void updateCombinedExpression() const;
+
+  /** Checks whether @a pattern matches literal text only
+   * @param pattern the regular expression
+   * @param text returns the unescaped text
+   * @param exact returns whether the pattern is anchored at both ends
+   * @return true if @a pattern is literal text which is either unanchored or anchored at both ends
+   */
+  static bool isLiteral(const QString& pattern, QString& text, bool& exact);
+
+  /** Checks whether QRegularExpression finds a match for @a pattern in every name
+   * in which QRegExp finds one. Escape sequences other than character classes and
+   * word boundaries, POSIX classes, QRegExp's {,n} and the lazy and possessive
+   * quantifiers of QRegularExpression are rejected.
+   * @param pattern the regular expression in QRegExp syntax
+   * @return true if @a pattern can be part of the combined expression
+   */
+  static bool isPortable(const QString& pattern);
+
+  QHash<QString, Candidate>         m_exact;          ///< exact names, case sensitive
+  QHash<QString, Candidate>         m_exactFolded;    ///< exact names, case folded
+  QVector<LiteralKey>               m_literals;
+  QVector<PatternKey>               m_patterns;
+  QStringList                       m_alternatives;
+  mutable QRegularExpression        m_combined;
+  mutable bool                      m_combinedDirty;
+  int                               m_order;
+};
+
+#endif // PAYEEMATCHFINDER_H
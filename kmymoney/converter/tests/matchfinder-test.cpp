@@ -20,6 +20,7 @@
 #include <QTest>
 
 #include "mymoneyfile.h"
+#include "existingtransactionmatchindex.h"
 #include "mymoneysecurity.h"
 #include "mymoneymoney.h"
 #include "mymoneyenums.h"
@@ -429,6 +430,46 @@ void MatchFinderTest::testExistingTransactionMatch_multipleAccounts_noBankId()
   expectMatchWithExistingTransaction(TransactionMatchFinder::MatchNotFound);
 }
 
+void MatchFinderTest::testExistingTransactionMatch_matchIndex()
+{
+  ExistingTransactionMatchIndex index;
+  index.addAccount(account->id());
+  existingTrFinder.reset(new ExistingTransactionMatchFinder(MATCH_WINDOW, &index));
+
+  ledgerTransaction.splits().first().setBankID("");
+  importTransaction.splits().first().setBankID("");
+  importTransaction.setPostDate(importTransaction.postDate().addDays(MATCH_WINDOW));
+  QString transactionId = addTransactionToLedger(ledgerTransaction);
+
+  // the transaction was added after the account has been indexed
+  expectMatchWithExistingTransaction(TransactionMatchFinder::MatchNotFound);
+
+  index.addTransaction(file->transaction(transactionId));
+  expectMatchWithExistingTransaction(TransactionMatchFinder::MatchImprecise);
+  QCOMPARE(existingTrFinder->getMatchedTransaction().id(), transactionId);
+
+  // modifications are picked up from the engine
+  MyMoneyTransaction transaction = file->transaction(transactionId);
+  transaction.setPostDate(transaction.postDate().addDays(-1));
+  MyMoneyFileTransaction ft;
+  file->modifyTransaction(transaction);
+  ft.commit();
+  index.addTransaction(transaction);
+  expectMatchWithExistingTransaction(TransactionMatchFinder::MatchNotFound);
+
+  // removed transactions are skipped
+  ft.restart();
+  file->removeTransaction(transaction);
+  ft.commit();
+  expectMatchWithExistingTransaction(TransactionMatchFinder::MatchNotFound);
+
+  // accounts are indexed on first use
+  ExistingTransactionMatchIndex lazyIndex;
+  addTransactionToLedger(ledgerTransaction);
+  existingTrFinder.reset(new ExistingTransactionMatchFinder(MATCH_WINDOW, &lazyIndex));
+  expectMatchWithExistingTransaction(TransactionMatchFinder::MatchImprecise);
+}
+
 
 void MatchFinderTest::testScheduleMatch_allMatch()
 {
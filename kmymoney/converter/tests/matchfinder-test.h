@@ -96,6 +96,7 @@ private Q_SLOTS:
   void testExistingTransactionMatch_sameTransactionId_noBankId();
   void testExistingTransactionMatch_multipleAccounts_withBankId();
   void testExistingTransactionMatch_multipleAccounts_noBankId();
+  void testExistingTransactionMatch_matchIndex();
 
   void testScheduleMatch_allMatch();
   void testScheduleMatch_dueDateWithinMatchWindow();
@@ -0,0 +1,179 @@
+/***************************************************************************
+    KMyMoney transaction importing module - tests for PayeeMatchFinder
+
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "payeematchfinder-test.h"
+
+#include <QTest>
+#include <QRegExp>
+
+#include "payeematchfinder.h"
+#include "mymoneyenums.h"
+
+QTEST_GUILESS_MAIN(PayeeMatchFinderTest)
+
+MyMoneyPayee PayeeMatchFinderTest::buildPayee(const QString& id, const QString& name, eMyMoney::Payee::MatchType type, bool ignoreCase, const QStringList& keys)
+{
+  MyMoneyPayee payee(id);
+  payee.setName(name);
+  payee.setMatchData(type, ignoreCase, keys);
+  return payee;
+}
+
+// the matching as it was done by MyMoneyStatementReader before PayeeMatchFinder existed
+QString PayeeMatchFinderTest::referenceMatch(const QList<MyMoneyPayee>& payees, const QString& name)
+{
+  QMap<int, QString> matchMap;
+  foreach (const MyMoneyPayee& payee, payees) {
+    bool ignoreCase;
+    QStringList keys;
+    const auto matchType = payee.matchData(ignoreCase, keys);
+    if (matchType == eMyMoney::Payee::MatchType::Disabled)
+      continue;
+    if (matchType == eMyMoney::Payee::MatchType::Name)
+      keys << QRegExp::escape(payee.name());
+    else if (matchType == eMyMoney::Payee::MatchType::NameExact)
+      keys = QStringList() << QString("^%1$").arg(QRegExp::escape(payee.name()));
+
+    foreach (const QString& key, keys) {
+      QRegExp exp(key, ignoreCase ? Qt::CaseInsensitive : Qt::CaseSensitive);
+      if (exp.indexIn(name) != -1)
+        matchMap[exp.matchedLength()] = payee.id();
+    }
+  }
+  return matchMap.isEmpty() ? QString() : matchMap.last();
+}
+
+void PayeeMatchFinderTest::init()
+{
+  m_payees.clear();
+  m_payees << buildPayee("P000001", "Grocery", eMyMoney::Payee::MatchType::Name, true);
+  m_payees << buildPayee("P000002", "Grocery Store", eMyMoney::Payee::MatchType::Name, false);
+  m_payees << buildPayee("P000003", "ACME Inc.", eMyMoney::Payee::MatchType::NameExact, false);
+  m_payees << buildPayee("P000004", "Acme", eMyMoney::Payee::MatchType::Key, true, QStringList() << "^acme inc.$");
+  m_payees << buildPayee("P000005", "Gas", eMyMoney::Payee::MatchType::Key, false, QStringList() << "SHELL \\d+" << "ESSO");
+  m_payees << buildPayee("P000006", "Disabled", eMyMoney::Payee::MatchType::Disabled, false);
+  m_payees << buildPayee("P000007", "Bank (fees)", eMyMoney::Payee::MatchType::Name, false);
+  m_payees << buildPayee("P000008", "Dup", eMyMoney::Payee::MatchType::Key, false, QStringList() << "^Dup$");
+  m_payees << buildPayee("P000009", "Dup too", eMyMoney::Payee::MatchType::Key, false, QStringList() << "^Dup$");
+}
+
+void PayeeMatchFinderTest::testFindMatch_data()
+{
+  QTest::addColumn<QString>("name");
+  QTest::addColumn<QString>("payeeId");
+
+  QTest::newRow("no match") << "Nobody" << QString();
+  QTest::newRow("name, ignore case") << "my grocery" << "P000001";
+  QTest::newRow("longest match wins") << "Grocery Store 5th Ave" << "P000002";
+  QTest::newRow("name is case sensitive") << "grocery store" << "P000001";
+  QTest::newRow("exact name") << "ACME Inc." << "P000004";
+  QTest::newRow("exact name, ignore case") << "acme INC." << "P000004";
+  QTest::newRow("exact name only") << "ACME Inc. Ltd" << QString();
+  QTest::newRow("regular expression") << "SHELL 1234 Main St" << "P000005";
+  QTest::newRow("regular expression mismatch") << "SHELL Main St" << QString();
+  QTest::newRow("second key") << "ESSO" << "P000005";
+  QTest::newRow("disabled") << "Disabled" << QString();
+  QTest::newRow("meta characters in name") << "Bank (fees) March" << "P000007";
+  QTest::newRow("last one wins on tie") << "Dup" << "P000009";
+}
+
+void PayeeMatchFinderTest::testFindMatch()
+{
+  QFETCH(QString, name);
+  QFETCH(QString, payeeId);
+
+  PayeeMatchFinder finder;
+  finder.setPayees(m_payees);
+  QCOMPARE(referenceMatch(m_payees, name), payeeId);
+  QCOMPARE(finder.findMatch(name), payeeId);
+}
+
+void PayeeMatchFinderTest::testQRegExpSyntax_data()
+{
+  QTest::addColumn<QString>("key");
+  QTest::addColumn<QString>("name");
+
+  // stored keys are QRegExp patterns, some of which QRegularExpression reads differently
+  QTest::newRow("unicode word characters") << "^\\w+ Caf\\w$" << QString::fromUtf8("Müller Café");
+  QTest::newRow("four digit hex escape") << "^\\x0041BC" << "ABC Corp";
+  QTest::newRow("at most quantifier") << "^AB{,2}C$" << "ABBC";
+  QTest::newRow("word boundary") << "\\bshell\\b" << "Shell Station 12";
+  QTest::newRow("back reference") << "(\\d)\\1" << "Store 11";
+  QTest::newRow("alternation") << "Shop|Shopping" << "Shopping Mall";
+}
+
+void PayeeMatchFinderTest::testQRegExpSyntax()
+{
+  QFETCH(QString, key);
+  QFETCH(QString, name);
+
+  // the key competes with a plain name key and with a portable pattern
+  auto payees = m_payees;
+  payees << buildPayee("P000010", "Pattern", eMyMoney::Payee::MatchType::Key, true, QStringList() << key);
+  payees << buildPayee("P000011", "Shopping", eMyMoney::Payee::MatchType::Name, true);
+  payees << buildPayee("P000012", "Digits", eMyMoney::Payee::MatchType::Key, false, QStringList() << "\\d+");
+
+  PayeeMatchFinder finder;
+  finder.setPayees(payees);
+  const auto expected = referenceMatch(payees, name);
+  QVERIFY(!expected.isEmpty());
+  QCOMPARE(finder.findMatch(name), expected);
+
+  // also when the key is the only one which can match
+  PayeeMatchFinder single;
+  single.setPayees(QList<MyMoneyPayee>() << payees.at(payees.count() - 3));
+  QCOMPARE(single.findMatch(name), QString("P000010"));
+}
+
+void PayeeMatchFinderTest::testAddPayee()
+{
+  PayeeMatchFinder finder;
+  finder.setPayees(m_payees);
+  QCOMPARE(finder.findMatch("New Payee"), QString());
+
+  finder.addPayee(buildPayee("P000010", "New Payee", eMyMoney::Payee::MatchType::Key, true, QStringList() << QString("^%1$").arg(QRegExp::escape("New Payee"))));
+  QCOMPARE(finder.findMatch("new payee"), QString("P000010"));
+
+  // setPayees() starts from scratch
+  finder.setPayees(QList<MyMoneyPayee>());
+  QCOMPARE(finder.findMatch("new payee"), QString());
+  QCOMPARE(finder.findMatch("Grocery"), QString());
+}
+
+void PayeeMatchFinderTest::testManyPayees()
+{
+  QList<MyMoneyPayee> payees;
+  for (auto i = 1; i <= 3000; ++i) {
+    const auto id = QString("P%1").arg(i, 6, 10, QLatin1Char('0'));
+    const auto name = QString("Payee %1").arg(i);
+    switch (i % 3) {
+      case 0:
+        payees << buildPayee(id, name, eMyMoney::Payee::MatchType::Key, true, QStringList() << QString("^%1$").arg(QRegExp::escape(name)));
+        break;
+      case 1:
+        payees << buildPayee(id, name, eMyMoney::Payee::MatchType::Name, false);
+        break;
+      default:
+        payees << buildPayee(id, name, eMyMoney::Payee::MatchType::Key, false, QStringList() << QString("^%1 [A-Z]+").arg(QRegExp::escape(name)));
+        break;
+    }
+  }
+
+  PayeeMatchFinder finder;
+  finder.setPayees(payees);
+
+  const QStringList names = QStringList() << "payee 300" << "Payee 1" << "Payee 1000 x" << "Payee 20 ABC" << "Payee 2000 ABC" << "nobody";
+  foreach (const QString& name, names)
+    QCOMPARE(finder.findMatch(name), referenceMatch(payees, name));
+}
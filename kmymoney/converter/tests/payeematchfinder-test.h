@@ -0,0 +1,44 @@
+/***************************************************************************
+    KMyMoney transaction importing module - tests for PayeeMatchFinder
+
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PAYEEMATCHFINDERTEST_H
+#define PAYEEMATCHFINDERTEST_H
+
+#include <QObject>
+#include <QList>
+
+#include "mymoneypayee.h"
+
+class PayeeMatchFinderTest : public QObject
+{
+  Q_OBJECT
+
+private:
+  QList<MyMoneyPayee> m_payees;
+
+  static MyMoneyPayee buildPayee(const QString& id, const QString& name, eMyMoney::Payee::MatchType type, bool ignoreCase, const QStringList& keys = QStringList());
+  static QString referenceMatch(const QList<MyMoneyPayee>& payees, const QString& name);
+
+private Q_SLOTS:
+  void init();
+
+  void testFindMatch_data();
+  void testFindMatch();
+  void testQRegExpSyntax_data();
+  void testQRegExpSyntax();
+  void testAddPayee();
+  void testManyPayees();
+};
+
+#endif // PAYEEMATCHFINDERTEST_H
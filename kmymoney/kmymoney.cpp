@@ -116,12 +116,14 @@
 #include "models/accountsmodel.h"
 #include "models/equitiesmodel.h"
 #include "models/securitiesmodel.h"
+#include "mymoney/storage/payeesmodel.h"
 #ifdef ENABLE_UNFINISHEDFEATURES
 #include "models/ledgermodel.h"
 #endif
 
 #include "mymoney/mymoneyobject.h"
 #include "mymoney/mymoneyfile.h"
+#include "mymoney/mymoneychanges.h"
 #include "mymoney/mymoneyinstitution.h"
 #include "mymoney/mymoneyaccount.h"
 #include "mymoney/mymoneyaccountloan.h"
@@ -454,19 +456,15 @@ public:
   {
     const auto file = MyMoneyFile::instance();
 
+    // these models update themselves once per MyMoneyFile transaction
     const auto accountsModel = Models::instance()->accountsModel();
-    q->connect(file, &MyMoneyFile::objectAdded,    accountsModel, &AccountsModel::slotObjectAdded);
-    q->connect(file, &MyMoneyFile::objectModified, accountsModel, &AccountsModel::slotObjectModified);
-    q->connect(file, &MyMoneyFile::objectRemoved,  accountsModel, &AccountsModel::slotObjectRemoved);
-    q->connect(file, &MyMoneyFile::balanceChanged, accountsModel, &AccountsModel::slotBalanceOrValueChanged);
-    q->connect(file, &MyMoneyFile::valueChanged,   accountsModel, &AccountsModel::slotBalanceOrValueChanged);
+    q->connect(file, &MyMoneyFile::objectsChanged, accountsModel, &AccountsModel::slotObjectsChanged);
 
     const auto institutionsModel = Models::instance()->institutionsModel();
-    q->connect(file, &MyMoneyFile::objectAdded,    institutionsModel, &InstitutionsModel::slotObjectAdded);
-    q->connect(file, &MyMoneyFile::objectModified, institutionsModel, &InstitutionsModel::slotObjectModified);
-    q->connect(file, &MyMoneyFile::objectRemoved,  institutionsModel, &InstitutionsModel::slotObjectRemoved);
-    q->connect(file, &MyMoneyFile::balanceChanged, institutionsModel, &AccountsModel::slotBalanceOrValueChanged);
-    q->connect(file, &MyMoneyFile::valueChanged,   institutionsModel, &AccountsModel::slotBalanceOrValueChanged);
+    q->connect(file, &MyMoneyFile::objectsChanged, institutionsModel, &InstitutionsModel::slotObjectsChanged);
+
+    const auto payeesModel = Models::instance()->payeesModel();
+    q->connect(file, &MyMoneyFile::objectsChanged, payeesModel, &PayeesModel::slotObjectsChanged);
 
     const auto equitiesModel = Models::instance()->equitiesModel();
     q->connect(file, &MyMoneyFile::objectAdded,    equitiesModel, &EquitiesModel::slotObjectAdded);
@@ -482,13 +480,7 @@ public:
 
 #ifdef ENABLE_UNFINISHEDFEATURES
     const auto ledgerModel = Models::instance()->ledgerModel();
-    q->connect(file, &MyMoneyFile::objectAdded,    ledgerModel, &LedgerModel::slotAddTransaction);
-    q->connect(file, &MyMoneyFile::objectModified, ledgerModel, &LedgerModel::slotModifyTransaction);
-    q->connect(file, &MyMoneyFile::objectRemoved,  ledgerModel, &LedgerModel::slotRemoveTransaction);
-
-    q->connect(file, &MyMoneyFile::objectAdded,    ledgerModel, &LedgerModel::slotAddSchedule);
-    q->connect(file, &MyMoneyFile::objectModified, ledgerModel, &LedgerModel::slotModifySchedule);
-    q->connect(file, &MyMoneyFile::objectRemoved,  ledgerModel, &LedgerModel::slotRemoveSchedule);
+    q->connect(file, &MyMoneyFile::objectsChanged, ledgerModel, &LedgerModel::slotObjectsChanged);
 #endif
   }
 
@@ -497,6 +489,7 @@ public:
     const auto file = MyMoneyFile::instance();
     q->disconnect(file, nullptr, Models::instance()->accountsModel(), nullptr);
     q->disconnect(file, nullptr, Models::instance()->institutionsModel(), nullptr);
+    q->disconnect(file, nullptr, Models::instance()->payeesModel(), nullptr);
     q->disconnect(file, nullptr, Models::instance()->equitiesModel(), nullptr);
     q->disconnect(file, nullptr, Models::instance()->securitiesModel(), nullptr);
 
@@ -1128,6 +1121,15 @@ public:
   bool canFileSaveAs() const;
   bool canUpdateAllAccounts() const;
   void fileAction(eKMyMoney::FileAction action);
+
+  /**
+    * Saves the current data in the background so that the user can
+    * continue to work while the file is written.
+    *
+    * @retval true if saving has been started
+    * @retval false otherwise
+    */
+  bool autoSave();
 };
 
 KMyMoneyApp::KMyMoneyApp(QWidget* parent) :
@@ -3165,10 +3167,10 @@ void KMyMoneyApp::slotAutoSave()
     d->m_inAutoSaving = true;
     KMSTATUS(i18n("Auto saving..."));
 
-    //calls slotFileSave if needed, and restart the timer
+    //saves the file in the background if needed, and restart the timer
     //it the file is not saved, reinitializes the countdown.
     if (d->dirty() && d->m_autoSaveEnabled) {
-      if (!slotFileSave() && d->m_autoSavePeriod > 0) {
+      if (!d->autoSave() && d->m_autoSavePeriod > 0) {
         d->m_autoSaveTimer->setSingleShot(true);
         d->m_autoSaveTimer->start(d->m_autoSavePeriod * 60 * 1000);
       }
@@ -3547,6 +3549,35 @@ void KMyMoneyApp::slotFileQuit()
   }
 }
 
+bool KMyMoneyApp::Private::autoSave()
+{
+  for (const auto& plugin : pPlugins.storage) {
+    if (plugin->storageType() == m_storageInfo.type) {
+      consistencyCheck(false);
+      const auto url = m_storageInfo.url;
+      try {
+        return plugin->saveInBackground(url, [this, url](bool saved) {
+          // the file might have been closed or replaced in the meantime
+          if (!m_storageInfo.isOpened || m_storageInfo.url != url)
+            return;
+
+          // changes made while the file was written are not part of it
+          if (saved && !dirty()) {
+            fileAction(eKMyMoney::FileAction::Saved);
+          } else if (m_autoSaveEnabled && m_autoSavePeriod > 0) {
+            m_autoSaveTimer->setSingleShot(true);
+            m_autoSaveTimer->start(m_autoSavePeriod * 60 * 1000);
+          }
+        });
+      } catch (const MyMoneyException &e) {
+        KMessageBox::detailedError(q, i18n("Failed to save your storage."), e.what());
+        return false;
+      }
+    }
+  }
+  return false;
+}
+
 void KMyMoneyApp::Private::fileAction(eKMyMoney::FileAction action)
 {
   switch(action) {
@@ -22,6 +22,8 @@
 // QT Includes
 
 #include <QIcon>
+#include <QSet>
+#include <QMultiMap>
 
 // ----------------------------------------------------------------------------
 // KDE Includes
@@ -35,6 +37,7 @@
 #include "mymoneymoney.h"
 #include "mymoneyexception.h"
 #include "mymoneyfile.h"
+#include "mymoneychanges.h"
 #include "mymoneyinstitution.h"
 #include "mymoneyaccount.h"
 #include "mymoneysecurity.h"
@@ -1006,6 +1009,57 @@ void AccountsModel::slotBalanceOrValueChanged(const MyMoneyAccount &account)
   checkProfit();
 }
 
+/**
+  * Notify the model about all changes of a MyMoneyFile transaction.
+  */
+void AccountsModel::slotObjectsChanged(const MyMoneyChanges& changes)
+{
+  foreach (const auto id, changes.ids(File::Mode::Remove, File::Object::Account))
+    slotObjectRemoved(File::Object::Account, id);
+  foreach (const auto id, changes.ids(File::Mode::Add, File::Object::Account))
+    slotObjectAdded(File::Object::Account, id);
+  foreach (const auto id, changes.ids(File::Mode::Modify, File::Object::Account))
+    slotObjectModified(File::Object::Account, id);
+
+  const auto accountIds = changes.balanceChanges() + changes.valueChanges();
+  if (!accountIds.isEmpty())
+    updateBalances(accountIds);
+}
+
+void AccountsModel::updateBalances(const QStringList& accountIds)
+{
+  Q_D(AccountsModel);
+  // collect the nodes of the accounts and of all their parents
+  QSet<QStandardItem*> items;
+  for (const auto& id : accountIds) {
+    for (auto item = d->itemFromAccountId(this, id); item && !items.contains(item); item = item->parent())
+      items.insert(item);
+  }
+
+  // sort them by depth so that the deepest nodes are updated first
+  QMultiMap<int, QStandardItem*> itemsByDepth;
+  for (const auto item : items) {
+    auto depth = 0;
+    for (auto parent = item->parent(); parent; parent = parent->parent())
+      ++depth;
+    itemsByDepth.insert(-depth, item);
+  }
+
+  for (const auto item : itemsByDepth) {
+    const auto account = d->m_file->account(item->data((int)Role::Account).value<MyMoneyAccount>().id());
+    if (account.id().isEmpty()) {   // this is institution
+      d->setInstitutionTotalValue(invisibleRootItem(), item->row());
+      continue;
+    }
+    auto parent = item->parent();
+    if (!parent)
+      parent = invisibleRootItem();
+    d->setAccountBalanceAndValue(parent, item->row(), account, d->m_columns);
+  }
+  checkNetWorth();
+  checkProfit();
+}
+
 /**
   * The pimpl of the @ref InstitutionsModel derived from the pimpl of the @ref AccountsModel.
   */
@@ -1252,3 +1306,26 @@ void InstitutionsModel::slotObjectRemoved(File::Object objType, const QString& i
     d->setInstitutionTotalValue(invisibleRootItem(), itInstitution->row());
   }
 }
+
+/**
+  * Notify the model about all changes of a MyMoneyFile transaction.
+  */
+void InstitutionsModel::slotObjectsChanged(const MyMoneyChanges& changes)
+{
+  foreach (const auto id, changes.ids(File::Mode::Remove, File::Object::Account))
+    slotObjectRemoved(File::Object::Account, id);
+  foreach (const auto id, changes.ids(File::Mode::Remove, File::Object::Institution))
+    slotObjectRemoved(File::Object::Institution, id);
+  foreach (const auto id, changes.ids(File::Mode::Add, File::Object::Institution))
+    slotObjectAdded(File::Object::Institution, id);
+  foreach (const auto id, changes.ids(File::Mode::Add, File::Object::Account))
+    slotObjectAdded(File::Object::Account, id);
+  foreach (const auto id, changes.ids(File::Mode::Modify, File::Object::Institution))
+    slotObjectModified(File::Object::Institution, id);
+  foreach (const auto id, changes.ids(File::Mode::Modify, File::Object::Account))
+    slotObjectModified(File::Object::Account, id);
+
+  const auto accountIds = changes.balanceChanges() + changes.valueChanges();
+  if (!accountIds.isEmpty())
+    updateBalances(accountIds);
+}
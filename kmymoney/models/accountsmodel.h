@@ -50,6 +50,7 @@
 class MyMoneyObject;
 class MyMoneyMoney;
 class MyMoneyAccount;
+class MyMoneyChanges;
 
 namespace eMyMoney { namespace File { enum class Object; } }
 namespace eAccountsModel { enum class Column; }
@@ -104,6 +105,12 @@ public Q_SLOTS:
   void slotObjectRemoved(eMyMoney::File::Object objType, const QString& id);
   void slotBalanceOrValueChanged(const MyMoneyAccount &account);
 
+  /**
+    * Notify the model about all changes of a MyMoneyFile transaction at once.
+    * The balances of parent accounts are recomputed only once per parent.
+    */
+  void slotObjectsChanged(const MyMoneyChanges& changes);
+
 Q_SIGNALS:
   /**
     * Emit this signal when the net worth based on the value of the loaded accounts is changed.
@@ -119,6 +126,12 @@ protected:
   AccountsModelPrivate * const d_ptr;
   AccountsModel(AccountsModelPrivate &dd, QObject *parent);
 
+  /**
+    * Updates the balance and value of the accounts with @a accountIds and of
+    * all their parents from the bottom to the top. Each item is updated once.
+    */
+  void updateBalances(const QStringList& accountIds);
+
 private:
   Q_DECLARE_PRIVATE(AccountsModel)
 
@@ -158,6 +171,7 @@ public Q_SLOTS:
   void slotObjectAdded(eMyMoney::File::Object objType, const QString &id);
   void slotObjectModified(eMyMoney::File::Object objType, const QString &id);
   void slotObjectRemoved(eMyMoney::File::Object objType, const QString& id);
+  void slotObjectsChanged(const MyMoneyChanges& changes);
 
 private:
   Q_DECLARE_PRIVATE(InstitutionsModel)
@@ -18,11 +18,15 @@
 
 #include "ledgermodel.h"
 
+#include <algorithm>
+
 // ----------------------------------------------------------------------------
 // QT Includes
 
 #include <QDebug>
 #include <QString>
+#include <QSet>
+#include <QHash>
 
 // ----------------------------------------------------------------------------
 // KDE Includes
@@ -39,6 +43,7 @@
 #include "mymoneytransaction.h"
 #include "mymoneytransactionfilter.h"
 #include "mymoneyfile.h"
+#include "mymoneychanges.h"
 #include "mymoneymoney.h"
 #include "mymoneyexception.h"
 #include "kmymoneyutils.h"
@@ -49,15 +54,309 @@
 using namespace eLedgerModel;
 using namespace eMyMoney;
 
+/**
+  * The number of changed transactions up to which
+  * slotObjectsChanged() updates the model row by row
+  */
+static const int maxIncrementalTransactionChanges = 10;
+
+/**
+  * The number of items which are kept for rows that have been used
+  * recently. Once it is exceeded, the least recently used half of
+  * them is dropped and created again when their rows are needed.
+  */
+static const int maxCachedItems = 1000;
+
+/**
+  * The number of rows before and after a requested row whose items are
+  * created along with it, so that scrolling through the ledger does not
+  * fetch the transactions one by one.
+  */
+static const int prefetchRows = 50;
+
 class LedgerModelPrivate
 {
 public:
+  /**
+    * A row of the model. It keeps everything which is needed to filter and
+    * sort the rows and to compute the balances. The LedgerItem with all
+    * other information is only created when the row is used. Schedules and
+    * the entry for a new transaction are not stored in the engine, so their
+    * items are kept permanently.
+    */
+  struct Row
+  {
+    Row() : item(nullptr), permanent(false), lastUsed(0) {}
+
+    QString       transactionId;
+    QString       splitId;
+    QString       accountId;
+    QDate         postDate;
+    MyMoneyMoney  shares;
+    QString       balance;
+    LedgerItem*   item;
+    bool          permanent;
+    quint32       lastUsed;
+  };
+
+  LedgerModelPrivate() :
+    m_indexedRows(0),
+    m_cachedItems(0),
+    m_usage(0)
+  {
+  }
+
   ~LedgerModelPrivate() {
-    qDeleteAll(m_ledgerItems);
-    m_ledgerItems.clear();
+    clear();
+  }
+
+  static Row transactionRow(const MyMoneyTransaction& t, const MyMoneySplit& split)
+  {
+    Row row;
+    row.transactionId = t.id();
+    row.splitId = split.id();
+    row.accountId = split.accountId();
+    row.postDate = t.postDate();
+    row.shares = split.shares();
+    return row;
+  }
+
+  static Row permanentRow(LedgerItem* item)
+  {
+    Row row;
+    row.transactionId = item->transactionId();
+    row.splitId = item->split().id();
+    row.accountId = item->accountId();
+    row.postDate = item->postDate();
+    row.shares = item->shares();
+    row.item = item;
+    row.permanent = true;
+    return row;
+  }
+
+  QString transactionSplitId(const Row& row) const
+  {
+    if (row.transactionId.isEmpty())
+      return QString();
+    return QString("%1-%2").arg(row.transactionId, row.splitId);
+  }
+
+  /**
+    * Returns the item of @a row. If it does not exist, it is
+    * created together with the items of the rows around it.
+    */
+  LedgerItem* item(int row)
+  {
+    if (!m_rows[row].item)
+      createItems(qMax(0, row - prefetchRows), qMin(m_rows.count() - 1, row + prefetchRows));
+    m_rows[row].lastUsed = ++m_usage;
+    return m_rows[row].item;
+  }
+
+  /**
+    * Creates the missing items of the rows @a first to @a last
+    */
+  void createItems(int first, int last)
+  {
+    if (m_cachedItems + last - first + 1 > maxCachedItems)
+      releaseItems();
+
+    const auto file = MyMoneyFile::instance();
+    MyMoneyTransaction t;
+    for (auto row = first; row <= last; ++row) {
+      auto& r = m_rows[row];
+      if (r.item)
+        continue;
+      // the splits of a transaction are kept in consecutive rows, so
+      // each transaction is only fetched once from the engine
+      if (t.id() != r.transactionId) {
+        try {
+          t = file->transaction(r.transactionId);
+        } catch (const MyMoneyException &) {
+          t = MyMoneyTransaction();
+        }
+      }
+      MyMoneySplit split;
+      try {
+        split = t.splitById(r.splitId);
+      } catch (const MyMoneyException &) {
+      }
+      r.item = new LedgerTransaction(t, split);
+      r.item->setBalance(r.balance);
+      r.lastUsed = ++m_usage;
+      ++m_cachedItems;
+    }
   }
+
+  /**
+    * Drops the least recently used half of the items which
+    * can be created again from the engine
+    */
+  void releaseItems()
+  {
+    QVector<quint32> usage;
+    usage.reserve(m_cachedItems);
+    for (const auto& row : m_rows) {
+      if (row.item && !row.permanent)
+        usage.append(row.lastUsed);
+    }
+    if (usage.isEmpty())
+      return;
+
+    const auto median = usage.begin() + usage.count() / 2;
+    std::nth_element(usage.begin(), median, usage.end());
+    const auto limit = *median;
+    for (auto& row : m_rows) {
+      if (row.item && !row.permanent && row.lastUsed < limit)
+        deleteItem(row);
+    }
+  }
+
+  void deleteItem(Row& row)
+  {
+    if (row.item) {
+      if (!row.permanent)
+        --m_cachedItems;
+      delete row.item;
+      row.item = nullptr;
+    }
+  }
+
+  void clear()
+  {
+    for (auto& row : m_rows)
+      deleteItem(row);
+    m_rows.clear();
+    rebuildIndex();
+  }
+
+  /**
+    * Inserts @a rows at position @a first
+    */
+  void insertRows(int first, const QVector<Row>& rows)
+  {
+    dropFromIndex(rows.constBegin(), rows.constEnd(), first);
+    if (first == m_rows.count()) {
+      m_rows += rows;
+    } else {
+      m_rows.insert(first, rows.count(), Row());
+      std::copy(rows.constBegin(), rows.constEnd(), m_rows.begin() + first);
+    }
+  }
+
+  void appendRows(const QVector<Row>& rows)
+  {
+    insertRows(m_rows.count(), rows);
+  }
+
+  /**
+    * Removes @a count rows starting at @a first
+    */
+  void removeRows(int first, int count)
+  {
+    dropFromIndex(m_rows.constBegin() + first, m_rows.constBegin() + first + count, first);
+    for (auto row = first; row < first + count; ++row)
+      deleteItem(m_rows[row]);
+    m_rows.remove(first, count);
+  }
+
+  /**
+    * Returns the first row and the number of rows of the splits of the
+    * transaction or schedule with @a id. If @a id is unknown, the
+    * pair (number of rows, 0) is returned.
+    */
+  QPair<int, int> transactionRows(const QString& id)
+  {
+    auto it = m_transactionRows.constFind(id);
+    if (it == m_transactionRows.constEnd() || (*it).first >= m_indexedRows) {
+      updateIndex();
+      it = m_transactionRows.constFind(id);
+    }
+    if (it == m_transactionRows.constEnd())
+      return qMakePair(m_rows.count(), 0);
+    return *it;
+  }
+
+  /**
+    * Inserting or removing rows moves all rows behind them. Instead of
+    * shifting the index entries of those rows right away, only the
+    * number of rows with valid entries is reduced to @a row. The
+    * entries are brought up to date by updateIndex() when needed.
+    */
+  void invalidateIndex(int row)
+  {
+    m_indexedRows = qMin(m_indexedRows, row);
+  }
+
+  /**
+    * Removes the index entries of the transactions referenced by the
+    * rows from @a begin to @a end which are inserted or removed at
+    * row @a first. Other splits of these transactions may still be
+    * kept in front of @a first, so their rows are invalidated as well.
+    */
+  void dropFromIndex(QVector<Row>::const_iterator begin, QVector<Row>::const_iterator end, int first)
+  {
+    invalidateIndex(first);
+    for (auto row = begin; row != end; ++row) {
+      const auto it = m_transactionRows.find((*row).transactionId);
+      if (it != m_transactionRows.end()) {
+        invalidateIndex((*it).first);
+        m_transactionRows.erase(it);
+      }
+    }
+  }
+
+  /**
+    * Indexes all rows which have been invalidated since the last call
+    */
+  void updateIndex()
+  {
+    QString previousId;
+    for (auto row = m_indexedRows; row < m_rows.count(); ++row) {
+      const auto& id = m_rows.at(row).transactionId;
+      if (id.isEmpty()) {
+        previousId.clear();
+      } else if (id == previousId) {
+        ++m_transactionRows[id].second;
+      } else {
+        m_transactionRows[id] = qMakePair(row, 1);
+        previousId = id;
+      }
+    }
+    m_indexedRows = m_rows.count();
+  }
+
+  void rebuildIndex()
+  {
+    m_transactionRows.clear();
+    m_indexedRows = 0;
+  }
+
   MyMoneyTransaction    m_lastTransactionStored;
-  QVector<LedgerItem*>  m_ledgerItems;
+  QVector<Row>          m_rows;
+
+  /**
+    * Maps the id of a transaction or schedule to the first row
+    * and the number of rows of its splits in m_rows.
+    * The splits of a transaction are always kept in consecutive rows.
+    */
+  QHash<QString, QPair<int, int> > m_transactionRows;
+
+  /**
+    * The number of rows at the beginning of m_rows whose
+    * entries in m_transactionRows are up to date
+    */
+  int                   m_indexedRows;
+
+  /**
+    * The number of items in m_rows which are not permanent
+    */
+  int                   m_cachedItems;
+
+  /**
+    * Counter used to find the least recently used items
+    */
+  quint32               m_usage;
 };
 
 LedgerModel::LedgerModel(QObject* parent) :
@@ -79,7 +378,7 @@ int LedgerModel::rowCount(const QModelIndex& parent) const
   }
 
   Q_D(const LedgerModel);
-  return d->m_ledgerItems.count();
+  return d->m_rows.count();
 }
 
 int LedgerModel::columnCount(const QModelIndex& parent) const
@@ -95,10 +394,10 @@ Qt::ItemFlags LedgerModel::flags(const QModelIndex& index) const
 
   if(!index.isValid())
     return flags;
-  if(index.row() < 0 || index.row() >= d->m_ledgerItems.count())
+  if(index.row() < 0 || index.row() >= d->m_rows.count())
     return flags;
 
-  return d->m_ledgerItems[index.row()]->flags();
+  return const_cast<LedgerModelPrivate*>(d)->item(index.row())->flags();
 }
 
 
@@ -147,38 +446,45 @@ QVariant LedgerModel::data(const QModelIndex& index, int role) const
   Q_D(const LedgerModel);
   if(!index.isValid())
     return QVariant();
-  if(index.row() < 0 || index.row() >= d->m_ledgerItems.count())
+  if(index.row() < 0 || index.row() >= d->m_rows.count())
     return QVariant();
 
+  // everything needed to filter and sort is available without the item,
+  // which is created on first use of any other information
+  const auto& row = d->m_rows.at(index.row());
+  const auto item = [&]() {
+    return const_cast<LedgerModelPrivate*>(d)->item(index.row());
+  };
+
   QVariant rc;
   switch(role) {
     case Qt::DisplayRole:
       // make sure to never return any displayable text for the dummy entry
-      if(!d->m_ledgerItems[index.row()]->transactionSplitId().isEmpty()) {
+      if(!row.transactionId.isEmpty()) {
         switch(index.column()) {
           case (int)Column::Number:
-            rc = d->m_ledgerItems[index.row()]->transactionNumber();
+            rc = item()->transactionNumber();
             break;
           case (int)Column::Date:
-            rc = QLocale().toString(d->m_ledgerItems[index.row()]->postDate(), QLocale::ShortFormat);
+            rc = QLocale().toString(row.postDate, QLocale::ShortFormat);
             break;
           case (int)Column::Detail:
-            rc = d->m_ledgerItems[index.row()]->counterAccount();
+            rc = item()->counterAccount();
             break;
           case (int)Column::Reconciliation:
-            rc = d->m_ledgerItems[index.row()]->reconciliationStateShort();
+            rc = item()->reconciliationStateShort();
             break;
           case (int)Column::Payment:
-            rc = d->m_ledgerItems[index.row()]->payment();
+            rc = item()->payment();
             break;
           case (int)Column::Deposit:
-            rc = d->m_ledgerItems[index.row()]->deposit();
+            rc = item()->deposit();
             break;
           case (int)Column::Amount:
-            rc = d->m_ledgerItems[index.row()]->signedSharesAmount();
+            rc = item()->signedSharesAmount();
             break;
           case (int)Column::Balance:
-            rc = d->m_ledgerItems[index.row()]->balance();
+            rc = row.balance;
             break;
         }
       }
@@ -203,80 +509,81 @@ QVariant LedgerModel::data(const QModelIndex& index, int role) const
       break;
 
     case Qt::BackgroundColorRole:
-      if(d->m_ledgerItems[index.row()]->isImported()) {
+      if(item()->isImported()) {
         return KMyMoneySettings::schemeColor(SchemeColor::TransactionImported);
       }
       break;
 
     case (int)Role::CounterAccount:
-      rc = d->m_ledgerItems[index.row()]->counterAccount();
+      rc = item()->counterAccount();
       break;
 
     case (int)Role::SplitCount:
-      rc = d->m_ledgerItems[index.row()]->splitCount();
+      rc = item()->splitCount();
       break;
 
     case (int)Role::CostCenterId:
-      rc = d->m_ledgerItems[index.row()]->costCenterId();
+      rc = item()->costCenterId();
       break;
 
     case (int)Role::PostDate:
-      rc = d->m_ledgerItems[index.row()]->postDate();
+      rc = row.postDate;
       break;
 
     case (int)Role::PayeeName:
-      rc = d->m_ledgerItems[index.row()]->payeeName();
+      rc = item()->payeeName();
       break;
 
     case (int)Role::PayeeId:
-      rc = d->m_ledgerItems[index.row()]->payeeId();
+      rc = item()->payeeId();
       break;
 
     case (int)Role::AccountId:
-      rc = d->m_ledgerItems[index.row()]->accountId();
+      rc = row.accountId;
       break;
 
     case Qt::EditRole:
     case (int)Role::TransactionSplitId:
-      rc = d->m_ledgerItems[index.row()]->transactionSplitId();
+      rc = d->transactionSplitId(row);
       break;
 
     case (int)Role::TransactionId:
-      rc = d->m_ledgerItems[index.row()]->transactionId();
+      rc = row.transactionId;
       break;
 
     case (int)Role::Reconciliation:
-      rc = (int)d->m_ledgerItems[index.row()]->reconciliationState();
+      rc = (int)item()->reconciliationState();
       break;
 
     case (int)Role::ReconciliationShort:
-      rc = d->m_ledgerItems[index.row()]->reconciliationStateShort();
+      rc = item()->reconciliationStateShort();
       break;
 
     case (int)Role::ReconciliationLong:
-      rc = d->m_ledgerItems[index.row()]->reconciliationStateLong();
+      rc = item()->reconciliationStateLong();
       break;
 
     case (int)Role::SplitValue:
-      rc.setValue(d->m_ledgerItems[index.row()]->value());
+      rc.setValue(item()->value());
       break;
 
     case (int)Role::SplitShares:
-      rc.setValue(d->m_ledgerItems[index.row()]->shares());
+      rc.setValue(row.shares);
       break;
 
     case (int)Role::ShareAmount:
-      rc.setValue(d->m_ledgerItems[index.row()]->sharesAmount());
+      rc.setValue(item()->sharesAmount());
       break;
 
     case (int)Role::ShareAmountSuffix:
-      rc.setValue(d->m_ledgerItems[index.row()]->sharesSuffix());
+      rc.setValue(item()->sharesSuffix());
       break;
 
     case (int)Role::ScheduleId:
       {
       LedgerSchedule* schedule = 0;
-      schedule = dynamic_cast<LedgerSchedule*>(d->m_ledgerItems[index.row()]);
+      if(row.permanent)
+        schedule = dynamic_cast<LedgerSchedule*>(row.item);
       if(schedule) {
         rc = schedule->scheduleId();
       }
@@ -285,7 +592,7 @@ QVariant LedgerModel::data(const QModelIndex& index, int role) const
 
     case (int)Role::Memo:
     case (int)Role::SingleLineMemo:
-      rc.setValue(d->m_ledgerItems[index.row()]->memo());
+      rc.setValue(item()->memo());
       if(role == (int)Role::SingleLineMemo) {
         QString txt = rc.toString();
         // remove empty lines
@@ -297,31 +604,31 @@ QVariant LedgerModel::data(const QModelIndex& index, int role) const
       break;
 
     case (int)Role::Number:
-      rc = d->m_ledgerItems[index.row()]->transactionNumber();
+      rc = item()->transactionNumber();
       break;
 
     case (int)Role::Erroneous:
-      rc = d->m_ledgerItems[index.row()]->isErroneous();
+      rc = item()->isErroneous();
       break;
 
     case (int)Role::Import:
-      rc = d->m_ledgerItems[index.row()]->isImported();
+      rc = item()->isImported();
       break;
 
     case (int)Role::CounterAccountId:
-      rc = d->m_ledgerItems[index.row()]->counterAccountId();
+      rc = item()->counterAccountId();
       break;
 
     case (int)Role::TransactionCommodity:
-      rc = d->m_ledgerItems[index.row()]->transactionCommodity();
+      rc = item()->transactionCommodity();
       break;
 
     case (int)Role::Transaction:
-      rc.setValue(d->m_ledgerItems[index.row()]->transaction());
+      rc.setValue(item()->transaction());
       break;
 
     case (int)Role::Split:
-      rc.setValue(d->m_ledgerItems[index.row()]->split());
+      rc.setValue(item()->split());
       break;
   }
   return rc;
@@ -334,7 +641,10 @@ bool LedgerModel::setData(const QModelIndex& index, const QVariant& value, int r
     return false;
   }
   if(role == Qt::DisplayRole && index.column() == (int)Column::Balance) {
-    d->m_ledgerItems[index.row()]->setBalance(value.toString());
+    auto& row = d->m_rows[index.row()];
+    row.balance = value.toString();
+    if(row.item)
+      row.item->setBalance(row.balance);
     return true;
   }
   qDebug() << "setData(" << index.row() << index.column() << ")" << value << role;
@@ -348,10 +658,7 @@ void LedgerModel::unload()
   Q_D(LedgerModel);
   if(rowCount() > 0) {
     beginRemoveRows(QModelIndex(), 0, rowCount() - 1);
-    for(int i = 0; i < rowCount(); ++i) {
-      delete d->m_ledgerItems[i];
-    }
-    d->m_ledgerItems.clear();
+    d->clear();
     endRemoveRows();
   }
 }
@@ -360,11 +667,14 @@ void LedgerModel::addTransactions(const QList< QPair<MyMoneyTransaction, MyMoney
 {
   Q_D(LedgerModel);
   if(list.count() > 0) {
-    beginInsertRows(QModelIndex(), rowCount(), rowCount() + list.count() - 1);
+    QVector<LedgerModelPrivate::Row> rows;
+    rows.reserve(list.count());
     QList< QPair<MyMoneyTransaction, MyMoneySplit> >::const_iterator it;
     for(it = list.constBegin(); it != list.constEnd(); ++it) {
-      d->m_ledgerItems.append(new LedgerTransaction((*it).first, (*it).second));
+      rows.append(LedgerModelPrivate::transactionRow((*it).first, (*it).second));
     }
+    beginInsertRows(QModelIndex(), rowCount(), rowCount() + rows.count() - 1);
+    d->appendRows(rows);
     endInsertRows();
   }
 }
@@ -373,7 +683,7 @@ void LedgerModel::addTransaction(const LedgerTransaction& t)
 {
   Q_D(LedgerModel);
   beginInsertRows(QModelIndex(), rowCount(), rowCount());
-  d->m_ledgerItems.append(new LedgerTransaction(t.transaction(), t.split()));
+  d->appendRows(QVector<LedgerModelPrivate::Row>() << LedgerModelPrivate::permanentRow(new LedgerTransaction(t.transaction(), t.split())));
   endInsertRows();
 }
 
@@ -394,7 +704,7 @@ void LedgerModel::addTransaction(const QString& transactionSplitId)
     try {
       MyMoneySplit split = d->m_lastTransactionStored.splitById(splitId);
       beginInsertRows(QModelIndex(), rowCount(), rowCount());
-      d->m_ledgerItems.append(new LedgerTransaction(d->m_lastTransactionStored, split));
+      d->appendRows(QVector<LedgerModelPrivate::Row>() << LedgerModelPrivate::transactionRow(d->m_lastTransactionStored, split));
       endInsertRows();
     } catch (const MyMoneyException &) {
       d->m_lastTransactionStored = MyMoneyTransaction();
@@ -406,7 +716,7 @@ void LedgerModel::addSchedules(const QList<MyMoneySchedule> & list, int previewP
 {
   Q_D(LedgerModel);
   if(list.count() > 0) {
-    QVector<LedgerItem*> newList;
+    QVector<LedgerModelPrivate::Row> newList;
 
     // create dummy entries for the scheduled transactions if sorted by postdate
     // show scheduled transactions which have a scheduled postdate
@@ -441,7 +751,7 @@ void LedgerModel::addSchedules(const QList<MyMoneySchedule> & list, int previewP
 
         // create a model entry for each split of the schedule
         foreach (const auto split, t.splits())
-          newList.append(new LedgerSchedule(schedule, t, split));
+          newList.append(LedgerModelPrivate::permanentRow(new LedgerSchedule(schedule, t, split)));
 
         // keep track of this payment locally (not in the engine)
         if (schedule.isOverdue()) {
@@ -465,7 +775,7 @@ void LedgerModel::addSchedules(const QList<MyMoneySchedule> & list, int previewP
     }
     if(!newList.isEmpty()) {
       beginInsertRows(QModelIndex(), rowCount(), rowCount() + newList.count() - 1);
-      d->m_ledgerItems += newList;
+      d->appendRows(newList);
       endInsertRows();
     }
   }
@@ -473,12 +783,20 @@ void LedgerModel::addSchedules(const QList<MyMoneySchedule> & list, int previewP
 
 void LedgerModel::load()
 {
+  Q_D(LedgerModel);
   qDebug() << "Start loading splits";
-  // load all transactions and splits into the model
-  QList<QPair<MyMoneyTransaction, MyMoneySplit> > tList;
+  // load all splits into the model. Only the information needed to
+  // filter and sort them is kept, the items are created on demand
+  QVector<LedgerModelPrivate::Row> rows;
   MyMoneyTransactionFilter filter;
-  MyMoneyFile::instance()->transactionList(tList, filter);
-  addTransactions(tList);
+  MyMoneyFile::instance()->forEachTransactionSplit(filter, [&](const MyMoneyTransaction& t, const MyMoneySplit& split) {
+    rows.append(LedgerModelPrivate::transactionRow(t, split));
+  });
+  if(!rows.isEmpty()) {
+    beginInsertRows(QModelIndex(), rowCount(), rowCount() + rows.count() - 1);
+    d->appendRows(rows);
+    endInsertRows();
+  }
   qDebug() << "Loaded" << rowCount() << "elements";
 
   // load all scheduled transactions and splits into the model
@@ -503,13 +821,13 @@ void LedgerModel::slotAddTransaction(File::Object objType, const QString& id)
 
   const auto t = MyMoneyFile::instance()->transaction(id);
 
-  beginInsertRows(QModelIndex(), rowCount(), rowCount() + t.splitCount() - 1);
+  QVector<LedgerModelPrivate::Row> rows;
   foreach (auto s, t.splits())
-    d->m_ledgerItems.append(new LedgerTransaction(t, s));
-  endInsertRows();
+    rows.append(LedgerModelPrivate::transactionRow(t, s));
 
-  // just make sure we're in sync
-  Q_ASSERT(d->m_ledgerItems.count() == rowCount());
+  beginInsertRows(QModelIndex(), rowCount(), rowCount() + rows.count() - 1);
+  d->appendRows(rows);
+  endInsertRows();
 }
 
 void LedgerModel::slotModifyTransaction(File::Object objType, const QString& id)
@@ -520,68 +838,42 @@ void LedgerModel::slotModifyTransaction(File::Object objType, const QString& id)
 
   Q_D(LedgerModel);
   const auto t = MyMoneyFile::instance()->transaction(id);
-  // get indexes of all existing splits for this transaction
-  auto list = match(index(0, 0), (int)Role::TransactionId, id, -1);
+  // get the rows of all existing splits for this transaction
+  const auto rows = d->transactionRows(id);
+  const auto firstRow = rows.first;
+  const auto oldCount = rows.second;
   // get list of splits to be stored
-  auto splits = t.splits();
-
-  int lastRowUsed = -1;
-  int firstRowUsed = 99999999;
-  if(list.count()) {
-    firstRowUsed = list.first().row();
-    lastRowUsed = list.last().row();
-  }
-
-  qDebug() << "first:" << firstRowUsed << "last:" << lastRowUsed;
-
-  while(!list.isEmpty() && !splits.isEmpty()) {
-    QModelIndex index = list.takeFirst();
-    MyMoneySplit split = splits.takeFirst();
-    // get rid of the old split and store new split
-    qDebug() << "Modify split in row:" << index.row() << t.id() << split.id();
-    delete d->m_ledgerItems[index.row()];
-    d->m_ledgerItems[index.row()] = new LedgerTransaction(t, split);
+  const auto splits = t.splits();
+  const auto newCount = splits.count();
+
+  // get rid of the old splits and store the new ones
+  const auto commonCount = qMin(oldCount, newCount);
+  for (auto i = 0; i < commonCount; ++i) {
+    d->deleteItem(d->m_rows[firstRow + i]);
+    d->m_rows[firstRow + i] = LedgerModelPrivate::transactionRow(t, splits.at(i));
   }
 
   // inform every one else about the changes
-  if(lastRowUsed != -1) {
-    qDebug() << "emit dataChanged from" << firstRowUsed << "to" << lastRowUsed;
-    emit dataChanged(index(firstRowUsed, 0), index(lastRowUsed, columnCount()-1));
-
-  } else {
-    lastRowUsed = rowCount();
-  }
-
-  // now check if we need to add more splits ...
-  if(!splits.isEmpty() && list.isEmpty()) {
-    beginInsertRows(QModelIndex(), lastRowUsed, lastRowUsed + splits.count() - 1);
-    d->m_ledgerItems.insert(lastRowUsed, splits.count(), 0);
-    while(!splits.isEmpty()) {
-      MyMoneySplit split = splits.takeFirst();
-      d->m_ledgerItems[lastRowUsed] = new LedgerTransaction(t, split);
-      lastRowUsed++;
-    }
+  if (commonCount > 0)
+    emit dataChanged(index(firstRow, 0), index(firstRow + commonCount - 1, columnCount() - 1));
+
+  if (newCount > oldCount) {
+    // now check if we need to add more splits ...
+    const auto row = firstRow + oldCount;
+    QVector<LedgerModelPrivate::Row> rows;
+    for (auto i = oldCount; i < newCount; ++i)
+      rows.append(LedgerModelPrivate::transactionRow(t, splits.at(i)));
+    beginInsertRows(QModelIndex(), row, row + rows.count() - 1);
+    d->insertRows(row, rows);
     endInsertRows();
-  }
 
-  // ... or remove some leftovers
-  if(splits.isEmpty() && !list.isEmpty()) {
-    firstRowUsed = lastRowUsed - list.count() + 1;
-    beginRemoveRows(QModelIndex(), firstRowUsed, lastRowUsed);
-    int count = 0;
-    while(!list.isEmpty()) {
-      ++count;
-      QModelIndex index = list.takeFirst();
-      // get rid of the old split and store new split
-      qDebug() << "Delete split in row:" << index.row() << data(index, (int)Role::TransactionSplitId).toString();
-      delete d->m_ledgerItems[index.row()];
-    }
-    d->m_ledgerItems.remove(firstRowUsed, count);
+  } else if (oldCount > newCount) {
+    // ... or remove some leftovers
+    const auto row = firstRow + newCount;
+    beginRemoveRows(QModelIndex(), row, firstRow + oldCount - 1);
+    d->removeRows(row, oldCount - newCount);
     endRemoveRows();
   }
-
-  // just make sure we're in sync
-  Q_ASSERT(d->m_ledgerItems.count() == rowCount());
 }
 
 void LedgerModel::slotRemoveTransaction(File::Object objType, const QString& id)
@@ -591,19 +883,13 @@ void LedgerModel::slotRemoveTransaction(File::Object objType, const QString& id)
   }
   Q_D(LedgerModel);
 
-  QModelIndexList list = match(index(0, 0), (int)Role::TransactionId, id, -1);
-
-  if(list.count()) {
-    const int firstRowUsed = list[0].row();
-    beginRemoveRows(QModelIndex(), firstRowUsed, firstRowUsed + list.count() - 1);
-    for(int row = firstRowUsed; row < firstRowUsed + list.count(); ++row) {
-      delete d->m_ledgerItems[row];
-    }
-    d->m_ledgerItems.remove(firstRowUsed, list.count());
+  const auto rows = d->transactionRows(id);
+  if (rows.second > 0) {
+    const auto firstRowUsed = rows.first;
+    const auto count = rows.second;
+    beginRemoveRows(QModelIndex(), firstRowUsed, firstRowUsed + count - 1);
+    d->removeRows(firstRowUsed, count);
     endRemoveRows();
-
-    // just make sure we're in sync
-    Q_ASSERT(d->m_ledgerItems.count() == rowCount());
   }
 }
 
@@ -637,6 +923,53 @@ void LedgerModel::slotRemoveSchedule(File::Object objType, const QString& id)
   /// @todo implement LedgerModel::removeSchedule
 }
 
+void LedgerModel::slotObjectsChanged(const MyMoneyChanges& changes)
+{
+  foreach (const auto id, changes.ids(File::Mode::Remove, File::Object::Schedule))
+    slotRemoveSchedule(File::Object::Schedule, id);
+  foreach (const auto id, changes.ids(File::Mode::Add, File::Object::Schedule))
+    slotAddSchedule(File::Object::Schedule, id);
+  foreach (const auto id, changes.ids(File::Mode::Modify, File::Object::Schedule))
+    slotModifySchedule(File::Object::Schedule, id);
+
+  const auto removed = changes.ids(File::Mode::Remove, File::Object::Transaction);
+  const auto added = changes.ids(File::Mode::Add, File::Object::Transaction);
+  const auto modified = changes.ids(File::Mode::Modify, File::Object::Transaction);
+
+  if (changes.count(File::Object::Transaction) <= maxIncrementalTransactionChanges) {
+    foreach (const auto id, removed)
+      slotRemoveTransaction(File::Object::Transaction, id);
+    foreach (const auto id, added)
+      slotAddTransaction(File::Object::Transaction, id);
+    foreach (const auto id, modified)
+      slotModifyTransaction(File::Object::Transaction, id);
+    return;
+  }
+
+  Q_D(LedgerModel);
+  const auto outdated = (removed + modified).toSet();
+  const auto file = MyMoneyFile::instance();
+
+  beginResetModel();
+  // drop the rows of all removed and modified transactions in one pass ...
+  auto it = std::remove_if(d->m_rows.begin(), d->m_rows.end(), [&](LedgerModelPrivate::Row& row) {
+    if (!outdated.contains(row.transactionId))
+      return false;
+    d->deleteItem(row);
+    return true;
+  });
+  d->m_rows.erase(it, d->m_rows.end());
+
+  // ... and append the current state of the modified and added ones
+  foreach (const auto id, modified + added) {
+    const auto t = file->transaction(id);
+    foreach (const auto split, t.splits())
+      d->m_rows.append(LedgerModelPrivate::transactionRow(t, split));
+  }
+  d->rebuildIndex();
+  endResetModel();
+}
+
 QString LedgerModel::transactionIdFromTransactionSplitId(const QString& transactionSplitId) const
 {
   QRegExp transactionSplitIdExp("^(\\w+)-\\w+$");
@@ -37,6 +37,7 @@ class MyMoneySchedule;
 class MyMoneySplit;
 class MyMoneyTransaction;
 class LedgerTransaction;
+class MyMoneyChanges;
 
 namespace eMyMoney { namespace File { enum class Object; } }
 
@@ -83,7 +84,10 @@ public:
   void addSchedules(const QList< MyMoneySchedule >& list, int previewPeriod);
 
   /**
-   * Loads the model with data from the engine
+   * Loads the model with data from the engine. Only the information needed
+   * to filter and sort the rows is loaded for all splits. The remaining
+   * data of a row is fetched from the engine when the row is used and
+   * dropped again after a while if it has not been used anymore.
    */
   void load();
 
@@ -102,6 +106,13 @@ public Q_SLOTS:
   void slotModifySchedule   (eMyMoney::File::Object objType, const QString& id);
   void slotRemoveSchedule   (eMyMoney::File::Object objType, const QString& id);
 
+  /**
+    * Applies all transaction and schedule changes of a MyMoneyFile transaction.
+    * A few changes are applied row by row, larger numbers rebuild the model
+    * in a single pass instead of searching the rows of each transaction.
+    */
+  void slotObjectsChanged(const MyMoneyChanges& changes);
+
 private:
   Q_DISABLE_COPY(LedgerModel)
   Q_DECLARE_PRIVATE(LedgerModel)
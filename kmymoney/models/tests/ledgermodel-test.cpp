@@ -0,0 +1,165 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ledgermodel-test.h"
+
+#include <QtTest>
+
+#include "ledgermodel.h"
+#include "modelenums.h"
+#include "mymoneyfile.h"
+#include "mymoneystoragemgr.h"
+#include "mymoneyaccount.h"
+#include "mymoneysecurity.h"
+#include "mymoneytransaction.h"
+#include "mymoneysplit.h"
+#include "mymoneymoney.h"
+#include "mymoneyenums.h"
+
+#include "tests/testutilities.h"
+using namespace test;
+
+QTEST_GUILESS_MAIN(LedgerModelTest)
+
+LedgerModelTest::LedgerModelTest() :
+  storage(nullptr),
+  file(nullptr),
+  model(nullptr)
+{
+}
+
+void LedgerModelTest::init()
+{
+  storage = new MyMoneyStorageMgr;
+  file = MyMoneyFile::instance();
+  file->attachStorage(storage);
+
+  MyMoneyFileTransaction ft;
+  file->addCurrency(MyMoneySecurity("USD", "US Dollar", "$"));
+  file->setBaseCurrency(file->currency("USD"));
+  acCheckingId = makeAccount("Checking", eMyMoney::Account::Type::Checkings, MyMoneyMoney(), QDate(2017, 1, 1), file->asset().id());
+  acExpenseId = makeAccount("Expense", eMyMoney::Account::Type::Expense, MyMoneyMoney(), QDate(2017, 1, 1), file->expense().id());
+  ft.commit();
+
+  model = new LedgerModel;
+}
+
+void LedgerModelTest::cleanup()
+{
+  delete model;
+  file->detachStorage(storage);
+  delete storage;
+}
+
+void LedgerModelTest::createSplits(MyMoneyTransaction& t, int splits) const
+{
+  t.removeSplits();
+  MyMoneySplit split;
+  split.setAccountId(acCheckingId);
+  split.setShares(MyMoneyMoney(1 - splits, 1));
+  split.setValue(MyMoneyMoney(1 - splits, 1));
+  t.addSplit(split);
+  for (auto i = 1; i < splits; ++i) {
+    MyMoneySplit category;
+    category.setAccountId(acExpenseId);
+    category.setShares(MyMoneyMoney::ONE);
+    category.setValue(MyMoneyMoney::ONE);
+    t.addSplit(category);
+  }
+}
+
+QString LedgerModelTest::addTransaction(const QDate& date, int splits)
+{
+  MyMoneyTransaction t;
+  t.setPostDate(date);
+  t.setCommodity("USD");
+  createSplits(t, splits);
+
+  MyMoneyFileTransaction ft;
+  file->addTransaction(t);
+  ft.commit();
+  model->slotAddTransaction(eMyMoney::File::Object::Transaction, t.id());
+  return t.id();
+}
+
+void LedgerModelTest::modifyTransaction(const QString& id, int splits)
+{
+  auto t = file->transaction(id);
+  createSplits(t, splits);
+
+  MyMoneyFileTransaction ft;
+  file->modifyTransaction(t);
+  ft.commit();
+  model->slotModifyTransaction(eMyMoney::File::Object::Transaction, id);
+}
+
+void LedgerModelTest::removeTransaction(const QString& id)
+{
+  MyMoneyFileTransaction ft;
+  file->removeTransaction(file->transaction(id));
+  ft.commit();
+  model->slotRemoveTransaction(eMyMoney::File::Object::Transaction, id);
+}
+
+QStringList LedgerModelTest::transactionIds() const
+{
+  QStringList ids;
+  for (auto row = 0; row < model->rowCount(); ++row)
+    ids << model->index(row, 0).data((int)eLedgerModel::Role::TransactionId).toString();
+  return ids;
+}
+
+void LedgerModelTest::testChangesInTheMiddle()
+{
+  const auto t1 = addTransaction(QDate(2017, 1, 2), 2);
+  const auto t2 = addTransaction(QDate(2017, 1, 3), 2);
+  const auto t3 = addTransaction(QDate(2017, 1, 4), 2);
+  const auto newEntry = QString();
+
+  model->unload();
+  model->load();
+  QCOMPARE(transactionIds(), QStringList() << t1 << t1 << t2 << t2 << t3 << t3 << newEntry);
+
+  // more splits for the transaction in the middle move the rows behind it
+  modifyTransaction(t2, 3);
+  QCOMPARE(transactionIds(), QStringList() << t1 << t1 << t2 << t2 << t2 << t3 << t3 << newEntry);
+
+  // same number of splits, the rows stay where they are
+  modifyTransaction(t3, 2);
+  QCOMPARE(transactionIds(), QStringList() << t1 << t1 << t2 << t2 << t2 << t3 << t3 << newEntry);
+
+  // less splits move them back
+  modifyTransaction(t2, 2);
+  QCOMPARE(transactionIds(), QStringList() << t1 << t1 << t2 << t2 << t3 << t3 << newEntry);
+
+  // new transactions are appended
+  const auto t4 = addTransaction(QDate(2017, 1, 1), 2);
+  QCOMPARE(transactionIds(), QStringList() << t1 << t1 << t2 << t2 << t3 << t3 << newEntry << t4 << t4);
+
+  // several changes in a row before the rows are looked up again
+  removeTransaction(t1);
+  modifyTransaction(t3, 4);
+  QCOMPARE(transactionIds(), QStringList() << t2 << t2 << t3 << t3 << t3 << t3 << newEntry << t4 << t4);
+
+  modifyTransaction(t4, 3);
+  QCOMPARE(transactionIds(), QStringList() << t2 << t2 << t3 << t3 << t3 << t3 << newEntry << t4 << t4 << t4);
+
+  removeTransaction(t3);
+  QCOMPARE(transactionIds(), QStringList() << t2 << t2 << newEntry << t4 << t4 << t4);
+
+  removeTransaction(t2);
+  removeTransaction(t4);
+  QCOMPARE(transactionIds(), QStringList() << newEntry);
+}
@@ -0,0 +1,53 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LEDGERMODELTEST_H
+#define LEDGERMODELTEST_H
+
+#include <QObject>
+#include <QStringList>
+
+class MyMoneyStorageMgr;
+class MyMoneyFile;
+class MyMoneyTransaction;
+class QDate;
+class LedgerModel;
+
+class LedgerModelTest : public QObject
+{
+  Q_OBJECT
+public:
+  LedgerModelTest();
+
+private Q_SLOTS:
+  void init();
+  void cleanup();
+  void testChangesInTheMiddle();
+
+private:
+  void createSplits(MyMoneyTransaction& t, int splits) const;
+  QString addTransaction(const QDate& date, int splits);
+  void modifyTransaction(const QString& id, int splits);
+  void removeTransaction(const QString& id);
+  QStringList transactionIds() const;
+
+  QString            acCheckingId;
+  QString            acExpenseId;
+  MyMoneyStorageMgr* storage;
+  MyMoneyFile*       file;
+  LedgerModel*       model;
+};
+
+#endif
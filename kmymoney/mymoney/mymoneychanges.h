@@ -0,0 +1,202 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MYMONEYCHANGES_H
+#define MYMONEYCHANGES_H
+
+// ----------------------------------------------------------------------------
+// QT Includes
+
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QMetaType>
+
+// ----------------------------------------------------------------------------
+// Project Includes
+
+#include "mymoneyenums.h"
+
+/**
+  * This class collects the ids of all engine objects which have been
+  * changed by a single MyMoneyFile transaction, grouped by the type of
+  * the object and the kind of change. It is sent out with
+  * MyMoneyFile::objectsChanged() so that a receiver can update
+  * itself once instead of once per object.
+  *
+  * An object which has been added and modified is only reported as
+  * added. An object which has been removed is only reported as removed.
+  */
+class MyMoneyChanges
+{
+public:
+  /**
+    * Records the change @a mode of the object of @a type with @a id
+    */
+  void add(eMyMoney::File::Mode mode, eMyMoney::File::Object type, const QString& id)
+  {
+    switch (mode) {
+      case eMyMoney::File::Mode::Add:
+        if (!m_removed.value(type).contains(id)) {
+          m_added[type].insert(id);
+          remove(m_modified, type, id);
+        }
+        break;
+      case eMyMoney::File::Mode::Modify:
+        if (!m_removed.value(type).contains(id) && !m_added.value(type).contains(id))
+          m_modified[type].insert(id);
+        break;
+      case eMyMoney::File::Mode::Remove:
+        m_removed[type].insert(id);
+        remove(m_added, type, id);
+        remove(m_modified, type, id);
+        break;
+    }
+  }
+
+  /**
+    * Records that the balance of the account with @a id has changed
+    */
+  void addBalanceChange(const QString& id)
+  {
+    m_balanceChanged.insert(id);
+  }
+
+  /**
+    * Records that the value but not the balance of the account
+    * with @a id has changed, e.g. due to a new price
+    */
+  void addValueChange(const QString& id)
+  {
+    m_valueChanged.insert(id);
+  }
+
+  /**
+    * Returns the ids of the objects of @a type which have been changed
+    * according to @a mode in the order the changes have been recorded
+    */
+  QStringList ids(eMyMoney::File::Mode mode, eMyMoney::File::Object type) const
+  {
+    switch (mode) {
+      case eMyMoney::File::Mode::Add:
+        return m_added.value(type).ids();
+      case eMyMoney::File::Mode::Modify:
+        return m_modified.value(type).ids();
+      case eMyMoney::File::Mode::Remove:
+        return m_removed.value(type).ids();
+    }
+    return QStringList();
+  }
+
+  /**
+    * Returns the number of objects of @a type which have been changed
+    */
+  int count(eMyMoney::File::Object type) const
+  {
+    return m_added.value(type).count() + m_modified.value(type).count() + m_removed.value(type).count();
+  }
+
+  /**
+    * Returns @c true if any object of @a type has been changed
+    */
+  bool contains(eMyMoney::File::Object type) const
+  {
+    return count(type) > 0;
+  }
+
+  /**
+    * Returns the ids of the accounts whose balance has changed
+    */
+  QStringList balanceChanges() const
+  {
+    return m_balanceChanged.ids();
+  }
+
+  /**
+    * Returns the ids of the accounts whose value but not balance has changed
+    */
+  QStringList valueChanges() const
+  {
+    return m_valueChanged.ids();
+  }
+
+  bool isEmpty() const
+  {
+    return m_added.isEmpty() && m_modified.isEmpty() && m_removed.isEmpty()
+           && m_balanceChanged.count() == 0 && m_valueChanged.count() == 0;
+  }
+
+private:
+  /**
+    * A list of ids without duplicates which keeps the order of insertion
+    */
+  class IdList
+  {
+  public:
+    void insert(const QString& id)
+    {
+      if (!m_set.contains(id)) {
+        m_set.insert(id);
+        m_list.append(id);
+      }
+    }
+
+    void remove(const QString& id)
+    {
+      if (m_set.remove(id))
+        m_list.removeOne(id);
+    }
+
+    bool contains(const QString& id) const
+    {
+      return m_set.contains(id);
+    }
+
+    int count() const
+    {
+      return m_list.count();
+    }
+
+    QStringList ids() const
+    {
+      return m_list;
+    }
+
+  private:
+    QStringList m_list;
+    QSet<QString> m_set;
+  };
+
+  static void remove(QMap<eMyMoney::File::Object, IdList>& map, eMyMoney::File::Object type, const QString& id)
+  {
+    const auto it = map.find(type);
+    if (it != map.end()) {
+      (*it).remove(id);
+      if ((*it).count() == 0)
+        map.erase(it);
+    }
+  }
+
+  QMap<eMyMoney::File::Object, IdList> m_added;
+  QMap<eMyMoney::File::Object, IdList> m_modified;
+  QMap<eMyMoney::File::Object, IdList> m_removed;
+  IdList m_balanceChanged;
+  IdList m_valueChanged;
+};
+
+Q_DECLARE_METATYPE(MyMoneyChanges)
+
+#endif
@@ -50,6 +50,7 @@
 #include "mymoneysecurity.h"
 #include "mymoneyreport.h"
 #include "mymoneybalancecache.h"
+#include "mymoneypricecache.h"
 #include "mymoneybudget.h"
 #include "mymoneyprice.h"
 #include "mymoneypayee.h"
@@ -58,6 +59,7 @@
 #include "mymoneysplit.h"
 #include "mymoneytransaction.h"
 #include "mymoneycostcenter.h"
+#include "mymoneychanges.h"
 #include "mymoneyexception.h"
 #include "onlinejob.h"
 #include "storageenums.h"
@@ -252,7 +254,7 @@ public:
    * It is also used to emit the objectAdded() and objectModified() signals.
    * => If one of these signals is used, you must use this cache.
    */
-  MyMoneyPriceList       m_priceCache;
+  MyMoneyPriceCache      m_priceCache;
   MyMoneyBalanceCache    m_balanceCache;
 
   /**
@@ -322,9 +324,17 @@ MyMoneyFile::MyMoneyFile(MyMoneyStorageMgr *storage) :
   attachStorage(storage);
 }
 
+/// The object returned by instance() in threads which have set their own one
+static thread_local MyMoneyFile* threadFile = nullptr;
+
 MyMoneyFile* MyMoneyFile::instance()
 {
-  return &file;
+  return threadFile ? threadFile : &file;
+}
+
+void MyMoneyFile::setThreadInstance(MyMoneyFile* threadInstance)
+{
+  threadFile = threadInstance;
 }
 
 void MyMoneyFile::attachStorage(MyMoneyStorageMgr* const storage)
@@ -408,6 +418,9 @@ void MyMoneyFile::commitTransaction()
   // inform the outside world about the beginning of notifications
   emit beginChangeNotification();
 
+  // the same notifications collected for receivers which update at once
+  MyMoneyChanges objectChanges;
+
   // Now it's time to send out some signals to the outside world
   // First we go through the d->m_changeSet and emit respective
   // signals about addition, modification and removal of engine objects
@@ -416,6 +429,7 @@ void MyMoneyFile::commitTransaction()
     switch (change.notificationMode()) {
       case File::Mode::Remove:
         emit objectRemoved(change.objectType(), change.id());
+        objectChanges.add(File::Mode::Remove, change.objectType(), change.id());
         // if there is a balance change recorded for this account remove it since the account itself will be removed
         // this can happen when deleting categories that have transactions and the reassign category feature was used
         d->m_balanceChangedSet.remove(change.id());
@@ -423,11 +437,13 @@ void MyMoneyFile::commitTransaction()
       case File::Mode::Add:
         if (!removedObjects.contains(change.id())) {
           emit objectAdded(change.objectType(), change.id());
+          objectChanges.add(File::Mode::Add, change.objectType(), change.id());
         }
         break;
       case File::Mode::Modify:
         if (!removedObjects.contains(change.id())) {
           emit objectModified(change.objectType(), change.id());
+          objectChanges.add(File::Mode::Modify, change.objectType(), change.id());
         }
         break;
     }
@@ -446,6 +462,7 @@ void MyMoneyFile::commitTransaction()
       // for the same account since a balance change implies a value change
       d->m_valueChangedSet.remove(id);
       emit balanceChanged(account(id));
+      objectChanges.addBalanceChange(id);
     }
   }
   d->m_balanceChangedSet.clear();
@@ -455,11 +472,15 @@ void MyMoneyFile::commitTransaction()
   for (const auto& id : m_valueChanges) {
     if (!removedObjects.contains(id)) {
       emit valueChanged(account(id));
+      objectChanges.addValueChange(id);
     }
   }
 
   d->m_valueChangedSet.clear();
 
+  if (!objectChanges.isEmpty())
+    emit objectsChanged(objectChanges);
+
   // as a last action, send out the global dataChanged signal
   if (changed)
     emit dataChanged();
@@ -474,6 +495,7 @@ void MyMoneyFile::rollbackTransaction()
 
   d->m_storage->rollbackTransaction();
   d->m_inTransaction = false;
+  d->m_priceCache.clear();
   d->m_balanceChangedSet.clear();
   d->m_valueChangedSet.clear();
   d->m_changeSet.clear();
@@ -672,15 +694,22 @@ MyMoneyAccount MyMoneyFile::subAccountByName(const MyMoneyAccount& account, cons
   return nullAccount;
 }
 
-MyMoneyAccount MyMoneyFile::accountByName(const QString& name) const
+MyMoneyAccount MyMoneyFile::accountByName(const QString& name, Qt::CaseSensitivity cs) const
 {
   try {
-    return d->m_storage->accountByName(name);
+    return d->m_storage->accountByName(name, cs);
   } catch (const MyMoneyException &) {
   }
   return MyMoneyAccount();
 }
 
+QList<MyMoneyAccount> MyMoneyFile::accountsByNumber(const QString& number) const
+{
+  d->checkStorage();
+
+  return d->m_storage->accountsByNumber(number);
+}
+
 void MyMoneyFile::removeTransaction(const MyMoneyTransaction& transaction)
 {
   d->checkTransaction(Q_FUNC_INFO);
@@ -1312,11 +1341,11 @@ MyMoneyPayee MyMoneyFile::payee(const QString& id) const
   return d->m_storage->payee(id);
 }
 
-MyMoneyPayee MyMoneyFile::payeeByName(const QString& name) const
+MyMoneyPayee MyMoneyFile::payeeByName(const QString& name, Qt::CaseSensitivity cs) const
 {
   d->checkStorage();
 
-  return d->m_storage->payeeByName(name);
+  return d->m_storage->payeeByName(name, cs);
 }
 
 void MyMoneyFile::modifyPayee(const MyMoneyPayee& payee)
@@ -1349,11 +1378,11 @@ MyMoneyTag MyMoneyFile::tag(const QString& id) const
   return d->m_storage->tag(id);
 }
 
-MyMoneyTag MyMoneyFile::tagByName(const QString& name) const
+MyMoneyTag MyMoneyFile::tagByName(const QString& name, Qt::CaseSensitivity cs) const
 {
   d->checkStorage();
 
-  return d->m_storage->tagByName(name);
+  return d->m_storage->tagByName(name, cs);
 }
 
 void MyMoneyFile::modifyTag(const MyMoneyTag& tag)
@@ -1624,6 +1653,12 @@ QList<MyMoneyTransaction> MyMoneyFile::transactionList(MyMoneyTransactionFilter&
   return d->m_storage->transactionList(filter);
 }
 
+void MyMoneyFile::forEachTransactionSplit(MyMoneyTransactionFilter& filter, const std::function<void(const MyMoneyTransaction&, const MyMoneySplit&)>& function) const
+{
+  d->checkStorage();
+  d->m_storage->forEachTransactionSplit(filter, function);
+}
+
 QList<MyMoneyPayee> MyMoneyFile::payeeList() const
 {
   return d->m_storage->payeeList();
@@ -2609,6 +2644,20 @@ QList<MyMoneySecurity> MyMoneyFile::securityList() const
   return d->m_storage->securityList();
 }
 
+QList<MyMoneySecurity> MyMoneyFile::securitiesByName(const QString& name, Qt::CaseSensitivity cs) const
+{
+  d->checkStorage();
+
+  return d->m_storage->securitiesByName(name, cs);
+}
+
+QList<MyMoneySecurity> MyMoneyFile::securitiesBySymbol(const QString& symbol) const
+{
+  d->checkStorage();
+
+  return d->m_storage->securitiesBySymbol(symbol);
+}
+
 void MyMoneyFile::addCurrency(const MyMoneySecurity& currency)
 {
   d->checkTransaction(Q_FUNC_INFO);
@@ -2942,6 +2991,7 @@ void MyMoneyFile::addPrice(const MyMoneyPrice& price)
   // store the account's which are affected by this price regarding their value
   d->priceChanged(*this, price);
   d->m_storage->addPrice(price);
+  d->m_priceCache.clear(price.from(), price.to());
 }
 
 void MyMoneyFile::removePrice(const MyMoneyPrice& price)
@@ -2951,6 +3001,7 @@ void MyMoneyFile::removePrice(const MyMoneyPrice& price)
   // store the account's which are affected by this price regarding their value
   d->priceChanged(*this, price);
   d->m_storage->removePrice(price);
+  d->m_priceCache.clear(price.from(), price.to());
 }
 
 MyMoneyPrice MyMoneyFile::price(const QString& fromId, const QString& toId, const QDate& date, const bool exactDate) const
@@ -2969,37 +3020,14 @@ MyMoneyPrice MyMoneyFile::price(const QString& fromId, const QString& toId, cons
     return MyMoneyPrice(fromId, toId, date, MyMoneyMoney::ONE, "KMyMoney");
   }
 
-  // if not asking for exact date, try to find the exact date match first,
-  // either the requested price or its reciprocal value. If unsuccessful, it will move
-  // on and look for prices of previous dates
-  MyMoneyPrice rc = d->m_storage->price(fromId, to, date, true);
-  if (!rc.isValid()) {
-    // not found, search 'to-from' rate and use reciprocal value
-    rc = d->m_storage->price(to, fromId, date, true);
-
-    // not found, search previous dates, if exact date is not needed
-    if (!exactDate && !rc.isValid()) {
-      // search 'from-to' and 'to-from', select the most recent one
-      MyMoneyPrice fromPrice = d->m_storage->price(fromId, to, date, exactDate);
-      MyMoneyPrice toPrice = d->m_storage->price(to, fromId, date, exactDate);
-
-      // check first whether both prices are valid
-      if (fromPrice.isValid() && toPrice.isValid()) {
-        if (fromPrice.date() >= toPrice.date()) {
-          // if 'from-to' is newer or the same date, prefer that one
-          rc = fromPrice;
-        } else {
-          // otherwise, use the reciprocal price
-          rc = toPrice;
-        }
-      } else if (fromPrice.isValid()) { // check if any of the prices is valid, return that one
-        rc = fromPrice;
-      } else if (toPrice.isValid()) {
-        rc = toPrice;
-      }
-    }
+  // the cache merges the 'from-to' and 'to-from' prices of the pair by date.
+  // An exact date match is found first, either the requested price or its
+  // reciprocal value. Otherwise the most recent one of them on a previous
+  // date is used, if exact date is not needed.
+  if (!d->m_priceCache.contains(fromId, to)) {
+    d->m_priceCache.insert(fromId, to, d->m_storage->priceEntries(fromId, to), d->m_storage->priceEntries(to, fromId));
   }
-  return rc;
+  return d->m_priceCache.price(fromId, to, date, exactDate);
 }
 
 MyMoneyPrice MyMoneyFile::price(const QString& fromId, const QString& toId) const
@@ -3364,6 +3392,7 @@ void MyMoneyFile::clearCache()
 {
   d->checkStorage();
   d->m_balanceCache.clear();
+  d->m_priceCache.clear();
 }
 
 void MyMoneyFile::forceDataChanged()
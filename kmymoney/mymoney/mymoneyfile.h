@@ -24,6 +24,8 @@
 #ifndef MYMONEYFILE_H
 #define MYMONEYFILE_H
 
+#include <functional>
+
 // ----------------------------------------------------------------------------
 // QT Includes
 
@@ -146,6 +148,7 @@ class MyMoneySplit;
 class MyMoneyObject;
 class MyMoneyTransaction;
 class MyMoneyTransactionFilter;
+class MyMoneyChanges;
 class onlineJob;
 
 namespace eMyMoney { namespace Account { enum class Type; }
@@ -170,6 +173,17 @@ public:
     */
   static MyMoneyFile* instance();
 
+  /**
+    * Makes instance() return @a threadInstance in the calling thread instead of
+    * the object of the application. This allows a worker thread to read
+    * from its own snapshot of the storage (see MyMoneyStorageMgr::snapshot())
+    * while the user continues to work with the application's data.
+    * Passing @c nullptr switches the calling thread back.
+    *
+    * @param threadInstance pointer to MyMoneyFile object used by the calling thread
+    */
+  static void setThreadInstance(MyMoneyFile* threadInstance);
+
   /**
     * This is the destructor for any MyMoneyFile object
     */
@@ -601,6 +615,14 @@ public:
 
   void transactionList(QList<QPair<MyMoneyTransaction, MyMoneySplit> >& list, MyMoneyTransactionFilter& filter) const;
 
+  /**
+    * Calls @a function for each split which matches @a filter together
+    * with its transaction without copying the transactions.
+    *
+    * @sa MyMoneyStorageMgr::forEachTransactionSplit()
+    */
+  void forEachTransactionSplit(MyMoneyTransactionFilter& filter, const std::function<void(const MyMoneyTransaction&, const MyMoneySplit&)>& function) const;
+
   /**
     * This method is used to remove a transaction from the transaction
     * pool (journal).
@@ -722,10 +744,20 @@ public:
    * Returns the account addressed by its name.
    *
    * @param name  name of the account to locate.
+   * @param cs whether the name is compared case sensitive
    * @return First MyMoneyAccount object found carrying the @p name.
    * An empty MyMoneyAccount object will be returned if the name is not found.
    */
-  MyMoneyAccount accountByName(const QString& name) const;
+  MyMoneyAccount accountByName(const QString& name, Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
+
+  /**
+   * Returns the accounts whose account number or statement key
+   * equals @p number.
+   *
+   * @param number  account number or statement key to locate.
+   * @return the matching accounts in the order of their ids
+   */
+  QList<MyMoneyAccount> accountsByNumber(const QString& number) const;
 
   /**
    * Returns the sub-account addressed by its name.
@@ -828,10 +860,11 @@ public:
     * An exception will be thrown upon error conditions.
     *
     * @param payee QString reference to name of payee
+    * @param cs whether the name is compared case sensitive
     *
     * @return MyMoneyPayee object of payee
     */
-  MyMoneyPayee payeeByName(const QString& payee) const;
+  MyMoneyPayee payeeByName(const QString& payee, Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
 
   /**
     * This method is used to modify an existing payee
@@ -886,10 +919,11 @@ public:
     * An exception will be thrown upon error conditions.
     *
     * @param tag QString reference to name of tag
+    * @param cs whether the name is compared case sensitive
     *
     * @return MyMoneyTag object of tag
     */
-  MyMoneyTag tagByName(const QString& tag) const;
+  MyMoneyTag tagByName(const QString& tag, Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
 
   /**
     * This method is used to modify an existing tag
@@ -1149,6 +1183,23 @@ public:
     */
   QList<MyMoneySecurity> securityList() const;
 
+  /**
+    * This method is used to retrieve the securities named @p name
+    * in the order of their ids.
+    *
+    * @param name name of the security
+    * @param cs whether the name is compared case sensitive
+    */
+  QList<MyMoneySecurity> securitiesByName(const QString& name, Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
+
+  /**
+    * This method is used to retrieve the securities whose trading symbol
+    * equals @p symbol ignoring the case in the order of their ids.
+    *
+    * @param symbol trading symbol of the security
+    */
+  QList<MyMoneySecurity> securitiesBySymbol(const QString& symbol) const;
+
   /**
     * This method is used to add a new currency object to the engine.
     * The ID of the object is the trading symbol, so there is no need for an additional
@@ -1657,6 +1708,14 @@ Q_SIGNALS:
     */
   void valueChanged(const MyMoneyAccount& acc);
 
+  /**
+    * This signal is emitted once per committed transaction after the
+    * signals above have been sent out. @a changes contains the ids of
+    * all objects reported by them, so that a receiver like a model
+    * can update itself at once instead of once per object.
+    */
+  void objectsChanged(const MyMoneyChanges& changes);
+
 private:
   static MyMoneyFile file;
 
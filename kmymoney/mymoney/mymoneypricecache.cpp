@@ -0,0 +1,95 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mymoneypricecache.h"
+
+#include <algorithm>
+
+// ----------------------------------------------------------------------------
+// QT Includes
+
+#include <QDate>
+
+// ----------------------------------------------------------------------------
+// KDE Includes
+
+// ----------------------------------------------------------------------------
+// Project Includes
+
+void MyMoneyPriceCache::clear()
+{
+  m_cache.clear();
+}
+
+void MyMoneyPriceCache::clear(const QString& fromId, const QString& toId)
+{
+  m_cache.remove(qMakePair(fromId, toId));
+  m_cache.remove(qMakePair(toId, fromId));
+}
+
+bool MyMoneyPriceCache::contains(const QString& fromId, const QString& toId) const
+{
+  return m_cache.contains(qMakePair(fromId, toId));
+}
+
+int MyMoneyPriceCache::size() const
+{
+  return m_cache.size();
+}
+
+void MyMoneyPriceCache::insert(const QString& fromId, const QString& toId, const MyMoneyPriceEntries& fromTo, const MyMoneyPriceEntries& toFrom)
+{
+  QVector<MyMoneyPrice>& prices = m_cache[qMakePair(fromId, toId)];
+  prices.clear();
+  prices.reserve(fromTo.count() + toFrom.count());
+
+  // merge both date ordered maps and keep the direct price on the same date
+  auto itFromTo = fromTo.constBegin();
+  auto itToFrom = toFrom.constBegin();
+  while (itFromTo != fromTo.constEnd() || itToFrom != toFrom.constEnd()) {
+    if (itToFrom == toFrom.constEnd()
+        || (itFromTo != fromTo.constEnd() && itFromTo.key() <= itToFrom.key())) {
+      if (itToFrom != toFrom.constEnd() && itToFrom.key() == itFromTo.key())
+        ++itToFrom;
+      prices.append(*itFromTo);
+      ++itFromTo;
+    } else {
+      prices.append(*itToFrom);
+      ++itToFrom;
+    }
+  }
+}
+
+MyMoneyPrice MyMoneyPriceCache::price(const QString& fromId, const QString& toId, const QDate& _date, bool exactDate) const
+{
+  const auto it = m_cache.constFind(qMakePair(fromId, toId));
+  if (it == m_cache.constEnd())
+    return MyMoneyPrice();
+
+  const QDate& date = _date.isValid() ? _date : QDate::currentDate();
+  const QVector<MyMoneyPrice>& prices = *it;
+
+  // find the first price after the date, the one before is the one we look for
+  const auto pos = std::upper_bound(prices.constBegin(), prices.constEnd(), date, [](const QDate& d, const MyMoneyPrice& p) {
+    return d < p.date();
+  });
+  if (pos == prices.constBegin())
+    return MyMoneyPrice();
+
+  const MyMoneyPrice& rc = *(pos - 1);
+  if (exactDate && rc.date() != date)
+    return MyMoneyPrice();
+  return rc;
+}
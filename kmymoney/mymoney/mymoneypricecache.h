@@ -0,0 +1,103 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MYMONEYPRICECACHE_H
+#define MYMONEYPRICECACHE_H
+
+// ----------------------------------------------------------------------------
+// QT Includes
+
+#include <QHash>
+#include <QVector>
+
+// ----------------------------------------------------------------------------
+// KDE Includes
+
+// ----------------------------------------------------------------------------
+// Project Includes
+
+#include "kmm_mymoney_export.h"
+#include "mymoneyprice.h"
+
+/**
+ * This class provides a price cache for the @ref MyMoneyFile layer. For each
+ * pair of securities it keeps the prices of both directions merged into a
+ * single array sorted by date, so that the price on a given date is found by
+ * a binary search instead of up to four lookups in the price list.
+ *
+ * The cache does not know about the storage. The caller has to insert the
+ * price entries of a pair before asking for one of its prices and must
+ * clear the pair whenever one of its prices changes.
+ */
+class KMM_MYMONEY_EXPORT MyMoneyPriceCache
+{
+public:
+
+  /**
+   * Remove all prices from the cache
+   */
+  void clear();
+
+  /**
+   * Remove the prices of the pair @a fromId / @a toId from the cache
+   * in both directions
+   */
+  void clear(const QString& fromId, const QString& toId);
+
+  /**
+   * @return true if the prices of the pair @a fromId / @a toId have
+   * been inserted, otherwise false
+   */
+  bool contains(const QString& fromId, const QString& toId) const;
+
+  /**
+   * @return the number of security pairs in the cache
+   */
+  int size() const;
+
+  /**
+   * This function inserts the prices of the pair @a fromId / @a toId.
+   * On the same date a price in @a fromTo is preferred over its
+   * reciprocal in @a toFrom.
+   *
+   * @param fromId the security the price is asked for
+   * @param toId the security the price is expressed in
+   * @param fromTo the prices stored for @a fromId in @a toId
+   * @param toFrom the prices stored for @a toId in @a fromId
+   */
+  void insert(const QString& fromId, const QString& toId, const MyMoneyPriceEntries& fromTo, const MyMoneyPriceEntries& toFrom);
+
+  /**
+   * This function retrieves a price of the pair @a fromId / @a toId from
+   * the cache. It returns the price on @a date, either the requested price
+   * or its reciprocal. If there is none and @a exactDate is false, the most
+   * recent price before @a date is returned. The price is invalid if the
+   * cache does not contain a matching price.
+   *
+   * @param fromId the security the price is asked for
+   * @param toId the security the price is expressed in
+   * @param date the date of the price, QDate::currentDate() if invalid
+   * @param exactDate if true, only a price on @a date is returned
+   *
+   * @return the price, use MyMoneyPrice::rate(toId) to get the rate
+   */
+  MyMoneyPrice price(const QString& fromId, const QString& toId, const QDate& date, bool exactDate) const;
+
+private:
+  typedef QHash<MyMoneySecurityPair, QVector<MyMoneyPrice> > PriceCacheType;
+  PriceCacheType m_cache;
+};
+
+#endif
@@ -0,0 +1,102 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMYMONEYSTORAGESOURCE_H
+#define IMYMONEYSTORAGESOURCE_H
+
+// ----------------------------------------------------------------------------
+// QT Includes
+
+class QString;
+class QStringList;
+class QDate;
+
+template <class Key, class T> class QMap;
+template <class T1, class T2> struct QPair;
+
+// ----------------------------------------------------------------------------
+// Project Includes
+
+class MyMoneyTransaction;
+class MyMoneyTransactionFilter;
+class MyMoneyPrice;
+
+typedef QPair<QString, QString> MyMoneySecurityPair;
+typedef QMap<QDate, MyMoneyPrice> MyMoneyPriceEntries;
+typedef QMap<MyMoneySecurityPair, MyMoneyPriceEntries> MyMoneyPriceList;
+
+/**
+  * Interface of a persistent storage which provides transactions and
+  * prices to a MyMoneyStorageMgr on demand instead of loading them
+  * all when the file is opened.
+  *
+  * @sa MyMoneyStorageMgr::setSource()
+  */
+class IMyMoneyStorageSource
+{
+public:
+  virtual ~IMyMoneyStorageSource() {}
+
+  /**
+    * Returns all transactions which reference at least one of the
+    * accounts in @a accountIds. If @a accountIds is empty, all
+    * transactions are returned. The key of the map is
+    * MyMoneyTransaction::uniqueSortKey().
+    */
+  virtual QMap<QString, MyMoneyTransaction> fetchAccountTransactions(const QStringList& accountIds) const = 0;
+
+  /**
+    * Returns the transactions which possibly match @a filter. The result
+    * may contain more transactions than the filter accepts, so the caller
+    * still has to check each of them. The key of the map is
+    * MyMoneyTransaction::uniqueSortKey().
+    */
+  virtual QMap<QString, MyMoneyTransaction> fetchTransactions(const MyMoneyTransactionFilter& filter) const = 0;
+
+  /**
+    * Returns the transaction with @a id or an empty
+    * transaction if it is not known.
+    */
+  virtual MyMoneyTransaction fetchTransaction(const QString& id) const = 0;
+
+  /**
+    * Returns the prices from any security in @a fromIdList to any security
+    * in @a toIdList. Empty lists return the prices of all securities.
+    */
+  virtual MyMoneyPriceList fetchPrices(const QStringList& fromIdList, const QStringList& toIdList, bool forUpdate = false) const = 0;
+
+  /**
+    * Returns @c true if any stored transaction references the object with @a id.
+    */
+  virtual bool isReferencedByTransaction(const QString& id) const = 0;
+
+  /**
+    * Returns the numeric part of the highest transaction id
+    * in use, so that new transactions get unique ids.
+    */
+  virtual ulong lastTransactionId() const = 0;
+
+  /**
+    * Returns a new source which reads from the same persistent storage
+    * on behalf of a snapshot (see MyMoneyStorageMgr::snapshot()). As the
+    * snapshot may be used by another thread, the copy must not access
+    * the storage before data is fetched from it for the first time.
+    * Returns @c nullptr if the source cannot be copied. The caller
+    * takes ownership of the returned object.
+    */
+  virtual IMyMoneyStorageSource* readOnlyCopy() const = 0;
+};
+
+#endif
@@ -0,0 +1,304 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MYMONEYINDEXEDMAP_H
+#define MYMONEYINDEXEDMAP_H
+
+#include <algorithm>
+
+// ----------------------------------------------------------------------------
+// QT Includes
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// ----------------------------------------------------------------------------
+// Project Includes
+
+#include "mymoneymap.h"
+
+/**
+  * This template class extends MyMoneyMap<> by hash indexes which map
+  * secondary keys of the contained objects, e.g. their name, to their ids.
+  * The indexes are MyMoneyMap<> objects themselves and take part in the
+  * transactions of the container, so a rollback restores them as well.
+  *
+  * Each index is set up with addIndex() and a function which returns the
+  * keys of an object. Empty keys are not indexed. A case insensitive index
+  * keeps the case folded keys. Several objects may share the same key, their
+  * ids are kept in ascending order so that the first id is the one a scan
+  * of an ordered container would find first.
+  *
+  * Objects which are mostly looked up by their id can be kept in a QHash<>
+  * as @a Container. keys() and values() still return them ordered by id.
+  * The ordered lists are built when they are asked for and kept until the
+  * contents change.
+  */
+template <class T, class Container = QMap<QString, T> >
+class MyMoneyIndexedMap : public MyMoneyMap<QString, T, Container>
+{
+  typedef MyMoneyMap<QString, T, Container> Base;
+
+public:
+  typedef QStringList (*KeyFunction)(const T& obj);
+
+  MyMoneyIndexedMap() : m_keysValid(false), m_valuesValid(false) {}
+
+  /**
+    * Adds an index built from the keys returned by @a keyFunction for each
+    * object. Indexes must be added before any object is added and are
+    * numbered in the order they have been added starting with 0.
+    */
+  void addIndex(KeyFunction keyFunction, Qt::CaseSensitivity cs = Qt::CaseSensitive)
+  {
+    Index index;
+    index.keyFunction = keyFunction;
+    index.cs = cs;
+    m_indexes.append(index);
+  }
+
+  /**
+    * Returns the ids of the objects which have @a key in the
+    * index with number @a index in ascending order
+    */
+  QStringList ids(int index, const QString& key) const
+  {
+    const auto& idx = m_indexes.at(index);
+    const auto it = idx.ids.find(idx.cs == Qt::CaseSensitive ? key : key.toCaseFolded());
+    return it != idx.ids.end() ? *it : QStringList();
+  }
+
+  void startTransaction(unsigned long* id = 0)
+  {
+    Base::startTransaction(id);
+    for (auto& index : m_indexes)
+      index.ids.startTransaction();
+  }
+
+  void rollbackTransaction()
+  {
+    invalidateKeys();
+    Base::rollbackTransaction();
+    for (auto& index : m_indexes)
+      index.ids.rollbackTransaction();
+  }
+
+  bool commitTransaction()
+  {
+    const auto rc = Base::commitTransaction();
+    for (auto& index : m_indexes)
+      index.ids.commitTransaction();
+    return rc;
+  }
+
+  void insert(const QString& key, const T& obj)
+  {
+    invalidateKeys();
+    updateIndexes(key, &obj, true);
+    Base::insert(key, obj);
+  }
+
+  void modify(const QString& key, const T& obj)
+  {
+    m_valuesValid = false;
+    updateIndexes(key, &obj, true);
+    Base::modify(key, obj);
+  }
+
+  void remove(const QString& key)
+  {
+    invalidateKeys();
+    updateIndexes(key, nullptr, true);
+    Base::remove(key);
+  }
+
+  void load(const QString& key, const T& obj)
+  {
+    invalidateKeys();
+    updateIndexes(key, &obj, false);
+    Base::load(key, obj);
+  }
+
+  void unload(const QString& key)
+  {
+    invalidateKeys();
+    updateIndexes(key, nullptr, false);
+    Base::unload(key);
+  }
+
+  /**
+    * Returns the ids of all objects in ascending order
+    */
+  QStringList keys() const
+  {
+    if (!m_keysValid) {
+      m_keys = Base::keys();
+      std::sort(m_keys.begin(), m_keys.end());
+      m_keysValid = true;
+    }
+    return m_keys;
+  }
+
+  /**
+    * Returns all objects ordered by their id
+    */
+  QList<T> values() const
+  {
+    if (!m_valuesValid) {
+      m_values.clear();
+      m_values.reserve(Base::count());
+      foreach (const auto id, keys())
+        m_values.append(*Base::find(id));
+      m_valuesValid = true;
+    }
+    return m_values;
+  }
+
+  MyMoneyIndexedMap<T, Container>& operator= (const Container& m)
+  {
+    invalidateKeys();
+    Base::operator=(m);
+    for (auto& index : m_indexes) {
+      QHash<QString, QStringList> ids;
+      for (auto it = m.constBegin(); it != m.constEnd(); ++it) {
+        foreach (const auto key, keys(index, *it))
+          ids[key].append(it.key());
+      }
+      // a hash is not ordered by id
+      for (auto it = ids.begin(); it != ids.end(); ++it)
+        std::sort((*it).begin(), (*it).end());
+      index.ids = ids;
+    }
+    return *this;
+  }
+
+  /**
+    * Replaces the contents by the objects of @a m which may
+    * be kept in a different type of container
+    */
+  template <class Map>
+  MyMoneyIndexedMap<T, Container>& operator= (const Map& m)
+  {
+    Container c;
+    for (auto it = m.constBegin(); it != m.constEnd(); ++it)
+      c.insert(it.key(), it.value());
+    return operator=(c);
+  }
+
+private:
+  class Index
+  {
+  public:
+    Index() : keyFunction(nullptr), cs(Qt::CaseSensitive) {}
+
+    KeyFunction keyFunction;
+    Qt::CaseSensitivity cs;
+    MyMoneyMap<QString, QStringList, QHash<QString, QStringList> > ids;
+  };
+
+  /**
+    * Returns the non empty keys of @a obj for @a index without duplicates
+    */
+  static QStringList keys(const Index& index, const T& obj)
+  {
+    QStringList result;
+    foreach (const auto key, index.keyFunction(obj)) {
+      const auto k = index.cs == Qt::CaseSensitive ? key : key.toCaseFolded();
+      if (!k.isEmpty() && !result.contains(k))
+        result.append(k);
+    }
+    return result;
+  }
+
+  /**
+    * Replaces the keys of the object with @a id in all indexes by the
+    * keys of @a obj. A null pointer for @a obj removes the keys. The
+    * change is recorded for a rollback if @a record is @c true.
+    */
+  void updateIndexes(const QString& id, const T* obj, bool record)
+  {
+    const auto it = Base::find(id);
+    for (auto& index : m_indexes) {
+      const auto oldKeys = it != Base::end() ? keys(index, *it) : QStringList();
+      const auto newKeys = obj ? keys(index, *obj) : QStringList();
+      if (oldKeys == newKeys)
+        continue;
+      foreach (const auto key, oldKeys) {
+        if (!newKeys.contains(key))
+          removeId(index, key, id, record);
+      }
+      foreach (const auto key, newKeys) {
+        if (!oldKeys.contains(key))
+          addId(index, key, id, record);
+      }
+    }
+  }
+
+  static void addId(Index& index, const QString& key, const QString& id, bool record)
+  {
+    const auto it = index.ids.find(key);
+    auto ids = it != index.ids.end() ? *it : QStringList();
+    const auto pos = std::lower_bound(ids.begin(), ids.end(), id);
+    if (pos != ids.end() && *pos == id)
+      return;
+    ids.insert(pos, id);
+    if (record)
+      index.ids.modify(key, ids);
+    else
+      index.ids.load(key, ids);
+  }
+
+  static void removeId(Index& index, const QString& key, const QString& id, bool record)
+  {
+    const auto it = index.ids.find(key);
+    if (it == index.ids.end())
+      return;
+    auto ids = *it;
+    if (!ids.removeOne(id))
+      return;
+    if (record) {
+      if (ids.isEmpty())
+        index.ids.remove(key);
+      else
+        index.ids.modify(key, ids);
+    } else {
+      if (ids.isEmpty())
+        index.ids.unload(key);
+      else
+        index.ids.load(key, ids);
+    }
+  }
+
+  /**
+    * Drops the ordered lists returned by keys() and values()
+    */
+  void invalidateKeys()
+  {
+    m_keysValid = false;
+    m_valuesValid = false;
+  }
+
+  QVector<Index> m_indexes;
+
+  mutable QStringList m_keys;
+  mutable QList<T> m_values;
+  mutable bool m_keysValid;
+  mutable bool m_valuesValid;
+};
+
+#endif
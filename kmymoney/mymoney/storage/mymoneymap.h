@@ -18,7 +18,9 @@
 
 #include <stdint.h>
 #include <QMap>
-#include <QStack>
+#include <QHash>
+#include <QSet>
+#include <QVector>
 #include <mymoneyexception.h>
 
 #ifndef MYMONEYMAP_H
@@ -39,77 +41,98 @@
   * rollbackTransaction() to set the container to the state it was
   * in before you called startTransaction().
   *
-  * The implementation is based on the command pattern, in case
-  * someone is interested.
+  * The first change of each key within a transaction records the
+  * previous state of the object in a journal. The keys which have
+  * been touched are kept in a QSet<>, so recording a change takes
+  * constant time even for transactions containing many changes.
+  * Keys must therefore provide a qHash() function (QPair<> does).
+  *
+  * By default, the elements are kept in a QMap<> ordered by their key.
+  * Containers which are only used to lookup elements by their key
+  * can use a QHash<> as @a Container instead.
   */
-template <class Key, class T>
-class MyMoneyMap : protected QMap<Key, T>
+template <class Key, class T, class Container = QMap<Key, T> >
+class MyMoneyMap : protected Container
 {
 private:
-  // check if a key required (not already contained in the stack) or not
-  bool required(const Key& key) const {
-    if (m_stack.count() > 1) {
-      for (auto i = 0; i < m_stack.count(); ++i) {
-        if (m_stack[i]->key() == key) {
-          return false;
-        }
-      }
-    }
-    return true;
+  // check if a key required (not already contained in the journal) or not
+  // and mark it as touched in the current transaction
+  bool required(const Key& key) {
+    const auto count = m_touched.count();
+    m_touched.insert(key);
+    return m_touched.count() != count;
+  }
+
+  // record the state of the object identified by 'key' before it gets changed
+  void record(const Key& key) {
+    const auto it = Container::constFind(key);
+    if (it != Container::constEnd())
+      m_journal.append(MyMoneyMapUndo(key, it.value()));
+    else
+      m_journal.append(MyMoneyMapUndo(key));
+  }
+
+  void clearJournal(void) {
+    m_journal.clear();
+    m_touched.clear();
+    m_idPtr = 0;
+    m_inTransaction = false;
   }
 
 public:
-  MyMoneyMap() : QMap<Key, T>() {}
+  MyMoneyMap() : Container(), m_idPtr(0), m_id(0), m_inTransaction(false) {}
   ~MyMoneyMap() {}
 
   void startTransaction(unsigned long* id = 0) {
-    m_stack.push(new MyMoneyMapStart(this, id));
+    // only the state at the start of the outermost
+    // transaction is of interest for a rollback
+    if (m_inTransaction)
+      return;
+    m_inTransaction = true;
+    m_idPtr = id;
+    m_id = (id != 0) ? *id : 0;
   }
 
   void rollbackTransaction(void) {
-    if (m_stack.isEmpty())
+    if (!m_inTransaction)
       throw MYMONEYEXCEPTION_CSTRING("No transaction started to rollback changes");
 
-    // undo all actions
-    MyMoneyMapAction* action;
-    while (!m_stack.isEmpty()) {
-      action = m_stack.pop();
-      action->undo();
-      delete action;
+    // undo all actions. Since each key is recorded only once
+    // the order in which the records are applied does not matter
+    for (auto it = m_journal.constBegin(); it != m_journal.constEnd(); ++it) {
+      if ((*it).existed)
+        Container::insert((*it).key, (*it).obj);
+      else
+        Container::remove((*it).key);
     }
+    if (m_idPtr != 0)
+      *m_idPtr = m_id;
+    clearJournal();
   }
 
   bool commitTransaction(void) {
-    if (m_stack.isEmpty())
+    if (!m_inTransaction)
       throw MYMONEYEXCEPTION_CSTRING("No transaction started to commit changes");
 
-    bool rc = m_stack.count() > 1;
-    // remove all actions from the stack
-    MyMoneyMapAction* action;
-    while (!m_stack.isEmpty()) {
-      action = m_stack.pop();
-      delete action;
-    }
+    bool rc = !m_journal.isEmpty();
+    clearJournal();
     return rc;
   }
 
   void insert(const Key& key, const T& obj) {
-    if (m_stack.isEmpty())
+    if (!m_inTransaction)
       throw MYMONEYEXCEPTION_CSTRING("No transaction started to insert new element into container");
 
-    // check if information about the object identified by 'key'
-    // is already present in the stack
-    if (!required(key)) {
-      this->QMap<Key, T>::insert(key, obj);
-      return;
-    }
+    // keep the information needed to undo the change unless
+    // the object identified by 'key' has been touched before
+    if (required(key))
+      record(key);
 
-    // store object in
-    m_stack.push(new MyMoneyMapInsert(this, key, obj));
+    Container::insert(key, obj);
   }
 
   void modify(const Key& key, const T& obj) {
-    if (m_stack.isEmpty())
+    if (!m_inTransaction)
       throw MYMONEYEXCEPTION_CSTRING("No transaction started to modify element in container");
 
 #if 0
@@ -118,18 +141,16 @@ public:
       throw MYMONEYEXCEPTION_CSTRING("No key to update object");
 #endif
 
-    // check if information about the object identified by 'key'
-    // is already present in the stack
-    if (!required(key)) {
-      this->QMap<Key, T>::insert(key, obj);
-      return;
-    }
+    // keep the information needed to undo the change unless
+    // the object identified by 'key' has been touched before
+    if (required(key))
+      record(key);
 
-    m_stack.push(new MyMoneyMapModify(this, key, obj));
+    Container::insert(key, obj);
   }
 
   void remove(const Key& key) {
-    if (m_stack.isEmpty())
+    if (!m_inTransaction)
       throw MYMONEYEXCEPTION_CSTRING("No transaction started to remove element from container");
 
 #if 0
@@ -138,53 +159,76 @@ public:
       throw MYMONEYEXCEPTION_CSTRING("No key to remove object");
 #endif
 
-    // check if information about the object identified by 'key'
-    // is already present in the stack
-    if (!required(key)) {
-      this->QMap<Key, T>::remove(key);
-      return;
-    }
+    // keep the information needed to undo the change unless
+    // the object identified by 'key' has been touched before
+    if (required(key))
+      record(key);
 
-    m_stack.push(new MyMoneyMapRemove(this, key));
+    Container::remove(key);
   }
 
-  MyMoneyMap<Key, T>& operator= (const QMap<Key, T>& m) {
-    if (!m_stack.isEmpty()) {
+  /**
+    * Adds @a obj with @a key without recording the change. This is
+    * used for objects which are loaded on demand from a persistent
+    * storage and are therefore not subject to a rollback.
+    */
+  void load(const Key& key, const T& obj) {
+    Container::insert(key, obj);
+  }
+
+  /**
+    * Removes the object with @a key without recording the change.
+    * This is the counterpart of load().
+    */
+  void unload(const Key& key) {
+    Container::remove(key);
+  }
+
+  MyMoneyMap<Key, T, Container>& operator= (const Container& m) {
+    if (m_inTransaction) {
       throw MYMONEYEXCEPTION_CSTRING("Cannot assign whole container during transaction");
     }
-    QMap<Key, T>::operator=(m);
+    Container::operator=(m);
     return *this;
   }
 
 
   inline QList<T> values(void) const {
-    return QMap<Key, T>::values();
+    return Container::values();
   }
 
   inline QList<Key> keys(void) const {
-    return QMap<Key, T>::keys();
+    return Container::keys();
   }
 
   const T& operator[](const Key& k) const {
     return find(k).value();
 #if 0
-    /*QT_CHECK_INVALID_MAP_ELEMENT;*/ /*PORT ME KDE4*/ return QMap<Key, T>::operator[](k);
+    /*QT_CHECK_INVALID_MAP_ELEMENT;*/ /*PORT ME KDE4*/ return Container::operator[](k);
 #endif
   }
 
-  inline typename QMap<Key, T>::const_iterator find(const Key& k) const {
-    return QMap<Key, T>::find(k);
+  inline typename Container::const_iterator find(const Key& k) const {
+    return Container::find(k);
   }
 
-  inline typename QMap<Key, T>::const_iterator begin(void) const {
-    return QMap<Key, T>::constBegin();
+  inline typename Container::const_iterator begin(void) const {
+    return Container::constBegin();
   }
 
-  inline typename QMap<Key, T>::const_iterator end(void) const {
-    return QMap<Key, T>::constEnd();
+  inline typename Container::const_iterator end(void) const {
+    return Container::constEnd();
+  }
+
+  typedef typename Container::const_iterator const_iterator;
+
+  inline typename Container::const_iterator lowerBound(const Key& k) const {
+    return Container::lowerBound(k);
   }
 
-  typedef typename QMap<Key, T>::const_iterator const_iterator;
+  inline typename Container::const_iterator upperBound(const Key& k) const {
+    return Container::upperBound(k);
+  }
 
   inline bool contains(const Key& k) const {
     return find(k) != end();
@@ -193,18 +237,35 @@ public:
   inline void map(QMap<Key, T>& that) const {
     //QMap<Key, T>* ptr = dynamic_cast<QMap<Key, T>* >(this);
     //that = *ptr;
-    that = *(static_cast<QMap<Key, T>* >(const_cast<MyMoneyMap<Key, T>* >(this)));
+    that = *(static_cast<QMap<Key, T>* >(const_cast<MyMoneyMap<Key, T, Container>* >(this)));
   }
 
   inline int count(void) const {
-    return QMap<Key, T>::count();
+    return Container::count();
+  }
+
+  /**
+    * Returns @c true if a transaction has been started but not yet
+    * committed or rolled back.
+    */
+  inline bool inTransaction(void) const {
+    return m_inTransaction;
+  }
+
+  /**
+    * Returns a copy of the contained data. The copy shares the data
+    * with this map until either of them is modified (copy-on-write),
+    * so this is cheap even for large maps.
+    */
+  inline Container container(void) const {
+    return *this;
   }
 
 #if MY_OWN_DEBUG
   void dump(void) const {
     printf("Container dump\n");
     printf(" items in container = %d\n", count());
-    printf(" items on stack     = %d\n", m_stack.count());
+    printf(" items in journal   = %d\n", m_journal.count());
 
     const_iterator it;
     for (it = begin(); it != end(); ++it) {
@@ -214,96 +275,29 @@ public:
 #endif
 
 private:
-  class MyMoneyMapAction
-  {
-  public:
-    MyMoneyMapAction(MyMoneyMap<Key, T>* container) :
-        m_container(container) {}
-
-    MyMoneyMapAction(MyMoneyMap<Key, T>* container, const Key& key, const T& obj) :
-        m_container(container),
-        m_obj(obj),
-        m_key(key) {}
-
-    virtual ~MyMoneyMapAction() {}
-    virtual void undo(void) = 0;
-    const Key& key(void) const {
-      return m_key;
-    }
-
-  protected:
-    MyMoneyMap<Key, T>* m_container;
-    T m_obj;
-    Key m_key;
-  };
-
-  class MyMoneyMapStart : public MyMoneyMapAction
-  {
-  public:
-    MyMoneyMapStart(MyMoneyMap<Key, T>* container, unsigned long* id) :
-        MyMoneyMapAction(container),
-        m_idPtr(id),
-        m_id(0) {
-      if (id != 0)
-        m_id = *id;
-    }
-    ~MyMoneyMapStart() final {}
-    void undo(void) final override {
-      if (m_idPtr != 0)
-        *m_idPtr = m_id;
-    }
-
-  private:
-    unsigned long* m_idPtr;
-    unsigned long  m_id;
-  };
-
-  class MyMoneyMapInsert : public MyMoneyMapAction
-  {
-  public:
-    MyMoneyMapInsert(MyMoneyMap<Key, T>* container, const Key& key, const T& obj) :
-        MyMoneyMapAction(container, key, obj) {
-      container->QMap<Key, T>::insert(key, obj);
-    }
-
-    ~MyMoneyMapInsert() final {}
-    void undo(void) final override {
-      // m_container->remove(m_key) does not work on GCC 4.0.2
-      // using this-> to access those member does the trick
-      this->m_container->QMap<Key, T>::remove(this->m_key);
-    }
-  };
-
-  class MyMoneyMapRemove : public MyMoneyMapAction
-  {
-  public:
-    MyMoneyMapRemove(MyMoneyMap<Key, T>* container, const Key& key) :
-        MyMoneyMapAction(container, key, (*container)[key]) {
-      container->QMap<Key, T>::remove(key);
-    }
-
-    ~MyMoneyMapRemove() final {}
-    void undo(void) final override {
-      this->m_container->insert(this->m_key, this->m_obj);
-    }
-  };
-
-  class MyMoneyMapModify : public MyMoneyMapAction
+  /**
+    * The state of an object before it was changed the first time
+    * within a transaction. If @a existed is @c false, the object
+    * was not contained before and is removed upon rollback.
+    */
+  class MyMoneyMapUndo
   {
   public:
-    MyMoneyMapModify(MyMoneyMap<Key, T>* container, const Key& key, const T& obj) :
-        MyMoneyMapAction(container, key, (*container)[key]) {
-      container->QMap<Key, T>::insert(key, obj);
-    }
+    MyMoneyMapUndo() : existed(false) {}
+    explicit MyMoneyMapUndo(const Key& k) : key(k), existed(false) {}
+    MyMoneyMapUndo(const Key& k, const T& o) : key(k), obj(o), existed(true) {}
 
-    ~MyMoneyMapModify() final {}
-    void undo(void) final override {
-      this->m_container->QMap<Key, T>::insert(this->m_key, this->m_obj);
-    }
+    Key   key;
+    T     obj;
+    bool  existed;
   };
 
 protected:
-  QStack<MyMoneyMapAction *> m_stack;
+  QVector<MyMoneyMapUndo>   m_journal;
+  QSet<Key>                 m_touched;
+  unsigned long*            m_idPtr;
+  unsigned long             m_id;
+  bool                      m_inTransaction;
 };
 
 #if MY_OWN_DEBUG
@@ -46,6 +46,7 @@ MyMoneyStorageMgr::MyMoneyStorageMgr() :
 MyMoneyStorageMgr::~MyMoneyStorageMgr()
 {
   Q_D(MyMoneyStorageMgr);
+  delete d->m_source;
   delete d;
 }
 
@@ -128,8 +129,9 @@ MyMoneyAccount MyMoneyStorageMgr::account(const QString& id) const
 {
   Q_D(const MyMoneyStorageMgr);
   // locate the account and if present, return it's data
-  if (d->m_accountList.find(id) != d->m_accountList.end()) {
-    auto acc = d->m_accountList[id];
+  const auto it = d->m_accountList.find(id);
+  if (it != d->m_accountList.end()) {
+    auto acc = *it;
     // is that needed at all?
     if (acc.fraction() == -1) {
       const auto& sec = security(acc.currencyId());
@@ -142,23 +144,28 @@ MyMoneyAccount MyMoneyStorageMgr::account(const QString& id) const
   throw MYMONEYEXCEPTION(QString::fromLatin1("Unknown account id '%1'").arg(id));
 }
 
-MyMoneyAccount MyMoneyStorageMgr::accountByName(const QString& name) const
+MyMoneyAccount MyMoneyStorageMgr::accountByName(const QString& name, Qt::CaseSensitivity cs) const
 {
   Q_D(const MyMoneyStorageMgr);
   if (name.isEmpty())
     return MyMoneyAccount();
 
-  QMap<QString, MyMoneyAccount>::ConstIterator it_a;
-
-  for (it_a = d->m_accountList.begin(); it_a != d->m_accountList.end(); ++it_a) {
-    if ((*it_a).name() == name) {
-      return *it_a;
-    }
-  }
+  const auto ids = d->idsByName(d->m_accountList, name, cs);
+  if (!ids.isEmpty())
+    return d->m_accountList[ids.first()];
 
   throw MYMONEYEXCEPTION(QString::fromLatin1("Unknown account '%1'").arg(name));
 }
 
+QList<MyMoneyAccount> MyMoneyStorageMgr::accountsByNumber(const QString& number) const
+{
+  Q_D(const MyMoneyStorageMgr);
+  QList<MyMoneyAccount> list;
+  foreach (const auto id, d->m_accountList.ids(MyMoneyStorageMgrPrivate::AccountNumberIndex, number))
+    list.append(d->m_accountList[id]);
+  return list;
+}
+
 void MyMoneyStorageMgr::accountList(QList<MyMoneyAccount>& list) const
 {
   Q_D(const MyMoneyStorageMgr);
@@ -236,7 +243,7 @@ ulong MyMoneyStorageMgr::onlineJobId() const
 MyMoneyPayee MyMoneyStorageMgr::payee(const QString& id) const
 {
   Q_D(const MyMoneyStorageMgr);
-  QMap<QString, MyMoneyPayee>::ConstIterator it;
+  QHash<QString, MyMoneyPayee>::ConstIterator it;
   it = d->m_payeeList.find(id);
   if (it == d->m_payeeList.end())
     throw MYMONEYEXCEPTION(QString::fromLatin1("Unknown payee '%1'").arg(id));
@@ -244,19 +251,15 @@ MyMoneyPayee MyMoneyStorageMgr::payee(const QString& id) const
   return *it;
 }
 
-MyMoneyPayee MyMoneyStorageMgr::payeeByName(const QString& payee) const
+MyMoneyPayee MyMoneyStorageMgr::payeeByName(const QString& payee, Qt::CaseSensitivity cs) const
 {
   Q_D(const MyMoneyStorageMgr);
   if (payee.isEmpty())
     return MyMoneyPayee::null;
 
-  QMap<QString, MyMoneyPayee>::ConstIterator it_p;
-
-  for (it_p = d->m_payeeList.begin(); it_p != d->m_payeeList.end(); ++it_p) {
-    if ((*it_p).name() == payee) {
-      return *it_p;
-    }
-  }
+  const auto ids = d->idsByName(d->m_payeeList, payee, cs);
+  if (!ids.isEmpty())
+    return d->m_payeeList[ids.first()];
 
   throw MYMONEYEXCEPTION(QString::fromLatin1("Unknown payee '%1'").arg(payee));
 }
@@ -264,7 +267,7 @@ MyMoneyPayee MyMoneyStorageMgr::payeeByName(const QString& payee) const
 void MyMoneyStorageMgr::modifyPayee(const MyMoneyPayee& payee)
 {
   Q_D(MyMoneyStorageMgr);
-  QMap<QString, MyMoneyPayee>::ConstIterator it;
+  QHash<QString, MyMoneyPayee>::ConstIterator it;
 
   it = d->m_payeeList.find(payee.id());
   if (it == d->m_payeeList.end())
@@ -276,20 +279,16 @@ void MyMoneyStorageMgr::modifyPayee(const MyMoneyPayee& payee)
 void MyMoneyStorageMgr::removePayee(const MyMoneyPayee& payee)
 {
   Q_D(MyMoneyStorageMgr);
-  QMap<QString, MyMoneyTransaction>::ConstIterator it_t;
   QMap<QString, MyMoneySchedule>::ConstIterator it_s;
-  QMap<QString, MyMoneyPayee>::ConstIterator it_p;
+  QHash<QString, MyMoneyPayee>::ConstIterator it_p;
 
   it_p = d->m_payeeList.find(payee.id());
   if (it_p == d->m_payeeList.end())
     throw MYMONEYEXCEPTION(QString::fromLatin1("Unknown payee '%1'").arg(payee.id()));
 
-  // scan all transactions to check if the payee is still referenced
-  for (it_t = d->m_transactionList.begin(); it_t != d->m_transactionList.end(); ++it_t) {
-    if ((*it_t).hasReferenceTo(payee.id())) {
-      throw MYMONEYEXCEPTION(QString::fromLatin1("Cannot remove payee that is still referenced to a %1").arg("transaction"));
-    }
-  }
+  // check if the payee is still referenced by a transaction
+  if (d->isReferencedByTransaction(payee.id()))
+    throw MYMONEYEXCEPTION(QString::fromLatin1("Cannot remove payee that is still referenced to a %1").arg("transaction"));
 
   // check referential integrity in schedules
   for (it_s = d->m_scheduleList.begin(); it_s != d->m_scheduleList.end(); ++it_s) {
@@ -330,19 +329,15 @@ MyMoneyTag MyMoneyStorageMgr::tag(const QString& id) const
   return *it;
 }
 
-MyMoneyTag MyMoneyStorageMgr::tagByName(const QString& tag) const
+MyMoneyTag MyMoneyStorageMgr::tagByName(const QString& tag, Qt::CaseSensitivity cs) const
 {
   Q_D(const MyMoneyStorageMgr);
   if (tag.isEmpty())
     return MyMoneyTag::null;
 
-  QMap<QString, MyMoneyTag>::ConstIterator it_ta;
-
-  for (it_ta = d->m_tagList.begin(); it_ta != d->m_tagList.end(); ++it_ta) {
-    if ((*it_ta).name() == tag) {
-      return *it_ta;
-    }
-  }
+  const auto ids = d->idsByName(d->m_tagList, tag, cs);
+  if (!ids.isEmpty())
+    return d->m_tagList[ids.first()];
 
   throw MYMONEYEXCEPTION(QString::fromLatin1("Unknown tag '%1'").arg(tag));
 }
@@ -362,7 +357,6 @@ void MyMoneyStorageMgr::modifyTag(const MyMoneyTag& tag)
 void MyMoneyStorageMgr::removeTag(const MyMoneyTag& tag)
 {
   Q_D(MyMoneyStorageMgr);
-  QMap<QString, MyMoneyTransaction>::ConstIterator it_t;
   QMap<QString, MyMoneySchedule>::ConstIterator it_s;
   QMap<QString, MyMoneyTag>::ConstIterator it_ta;
 
@@ -370,12 +364,9 @@ void MyMoneyStorageMgr::removeTag(const MyMoneyTag& tag)
   if (it_ta == d->m_tagList.end())
     throw MYMONEYEXCEPTION(QString::fromLatin1("Unknown tag '%1'").arg(tag.id()));
 
-  // scan all transactions to check if the tag is still referenced
-  for (it_t = d->m_transactionList.begin(); it_t != d->m_transactionList.end(); ++it_t) {
-    if ((*it_t).hasReferenceTo(tag.id())) {
-      throw MYMONEYEXCEPTION(QString::fromLatin1("Cannot remove tag that is still referenced to a %1").arg("transaction"));
-    }
-  }
+  // check if the tag is still referenced by a transaction
+  if (d->isReferencedByTransaction(tag.id()))
+    throw MYMONEYEXCEPTION(QString::fromLatin1("Cannot remove tag that is still referenced to a %1").arg("transaction"));
 
   // check referential integrity in schedules
   for (it_s = d->m_scheduleList.begin(); it_s != d->m_scheduleList.end(); ++it_s) {
@@ -399,8 +390,8 @@ QList<MyMoneyTag> MyMoneyStorageMgr::tagList() const
 void MyMoneyStorageMgr::addAccount(MyMoneyAccount& parent, MyMoneyAccount& account)
 {
   Q_D(MyMoneyStorageMgr);
-  QMap<QString, MyMoneyAccount>::ConstIterator theParent;
-  QMap<QString, MyMoneyAccount>::ConstIterator theChild;
+  QHash<QString, MyMoneyAccount>::ConstIterator theParent;
+  QHash<QString, MyMoneyAccount>::ConstIterator theChild;
 
   theParent = d->m_accountList.find(parent.id());
   if (theParent == d->m_accountList.end())
@@ -438,31 +429,15 @@ uint MyMoneyStorageMgr::transactionCount(const QString& account) const
   Q_D(const MyMoneyStorageMgr);
   uint cnt = 0;
 
+  const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchTransactions(account.isEmpty() ? QStringList() : QStringList(account));
   if (account.length() == 0) {
     cnt = d->m_transactionList.count();
 
   } else {
-    // scan all transactions
-    foreach (const auto transaction, d->m_transactionList) {
-      // scan all splits of this transaction
-      auto found = false;
-      foreach (const auto split, transaction.splits()) {
-        // is it a split in our account?
-        if (split.accountId() == account) {
-          // since a transaction can only have one split referencing
-          // each account, we're done with the splits here!
-          found = true;
-          break;
-        }
-      }
-      // if no split contains the account id, continue with the
-      // next transaction
-      if (!found)
-        continue;
-
-      // otherwise count it
+    // the index contains each transaction
+    // referencing the account exactly once
+    for (auto it = d->accountIndexBegin(account); !d->accountIndexEnd(it, account); ++it)
       ++cnt;
-    }
   }
   return cnt;
 }
@@ -473,6 +448,7 @@ QMap<QString, ulong> MyMoneyStorageMgr::transactionCountMap() const
   QMap<QString, ulong> map;
 
   // scan all transactions
+  const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchTransactions(QStringList());
   foreach (const auto transaction, d->m_transactionList) {
     // scan all splits of this transaction
     foreach (const auto split, transaction.splits()) {
@@ -518,11 +494,15 @@ void MyMoneyStorageMgr::addTransaction(MyMoneyTransaction& transaction, bool ski
       payee(split.payeeId());
   }
 
+  d->fetchTransactions(transaction);
+
   MyMoneyTransaction newTransaction(d->nextTransactionID(), transaction);
   QString key = newTransaction.uniqueSortKey();
 
   d->m_transactionList.insert(key, newTransaction);
   d->m_transactionKeys.insert(newTransaction.id(), key);
+  d->addToAccountIndex(newTransaction, key);
+  d->addToReferenceIndex(newTransaction, key);
 
   transaction = newTransaction;
 
@@ -540,14 +520,8 @@ void MyMoneyStorageMgr::addTransaction(MyMoneyTransaction& transaction, bool ski
 bool MyMoneyStorageMgr::hasActiveSplits(const QString& id) const
 {
   Q_D(const MyMoneyStorageMgr);
-  QMap<QString, MyMoneyTransaction>::ConstIterator it;
-
-  for (it = d->m_transactionList.begin(); it != d->m_transactionList.end(); ++it) {
-    if ((*it).accountReferenced(id)) {
-      return true;
-    }
-  }
-  return false;
+  const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchTransactions(QStringList(id));
+  return !d->accountIndexEnd(d->accountIndexBegin(id), id);
 }
 
 MyMoneyInstitution MyMoneyStorageMgr::institution(const QString& id) const
@@ -573,6 +547,74 @@ void MyMoneyStorageMgr::setDirty()
   d->m_dirty = true;
 }
 
+MyMoneyStorageMgr* MyMoneyStorageMgr::snapshot() const
+{
+  Q_D(const MyMoneyStorageMgr);
+  // all containers start their transactions together
+  if (d->m_accountList.inTransaction())
+    throw MYMONEYEXCEPTION_CSTRING("Cannot take a snapshot while a transaction is in progress");
+
+  // the snapshot reads the data which has not been loaded yet from a
+  // copy of the source. Without one, all of it must be loaded now.
+  const auto source = d->m_source ? d->m_source->readOnlyCopy() : nullptr;
+  if (d->m_source && !source) {
+    const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchTransactions(QStringList());
+    const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchPrices();
+  }
+
+  auto storage = new MyMoneyStorageMgr;
+  auto s = storage->d_func();
+  if (source) {
+    s->m_source = source;
+    s->m_cacheSize = d->m_cacheSize;
+    s->m_loadedAccounts = d->m_loadedAccounts;
+    s->m_loadedPricePairs = d->m_loadedPricePairs;
+    s->m_priceListFull = d->m_priceListFull;
+    s->m_removedTransactions = d->m_removedTransactions.container();
+  }
+
+  s->m_user = d->m_user;
+  s->m_nextInstitutionID = d->m_nextInstitutionID;
+  s->m_nextAccountID = d->m_nextAccountID;
+  s->m_nextTransactionID = d->m_nextTransactionID;
+  s->m_nextPayeeID = d->m_nextPayeeID;
+  s->m_nextTagID = d->m_nextTagID;
+  s->m_nextScheduleID = d->m_nextScheduleID;
+  s->m_nextSecurityID = d->m_nextSecurityID;
+  s->m_nextReportID = d->m_nextReportID;
+  s->m_nextBudgetID = d->m_nextBudgetID;
+  s->m_nextOnlineJobID = d->m_nextOnlineJobID;
+  s->m_nextCostCenterID = d->m_nextCostCenterID;
+
+  s->m_institutionList = d->m_institutionList.container();
+  s->m_accountList = d->m_accountList.container();
+  s->m_transactionList = d->m_transactionList.container();
+  s->m_transactionKeys = d->m_transactionKeys.container();
+  s->m_accountTransactions = d->m_accountTransactions.container();
+  s->m_referenceTransactions = d->m_referenceTransactions.container();
+  s->m_payeeList = d->m_payeeList.container();
+  s->m_tagList = d->m_tagList.container();
+  s->m_scheduleList = d->m_scheduleList.container();
+  s->m_securitiesList = d->m_securitiesList.container();
+  s->m_currencyList = d->m_currencyList.container();
+  s->m_reportList = d->m_reportList.container();
+  s->m_budgetList = d->m_budgetList.container();
+  s->m_priceList = d->m_priceList.container();
+  s->m_onlineJobList = d->m_onlineJobList.container();
+  s->m_costCenterList = d->m_costCenterList.container();
+  // the balance checkpoints are a cache which the snapshot rebuilds on demand
+
+  s->m_dirty = d->m_dirty;
+  s->m_creationDate = d->m_creationDate;
+  s->m_lastModificationDate = d->m_lastModificationDate;
+  s->m_currentFixVersion = d->m_currentFixVersion;
+  s->m_fileFixVersion = d->m_fileFixVersion;
+  s->m_transactionListFull = d->m_transactionListFull;
+
+  storage->setPairs(pairs());
+  return storage;
+}
+
 QList<MyMoneyInstitution> MyMoneyStorageMgr::institutionList() const
 {
   Q_D(const MyMoneyStorageMgr);
@@ -582,7 +624,7 @@ QList<MyMoneyInstitution> MyMoneyStorageMgr::institutionList() const
 void MyMoneyStorageMgr::modifyAccount(const MyMoneyAccount& account, bool skipCheck)
 {
   Q_D(MyMoneyStorageMgr);
-  QMap<QString, MyMoneyAccount>::ConstIterator pos;
+  QHash<QString, MyMoneyAccount>::ConstIterator pos;
 
   // locate the account in the file global pool
   pos = d->m_accountList.find(account.id());
@@ -656,12 +698,18 @@ void MyMoneyStorageMgr::modifyTransaction(const MyMoneyTransaction& transaction)
 
   // new data seems to be ok. find old version of transaction
   // in our pool. Throw exception if unknown.
-  if (!d->m_transactionKeys.contains(transaction.id()))
+  d->fetchTransaction(transaction.id());
+  auto it_k = d->m_transactionKeys.find(transaction.id());
+  if (it_k == d->m_transactionKeys.end())
     throw MYMONEYEXCEPTION_CSTRING("invalid transaction id");
 
-  QString oldKey = d->m_transactionKeys[transaction.id()];
-  if (!d->m_transactionList.contains(oldKey))
-    throw MYMONEYEXCEPTION_CSTRING("invalid transaction key");
+  if (d->m_source) {
+    d->fetchTransactions(d->m_transactionList[*it_k]);
+    d->fetchTransactions(transaction);
+    it_k = d->m_transactionKeys.find(transaction.id());
+  }
+
+  const QString oldKey = *it_k;
 
   QMap<QString, MyMoneyTransaction>::ConstIterator it_t;
 
@@ -674,6 +722,8 @@ void MyMoneyStorageMgr::modifyTransaction(const MyMoneyTransaction& transaction)
 
   // remove old transaction from lists
   d->m_transactionList.remove(oldKey);
+  d->removeFromAccountIndex(oldTransaction, oldKey);
+  d->removeFromReferenceIndex(oldTransaction, oldKey);
 
   // and adjust the balances of the accounts
   foreach (const auto split, oldTransaction.splits()) {
@@ -687,6 +737,8 @@ void MyMoneyStorageMgr::modifyTransaction(const MyMoneyTransaction& transaction)
   QString newKey = transaction.uniqueSortKey();
   d->m_transactionList.insert(newKey, transaction);
   d->m_transactionKeys.modify(transaction.id(), newKey);
+  d->addToAccountIndex(transaction, newKey);
+  d->addToReferenceIndex(transaction, newKey);
 
   // adjust account balances
   foreach (const auto split, transaction.splits()) {
@@ -714,13 +766,19 @@ void MyMoneyStorageMgr::removeTransaction(const MyMoneyTransaction& transaction)
   if (transaction.id().isEmpty())
     throw MYMONEYEXCEPTION_CSTRING("invalid transaction to be deleted");
 
-  QMap<QString, QString>::ConstIterator it_k;
+  QHash<QString, QString>::ConstIterator it_k;
   QMap<QString, MyMoneyTransaction>::ConstIterator it_t;
 
+  d->fetchTransaction(transaction.id());
   it_k = d->m_transactionKeys.find(transaction.id());
   if (it_k == d->m_transactionKeys.end())
     throw MYMONEYEXCEPTION_CSTRING("invalid transaction to be deleted");
 
+  if (d->m_source) {
+    d->fetchTransactions(d->m_transactionList[*it_k]);
+    it_k = d->m_transactionKeys.find(transaction.id());
+  }
+
   it_t = d->m_transactionList.find(*it_k);
   if (it_t == d->m_transactionList.end())
     throw MYMONEYEXCEPTION_CSTRING("invalid transaction key");
@@ -730,9 +788,13 @@ void MyMoneyStorageMgr::removeTransaction(const MyMoneyTransaction& transaction)
 
   // FIXME: check if any split is frozen and throw exception
 
-  // remove the transaction from the two lists
+  // remove the transaction from the lists
+  d->removeFromAccountIndex(t, *it_k);
+  d->removeFromReferenceIndex(t, *it_k);
   d->m_transactionList.remove(*it_k);
   d->m_transactionKeys.remove(transaction.id());
+  if (d->m_source)
+    d->m_removedTransactions.insert(transaction.id(), transaction.id());
 
   // scan the splits and collect all accounts that need
   // to be updated after the removal of this transaction
@@ -773,8 +835,8 @@ void MyMoneyStorageMgr::removeAccount(const MyMoneyAccount& account)
   // if one of the accounts did not exist, an exception had been
   // thrown and we would not make it until here.
 
-  QMap<QString, MyMoneyAccount>::ConstIterator it_a;
-  QMap<QString, MyMoneyAccount>::ConstIterator it_p;
+  QHash<QString, MyMoneyAccount>::ConstIterator it_a;
+  QHash<QString, MyMoneyAccount>::ConstIterator it_p;
 
   // locate the account in the file global pool
 
@@ -835,8 +897,9 @@ void MyMoneyStorageMgr::transactionList(QList<MyMoneyTransaction>& list, MyMoney
   Q_D(const MyMoneyStorageMgr);
   list.clear();
 
-  const auto& transactions = d->m_transactionList;
-  for (const auto& transaction : transactions) {
+  const auto fetched = const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchTransactions(filter);
+
+  d->forEachTransaction(filter, fetched, [&](const MyMoneyTransaction& transaction) {
     // This code is used now. It adds the transaction to the list for
     // each matching split exactly once. This allows to show information
     // about different splits in the same register view (e.g. search result)
@@ -846,7 +909,7 @@ void MyMoneyStorageMgr::transactionList(QList<MyMoneyTransaction>& list, MyMoney
     const auto cnt = filter.matchingSplitsCount(transaction);
     for (uint i = 0; i < cnt; ++i)
       list.append(transaction);
-  }
+  });
 }
 
 void MyMoneyStorageMgr::transactionList(QList< QPair<MyMoneyTransaction, MyMoneySplit> >& list, MyMoneyTransactionFilter& filter) const
@@ -854,11 +917,13 @@ void MyMoneyStorageMgr::transactionList(QList< QPair<MyMoneyTransaction, MyMoney
   Q_D(const MyMoneyStorageMgr);
   list.clear();
 
-  for (const auto& transaction : d->m_transactionList) {
+  const auto fetched = const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchTransactions(filter);
+
+  d->forEachTransaction(filter, fetched, [&](const MyMoneyTransaction& transaction) {
     const auto& splits = filter.matchingSplits(transaction);
     for (const auto& split : splits)
       list.append(qMakePair(transaction, split));
-  }
+  });
 }
 
 QList<MyMoneyTransaction> MyMoneyStorageMgr::transactionList(MyMoneyTransactionFilter& filter) const
@@ -868,6 +933,18 @@ QList<MyMoneyTransaction> MyMoneyStorageMgr::transactionList(MyMoneyTransactionF
   return list;
 }
 
+void MyMoneyStorageMgr::forEachTransactionSplit(MyMoneyTransactionFilter& filter, const std::function<void(const MyMoneyTransaction&, const MyMoneySplit&)>& function) const
+{
+  Q_D(const MyMoneyStorageMgr);
+  const auto fetched = const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchTransactions(filter);
+
+  d->forEachTransaction(filter, fetched, [&](const MyMoneyTransaction& transaction) {
+    const auto& splits = filter.matchingSplits(transaction);
+    for (const auto& split : splits)
+      function(transaction, split);
+  });
+}
+
 QList<onlineJob> MyMoneyStorageMgr::onlineJobList() const
 {
   Q_D(const MyMoneyStorageMgr);
@@ -891,24 +968,28 @@ MyMoneyCostCenter MyMoneyStorageMgr::costCenter(const QString& id) const
 bool MyMoneyStorageMgr::isDuplicateTransaction(const QString& id) const
 {
   Q_D(const MyMoneyStorageMgr);
+  const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchTransaction(id);
   return d->m_transactionKeys.contains(id);
 }
 
 MyMoneyTransaction MyMoneyStorageMgr::transaction(const QString& id) const
 {
   Q_D(const MyMoneyStorageMgr);
+  const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchTransaction(id);
+
   // get the full key of this transaction, throw exception
   // if it's invalid (unknown)
-  if (!d->m_transactionKeys.contains(id)) {
+  const auto it_k = d->m_transactionKeys.find(id);
+  if (it_k == d->m_transactionKeys.end()) {
     throw MYMONEYEXCEPTION(QString::fromLatin1("Invalid transaction id '%1'").arg(id));
   }
 
   // check if this key is in the list, throw exception if not
-  QString key = d->m_transactionKeys[id];
-  if (!d->m_transactionList.contains(key))
-    throw MYMONEYEXCEPTION(QString::fromLatin1("Invalid transaction key '%1'").arg(key));
+  const auto it_t = d->m_transactionList.find(*it_k);
+  if (it_t == d->m_transactionList.end())
+    throw MYMONEYEXCEPTION(QString::fromLatin1("Invalid transaction key '%1'").arg(*it_k));
 
-  return d->m_transactionList[key];
+  return *it_t;
 }
 
 MyMoneyTransaction MyMoneyStorageMgr::transaction(const QString& account, const int idx) const
@@ -957,8 +1038,9 @@ MyMoneyMoney MyMoneyStorageMgr::balance(const QString& id, const QDate& date) co
   // have this number with the account object already.
   if (!date.isValid())
     return d->m_accountList[id].balance();
-  else
-    return d->calculateBalance(id, date);
+
+  const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchTransactions(QStringList(id));
+  return d->calculateBalance(id, date);
 }
 
 MyMoneyMoney MyMoneyStorageMgr::totalBalance(const QString& id, const QDate& date) const
@@ -1017,7 +1099,8 @@ void MyMoneyStorageMgr::loadTransactions(const QMap<QString, MyMoneyTransaction>
 
   // now fill the key map and
   // identify the last used id
-  QMap<QString, QString> keys;
+  QHash<QString, QString> keys;
+  keys.reserve(map.count());
 
   d->m_nextTransactionID = 0;
   const QRegularExpression idExp("T(\\d+)$");
@@ -1030,6 +1113,8 @@ void MyMoneyStorageMgr::loadTransactions(const QMap<QString, MyMoneyTransaction>
     }
   }
   d->m_transactionKeys = keys;
+  d->rebuildAccountIndex();
+  d->rebuildReferenceIndex();
 }
 
 void MyMoneyStorageMgr::loadInstitutions(const QMap<QString, MyMoneyInstitution>& map)
@@ -1145,6 +1230,45 @@ void MyMoneyStorageMgr::loadCostCenters(const QMap< QString, MyMoneyCostCenter >
   }
 }
 
+void MyMoneyStorageMgr::setSource(IMyMoneyStorageSource* source, uint cacheSize)
+{
+  Q_D(MyMoneyStorageMgr);
+  if (d->m_source != source)
+    delete d->m_source;
+  d->m_source = source;
+  d->m_cacheSize = cacheSize;
+  d->m_transactionListFull = false;
+  d->m_priceListFull = false;
+  d->m_loadedAccounts.clear();
+  d->m_loadedPricePairs.clear();
+  if (source && source->lastTransactionId() > d->m_nextTransactionID)
+    d->m_nextTransactionID = source->lastTransactionId();
+}
+
+IMyMoneyStorageSource* MyMoneyStorageMgr::source() const
+{
+  Q_D(const MyMoneyStorageMgr);
+  return d->m_source;
+}
+
+QList<MyMoneyTransaction> MyMoneyStorageMgr::loadedTransactionList() const
+{
+  Q_D(const MyMoneyStorageMgr);
+  return d->m_transactionList.values();
+}
+
+QStringList MyMoneyStorageMgr::removedTransactionIds() const
+{
+  Q_D(const MyMoneyStorageMgr);
+  return d->m_removedTransactions.keys();
+}
+
+void MyMoneyStorageMgr::clearRemovedTransactionIds()
+{
+  Q_D(MyMoneyStorageMgr);
+  d->m_removedTransactions = QHash<QString, QString>();
+}
+
 void MyMoneyStorageMgr::setValue(const QString& key, const QString& val)
 {
   Q_D(MyMoneyStorageMgr);
@@ -1429,6 +1553,24 @@ QList<MyMoneySecurity> MyMoneyStorageMgr::securityList() const
   return d->m_securitiesList.values();
 }
 
+QList<MyMoneySecurity> MyMoneyStorageMgr::securitiesByName(const QString& name, Qt::CaseSensitivity cs) const
+{
+  Q_D(const MyMoneyStorageMgr);
+  QList<MyMoneySecurity> list;
+  foreach (const auto id, d->idsByName(d->m_securitiesList, name, cs))
+    list.append(d->m_securitiesList[id]);
+  return list;
+}
+
+QList<MyMoneySecurity> MyMoneyStorageMgr::securitiesBySymbol(const QString& symbol) const
+{
+  Q_D(const MyMoneyStorageMgr);
+  QList<MyMoneySecurity> list;
+  foreach (const auto id, d->m_securitiesList.ids(MyMoneyStorageMgrPrivate::TradingSymbolIndex, symbol))
+    list.append(d->m_securitiesList[id]);
+  return list;
+}
+
 void MyMoneyStorageMgr::addCurrency(const MyMoneySecurity& currency)
 {
   Q_D(MyMoneyStorageMgr);
@@ -1643,6 +1785,7 @@ void MyMoneyStorageMgr::removeBudget(const MyMoneyBudget& budget)
 void MyMoneyStorageMgr::addPrice(const MyMoneyPrice& price)
 {
   Q_D(MyMoneyStorageMgr);
+  d->fetchPrices(price.from(), price.to());
   MyMoneySecurityPair pricePair(price.from(), price.to());
   QMap<MyMoneySecurityPair, MyMoneyPriceEntries>::ConstIterator it_m;
   it_m = d->m_priceList.find(pricePair);
@@ -1678,6 +1821,7 @@ void MyMoneyStorageMgr::addPrice(const MyMoneyPrice& price)
 void MyMoneyStorageMgr::removePrice(const MyMoneyPrice& price)
 {
   Q_D(MyMoneyStorageMgr);
+  d->fetchPrices(price.from(), price.to());
   MyMoneySecurityPair pricePair(price.from(), price.to());
   QMap<MyMoneySecurityPair, MyMoneyPriceEntries>::ConstIterator it_m;
   it_m = d->m_priceList.find(pricePair);
@@ -1700,6 +1844,7 @@ void MyMoneyStorageMgr::removePrice(const MyMoneyPrice& price)
 MyMoneyPriceList MyMoneyStorageMgr::priceList() const
 {
   Q_D(const MyMoneyStorageMgr);
+  const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchPrices();
   MyMoneyPriceList list;
   d->m_priceList.map(list);
   return list;
@@ -1708,6 +1853,7 @@ MyMoneyPriceList MyMoneyStorageMgr::priceList() const
 MyMoneyPrice MyMoneyStorageMgr::price(const QString& fromId, const QString& toId, const QDate& _date, bool exactDate) const
 {
   Q_D(const MyMoneyStorageMgr);
+  const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchPrices(fromId, toId);
   // if the caller selected an exact entry, we can search for it using the date as the key
   QMap<MyMoneySecurityPair, MyMoneyPriceEntries>::const_iterator itm = d->m_priceList.find(qMakePair(fromId, toId));
   if (itm != d->m_priceList.end()) {
@@ -1733,19 +1879,28 @@ MyMoneyPrice MyMoneyStorageMgr::price(const QString& fromId, const QString& toId
   return MyMoneyPrice();
 }
 
+MyMoneyPriceEntries MyMoneyStorageMgr::priceEntries(const QString& fromId, const QString& toId) const
+{
+  Q_D(const MyMoneyStorageMgr);
+  const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchPrices(fromId, toId);
+  const auto it = d->m_priceList.find(qMakePair(fromId, toId));
+  if (it != d->m_priceList.end())
+    return *it;
+  return MyMoneyPriceEntries();
+}
+
 void MyMoneyStorageMgr::rebuildAccountBalances()
 {
   Q_D(MyMoneyStorageMgr);
   // reset the balance of all accounts to 0
-  QMap<QString, MyMoneyAccount> map;
-  d->m_accountList.map(map);
+  auto map = d->m_accountList.container();
 
-  QMap<QString, MyMoneyAccount>::iterator it_a;
-  for (it_a = map.begin(); it_a != map.end(); ++it_a) {
+  for (auto it_a = map.begin(); it_a != map.end(); ++it_a) {
     (*it_a).setBalance(MyMoneyMoney());
   }
 
   // now scan over all transactions and all splits and setup the balances
+  d->fetchTransactions(QStringList());
   foreach (const auto transaction, d->m_transactionList) {
     foreach (const auto split, transaction.splits()) {
       if (!split.shares().isZero()) {
@@ -1773,15 +1928,12 @@ bool MyMoneyStorageMgr::isReferenced(const MyMoneyObject& obj, const QBitArray&
 
   const auto& id = obj.id();
 
-  // FIXME optimize the list of objects we have to checks
-  //       with a bit of knowledge of the internal structure, we
-  //       could optimize the number of objects we check for references
-
-  // Scan all engine objects for a reference
-  if (!skipCheck.testBit((int)Reference::Transaction))
-    foreach (const auto it, d->m_transactionList)
-      if (it.hasReferenceTo(id))
-        return true;
+  // The transactions are looked up in the indexes, all
+  // other engine objects are scanned for a reference
+  if (!skipCheck.testBit((int)Reference::Transaction)) {
+    if (d->isReferencedByTransaction(id))
+      return true;
+  }
 
   if (!skipCheck.testBit((int)Reference::Account))
     foreach (const auto it, d->m_accountList)
@@ -1827,6 +1979,7 @@ bool MyMoneyStorageMgr::isReferenced(const MyMoneyObject& obj, const QBitArray&
   // members of the MyMoneySecurityPair is enough as they are identical to the
   // two security ids
   if (!skipCheck.testBit((int)Reference::Price)) {
+    const_cast<MyMoneyStorageMgrPrivate*>(d)->fetchPrices();
     for (auto it_pr = d->m_priceList.begin(); it_pr != d->m_priceList.end(); ++it_pr) {
       if ((it_pr.key().first == id) || (it_pr.key().second == id))
         return true;
@@ -1845,6 +1998,8 @@ void MyMoneyStorageMgr::startTransaction()
   d->m_accountList.startTransaction(&d->m_nextPayeeID);
   d->m_transactionList.startTransaction(&d->m_nextTransactionID);
   d->m_transactionKeys.startTransaction();
+  d->m_accountTransactions.startTransaction();
+  d->m_referenceTransactions.startTransaction();
   d->m_scheduleList.startTransaction(&d->m_nextScheduleID);
   d->m_securitiesList.startTransaction(&d->m_nextSecurityID);
   d->m_currencyList.startTransaction();
@@ -1852,6 +2007,7 @@ void MyMoneyStorageMgr::startTransaction()
   d->m_budgetList.startTransaction(&d->m_nextBudgetID);
   d->m_priceList.startTransaction();
   d->m_onlineJobList.startTransaction(&d->m_nextOnlineJobID);
+  d->m_removedTransactions.startTransaction();
 }
 
 bool MyMoneyStorageMgr::commitTransaction()
@@ -1864,6 +2020,8 @@ bool MyMoneyStorageMgr::commitTransaction()
   rc |= d->m_accountList.commitTransaction();
   rc |= d->m_transactionList.commitTransaction();
   rc |= d->m_transactionKeys.commitTransaction();
+  rc |= d->m_accountTransactions.commitTransaction();
+  rc |= d->m_referenceTransactions.commitTransaction();
   rc |= d->m_scheduleList.commitTransaction();
   rc |= d->m_securitiesList.commitTransaction();
   rc |= d->m_currencyList.commitTransaction();
@@ -1871,6 +2029,7 @@ bool MyMoneyStorageMgr::commitTransaction()
   rc |= d->m_budgetList.commitTransaction();
   rc |= d->m_priceList.commitTransaction();
   rc |= d->m_onlineJobList.commitTransaction();
+  rc |= d->m_removedTransactions.commitTransaction();
 
   // if there was a change, touch the whole storage object
   if (rc)
@@ -1888,6 +2047,9 @@ void MyMoneyStorageMgr::rollbackTransaction()
   d->m_accountList.rollbackTransaction();
   d->m_transactionList.rollbackTransaction();
   d->m_transactionKeys.rollbackTransaction();
+  d->m_accountTransactions.rollbackTransaction();
+  d->m_referenceTransactions.rollbackTransaction();
+  d->m_balanceCheckpoints.clear();
   d->m_scheduleList.rollbackTransaction();
   d->m_securitiesList.rollbackTransaction();
   d->m_currencyList.rollbackTransaction();
@@ -1895,4 +2057,5 @@ void MyMoneyStorageMgr::rollbackTransaction()
   d->m_budgetList.rollbackTransaction();
   d->m_priceList.rollbackTransaction();
   d->m_onlineJobList.rollbackTransaction();
+  d->m_removedTransactions.rollbackTransaction();
 }
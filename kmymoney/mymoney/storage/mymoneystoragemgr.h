@@ -25,9 +25,13 @@
 
 #include "kmm_mymoney_export.h"
 
+#include <functional>
+
 // ----------------------------------------------------------------------------
 // QT Includes
 
+#include <qnamespace.h>
+
 // ----------------------------------------------------------------------------
 // Project Includes
 
@@ -56,6 +60,7 @@ class MyMoneyTransactionFilter;
 class MyMoneyCostCenter;
 class onlineJob;
 class MyMoneyStorageSql;
+class IMyMoneyStorageSource;
 
 template <class Key, class T> class QMap;
 template <typename T> class QList;
@@ -127,10 +132,20 @@ public:
     * An exception will be thrown upon error conditions.
     *
     * @param name QString reference to name of account
+    * @param cs whether the name is compared case sensitive
     *
     * @return MyMoneyAccount reference to object of account
     */
-  MyMoneyAccount accountByName(const QString& name) const;
+  MyMoneyAccount accountByName(const QString& name, Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
+
+  /**
+    * This method returns the accounts whose account number or
+    * statement key (see MyMoneyStatementReader) equals @a number
+    * in the order of their ids.
+    *
+    * @param number account number or statement key
+    */
+  QList<MyMoneyAccount> accountsByNumber(const QString& number) const;
 
   /**
     * This method is used to check whether a given
@@ -199,10 +214,11 @@ public:
     * An exception will be thrown upon error conditions.
     *
     * @param payee QString reference to name of payee
+    * @param cs whether the name is compared case sensitive
     *
     * @return MyMoneyPayee reference to object of payee
     */
-  MyMoneyPayee payeeByName(const QString& payee) const;
+  MyMoneyPayee payeeByName(const QString& payee, Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
 
   /**
     * This method is used to modify an existing payee
@@ -255,10 +271,11 @@ public:
     * An exception will be thrown upon error conditions.
     *
     * @param tag QString reference to name of tag
+    * @param cs whether the name is compared case sensitive
     *
     * @return MyMoneyTag reference to object of tag
     */
-  MyMoneyTag tagByName(const QString& tag) const;
+  MyMoneyTag tagByName(const QString& tag, Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
 
   /**
     * This method is used to modify an existing tag
@@ -482,6 +499,36 @@ public:
     */
   void setDirty();
 
+  /**
+    * This method returns a new storage object containing the data of
+    * this one at the time of the call. The containers are shared with
+    * this object until either of them is modified (copy-on-write), so
+    * taking a snapshot is cheap even for large files. The snapshot is
+    * independent of this object and can e.g. be written to a file by a
+    * worker thread while the user continues to modify this object.
+    *
+    * If transactions and prices are provided by a source (see setSource()),
+    * those which have not been loaded yet are read on demand by the snapshot
+    * from a copy of the source (see IMyMoneyStorageSource::readOnlyCopy()).
+    * Only if the source cannot be copied, they are all loaded beforehand.
+    *
+    * @note The copy reads the persistent storage when the data is needed,
+    *       not as of the time of the call. Transactions and prices which
+    *       were not loaded when the snapshot was taken and are changed and
+    *       written to the source afterwards, e.g. by saving the file or by
+    *       another user of the same database, show up in the snapshot with
+    *       their new values. The copy cannot open a read transaction at the
+    *       time of the call, because its connection belongs to the thread
+    *       using the snapshot.
+    *
+    * The caller takes ownership of the returned object.
+    *
+    * An exception will be thrown if a transaction is in progress.
+    *
+    * @return pointer to the snapshot
+    */
+  MyMoneyStorageMgr* snapshot() const;
+
   /**
     * This method returns a list of the institutions
     * inside a MyMoneyFile object
@@ -540,6 +587,17 @@ public:
     */
   QList<MyMoneyTransaction> transactionList(MyMoneyTransactionFilter& filter) const;
 
+  /**
+    * Calls @a function for each split which matches @a filter together with
+    * its transaction in the same order as transactionList() returns them.
+    * The transactions are not copied, so this is the method of choice
+    * if only some details of each split are needed.
+    *
+    * @param filter MyMoneyTransactionFilter object with the match criteria
+    * @param function called with the transaction and the split
+    */
+  void forEachTransactionSplit(MyMoneyTransactionFilter& filter, const std::function<void(const MyMoneyTransaction&, const MyMoneySplit&)>& function) const;
+
   /**
    * @brief Return all onlineJobs
    */
@@ -622,6 +680,45 @@ public:
     */
   MyMoneyAccount equity() const;
 
+  /**
+    * Attaches a persistent storage from which transactions and prices
+    * are loaded on demand instead of being loaded with loadTransactions()
+    * and loadPrices(). The storage object takes ownership of @a source.
+    *
+    * The transactions are loaded per account the first time they are
+    * requested. Once more than @a cacheSize transactions are kept in
+    * memory and all changes have been saved, the transactions of the
+    * least recently used accounts are dropped again.
+    *
+    * @sa IMyMoneyStorageSource
+    */
+  void setSource(IMyMoneyStorageSource* source, uint cacheSize);
+
+  /**
+    * Returns the source set with setSource() or @c nullptr
+    */
+  IMyMoneyStorageSource* source() const;
+
+  /**
+    * Returns the transactions which are currently kept in memory.
+    * Unlike transactionList() this does not load any transactions
+    * from the source. This is used to write the changes back to it.
+    */
+  QList<MyMoneyTransaction> loadedTransactionList() const;
+
+  /**
+    * Returns the ids of the transactions which have been removed
+    * since clearRemovedTransactionIds() has been called. The ids
+    * are only collected if a source is attached.
+    */
+  QStringList removedTransactionIds() const;
+
+  /**
+    * Forgets the ids returned by removedTransactionIds(). Call this
+    * once the removal has been written to the source.
+    */
+  void clearRemovedTransactionIds();
+
   void loadAccounts(const QMap<QString, MyMoneyAccount>& acc);
   void loadTransactions(const QMap<QString, MyMoneyTransaction>& map);
   void loadInstitutions(const QMap<QString, MyMoneyInstitution>& map);
@@ -757,6 +854,23 @@ public:
     */
   QList<MyMoneySecurity> securityList() const;
 
+  /**
+    * This method returns the securities named @a name
+    * in the order of their ids.
+    *
+    * @param name name of the security
+    * @param cs whether the name is compared case sensitive
+    */
+  QList<MyMoneySecurity> securitiesByName(const QString& name, Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
+
+  /**
+    * This method returns the securities whose trading symbol equals
+    * @a symbol ignoring the case in the order of their ids.
+    *
+    * @param symbol trading symbol of the security
+    */
+  QList<MyMoneySecurity> securitiesBySymbol(const QString& symbol) const;
+
   /**
     * This method is used to add a new currency object to the engine.
     * The ID of the object is the trading symbol, so there is no need for an additional
@@ -1018,6 +1132,12 @@ public:
     */
   MyMoneyPrice price(const QString& fromId, const QString& toId, const QDate& _date, bool exactDate) const;
 
+  /**
+    * This method retrieves all prices of @p fromId in @p toId ordered by date.
+    * An empty map is returned if there are none.
+    */
+  MyMoneyPriceEntries priceEntries(const QString& fromId, const QString& toId) const;
+
   /**
     * This method returns a list of all price entries.
     */
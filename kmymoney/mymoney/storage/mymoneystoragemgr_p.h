@@ -29,6 +29,8 @@
 // QT Includes
 
 #include <QList>
+#include <QSet>
+#include <QHash>
 #include <QBitArray>
 #include <QDate>
 #include <QRegularExpression>
@@ -58,9 +60,13 @@
 #include "mymoneytransactionfilter.h"
 #include "mymoneycostcenter.h"
 #include "mymoneymap.h"
+#include "mymoneyindexedmap.h"
+#include "imymoneystoragesource.h"
 #include "onlinejob.h"
 #include "mymoneyenums.h"
 
+#include <algorithm>
+
 using namespace eStorage;
 
 const int INSTITUTION_ID_SIZE = 6;
@@ -75,6 +81,24 @@ const int BUDGET_ID_SIZE = 6;
 const int ONLINE_JOB_ID_SIZE = 6;
 const int COSTCENTER_ID_SIZE = 6;
 
+/**
+  * Monthly balance checkpoints of a single account used by
+  * MyMoneyStorageMgrPrivate::calculateBalance(). Each entry in
+  * @a checkpoints maps the first day of a month in which the account
+  * is referenced by at least one transaction to the balance of the
+  * account before this day. The list is only complete for all
+  * transactions of the account if @a complete is @c true. In this
+  * case @a balance contains the balance after the last transaction.
+  */
+struct MyMoneyBalanceCheckpoints
+{
+  MyMoneyBalanceCheckpoints() : complete(false) {}
+
+  QMap<QDate, MyMoneyMoney> checkpoints;
+  MyMoneyMoney balance;
+  bool complete;
+};
+
 class MyMoneyStorageMgrPrivate
 {
   Q_DISABLE_COPY(MyMoneyStorageMgrPrivate)
@@ -99,8 +123,62 @@ public:
     // initialize for file fixes (see kmymoneyview.cpp)
     m_currentFixVersion(5),
     m_fileFixVersion(0), // default value if no fix-version in file
-    m_transactionListFull(false)
+    m_transactionListFull(false),
+    m_source(nullptr),
+    m_cacheSize(0),
+    m_priceListFull(false)
+  {
+    m_accountList.addIndex(nameKeys<MyMoneyAccount>);
+    m_accountList.addIndex(nameKeys<MyMoneyAccount>, Qt::CaseInsensitive);
+    m_accountList.addIndex(accountNumberKeys);
+    m_payeeList.addIndex(nameKeys<MyMoneyPayee>);
+    m_payeeList.addIndex(nameKeys<MyMoneyPayee>, Qt::CaseInsensitive);
+    m_tagList.addIndex(nameKeys<MyMoneyTag>);
+    m_tagList.addIndex(nameKeys<MyMoneyTag>, Qt::CaseInsensitive);
+    m_securitiesList.addIndex(nameKeys<MyMoneySecurity>);
+    m_securitiesList.addIndex(nameKeys<MyMoneySecurity>, Qt::CaseInsensitive);
+    m_securitiesList.addIndex(tradingSymbolKeys, Qt::CaseInsensitive);
+  }
+
+  /**
+    * The numbers of the indexes of m_accountList, m_payeeList,
+    * m_tagList and m_securitiesList
+    */
+  enum Index {
+    NameIndex = 0,
+    CaseFoldedNameIndex,
+    AccountNumberIndex,
+    TradingSymbolIndex = AccountNumberIndex
+  };
+
+  template <class T>
+  static QStringList nameKeys(const T& obj)
+  {
+    return QStringList(obj.name());
+  }
+
+  /**
+    * Returns the account number and the statement key which
+    * are used to identify the account during statement import
+    */
+  static QStringList accountNumberKeys(const MyMoneyAccount& account)
+  {
+    return QStringList() << account.number() << account.value(QStringLiteral("StatementKey"));
+  }
+
+  static QStringList tradingSymbolKeys(const MyMoneySecurity& security)
   {
+    return QStringList(security.tradingSymbol());
+  }
+
+  /**
+    * Returns the ids of the objects in @a list which have @a key in
+    * the name index, respecting @a cs
+    */
+  template <class T, class Container>
+  static QStringList idsByName(const MyMoneyIndexedMap<T, Container>& list, const QString& key, Qt::CaseSensitivity cs)
+  {
+    return list.ids(cs == Qt::CaseSensitive ? NameIndex : CaseFoldedNameIndex, key);
   }
 
   ~MyMoneyStorageMgrPrivate()
@@ -182,9 +260,9 @@ public:
   void reparentAccount(MyMoneyAccount &account, MyMoneyAccount& parent, bool /* sendNotification */)
   {
     Q_Q(MyMoneyStorageMgr);
-    QMap<QString, MyMoneyAccount>::ConstIterator oldParent;
-    QMap<QString, MyMoneyAccount>::ConstIterator newParent;
-    QMap<QString, MyMoneyAccount>::ConstIterator childAccount;
+    QHash<QString, MyMoneyAccount>::ConstIterator oldParent;
+    QHash<QString, MyMoneyAccount>::ConstIterator newParent;
+    QHash<QString, MyMoneyAccount>::ConstIterator childAccount;
 
     // verify that accounts exist. If one does not,
     // an exception is thrown
@@ -226,37 +304,112 @@ public:
   /**
     * This method is used to calculate the actual balance of an account
     * without it's sub-ordinate accounts. If a @p date is presented,
-    * the balance at the beginning of this date (not including any
-    * transaction on this date) is returned. Otherwise all recorded
+    * the balance at the end of this date (including all transactions
+    * on this date) is returned. Otherwise all recorded
     * transactions are included in the balance.
     *
+    * The balance is based on the monthly checkpoints kept in
+    * m_balanceCheckpoints so that only the transactions of the account
+    * in the month of @p date need to be added to the checkpoint.
+    *
     * @param id id of the account in question
     * @param date return balance for specific date
     * @return balance of the account as MyMoneyMoney object
     */
   MyMoneyMoney calculateBalance(const QString& id, const QDate& date) const
   {
-    Q_Q(const MyMoneyStorageMgr);
+    auto& history = m_balanceCheckpoints[id];
+    if (!history.complete)
+      updateBalanceCheckpoints(id, history);
+
+    if (!date.isValid())
+      return history.balance;
+
+    auto it = history.checkpoints.upperBound(date);
+    // all transactions of the account are posted after date
+    if (it == history.checkpoints.begin())
+      return MyMoneyMoney();
+
+    --it;
+    auto balance = *it;
+    const auto end = accountTransactionKey(id, dateKey(date.addDays(1)));
+    for (auto it_t = m_accountTransactions.lowerBound(accountTransactionKey(id, dateKey(it.key()))); !accountIndexEnd(it_t, id); ++it_t) {
+      if (it_t.key() >= end)
+        break;
+      addToBalance(balance, id, m_transactionList[*it_t]);
+    }
+    return balance;
+  }
+
+  /**
+    * Adds the shares of all splits of @a transaction referencing the
+    * account with @a id to @a balance. In case of a stock split the
+    * balance is multiplied by the shares instead.
+    */
+  static void addToBalance(MyMoneyMoney& balance, const QString& id, const MyMoneyTransaction& transaction)
+  {
+    const auto splits = transaction.splits();
+    for (const auto& split : splits) {
+      if (split.accountId().compare(id) != 0)
+        continue;
+      else if (split.action().compare(MyMoneySplit::actionName(eMyMoney::Split::Action::SplitShares)) == 0)
+        balance *= split.shares();
+      else
+        balance += split.shares();
+    }
+  }
+
+  /**
+    * Completes the monthly balance checkpoints in @a history of the account
+    * with @a id. The calculation starts at the last checkpoint which is still
+    * valid, so only the months after a modification are recalculated.
+    */
+  void updateBalanceCheckpoints(const QString& id, MyMoneyBalanceCheckpoints& history) const
+  {
+    QDate month;
     MyMoneyMoney balance;
+    if (!history.checkpoints.isEmpty()) {
+      auto last = history.checkpoints.end();
+      --last;
+      month = last.key();
+      balance = *last;
+    }
 
-    MyMoneyTransactionFilter filter;
-    filter.setDateFilter(QDate(), date);
-    filter.setReportAllSplits(false);
-
-    const auto list = q->transactionList(filter);
-    for (const auto& transaction : list) {
-      const auto splits = transaction.splits();
-      for (const auto& split : splits) {
-        if (split.accountId().compare(id) != 0)
-          continue;
-        else if (split.action().compare(MyMoneySplit::actionName(eMyMoney::Split::Action::SplitShares)) == 0)
-          balance *= split.shares();
-        else
-          balance += split.shares();
+    const auto first = month.isValid() ? dateKey(month) : QString();
+    for (auto it = m_accountTransactions.lowerBound(accountTransactionKey(id, first)); !accountIndexEnd(it, id); ++it) {
+      const auto& transaction = m_transactionList[*it];
+      const auto postDate = transaction.postDate();
+      const QDate transactionMonth(postDate.year(), postDate.month(), 1);
+      if (transactionMonth != month) {
+        month = transactionMonth;
+        history.checkpoints.insert(month, balance);
       }
+      addToBalance(balance, id, transaction);
     }
+    history.balance = balance;
+    history.complete = true;
+  }
 
-    return balance;
+  /**
+    * Invalidates the balance checkpoints of the account with @a id which
+    * are affected by a change of a transaction posted on @a date.
+    */
+  void invalidateBalanceCheckpoints(const QString& id, const QDate& date)
+  {
+    auto it = m_balanceCheckpoints.find(id);
+    if (it == m_balanceCheckpoints.end())
+      return;
+
+    if (!date.isValid()) {
+      m_balanceCheckpoints.erase(it);
+      return;
+    }
+
+    auto& checkpoints = (*it).checkpoints;
+    auto it_c = checkpoints.upperBound(date);
+    while (it_c != checkpoints.end())
+      it_c = checkpoints.erase(it_c);
+    (*it).complete = false;
   }
 
   void removeReferences(const QString& id)
@@ -279,6 +432,568 @@ public:
     }
   }
 
+  /**
+    * Returns the key used in m_accountTransactions for the transaction
+    * stored with @a transactionKey in m_transactionList that references
+    * the account with @a accountId. All keys of one account share the
+    * same prefix and are ordered the same way as in m_transactionList.
+    * m_referenceTransactions uses the same keys for the other objects
+    * referenced by a transaction.
+    */
+  static QString accountTransactionKey(const QString& accountId, const QString& transactionKey)
+  {
+    return accountId + QLatin1Char('|') + transactionKey;
+  }
+
+  /**
+    * Returns the ids of the accounts referenced by the splits
+    * of @a transaction. Each id is contained only once.
+    */
+  static QSet<QString> referencedAccounts(const MyMoneyTransaction& transaction)
+  {
+    QSet<QString> accounts;
+    const auto splits = transaction.splits();
+    for (const auto& split : splits)
+      accounts.insert(split.accountId());
+    return accounts;
+  }
+
+  /**
+    * Returns the ids of the objects referenced by @a transaction other
+    * than the accounts of its splits: the commodity and the payees, tags
+    * and cost centers of the splits. Everything referenced by a matched
+    * transaction is included as well. Each id is contained only once.
+    * @sa MyMoneyTransaction::hasReferenceTo()
+    */
+  static QSet<QString> referencedObjects(const MyMoneyTransaction& transaction)
+  {
+    QSet<QString> objects;
+    objects.insert(transaction.commodity());
+    const auto splits = transaction.splits();
+    for (const auto& split : splits) {
+      objects.insert(split.payeeId());
+      objects.insert(split.costCenterId());
+      foreach (const auto tagId, split.tagIdList())
+        objects.insert(tagId);
+      if (split.isMatched()) {
+        const auto matched = split.matchedTransaction();
+        objects.unite(referencedAccounts(matched));
+        objects.unite(referencedObjects(matched));
+      }
+    }
+    objects.remove(QString());
+    return objects;
+  }
+
+  /**
+    * Adds @a transaction stored with @a key in m_transactionList
+    * to the per account index m_accountTransactions
+    */
+  void addToAccountIndex(const MyMoneyTransaction& transaction, const QString& key)
+  {
+    foreach (const auto accountId, referencedAccounts(transaction)) {
+      m_accountTransactions.insert(accountTransactionKey(accountId, key), key);
+      invalidateBalanceCheckpoints(accountId, transaction.postDate());
+    }
+  }
+
+  /**
+    * Removes @a transaction stored with @a key in m_transactionList
+    * from the per account index m_accountTransactions
+    */
+  void removeFromAccountIndex(const MyMoneyTransaction& transaction, const QString& key)
+  {
+    foreach (const auto accountId, referencedAccounts(transaction)) {
+      m_accountTransactions.remove(accountTransactionKey(accountId, key));
+      invalidateBalanceCheckpoints(accountId, transaction.postDate());
+    }
+  }
+
+  /**
+    * Adds @a transaction stored with @a key in m_transactionList
+    * to the reference index m_referenceTransactions
+    */
+  void addToReferenceIndex(const MyMoneyTransaction& transaction, const QString& key)
+  {
+    foreach (const auto id, referencedObjects(transaction))
+      m_referenceTransactions.insert(accountTransactionKey(id, key), key);
+  }
+
+  /**
+    * Removes @a transaction stored with @a key in m_transactionList
+    * from the reference index m_referenceTransactions
+    */
+  void removeFromReferenceIndex(const MyMoneyTransaction& transaction, const QString& key)
+  {
+    foreach (const auto id, referencedObjects(transaction))
+      m_referenceTransactions.remove(accountTransactionKey(id, key));
+  }
+
+  /**
+    * Rebuilds m_accountTransactions from scratch based on m_transactionList.
+    * This must not be called during a transaction.
+    */
+  void rebuildAccountIndex()
+  {
+    QMap<QString, QString> index;
+    for (auto it = m_transactionList.begin(); it != m_transactionList.end(); ++it) {
+      foreach (const auto accountId, referencedAccounts(*it))
+        index.insert(accountTransactionKey(accountId, it.key()), it.key());
+    }
+    m_accountTransactions = index;
+    m_balanceCheckpoints.clear();
+  }
+
+  /**
+    * Rebuilds m_referenceTransactions from scratch based on m_transactionList.
+    * This must not be called during a transaction.
+    */
+  void rebuildReferenceIndex()
+  {
+    QMap<QString, QString> index;
+    for (auto it = m_transactionList.begin(); it != m_transactionList.end(); ++it) {
+      foreach (const auto id, referencedObjects(*it))
+        index.insert(accountTransactionKey(id, it.key()), it.key());
+    }
+    m_referenceTransactions = index;
+  }
+
+  /**
+    * Returns the first entry of m_accountTransactions for the account
+    * with @a accountId. Use accountIndexEnd() to detect the end of
+    * the entries for this account.
+    */
+  MyMoneyMap<QString, QString>::const_iterator accountIndexBegin(const QString& accountId) const
+  {
+    return indexBegin(m_accountTransactions, accountId);
+  }
+
+  /**
+    * Returns @c true if @a it does not point to an entry
+    * of m_accountTransactions for the account with @a accountId.
+    */
+  bool accountIndexEnd(const MyMoneyMap<QString, QString>::const_iterator& it, const QString& accountId) const
+  {
+    return indexEnd(m_accountTransactions, it, accountId);
+  }
+
+  /**
+    * Returns the first entry of m_referenceTransactions for the object
+    * with @a id. Use referenceIndexEnd() to detect the end of
+    * the entries for this object.
+    */
+  MyMoneyMap<QString, QString>::const_iterator referenceIndexBegin(const QString& id) const
+  {
+    return indexBegin(m_referenceTransactions, id);
+  }
+
+  /**
+    * Returns @c true if @a it does not point to an entry
+    * of m_referenceTransactions for the object with @a id.
+    */
+  bool referenceIndexEnd(const MyMoneyMap<QString, QString>::const_iterator& it, const QString& id) const
+  {
+    return indexEnd(m_referenceTransactions, it, id);
+  }
+
+  static MyMoneyMap<QString, QString>::const_iterator indexBegin(const MyMoneyMap<QString, QString>& index, const QString& id)
+  {
+    return index.lowerBound(accountTransactionKey(id, QString()));
+  }
+
+  static bool indexEnd(const MyMoneyMap<QString, QString>& index, const MyMoneyMap<QString, QString>::const_iterator& it, const QString& id)
+  {
+    return it == index.end() || !it.key().startsWith(accountTransactionKey(id, QString()));
+  }
+
+  /**
+    * Returns @c true if a transaction in memory or in m_source
+    * references the object with @a id
+    */
+  bool isReferencedByTransaction(const QString& id) const
+  {
+    return !accountIndexEnd(accountIndexBegin(id), id)
+           || !referenceIndexEnd(referenceIndexBegin(id), id)
+           || isReferencedBySource(id);
+  }
+
+  /**
+    * Returns the date part of the keys used in m_transactionList
+    * (see MyMoneyTransaction::uniqueSortKey()) for @a date.
+    */
+  static QString dateKey(const QDate& date)
+  {
+    return QString::fromLatin1("%1-%2-%3").arg(date.year(), 4, 10, QLatin1Char('0'))
+                                          .arg(date.month(), 2, 10, QLatin1Char('0'))
+                                          .arg(date.day(), 2, 10, QLatin1Char('0'));
+  }
+
+  /**
+    * Returns the range of transaction keys for the date range @a from to @a to
+    * in @a first and @a last. Any key in m_transactionList with a post date in
+    * the range satisfies @a first <= key < @a last. An invalid @a from or @a to
+    * leaves the respective side open which is denoted by an empty string.
+    */
+  static void dateKeyRange(const QDate& from, const QDate& to, QString& first, QString& last)
+  {
+    first = from.isValid() ? dateKey(from) : QString();
+    last = to.isValid() ? dateKey(to.addDays(1)) : QString();
+  }
+
+  /**
+    * Returns the keys of the transactions in m_transactionList which
+    * reference at least one of the accounts in @a accountIds and have
+    * a post date between @a from and @a to. An invalid date does not
+    * limit the range on this side. The keys are returned in the order
+    * of m_transactionList.
+    */
+  QStringList accountTransactionKeys(const QStringList& accountIds, const QDate& from = QDate(), const QDate& to = QDate()) const
+  {
+    return indexedKeys(m_accountTransactions, accountIds, from, to);
+  }
+
+  /**
+    * Same as accountTransactionKeys() but for the transactions
+    * referencing one of the payees or tags in @a ids.
+    */
+  QStringList referenceTransactionKeys(const QStringList& ids, const QDate& from = QDate(), const QDate& to = QDate()) const
+  {
+    return indexedKeys(m_referenceTransactions, ids, from, to);
+  }
+
+  static QStringList indexedKeys(const MyMoneyMap<QString, QString>& index, const QStringList& ids, const QDate& from, const QDate& to)
+  {
+    QStringList keys;
+    QString first, last;
+    dateKeyRange(from, to, first, last);
+    for (const auto& id : ids) {
+      auto it = index.lowerBound(accountTransactionKey(id, first));
+      const auto end = last.isEmpty() ? QString() : accountTransactionKey(id, last);
+      for (; !indexEnd(index, it, id); ++it) {
+        if (!end.isEmpty() && it.key() >= end)
+          break;
+        keys.append(*it);
+      }
+    }
+
+    // a transaction may reference more than one of the objects
+    if (ids.count() > 1) {
+      std::sort(keys.begin(), keys.end());
+      keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    }
+    return keys;
+  }
+
+  /**
+    * Collects the keys of all transactions that possibly match @a filter
+    * in @a keys using the per account or the reference index. Returns
+    * @c false in case the filter does not limit the accounts, categories,
+    * payees or tags and all transactions must be checked.
+    */
+  bool indexedTransactionKeys(const MyMoneyTransactionFilter& filter, const QDate& from, const QDate& to, QStringList& keys) const
+  {
+    QStringList ids;
+    // a transaction only matches an account filter if one of its splits
+    // references one of the accounts. Without accounts, nothing matches.
+    if (filter.accounts(ids)) {
+      keys = accountTransactionKeys(ids, from, to);
+      return true;
+    }
+
+    // an empty category filter is used to find transactions
+    // without a category and cannot be resolved using the index
+    if (filter.categories(ids) && !ids.isEmpty()) {
+      keys = accountTransactionKeys(ids, from, to);
+      return true;
+    }
+
+    // the same applies to empty payee and tag filters
+    ids.clear();
+    if (filter.payees(ids) && !ids.isEmpty()) {
+      keys = referenceTransactionKeys(ids, from, to);
+      return true;
+    }
+
+    ids.clear();
+    if (filter.tags(ids) && !ids.isEmpty()) {
+      keys = referenceTransactionKeys(ids, from, to);
+      return true;
+    }
+    return false;
+  }
+
+  /**
+    * Calls @a function for each transaction that possibly matches @a filter
+    * in the order of m_transactionList. Only the transactions referencing
+    * one of the accounts, categories, payees or tags of the filter are
+    * visited if it contains such a selection. Otherwise all transactions are visited.
+    * In both cases, a date filter is used to seek directly to the first
+    * transaction in the range and stop after the last one.
+    */
+  template <typename Function>
+  void forEachTransaction(const MyMoneyTransactionFilter& filter, Function function) const
+  {
+    QDate from, to;
+    if (!filter.dateFilter(from, to)) {
+      from = QDate();
+      to = QDate();
+    }
+
+    if (from.isValid() && to.isValid() && from > to)
+      return;
+
+    QStringList keys;
+    if (indexedTransactionKeys(filter, from, to, keys)) {
+      for (const auto& key : keys)
+        function(m_transactionList[key]);
+    } else {
+      QString first, last;
+      dateKeyRange(from, to, first, last);
+      const auto end = last.isEmpty() ? m_transactionList.end() : m_transactionList.lowerBound(last);
+      for (auto it = first.isEmpty() ? m_transactionList.begin() : m_transactionList.lowerBound(first); it != end; ++it)
+        function(*it);
+    }
+  }
+
+  /**
+    * Same as above, but also visits the transactions in @a fetched, which
+    * have been provided by fetchTransactions(const MyMoneyTransactionFilter&)
+    * and are not part of m_transactionList. Both are visited in the
+    * order of their keys.
+    */
+  template <typename Function>
+  void forEachTransaction(const MyMoneyTransactionFilter& filter, const QMap<QString, MyMoneyTransaction>& fetched, Function function) const
+  {
+    if (fetched.isEmpty()) {
+      forEachTransaction(filter, function);
+      return;
+    }
+
+    auto it = fetched.constBegin();
+    forEachTransaction(filter, [&](const MyMoneyTransaction& transaction) {
+      const auto key = transaction.uniqueSortKey();
+      for (; it != fetched.constEnd() && it.key() < key; ++it)
+        function(*it);
+      function(transaction);
+    });
+    for (; it != fetched.constEnd(); ++it)
+      function(*it);
+  }
+
+  /**
+    * Returns the ids of the accounts whose transactions are needed to
+    * process @a filter in @a accountIds. Returns @c false in case all
+    * transactions are needed. See indexedTransactionKeys().
+    */
+  static bool filterAccounts(const MyMoneyTransactionFilter& filter, QStringList& accountIds)
+  {
+    if (filter.accounts(accountIds))
+      return true;
+    return filter.categories(accountIds) && !accountIds.isEmpty();
+  }
+
+  /**
+    * Adds the transactions in @a map which have been loaded from m_source
+    * to m_transactionList and the indexes. Transactions which are already
+    * known or have been removed in the meantime are skipped, as the version
+    * in memory contains the latest changes.
+    */
+  void addLoadedTransactions(const QMap<QString, MyMoneyTransaction>& map)
+  {
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+      const auto& id = (*it).id();
+      if (m_transactionKeys.contains(id) || m_removedTransactions.contains(id))
+        continue;
+      m_transactionList.load(it.key(), *it);
+      m_transactionKeys.load(id, it.key());
+      foreach (const auto accountId, referencedAccounts(*it)) {
+        m_accountTransactions.load(accountTransactionKey(accountId, it.key()), it.key());
+        invalidateBalanceCheckpoints(accountId, (*it).postDate());
+      }
+      foreach (const auto objectId, referencedObjects(*it))
+        m_referenceTransactions.load(accountTransactionKey(objectId, it.key()), it.key());
+    }
+  }
+
+  /**
+    * Drops all transactions referencing the account with @a accountId
+    * from memory. Other accounts referenced by these transactions are
+    * no longer complete and are loaded again when they are needed.
+    */
+  void dropAccountTransactions(const QString& accountId)
+  {
+    m_loadedAccounts.removeOne(accountId);
+    m_transactionListFull = false;
+
+    QStringList keys;
+    for (auto it = accountIndexBegin(accountId); !accountIndexEnd(it, accountId); ++it)
+      keys.append(*it);
+
+    for (const auto& key : keys) {
+      const auto transaction = m_transactionList[key];
+      foreach (const auto id, referencedAccounts(transaction)) {
+        m_accountTransactions.unload(accountTransactionKey(id, key));
+        invalidateBalanceCheckpoints(id, transaction.postDate());
+        m_loadedAccounts.removeOne(id);
+      }
+      foreach (const auto id, referencedObjects(transaction))
+        m_referenceTransactions.unload(accountTransactionKey(id, key));
+      m_transactionKeys.unload(transaction.id());
+      m_transactionList.unload(key);
+    }
+  }
+
+  /**
+    * Drops the transactions of the least recently used accounts until
+    * no more than m_cacheSize transactions are kept in memory. The
+    * transactions of the accounts in @a keep are not dropped. Nothing
+    * is dropped as long as there are changes which have not been saved.
+    */
+  void dropTransactions(const QStringList& keep)
+  {
+    if (m_dirty || m_transactionList.inTransaction())
+      return;
+
+    while (static_cast<uint>(m_transactionList.count()) > m_cacheSize && !m_loadedAccounts.isEmpty()) {
+      const auto accountId = m_loadedAccounts.first();
+      // all remaining accounts have been used more recently
+      if (keep.contains(accountId))
+        break;
+      dropAccountTransactions(accountId);
+    }
+  }
+
+  /**
+    * Makes sure that all transactions referencing one of the accounts in
+    * @a accountIds are kept in memory when they are provided by m_source.
+    * An empty @a accountIds loads all transactions.
+    */
+  void fetchTransactions(const QStringList& accountIds)
+  {
+    if (!m_source)
+      return;
+
+    QStringList missing;
+    for (const auto& accountId : accountIds) {
+      // keep the list ordered by the last use
+      if (m_loadedAccounts.removeOne(accountId))
+        m_loadedAccounts.append(accountId);
+      else
+        missing.append(accountId);
+    }
+
+    if (m_transactionListFull || (!accountIds.isEmpty() && missing.isEmpty()))
+      return;
+
+    // make room before the new transactions are added. The transactions
+    // must be available to the caller, so they cannot be dropped afterwards
+    dropTransactions(accountIds);
+
+    addLoadedTransactions(m_source->fetchAccountTransactions(missing));
+    if (accountIds.isEmpty()) {
+      m_transactionListFull = true;
+      m_loadedAccounts = m_accountList.keys();
+    } else {
+      m_loadedAccounts += missing;
+    }
+  }
+
+  /**
+    * Prepares the transactions needed to process @a filter. If the filter
+    * selects accounts or categories, their transactions are kept in memory
+    * as usual. Otherwise, m_source is asked for the transactions which
+    * possibly match the filter. Those which are not yet in memory are
+    * returned without being added to m_transactionList, so that a search
+    * does not load the whole file. See forEachTransaction().
+    */
+  QMap<QString, MyMoneyTransaction> fetchTransactions(const MyMoneyTransactionFilter& filter)
+  {
+    QMap<QString, MyMoneyTransaction> map;
+    QStringList accountIds;
+    if (filterAccounts(filter, accountIds)) {
+      if (!accountIds.isEmpty())
+        fetchTransactions(accountIds);
+
+    } else if (m_source && !m_transactionListFull) {
+      map = m_source->fetchTransactions(filter);
+      for (auto it = map.begin(); it != map.end();) {
+        const auto& id = (*it).id();
+        if (m_transactionKeys.contains(id) || m_removedTransactions.contains(id))
+          it = map.erase(it);
+        else
+          ++it;
+      }
+    }
+    return map;
+  }
+
+  /**
+    * Makes sure that all accounts referenced by @a transaction are complete.
+    * This must be done before a transaction is changed, so that all accounts
+    * with changes which have not been saved are kept in memory.
+    */
+  void fetchTransactions(const MyMoneyTransaction& transaction)
+  {
+    if (m_source)
+      fetchTransactions(QStringList(referencedAccounts(transaction).toList()));
+  }
+
+  /**
+    * Makes sure that the transaction with @a id is kept in memory when
+    * it is provided by m_source.
+    */
+  void fetchTransaction(const QString& id)
+  {
+    if (!m_source || m_transactionListFull || m_transactionKeys.contains(id) || m_removedTransactions.contains(id))
+      return;
+
+    const auto transaction = m_source->fetchTransaction(id);
+    if (!transaction.id().isEmpty()) {
+      QMap<QString, MyMoneyTransaction> map;
+      map.insert(transaction.uniqueSortKey(), transaction);
+      addLoadedTransactions(map);
+    }
+  }
+
+  /**
+    * Makes sure that the prices from @a fromId to @a toId are kept in
+    * memory when they are provided by m_source. Empty ids load all prices.
+    */
+  void fetchPrices(const QString& fromId = QString(), const QString& toId = QString())
+  {
+    if (!m_source || m_priceListFull)
+      return;
+
+    const MyMoneySecurityPair pair(fromId, toId);
+    const auto all = fromId.isEmpty();
+    if (!all && m_loadedPricePairs.contains(pair))
+      return;
+
+    const auto list = all ? m_source->fetchPrices(QStringList(), QStringList())
+                          : m_source->fetchPrices(QStringList(fromId), QStringList(toId));
+    for (auto it = list.constBegin(); it != list.constEnd(); ++it) {
+      // prices which are already loaded may have been changed in memory
+      if (!m_loadedPricePairs.contains(it.key()))
+        m_priceList.load(it.key(), *it);
+    }
+
+    if (all)
+      m_priceListFull = true;
+    else
+      m_loadedPricePairs.insert(pair);
+  }
+
+  /**
+    * Returns @c true if a transaction in m_source, which has not been
+    * loaded, references the object with @a id. Changes which have not
+    * been saved are unknown to the source, so a reference removed in
+    * memory may still be reported until the data is saved.
+    */
+  bool isReferencedBySource(const QString& id) const
+  {
+    return m_source && !m_transactionListFull && m_source->isReferencedByTransaction(id);
+  }
+
   /**
     * The member variable m_nextAccountID keeps the number that will be
     * assigned to the next institution created. It is maintained by
@@ -515,9 +1230,10 @@ public:
 
   /**
     * The member variable m_accountList is the container for the accounts
-    * known within this file.
+    * known within this file. It is hashed because the accounts are looked
+    * up by id for every split that is processed.
     */
-  MyMoneyMap<QString, MyMoneyAccount> m_accountList;
+  MyMoneyIndexedMap<MyMoneyAccount, QHash<QString, MyMoneyAccount> > m_accountList;
 
   /**
     * The member variable m_transactionList is the container for all
@@ -529,19 +1245,46 @@ public:
   /**
     * The member variable m_transactionKeys is used to convert
     * transaction id's into the corresponding key used in m_transactionList.
+    * It is only used for lookups by id and therefore kept in a hash.
     * @see m_transactionList;
     */
-  MyMoneyMap<QString, QString> m_transactionKeys;
+  MyMoneyMap<QString, QString, QHash<QString, QString> > m_transactionKeys;
 
   /**
-    * A list containing all the payees that have been used
+    * The member variable m_accountTransactions is an index of the
+    * transactions in m_transactionList per referenced account. The key
+    * is built by accountTransactionKey() and the value is the key of the
+    * transaction in m_transactionList.
+    * @see m_transactionList
     */
-  MyMoneyMap<QString, MyMoneyPayee> m_payeeList;
+  MyMoneyMap<QString, QString> m_accountTransactions;
+
+  /**
+    * The member variable m_referenceTransactions is an index of the
+    * transactions in m_transactionList per referenced payee, tag, cost
+    * center and commodity as returned by referencedObjects(). The keys and
+    * values are built the same way as for m_accountTransactions.
+    * @see m_transactionList
+    */
+  MyMoneyMap<QString, QString> m_referenceTransactions;
+
+  /**
+    * The member variable m_balanceCheckpoints keeps the monthly balances
+    * per account id. It is filled on demand by calculateBalance() and
+    * invalidated whenever m_accountTransactions changes.
+    */
+  mutable QHash<QString, MyMoneyBalanceCheckpoints> m_balanceCheckpoints;
+
+  /**
+    * A list containing all the payees that have been used,
+    * hashed by their id
+    */
+  MyMoneyIndexedMap<MyMoneyPayee, QHash<QString, MyMoneyPayee> > m_payeeList;
 
   /**
     * A list containing all the tags that have been used
     */
-  MyMoneyMap<QString, MyMoneyTag> m_tagList;
+  MyMoneyIndexedMap<MyMoneyTag> m_tagList;
 
   /**
     * A list containing all the scheduled transactions
@@ -555,7 +1298,7 @@ public:
     * to determine the cost basis for sales, as well as the source of
     * information for reports in a security account.
     */
-  MyMoneyMap<QString, MyMoneySecurity> m_securitiesList;
+  MyMoneyIndexedMap<MyMoneySecurity> m_securitiesList;
 
   /**
     * A list containing all the currency information objects.
@@ -616,5 +1359,40 @@ public:
     * or after some types of transaction search which cannot be easily implemented in SQL
     */
   bool m_transactionListFull;
+
+  /**
+    * The persistent storage from which transactions and prices
+    * are loaded on demand.
+    * @sa MyMoneyStorageMgr::setSource()
+    */
+  IMyMoneyStorageSource* m_source;
+
+  /**
+    * The number of transactions which are kept in memory at most
+    * if they are provided by m_source. See dropTransactions().
+    */
+  uint m_cacheSize;
+
+  /**
+    * The ids of the accounts for which all transactions have been loaded
+    * from m_source. The least recently used account comes first.
+    */
+  QStringList m_loadedAccounts;
+
+  /**
+    * The security pairs for which the prices have been loaded from m_source
+    */
+  QSet<MyMoneySecurityPair> m_loadedPricePairs;
+
+  /**
+    * This member variable is set when all prices have been loaded from m_source
+    */
+  bool m_priceListFull;
+
+  /**
+    * The ids of the transactions which have been removed but are possibly
+    * still contained in m_source. Only used when m_source is set.
+    */
+  MyMoneyMap<QString, QString, QHash<QString, QString> > m_removedTransactions;
 };
 #endif
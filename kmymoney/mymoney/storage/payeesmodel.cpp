@@ -33,11 +33,25 @@
 
 #include "mymoneyfile.h"
 #include "mymoneypayee.h"
+#include "mymoneychanges.h"
+#include "mymoneyenums.h"
 
 struct PayeesModel::Private
 {
   Private() {}
 
+  /**
+   * Returns the row of the payee with @a id or -1 if it is not found
+   */
+  int row(const QString& id) const
+  {
+    for (auto row = 0; row < m_payeeItems.count(); ++row) {
+      if (m_payeeItems.at(row)->id() == id)
+        return row;
+    }
+    return -1;
+  }
+
   QVector<MyMoneyPayee*>  m_payeeItems;
 };
 
@@ -170,3 +184,45 @@ void PayeesModel::load()
     endInsertRows();
   }
 }
+
+void PayeesModel::slotObjectsChanged(const MyMoneyChanges& changes)
+{
+  if (!changes.contains(eMyMoney::File::Object::Payee))
+    return;
+
+  // the empty entry is only missing if there have been no payees before
+  if (d->m_payeeItems.isEmpty()) {
+    load();
+    return;
+  }
+
+  // the rows are updated one by one, so that views keep their
+  // selection and scroll position
+  const auto file = MyMoneyFile::instance();
+  foreach (const auto id, changes.ids(eMyMoney::File::Mode::Remove, eMyMoney::File::Object::Payee)) {
+    const auto row = d->row(id);
+    if (row != -1) {
+      beginRemoveRows(QModelIndex(), row, row);
+      delete d->m_payeeItems.takeAt(row);
+      endRemoveRows();
+    }
+  }
+
+  foreach (const auto id, changes.ids(eMyMoney::File::Mode::Modify, eMyMoney::File::Object::Payee)) {
+    const auto row = d->row(id);
+    if (row != -1) {
+      *d->m_payeeItems[row] = file->payee(id);
+      const auto idx = index(row, 0);
+      emit dataChanged(idx, idx);
+    }
+  }
+
+  // new payees have the highest ids, so they are appended like load() does
+  const auto added = changes.ids(eMyMoney::File::Mode::Add, eMyMoney::File::Object::Payee);
+  if (!added.isEmpty()) {
+    beginInsertRows(QModelIndex(), rowCount(), rowCount() + added.count() - 1);
+    foreach (const auto id, added)
+      d->m_payeeItems.append(new MyMoneyPayee(file->payee(id)));
+    endInsertRows();
+  }
+}
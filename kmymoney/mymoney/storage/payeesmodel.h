@@ -31,6 +31,8 @@
 
 #include "kmm_mymoney_export.h"
 
+class MyMoneyChanges;
+
 /**
   */
 class KMM_MYMONEY_EXPORT PayeesModel : public QAbstractListModel
@@ -64,6 +66,10 @@ public:
   void load();
 
 public Q_SLOTS:
+  /**
+   * Adds, updates and removes the rows of the payees in @a changes
+   */
+  void slotObjectsChanged(const MyMoneyChanges& changes);
 
 private:
   struct Private;
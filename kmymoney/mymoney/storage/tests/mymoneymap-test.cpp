@@ -90,3 +90,201 @@ void MyMoneyMapTest::testModifyKeyTwice()
   m->rollbackTransaction();
   QVERIFY((*m)["a"] == "a");
 }
+
+void MyMoneyMapTest::testHashContainer()
+{
+  MyMoneyMap<QString, QString, QHash<QString, QString> > h;
+
+  h.startTransaction();
+  h.insert("a", "a");
+  h.insert("b", "b");
+  h.commitTransaction();
+  QVERIFY(h.count() == 2);
+  QVERIFY(h["a"] == "a");
+  QVERIFY(h.contains("b"));
+  QVERIFY(!h.contains("c"));
+
+  h.startTransaction();
+  h.modify("a", "c");
+  h.insert("c", "c");
+  QVERIFY(h["a"] == "c");
+  QVERIFY(h.count() == 3);
+  h.rollbackTransaction();
+  QVERIFY(h["a"] == "a");
+  QVERIFY(h.count() == 2);
+  QVERIFY(!h.contains("c"));
+}
+
+static QStringList valueKeys(const QString& value)
+{
+  return QStringList(value);
+}
+
+void MyMoneyMapTest::testHashedIndexedMap()
+{
+  MyMoneyIndexedMap<QString, QHash<QString, QString> > h;
+  h.addIndex(valueKeys);
+
+  QMap<QString, QString> map;
+  map["c"] = "x";
+  map["a"] = "x";
+  map["b"] = "y";
+  h = map;
+
+  // ordered by id although kept in a hash
+  QCOMPARE(h.keys(), QStringList({"a", "b", "c"}));
+  QCOMPARE(h.values(), QList<QString>({"x", "y", "x"}));
+  QCOMPARE(h.ids(0, "x"), QStringList({"a", "c"}));
+
+  h.startTransaction();
+  h.modify("b", "x");
+  h.remove("a");
+  QCOMPARE(h.ids(0, "x"), QStringList({"b", "c"}));
+  QVERIFY(h.ids(0, "y").isEmpty());
+  QCOMPARE(h.keys(), QStringList({"b", "c"}));
+  QCOMPARE(h.values(), QList<QString>({"x", "x"}));
+  h.rollbackTransaction();
+  QCOMPARE(h.keys(), QStringList({"a", "b", "c"}));
+  QCOMPARE(h.values(), QList<QString>({"x", "y", "x"}));
+  QCOMPARE(h.ids(0, "x"), QStringList({"a", "c"}));
+  QCOMPARE(h.ids(0, "y"), QStringList({"b"}));
+
+  // the ordered lists follow each change
+  h.startTransaction();
+  h.insert("0", "z");
+  QCOMPARE(h.keys(), QStringList({"0", "a", "b", "c"}));
+  h.modify("0", "w");
+  QCOMPARE(h.values(), QList<QString>({"w", "x", "y", "x"}));
+  h.commitTransaction();
+  h.unload("b");
+  QCOMPARE(h.keys(), QStringList({"0", "a", "c"}));
+  h.load("d", "v");
+  QCOMPARE(h.keys(), QStringList({"0", "a", "c", "d"}));
+  QCOMPARE(h.values(), QList<QString>({"w", "x", "x", "v"}));
+}
+
+void MyMoneyMapTest::testRemoveKey()
+{
+  m->startTransaction();
+  m->insert("a", "a");
+  m->insert("b", "b");
+  m->commitTransaction();
+
+  // rollback
+  m->startTransaction();
+  m->remove("a");
+  QVERIFY(!m->contains("a"));
+  m->rollbackTransaction();
+  QVERIFY(m->count() == 2);
+  QVERIFY((*m)["a"] == "a");
+
+  // modify and remove the same key
+  m->startTransaction();
+  m->modify("a", "c");
+  m->remove("a");
+  m->insert("a", "d");
+  QVERIFY((*m)["a"] == "d");
+  m->rollbackTransaction();
+  QVERIFY((*m)["a"] == "a");
+
+  // commit
+  m->startTransaction();
+  m->remove("b");
+  QVERIFY(m->commitTransaction());
+  QVERIFY(m->count() == 1);
+  QVERIFY(!m->contains("b"));
+
+  // a transaction without changes
+  m->startTransaction();
+  QVERIFY(!m->commitTransaction());
+}
+
+void MyMoneyMapTest::testPairKey()
+{
+  typedef QPair<QString, QString> Pair;
+  MyMoneyMap<Pair, QString> p;
+
+  p.startTransaction();
+  p.insert(qMakePair(QString("EUR"), QString("USD")), "1.1");
+  p.insert(qMakePair(QString("USD"), QString("EUR")), "0.9");
+  p.commitTransaction();
+
+  p.startTransaction();
+  p.modify(qMakePair(QString("EUR"), QString("USD")), "1.2");
+  p.modify(qMakePair(QString("EUR"), QString("USD")), "1.3");
+  p.remove(qMakePair(QString("USD"), QString("EUR")));
+  p.insert(qMakePair(QString("EUR"), QString("GBP")), "0.8");
+  QVERIFY(p.count() == 2);
+  p.rollbackTransaction();
+
+  QVERIFY(p.count() == 2);
+  QVERIFY(p[qMakePair(QString("EUR"), QString("USD"))] == "1.1");
+  QVERIFY(p[qMakePair(QString("USD"), QString("EUR"))] == "0.9");
+  QVERIFY(!p.contains(qMakePair(QString("EUR"), QString("GBP"))));
+}
+
+void MyMoneyMapTest::testTransactionId()
+{
+  unsigned long id = 5;
+
+  m->startTransaction(&id);
+  m->insert("a", "a");
+  id = 6;
+  // a nested start must not overwrite the state to return to
+  m->startTransaction(&id);
+  id = 7;
+  m->rollbackTransaction();
+  QVERIFY(id == 5);
+  QVERIFY(m->count() == 0);
+  QVERIFY(!m->inTransaction());
+
+  m->startTransaction(&id);
+  m->insert("a", "a");
+  id = 6;
+  m->commitTransaction();
+  QVERIFY(id == 6);
+
+  try {
+    m->rollbackTransaction();
+    QFAIL("Missing expected exception");
+  } catch (const MyMoneyException &) {
+  }
+}
+
+void MyMoneyMapTest::testBulkModify_data()
+{
+  QTest::addColumn<int>("count");
+
+  QTest::newRow("10000 keys") << 10000;
+  QTest::newRow("20000 keys") << 20000;
+  QTest::newRow("40000 keys") << 40000;
+}
+
+void MyMoneyMapTest::testBulkModify()
+{
+  // the time needed for a transaction must grow linearly
+  // with the number of changes it contains
+  QFETCH(int, count);
+
+  QStringList keys;
+  keys.reserve(count);
+  m->startTransaction();
+  for (auto i = 0; i < count; ++i) {
+    keys << QString::fromLatin1("T%1").arg(i, 18, 10, QLatin1Char('0'));
+    m->insert(keys.last(), "a");
+  }
+  m->commitTransaction();
+
+  QBENCHMARK {
+    m->startTransaction();
+    foreach (const auto& key, keys)
+      m->modify(key, "b");
+    foreach (const auto& key, keys)
+      m->modify(key, "c");
+    m->rollbackTransaction();
+  }
+
+  QVERIFY(m->count() == count);
+  QVERIFY((*m)[keys.first()] == "a");
+  QVERIFY((*m)[keys.last()] == "a");
+}
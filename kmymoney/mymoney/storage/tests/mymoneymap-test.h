@@ -24,6 +24,7 @@
 
 #include "mymoneystoragemgr.h"
 #include "mymoneymap.h"
+#include "mymoneyindexedmap.h"
 
 class MyMoneyMapTest : public QObject
 {
@@ -37,6 +38,13 @@ private Q_SLOTS:
   void testArrayOperator();
   void testModifyKey();
   void testModifyKeyTwice();
+  void testHashContainer();
+  void testHashedIndexedMap();
+  void testRemoveKey();
+  void testPairKey();
+  void testTransactionId();
+  void testBulkModify_data();
+  void testBulkModify();
 };
 
 #endif
@@ -18,9 +18,11 @@
 #include "mymoneystoragemgr-test.h"
 #include <iostream>
 #include <QList>
+#include <QBitArray>
 #include <QtTest>
 
 #include "mymoneystoragemgr_p.h"
+#include "imymoneystoragesource.h"
 
 #include "mymoneytestutils.h"
 #include "mymoneymoney.h"
@@ -48,6 +50,102 @@ using namespace eMyMoney;
 
 QTEST_GUILESS_MAIN(MyMoneyStorageMgrTest)
 
+/**
+  * Returns a map of @a count transactions suitable for loadTransactions(),
+  * one per day starting at @a start. The transactions alternate
+  * between the standard asset and liability account.
+  */
+static QMap<QString, MyMoneyTransaction> dailyTransactions(int count, const QDate& start)
+{
+  QMap<QString, MyMoneyTransaction> map;
+  for (auto i = 0; i < count; ++i) {
+    MyMoneyTransaction t;
+    MyMoneySplit s;
+    s.setAccountId(MyMoneyAccount::stdAccName((i % 2) ? eMyMoney::Account::Standard::Liability : eMyMoney::Account::Standard::Asset));
+    s.setShares(MyMoneyMoney(100, 100));
+    s.setValue(MyMoneyMoney(100, 100));
+    t.addSplit(s);
+    t.setPostDate(start.addDays(i));
+    MyMoneyTransaction transaction(QString::fromLatin1("T%1").arg(i + 1, 18, 10, QLatin1Char('0')), t);
+    map[transaction.uniqueSortKey()] = transaction;
+  }
+  return map;
+}
+
+/**
+  * A storage source which provides a fixed set of transactions
+  * and keeps track of the accounts which have been requested.
+  */
+class TestStorageSource : public IMyMoneyStorageSource
+{
+public:
+  explicit TestStorageSource(const QMap<QString, MyMoneyTransaction>& transactions) :
+    m_transactions(transactions)
+  {
+  }
+
+  QMap<QString, MyMoneyTransaction> fetchAccountTransactions(const QStringList& accountIds) const override
+  {
+    m_requests.append(accountIds);
+    QMap<QString, MyMoneyTransaction> map;
+    for (auto it = m_transactions.constBegin(); it != m_transactions.constEnd(); ++it) {
+      foreach (const auto split, (*it).splits()) {
+        if (accountIds.isEmpty() || accountIds.contains(split.accountId())) {
+          map.insert(it.key(), *it);
+          break;
+        }
+      }
+    }
+    return map;
+  }
+
+  QMap<QString, MyMoneyTransaction> fetchTransactions(const MyMoneyTransactionFilter& filter) const override
+  {
+    ++m_filterRequests;
+    QMap<QString, MyMoneyTransaction> map;
+    QDate from, to;
+    filter.dateFilter(from, to);
+    for (auto it = m_transactions.constBegin(); it != m_transactions.constEnd(); ++it) {
+      if ((!from.isValid() || (*it).postDate() >= from) && (!to.isValid() || (*it).postDate() <= to))
+        map.insert(it.key(), *it);
+    }
+    return map;
+  }
+
+  MyMoneyTransaction fetchTransaction(const QString& id) const override
+  {
+    foreach (const auto transaction, m_transactions) {
+      if (transaction.id() == id)
+        return transaction;
+    }
+    return MyMoneyTransaction();
+  }
+
+  MyMoneyPriceList fetchPrices(const QStringList&, const QStringList&, bool) const override
+  {
+    return MyMoneyPriceList();
+  }
+
+  bool isReferencedByTransaction(const QString&) const override
+  {
+    return false;
+  }
+
+  ulong lastTransactionId() const override
+  {
+    return m_transactions.count();
+  }
+
+  IMyMoneyStorageSource* readOnlyCopy() const override
+  {
+    return new TestStorageSource(m_transactions);
+  }
+
+  QMap<QString, MyMoneyTransaction> m_transactions;
+  mutable QList<QStringList> m_requests;
+  mutable int m_filterRequests = 0;
+};
+
 void MyMoneyStorageMgrTest::init()
 {
   m = new MyMoneyStorageMgr;
@@ -598,20 +696,16 @@ void MyMoneyStorageMgrTest::testAddTransactions()
     QCOMPARE(t2.splitCount(), 4u);
     QCOMPARE(m->transactionCount(QString()), 2u);
 
-    QMap<QString, QString>::ConstIterator it_k;
     QMap<QString, MyMoneyTransaction>::ConstIterator it_t;
-    it_k = m->d_func()->m_transactionKeys.begin();
     it_t = m->d_func()->m_transactionList.begin();
 
-    QCOMPARE((*it_k), QLatin1String("2002-05-10-T000000000000000001"));
+    QCOMPARE(m->d_func()->m_transactionKeys.count(), 2);
+    QCOMPARE(m->d_func()->m_transactionKeys["T000000000000000001"], QLatin1String("2002-05-10-T000000000000000001"));
+    QCOMPARE(m->d_func()->m_transactionKeys["T000000000000000002"], QLatin1String("2002-05-09-T000000000000000002"));
     QCOMPARE((*it_t).id(), QLatin1String("T000000000000000002"));
-    ++it_k;
     ++it_t;
-    QCOMPARE((*it_k), QLatin1String("2002-05-09-T000000000000000002"));
     QCOMPARE((*it_t).id(), QLatin1String("T000000000000000001"));
-    ++it_k;
     ++it_t;
-    QCOMPARE(it_k, m->d_func()->m_transactionKeys.end());
     QCOMPARE(it_t, m->d_func()->m_transactionList.end());
 
     ch = m->account("A000006");
@@ -658,6 +752,65 @@ void MyMoneyStorageMgrTest::testBalance()
   QCOMPARE(m->balance("A000006", QDate(2002, 5, 10)),  MyMoneyMoney(88400, 100));
 }
 
+void MyMoneyStorageMgrTest::testBalanceCheckpoints()
+{
+  testAddTransactions();
+
+  // fill the checkpoints
+  QCOMPARE(m->balance("A000006", QDate(2002, 5, 9)),  MyMoneyMoney(-11600, 100));
+  QCOMPARE(m->balance("A000006", QDate(2002, 6, 1)),  MyMoneyMoney(88400, 100));
+  QCOMPARE(m->d_func()->m_balanceCheckpoints["A000006"].complete, true);
+  QCOMPARE(m->d_func()->m_balanceCheckpoints["A000006"].checkpoints.count(), 1);
+
+  // add a transaction in an earlier month
+  MyMoneyTransaction t;
+  MyMoneySplit s;
+  s.setAccountId("A000006");
+  s.setShares(MyMoneyMoney(5000, 100));
+  s.setValue(MyMoneyMoney(5000, 100));
+  t.addSplit(s);
+  s.d_func()->setId(QString());
+  s.setAccountId("A000005");
+  s.setShares(MyMoneyMoney(-5000, 100));
+  s.setValue(MyMoneyMoney(-5000, 100));
+  t.addSplit(s);
+  t.setPostDate(QDate(2002, 4, 15));
+  m->addTransaction(t);
+
+  QCOMPARE(m->d_func()->m_balanceCheckpoints["A000006"].complete, false);
+  QCOMPARE(m->balance("A000006", QDate(2002, 4, 14)),  MyMoneyMoney());
+  QCOMPARE(m->balance("A000006", QDate(2002, 4, 15)),  MyMoneyMoney(5000, 100));
+  QCOMPARE(m->balance("A000006", QDate(2002, 5, 9)),  MyMoneyMoney(-6600, 100));
+  QCOMPARE(m->balance("A000006", QDate(2002, 6, 1)),  MyMoneyMoney(93400, 100));
+  QCOMPARE(m->d_func()->m_balanceCheckpoints["A000006"].checkpoints.count(), 2);
+  QCOMPARE(m->d_func()->m_balanceCheckpoints["A000006"].checkpoints[QDate(2002, 5, 1)], MyMoneyMoney(5000, 100));
+
+  // a stock split multiplies the balance
+  MyMoneyTransaction split;
+  s.d_func()->setId(QString());
+  s.setAccountId("A000006");
+  s.setAction(MyMoneySplit::actionName(eMyMoney::Split::Action::SplitShares));
+  s.setShares(MyMoneyMoney(2, 1));
+  s.setValue(MyMoneyMoney());
+  split.addSplit(s);
+  split.setPostDate(QDate(2002, 7, 1));
+  m->addTransaction(split);
+  QCOMPARE(m->balance("A000006", QDate(2002, 6, 30)),  MyMoneyMoney(93400, 100));
+  QCOMPARE(m->balance("A000006", QDate(2002, 7, 1)),  MyMoneyMoney(186800, 100));
+
+  // removing a transaction updates the balances after its post date
+  m->removeTransaction(t);
+  QCOMPARE(m->balance("A000006", QDate(2002, 4, 15)),  MyMoneyMoney());
+  QCOMPARE(m->balance("A000006", QDate(2002, 6, 30)),  MyMoneyMoney(88400, 100));
+  QCOMPARE(m->balance("A000006", QDate(2002, 7, 1)),  MyMoneyMoney(176800, 100));
+
+  // a rollback drops all checkpoints
+  m->rollbackTransaction();
+  m->startTransaction();
+  QVERIFY(m->d_func()->m_balanceCheckpoints.isEmpty());
+  QCOMPARE(m->balance("A000006", QDate(2002, 7, 1)),  MyMoneyMoney(88400, 100));
+}
+
 void MyMoneyStorageMgrTest::testModifyTransaction()
 {
   testAddTransactions();
@@ -700,19 +853,16 @@ void MyMoneyStorageMgrTest::testModifyTransaction()
     QCOMPARE(m->balance("A000006", QDate()),  MyMoneyMoney(100000 - 12600, 100));
     QCOMPARE(m->totalBalance("A000001", QDate()),  MyMoneyMoney(1600, 100));
 
-    QMap<QString, QString>::ConstIterator it_k;
     QMap<QString, MyMoneyTransaction>::ConstIterator it_t;
-    it_k = m->d_func()->m_transactionKeys.begin();
     it_t = m->d_func()->m_transactionList.begin();
-    QCOMPARE((*it_k), QLatin1String("2002-05-10-T000000000000000001"));
+
+    QCOMPARE(m->d_func()->m_transactionKeys.count(), 2);
+    QCOMPARE(m->d_func()->m_transactionKeys["T000000000000000001"], QLatin1String("2002-05-10-T000000000000000001"));
+    QCOMPARE(m->d_func()->m_transactionKeys["T000000000000000002"], QLatin1String("2002-05-11-T000000000000000002"));
     QCOMPARE((*it_t).id(), QLatin1String("T000000000000000001"));
-    ++it_k;
     ++it_t;
-    QCOMPARE((*it_k), QLatin1String("2002-05-11-T000000000000000002"));
     QCOMPARE((*it_t).id(), QLatin1String("T000000000000000002"));
-    ++it_k;
     ++it_t;
-    QCOMPARE(it_k, m->d_func()->m_transactionKeys.end());
     QCOMPARE(it_t, m->d_func()->m_transactionList.end());
 
     ch = m->account("A000006");
@@ -890,6 +1040,277 @@ void MyMoneyStorageMgrTest::testTransactionList()
   QCOMPARE(list.at(1).id(), QLatin1String("T000000000000000001"));
 }
 
+void MyMoneyStorageMgrTest::testForEachTransactionSplit()
+{
+  testAddTransactions();
+
+  // the splits are visited in the same order as transactionList() returns them
+  foreach (const auto accountId, QStringList() << QString() << QStringLiteral("A000006")) {
+    MyMoneyTransactionFilter filter;
+    if (!accountId.isEmpty())
+      filter.addAccount(accountId);
+
+    QList<QPair<MyMoneyTransaction, MyMoneySplit> > expected;
+    m->transactionList(expected, filter);
+
+    QStringList ids;
+    m->forEachTransactionSplit(filter, [&](const MyMoneyTransaction& transaction, const MyMoneySplit& split) {
+      ids << QString::fromLatin1("%1-%2").arg(transaction.id(), split.id());
+    });
+
+    QCOMPARE(ids.count(), expected.count());
+    for (auto i = 0; i < ids.count(); ++i)
+      QCOMPARE(ids.at(i), QString::fromLatin1("%1-%2").arg(expected.at(i).first.id(), expected.at(i).second.id()));
+  }
+}
+
+void MyMoneyStorageMgrTest::testAccountTransactionIndex()
+{
+  testAddTransactions();
+
+  // each referenced account has one entry per transaction
+  QCOMPARE(m->d_func()->m_accountTransactions.count(), 6);
+  QCOMPARE(m->d_func()->m_accountTransactions.keys().first(), QLatin1String("A000002|2002-05-09-T000000000000000002"));
+  QCOMPARE(m->hasActiveSplits("A000001"), false);
+  QCOMPARE(m->hasActiveSplits("A000006"), true);
+
+  // changing the date of a transaction moves the entries
+  MyMoneyTransaction t = m->transaction("T000000000000000002");
+  t.setPostDate(QDate(2002, 5, 11));
+  m->modifyTransaction(t);
+  QCOMPARE(m->d_func()->m_accountTransactions.count(), 6);
+  QVERIFY(m->d_func()->m_accountTransactions.contains(QLatin1String("A000006|2002-05-11-T000000000000000002")));
+  QVERIFY(!m->d_func()->m_accountTransactions.contains(QLatin1String("A000006|2002-05-09-T000000000000000002")));
+
+  MyMoneyTransactionFilter filter("A000006");
+  QList<MyMoneyTransaction> list = m->transactionList(filter);
+  QCOMPARE(list.count(), 2);
+  QCOMPARE(list.at(0).id(), QLatin1String("T000000000000000001"));
+  QCOMPARE(list.at(1).id(), QLatin1String("T000000000000000002"));
+
+  // a category filter uses the index as well
+  filter.clear();
+  filter.addCategory(QLatin1String("A000005"));
+  list = m->transactionList(filter);
+  QCOMPARE(list.count(), 1);
+  QCOMPARE(list.at(0).id(), QLatin1String("T000000000000000001"));
+  m->commitTransaction();
+  m->startTransaction();
+
+  // a rollback also restores the index
+  MyMoneyTransaction t3;
+  MyMoneySplit s;
+  s.setAccountId("A000006");
+  s.setShares(MyMoneyMoney(100, 100));
+  s.setValue(MyMoneyMoney(100, 100));
+  t3.addSplit(s);
+  s.d_func()->setId(QString());
+  s.setAccountId("A000001");
+  s.setShares(MyMoneyMoney(-100, 100));
+  s.setValue(MyMoneyMoney(-100, 100));
+  t3.addSplit(s);
+  t3.setPostDate(QDate(2002, 5, 12));
+  m->addTransaction(t3);
+  QCOMPARE(m->d_func()->m_accountTransactions.count(), 8);
+  QCOMPARE(m->transactionCount("A000001"), 1u);
+  m->rollbackTransaction();
+  m->startTransaction();
+  QCOMPARE(m->d_func()->m_accountTransactions.count(), 6);
+  QCOMPARE(m->transactionCount("A000001"), 0u);
+  QCOMPARE(m->transactionCount("A000006"), 2u);
+
+  // removing a transaction removes all of its entries
+  m->removeTransaction(t);
+  QCOMPARE(m->d_func()->m_accountTransactions.count(), 2);
+  QCOMPARE(m->transactionCount("A000006"), 1u);
+  QCOMPARE(m->hasActiveSplits("A000004"), false);
+}
+
+void MyMoneyStorageMgrTest::testReferenceTransactionIndex()
+{
+  testAddTransactions();
+  testAddPayee();
+  testAddTag();
+
+  QBitArray skipCheck((int)eStorage::Reference::Count);
+  const auto payee = m->payee("P000001");
+  const auto tag = m->tag("G000001");
+  QCOMPARE(m->isReferenced(payee, skipCheck), false);
+  QCOMPARE(m->isReferenced(tag, skipCheck), false);
+
+  // a payee and a tag used in a split are added to the index
+  MyMoneyTransaction t = m->transaction("T000000000000000001");
+  MyMoneySplit s = t.splits()[0];
+  s.setPayeeId(payee.id());
+  s.setTagIdList(QList<QString>() << tag.id());
+  t.modifySplit(s);
+  m->modifyTransaction(t);
+  QVERIFY(m->d_func()->m_referenceTransactions.contains(QLatin1String("P000001|") + t.uniqueSortKey()));
+  QVERIFY(m->d_func()->m_referenceTransactions.contains(QLatin1String("G000001|") + t.uniqueSortKey()));
+  QCOMPARE(m->isReferenced(payee, skipCheck), true);
+  QCOMPARE(m->isReferenced(tag, skipCheck), true);
+
+  // the reference is ignored when transactions are skipped
+  skipCheck.setBit((int)eStorage::Reference::Transaction);
+  QCOMPARE(m->isReferenced(payee, skipCheck), false);
+  skipCheck.clearBit((int)eStorage::Reference::Transaction);
+
+  // payee and tag filters use the index
+  MyMoneyTransactionFilter filter;
+  filter.addPayee(payee.id());
+  auto visited = 0;
+  m->d_func()->forEachTransaction(filter, [&](const MyMoneyTransaction&) { ++visited; });
+  QCOMPARE(visited, 1);
+  QList<MyMoneyTransaction> list = m->transactionList(filter);
+  QCOMPARE(list.count(), 1);
+  QCOMPARE(list.at(0).id(), t.id());
+
+  filter.clear();
+  filter.addTag(tag.id());
+  list = m->transactionList(filter);
+  QCOMPARE(list.count(), 1);
+  QCOMPARE(list.at(0).id(), t.id());
+  m->commitTransaction();
+  m->startTransaction();
+
+  // a rollback also restores the index
+  s.setPayeeId(QString());
+  s.setTagIdList(QList<QString>());
+  t.modifySplit(s);
+  m->modifyTransaction(t);
+  QCOMPARE(m->isReferenced(payee, skipCheck), false);
+  m->rollbackTransaction();
+  m->startTransaction();
+  QCOMPARE(m->isReferenced(payee, skipCheck), true);
+
+  // a referenced payee or tag cannot be removed
+  try {
+    m->removePayee(payee);
+    QFAIL("Expected exception");
+  } catch (const MyMoneyException &) {
+  }
+  try {
+    m->removeTag(tag);
+    QFAIL("Expected exception");
+  } catch (const MyMoneyException &) {
+  }
+
+  // removing the transaction removes its entries
+  m->removeTransaction(m->transaction(t.id()));
+  QCOMPARE(m->isReferenced(payee, skipCheck), false);
+  QCOMPARE(m->isReferenced(tag, skipCheck), false);
+  m->removePayee(payee);
+  m->removeTag(tag);
+}
+
+void MyMoneyStorageMgrTest::testTransactionListDateRange()
+{
+  // we don't need the transaction started by setup() here
+  m->rollbackTransaction();
+
+  const QDate start(2000, 1, 1);
+  m->loadTransactions(dailyTransactions(1000, start));
+
+  auto visited = 0;
+  auto countVisited = [&](const MyMoneyTransaction&) { ++visited; };
+
+  // closed range
+  MyMoneyTransactionFilter filter;
+  filter.setDateFilter(QDate(2001, 1, 1), QDate(2001, 1, 30));
+  m->d_func()->forEachTransaction(filter, countVisited);
+  QCOMPARE(visited, 30);
+  QList<MyMoneyTransaction> list = m->transactionList(filter);
+  QCOMPARE(list.count(), 30);
+  QCOMPARE(list.first().postDate(), QDate(2001, 1, 1));
+  QCOMPARE(list.last().postDate(), QDate(2001, 1, 30));
+
+  // open start
+  visited = 0;
+  filter.setDateFilter(QDate(), start.addDays(9));
+  m->d_func()->forEachTransaction(filter, countVisited);
+  QCOMPARE(visited, 10);
+  QCOMPARE(m->transactionList(filter).count(), 10);
+
+  // open end
+  visited = 0;
+  filter.setDateFilter(start.addDays(990), QDate());
+  m->d_func()->forEachTransaction(filter, countVisited);
+  QCOMPARE(visited, 10);
+  QCOMPARE(m->transactionList(filter).count(), 10);
+
+  // empty range
+  visited = 0;
+  filter.setDateFilter(QDate(2001, 1, 30), QDate(2001, 1, 1));
+  m->d_func()->forEachTransaction(filter, countVisited);
+  QCOMPARE(visited, 0);
+
+  // the per account index is also limited to the range.
+  // 2001-01-01 is an even day which is assigned to the
+  // asset account, so the liability account has every
+  // other day starting at 2001-01-02
+  visited = 0;
+  filter.clear();
+  filter.addAccount(MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Liability));
+  filter.setDateFilter(QDate(2001, 1, 1), QDate(2001, 1, 30));
+  m->d_func()->forEachTransaction(filter, countVisited);
+  QCOMPARE(visited, 15);
+  list = m->transactionList(filter);
+  QCOMPARE(list.count(), 15);
+  QCOMPARE(list.first().postDate(), QDate(2001, 1, 2));
+  QCOMPARE(list.last().postDate(), QDate(2001, 1, 30));
+
+  // restart a transaction so that teardown() is happy
+  m->startTransaction();
+}
+
+void MyMoneyStorageMgrTest::benchmarkTransactionListDateRange_data()
+{
+  QTest::addColumn<int>("count");
+  QTest::addColumn<bool>("seek");
+
+  QTest::newRow("full scan 5000") << 5000 << false;
+  QTest::newRow("seek 5000") << 5000 << true;
+  QTest::newRow("full scan 50000") << 50000 << false;
+  QTest::newRow("seek 50000") << 50000 << true;
+}
+
+void MyMoneyStorageMgrTest::benchmarkTransactionListDateRange()
+{
+  QFETCH(int, count);
+  QFETCH(bool, seek);
+
+  // we don't need the transaction started by setup() here
+  m->rollbackTransaction();
+
+  const QDate start(1900, 1, 1);
+  m->loadTransactions(dailyTransactions(count, start));
+
+  // query the last 30 days
+  MyMoneyTransactionFilter filter;
+  filter.setDateFilter(start.addDays(count - 30), start.addDays(count - 1));
+
+  QList<MyMoneyTransaction> list;
+  if (seek) {
+    QBENCHMARK {
+      list = m->transactionList(filter);
+    }
+  } else {
+    // this is how transactionList() used to scan all transactions
+    QBENCHMARK {
+      list.clear();
+      for (const auto& transaction : m->d_func()->m_transactionList) {
+        const auto cnt = filter.matchingSplitsCount(transaction);
+        for (uint i = 0; i < cnt; ++i)
+          list.append(transaction);
+      }
+    }
+  }
+  QCOMPARE(list.count(), 30);
+
+  // restart a transaction so that teardown() is happy
+  m->startTransaction();
+}
+
 void MyMoneyStorageMgrTest::testAddPayee()
 {
   MyMoneyPayee p;
@@ -1216,6 +1637,68 @@ void MyMoneyStorageMgrTest::testTagName()
   }
 }
 
+void MyMoneyStorageMgrTest::testNameIndexes()
+{
+  testAddPayee();
+
+  // the standard accounts are part of the index
+  QCOMPARE(m->accountByName("asset", Qt::CaseInsensitive).id(), MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Asset));
+
+  MyMoneyPayee p = m->payeeByName("thb", Qt::CaseInsensitive);
+  QCOMPARE(p.id(), QLatin1String("P000001"));
+
+  // a renamed payee is only found by its new name
+  p.setName("Another Payee");
+  m->modifyPayee(p);
+  QCOMPARE(m->payeeByName("ANOTHER PAYEE", Qt::CaseInsensitive).id(), p.id());
+  try {
+    m->payeeByName("THB");
+    QFAIL("Exception expected");
+  } catch (const MyMoneyException &) {
+  }
+
+  // a rollback also restores the index
+  m->rollbackTransaction();
+  m->startTransaction();
+  QCOMPARE(m->payeeByName("THB").id(), p.id());
+  try {
+    m->payeeByName("Another Payee");
+    QFAIL("Exception expected");
+  } catch (const MyMoneyException &) {
+  }
+
+  // accounts sharing a name or number are returned in the order of their ids
+  MyMoneyAccount a;
+  a.setName("Checking");
+  a.setNumber("1234");
+  m->addAccount(a);
+  MyMoneyAccount b;
+  b.setName("Checking");
+  b.setValue("StatementKey", "1234");
+  m->addAccount(b);
+  QCOMPARE(m->accountByName("Checking").id(), a.id());
+  QList<MyMoneyAccount> accounts = m->accountsByNumber("1234");
+  QCOMPARE(accounts.count(), 2);
+  QCOMPARE(accounts.at(0).id(), a.id());
+  QCOMPARE(accounts.at(1).id(), b.id());
+
+  a.setNumber("5678");
+  m->modifyAccount(a);
+  QCOMPARE(m->accountsByNumber("1234").count(), 1);
+  QCOMPARE(m->accountsByNumber("5678").count(), 1);
+
+  // securities are found by symbol ignoring the case
+  MyMoneySecurity s;
+  s.setName("Some Stock");
+  s.setTradingSymbol("STK");
+  m->addSecurity(s);
+  QCOMPARE(m->securitiesBySymbol("stk").count(), 1);
+  QCOMPARE(m->securitiesByName("some stock", Qt::CaseInsensitive).count(), 1);
+  QVERIFY(m->securitiesByName("some stock").isEmpty());
+  m->removeSecurity(s);
+  QVERIFY(m->securitiesBySymbol("STK").isEmpty());
+}
+
 // disabled because of no real world use case
 //void MyMoneyStorageMgrTest::testAssignment()
 //{
@@ -1256,8 +1739,9 @@ void MyMoneyStorageMgrTest::testEquality(const MyMoneyStorageMgr *t)
   QCOMPARE(m->d_func()->m_payeeList.values(), t->d_func()->m_payeeList.values());
   QCOMPARE(m->d_func()->m_tagList.keys(), t->d_func()->m_tagList.keys());
   QCOMPARE(m->d_func()->m_tagList.values(), t->d_func()->m_tagList.values());
-  QCOMPARE(m->d_func()->m_transactionKeys.keys(), t->d_func()->m_transactionKeys.keys());
-  QCOMPARE(m->d_func()->m_transactionKeys.values(), t->d_func()->m_transactionKeys.values());
+  QCOMPARE(m->d_func()->m_transactionKeys.count(), t->d_func()->m_transactionKeys.count());
+  foreach (const auto id, m->d_func()->m_transactionKeys.keys())
+    QCOMPARE(m->d_func()->m_transactionKeys[id], t->d_func()->m_transactionKeys[id]);
   QCOMPARE(m->d_func()->m_institutionList.keys(), t->d_func()->m_institutionList.keys());
   QCOMPARE(m->d_func()->m_institutionList.values(), t->d_func()->m_institutionList.values());
   QCOMPARE(m->d_func()->m_accountList.keys(), t->d_func()->m_accountList.keys());
@@ -1767,6 +2251,7 @@ void MyMoneyStorageMgrTest::testLoaderFunctions()
   QCOMPARE(m->d_func()->m_transactionList.values(), tmap.values());
   QCOMPARE(m->d_func()->m_transactionList.keys(), tmap.keys());
   QCOMPARE(m->d_func()->m_nextTransactionID, 108ul);
+  QCOMPARE(m->d_func()->m_accountTransactions.count(), 0);
 
   // institution loader
   QMap<QString, MyMoneyInstitution> imap;
@@ -1852,3 +2337,182 @@ void MyMoneyStorageMgrTest::testAddOnlineJob()
   QVERIFY(! m->d_func()->m_onlineJobList["O000001"].isNull());
 
 }
+
+void MyMoneyStorageMgrTest::testSnapshot()
+{
+  testAddTransactions();
+
+  // init() leaves a transaction open
+  try {
+    delete m->snapshot();
+    QFAIL("Missing expected exception");
+  } catch (const MyMoneyException &) {
+  }
+  m->commitTransaction();
+
+  m->setValue("key", "value");
+  const auto t = m->transaction("T000000000000000001");
+  const auto count = m->transactionCount(QString());
+  const auto balance = m->balance("A000006", QDate());
+
+  QScopedPointer<MyMoneyStorageMgr> snapshot(m->snapshot());
+  QCOMPARE(snapshot->transactionCount(QString()), count);
+  QVERIFY(snapshot->transaction(t.id()) == t);
+  QCOMPARE(snapshot->accountList().count(), m->accountList().count());
+  QCOMPARE(snapshot->balance("A000006", QDate()), balance);
+  QCOMPARE(snapshot->value("key"), QLatin1String("value"));
+
+  // changes to the original do not show up in the snapshot
+  m->startTransaction();
+  m->removeTransaction(t);
+  m->setValue("key", "other");
+  m->commitTransaction();
+  QCOMPARE(m->transactionCount(QString()), count - 1);
+  QCOMPARE(snapshot->transactionCount(QString()), count);
+  QVERIFY(snapshot->transaction(t.id()) == t);
+  QCOMPARE(snapshot->balance("A000006", QDate()), balance);
+  QCOMPARE(snapshot->value("key"), QLatin1String("value"));
+
+  m->startTransaction();
+}
+
+void MyMoneyStorageMgrTest::testSnapshotSource()
+{
+  const auto asset = MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Asset);
+  const auto liability = MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Liability);
+
+  m->commitTransaction();
+  auto source = new TestStorageSource(dailyTransactions(10, QDate(2018, 1, 1)));
+  m->setSource(source, 100);
+  QCOMPARE(m->transactionCount(asset), 5u);
+  m->startTransaction();
+  m->removeTransaction(m->transaction(QLatin1String("T000000000000000001")));
+  m->commitTransaction();
+
+  // taking the snapshot does not load the remaining transactions ...
+  QScopedPointer<MyMoneyStorageMgr> snapshot(m->snapshot());
+  QCOMPARE(source->m_requests.count(), 1);
+  QCOMPARE(snapshot->d_func()->m_transactionList.count(), 4);
+  QVERIFY(snapshot->source() && snapshot->source() != source);
+
+  // ... the snapshot reads them from its own copy of the source
+  const auto copy = static_cast<TestStorageSource*>(snapshot->source());
+  QCOMPARE(snapshot->transactionCount(asset), 4u);
+  QVERIFY(copy->m_requests.isEmpty());
+  QCOMPARE(snapshot->transactionCount(liability), 5u);
+  QCOMPARE(copy->m_requests, QList<QStringList>() << QStringList(liability));
+  QCOMPARE(snapshot->transactionCount(QString()), 9u);
+  QCOMPARE(source->m_requests.count(), 1);
+
+  m->startTransaction();
+}
+
+void MyMoneyStorageMgrTest::testTransactionSource()
+{
+  const auto asset = MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Asset);
+  const auto liability = MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Liability);
+
+  m->commitTransaction();
+  auto source = new TestStorageSource(dailyTransactions(10, QDate(2018, 1, 1)));
+  m->setSource(source, 3);
+  // nothing has been changed, so the transactions can be dropped
+  m->setLastModificationDate(m->lastModificationDate());
+  QCOMPARE(m->d_func()->m_transactionList.count(), 0);
+
+  // the transactions are loaded per account on first use
+  QCOMPARE(m->transactionCount(asset), 5u);
+  QCOMPARE(m->transactionCount(asset), 5u);
+  QCOMPARE(source->m_requests.count(), 1);
+  QCOMPARE(source->m_requests.at(0), QStringList(asset));
+  QCOMPARE(m->d_func()->m_transactionList.count(), 5);
+
+  // the least recently used account is dropped to stay within the cache size
+  QCOMPARE(m->transactionCount(liability), 5u);
+  QCOMPARE(source->m_requests.count(), 2);
+  QCOMPARE(m->d_func()->m_transactionList.count(), 5);
+  QVERIFY(!m->d_func()->m_transactionKeys.contains(QLatin1String("T000000000000000001")));
+
+  // single transactions are loaded by id
+  QCOMPARE(m->transaction(QLatin1String("T000000000000000001")).postDate(), QDate(2018, 1, 1));
+  QCOMPARE(m->d_func()->m_transactionList.count(), 6);
+
+  // removed transactions are not loaded again
+  m->startTransaction();
+  m->removeTransaction(m->transaction(QLatin1String("T000000000000000003")));
+  m->commitTransaction();
+  QCOMPARE(m->removedTransactionIds(), QStringList(QLatin1String("T000000000000000003")));
+  QCOMPARE(m->transactionCount(asset), 4u);
+  QCOMPARE(source->m_requests.count(), 3);
+
+  // unsaved changes keep all transactions in memory
+  QCOMPARE(m->d_func()->m_transactionList.count(), 9);
+  m->d_func()->dropTransactions(QStringList());
+  QCOMPARE(m->d_func()->m_transactionList.count(), 9);
+
+  // new transactions get ids the source does not use yet
+  m->startTransaction();
+  MyMoneyTransaction t;
+  MyMoneySplit s;
+  s.setAccountId(asset);
+  s.setShares(MyMoneyMoney(100, 100));
+  s.setValue(MyMoneyMoney(100, 100));
+  t.addSplit(s);
+  t.setPostDate(QDate(2018, 2, 1));
+  m->addTransaction(t);
+  m->commitTransaction();
+  QCOMPARE(t.id(), QLatin1String("T000000000000000011"));
+
+  // after saving, all transactions are provided by the source again
+  source->m_transactions.remove(source->fetchTransaction(QLatin1String("T000000000000000003")).uniqueSortKey());
+  source->m_transactions.insert(t.uniqueSortKey(), t);
+  m->clearRemovedTransactionIds();
+  m->setLastModificationDate(m->lastModificationDate());
+  QVERIFY(m->removedTransactionIds().isEmpty());
+  QCOMPARE(m->transactionCount(QString()), 10u);
+  QCOMPARE(source->m_requests.last(), QStringList());
+
+  m->startTransaction();
+}
+
+void MyMoneyStorageMgrTest::testTransactionSourceFilter()
+{
+  const auto asset = MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Asset);
+
+  m->commitTransaction();
+  auto source = new TestStorageSource(dailyTransactions(10, QDate(2018, 1, 1)));
+  m->setSource(source, 100);
+  m->setLastModificationDate(m->lastModificationDate());
+
+  // a filter without accounts is passed to the source
+  // and the result is not kept in memory
+  MyMoneyTransactionFilter filter;
+  filter.setDateFilter(QDate(2018, 1, 3), QDate(2018, 1, 6));
+  auto list = m->transactionList(filter);
+  QCOMPARE(list.count(), 4);
+  QCOMPARE(list.first().id(), QLatin1String("T000000000000000003"));
+  QCOMPARE(list.last().id(), QLatin1String("T000000000000000006"));
+  QCOMPARE(source->m_filterRequests, 1);
+  QVERIFY(source->m_requests.isEmpty());
+  QCOMPARE(m->d_func()->m_transactionList.count(), 0);
+
+  // transactions in memory take precedence over those of the source
+  auto t = m->transaction(QLatin1String("T000000000000000004"));
+  t.setMemo(QLatin1String("Changed"));
+  m->startTransaction();
+  m->modifyTransaction(t);
+  m->commitTransaction();
+  QVERIFY(m->d_func()->m_transactionList.count() > 0);
+  list = m->transactionList(filter);
+  QCOMPARE(list.count(), 4);
+  QCOMPARE(list.at(1).id(), QLatin1String("T000000000000000004"));
+  QCOMPARE(list.at(1).memo(), QLatin1String("Changed"));
+  QCOMPARE(source->m_filterRequests, 2);
+
+  // a filter with accounts loads the transactions of these accounts
+  filter.addAccount(asset);
+  list = m->transactionList(filter);
+  QCOMPARE(list.count(), 2);
+  QCOMPARE(source->m_filterRequests, 2);
+
+  m->startTransaction();
+}
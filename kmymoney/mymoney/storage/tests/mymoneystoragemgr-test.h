@@ -50,12 +50,19 @@ private Q_SLOTS:
   void testAddTransactions();
   void testTransactionCount();
   void testBalance();
+  void testBalanceCheckpoints();
   void testModifyTransaction();
   void testRemoveUnusedAccount();
   void testRemoveUsedAccount();
   void testRemoveInstitution();
   void testRemoveTransaction();
   void testTransactionList();
+  void testForEachTransactionSplit();
+  void testAccountTransactionIndex();
+  void testReferenceTransactionIndex();
+  void testTransactionListDateRange();
+  void benchmarkTransactionListDateRange_data();
+  void benchmarkTransactionListDateRange();
   void testAddPayee();
   void testSetAccountName();
   void testModifyPayee();
@@ -64,6 +71,7 @@ private Q_SLOTS:
   void testAddTag();
   void testModifyTag();
   void testTagName();
+  void testNameIndexes();
   void testRemoveTag();
   void testRemoveAccountFromTree();
 //  void testAssignment();
@@ -83,6 +91,10 @@ private Q_SLOTS:
   void testAccountList();
   void testLoaderFunctions();
   void testAddOnlineJob();
+  void testSnapshot();
+  void testSnapshotSource();
+  void testTransactionSource();
+  void testTransactionSourceFilter();
 };
 
 #endif
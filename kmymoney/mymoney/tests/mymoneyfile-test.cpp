@@ -35,6 +35,7 @@
 #include "mymoneytransactionfilter.h"
 #include "mymoneysplit.h"
 #include "mymoneyprice.h"
+#include "mymoneychanges.h"
 #include "mymoneypayee.h"
 #include "mymoneyenums.h"
 #include "onlinejob.h"
@@ -2827,3 +2828,57 @@ void MyMoneyFileTest::testAddSecurity()
     unexpectedException(e);
   }
 }
+
+void MyMoneyFileTest::testObjectsChanged()
+{
+  testAddTransaction();
+  const auto t1 = m->transaction("T000000000000000001");
+
+  QList<MyMoneyChanges> notifications;
+  const auto connection = connect(m, &MyMoneyFile::objectsChanged, [&](const MyMoneyChanges& changes) {
+    notifications.append(changes);
+  });
+
+  MyMoneyTransaction t2;
+  t2.setPostDate(QDate(2002, 2, 2));
+  MyMoneySplit split1;
+  split1.setAccountId("A000001");
+  split1.setShares(MyMoneyMoney(-500, 100));
+  split1.setValue(MyMoneyMoney(-500, 100));
+  t2.addSplit(split1);
+  MyMoneySplit split2;
+  split2.setAccountId("A000003");
+  split2.setShares(MyMoneyMoney(500, 100));
+  split2.setValue(MyMoneyMoney(500, 100));
+  t2.addSplit(split2);
+
+  clearObjectLists();
+  MyMoneyFileTransaction ft;
+  try {
+    m->addTransaction(t2);
+    t2.setMemo("Modified");
+    m->modifyTransaction(t2);
+    m->removeTransaction(t1);
+    ft.commit();
+  } catch (const MyMoneyException &) {
+    QFAIL("Unexpected exception!");
+  }
+  disconnect(connection);
+
+  // the single object signals are still sent out
+  QCOMPARE(m_objectsAdded, QStringList() << t2.id());
+  QCOMPARE(m_objectsRemoved, QStringList() << t1.id());
+
+  // and are summarized in a single notification
+  QCOMPARE(notifications.count(), 1);
+  const auto& changes = notifications.first();
+  QCOMPARE(changes.ids(eMyMoney::File::Mode::Add, eMyMoney::File::Object::Transaction), QStringList() << t2.id());
+  QVERIFY(changes.ids(eMyMoney::File::Mode::Modify, eMyMoney::File::Object::Transaction).isEmpty());
+  QCOMPARE(changes.ids(eMyMoney::File::Mode::Remove, eMyMoney::File::Object::Transaction), QStringList() << t1.id());
+  QCOMPARE(changes.count(eMyMoney::File::Object::Transaction), 2);
+  QVERIFY(!changes.contains(eMyMoney::File::Object::Account));
+  auto balanceChanges = changes.balanceChanges();
+  std::sort(balanceChanges.begin(), balanceChanges.end());
+  QCOMPARE(balanceChanges, QStringList() << "A000001" << "A000003");
+  QVERIFY(changes.valueChanges().isEmpty());
+}
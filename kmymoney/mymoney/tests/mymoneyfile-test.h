@@ -60,6 +60,7 @@ private Q_SLOTS:
   void testRemoveAccountTree();
   void testAccountListRetrieval();
   void testAddTransaction();
+  void testObjectsChanged();
   void testIsStandardAccount();
   void testHasActiveSplits();
   void testModifyTransactionSimple();
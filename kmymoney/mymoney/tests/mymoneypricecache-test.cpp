@@ -0,0 +1,129 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mymoneypricecache-test.h"
+
+#include <QtTest>
+
+#include "mymoneymoney.h"
+#include "mymoneypricecache.h"
+
+QTEST_GUILESS_MAIN(MyMoneyPriceCacheTest)
+
+static MyMoneyPriceEntries entries(const QString& from, const QString& to, const QList<QPair<QDate, MyMoneyMoney> >& list)
+{
+  MyMoneyPriceEntries map;
+  for (const auto& entry : list)
+    map[entry.first] = MyMoneyPrice(from, to, entry.first, entry.second, "test");
+  return map;
+}
+
+void MyMoneyPriceCacheTest::init()
+{
+  m = new MyMoneyPriceCache();
+}
+
+void MyMoneyPriceCacheTest::cleanup()
+{
+  delete m;
+}
+
+void MyMoneyPriceCacheTest::testInsert()
+{
+  QVERIFY(!m->contains("E000001", "USD"));
+  QVERIFY(!m->price("E000001", "USD", QDate(2010, 9, 18), false).isValid());
+
+  m->insert("E000001", "USD", entries("E000001", "USD", { qMakePair(QDate(2010, 9, 16), MyMoneyMoney(10, 1)) }), MyMoneyPriceEntries());
+  QVERIFY(m->contains("E000001", "USD"));
+  QVERIFY(!m->contains("USD", "E000001"));
+  QCOMPARE(m->size(), 1);
+
+  // a pair without prices is cached as well
+  m->insert("E000002", "USD", MyMoneyPriceEntries(), MyMoneyPriceEntries());
+  QVERIFY(m->contains("E000002", "USD"));
+  QVERIFY(!m->price("E000002", "USD", QDate(2010, 9, 18), false).isValid());
+  QCOMPARE(m->size(), 2);
+}
+
+void MyMoneyPriceCacheTest::testClear()
+{
+  m->insert("E000001", "USD", MyMoneyPriceEntries(), MyMoneyPriceEntries());
+  m->insert("USD", "E000001", MyMoneyPriceEntries(), MyMoneyPriceEntries());
+  m->insert("E000002", "USD", MyMoneyPriceEntries(), MyMoneyPriceEntries());
+  QCOMPARE(m->size(), 3);
+
+  // both directions of the pair are removed
+  m->clear("USD", "E000001");
+  QVERIFY(!m->contains("E000001", "USD"));
+  QVERIFY(!m->contains("USD", "E000001"));
+  QVERIFY(m->contains("E000002", "USD"));
+
+  m->clear();
+  QCOMPARE(m->size(), 0);
+}
+
+void MyMoneyPriceCacheTest::testExactDate()
+{
+  m->insert("E000001", "USD", entries("E000001", "USD", {
+    qMakePair(QDate(2010, 9, 16), MyMoneyMoney(10, 1)),
+    qMakePair(QDate(2010, 9, 18), MyMoneyMoney(12, 1))
+  }), MyMoneyPriceEntries());
+
+  QCOMPARE(m->price("E000001", "USD", QDate(2010, 9, 16), true).rate("USD"), MyMoneyMoney(10, 1));
+  QCOMPARE(m->price("E000001", "USD", QDate(2010, 9, 18), true).rate("USD"), MyMoneyMoney(12, 1));
+  QVERIFY(!m->price("E000001", "USD", QDate(2010, 9, 17), true).isValid());
+  QVERIFY(!m->price("E000001", "USD", QDate(2010, 9, 15), true).isValid());
+}
+
+void MyMoneyPriceCacheTest::testPreviousDate()
+{
+  m->insert("E000001", "USD", entries("E000001", "USD", {
+    qMakePair(QDate(2010, 9, 16), MyMoneyMoney(10, 1)),
+    qMakePair(QDate(2010, 9, 18), MyMoneyMoney(12, 1))
+  }), MyMoneyPriceEntries());
+
+  QVERIFY(!m->price("E000001", "USD", QDate(2010, 9, 15), false).isValid());
+  QCOMPARE(m->price("E000001", "USD", QDate(2010, 9, 17), false).date(), QDate(2010, 9, 16));
+  QCOMPARE(m->price("E000001", "USD", QDate(2010, 9, 18), false).date(), QDate(2010, 9, 18));
+  QCOMPARE(m->price("E000001", "USD", QDate(2011, 1, 1), false).date(), QDate(2010, 9, 18));
+
+  // an invalid date is today
+  QCOMPARE(m->price("E000001", "USD", QDate(), false).date(), QDate(2010, 9, 18));
+}
+
+void MyMoneyPriceCacheTest::testReciprocal()
+{
+  m->insert("CAD", "USD", entries("CAD", "USD", {
+    qMakePair(QDate(2010, 9, 16), MyMoneyMoney(80, 100)),
+    qMakePair(QDate(2010, 9, 20), MyMoneyMoney(75, 100))
+  }), entries("USD", "CAD", {
+    qMakePair(QDate(2010, 9, 18), MyMoneyMoney(2, 1)),
+    qMakePair(QDate(2010, 9, 20), MyMoneyMoney(4, 1))
+  }));
+
+  // the reciprocal price is used if it is more recent
+  auto price = m->price("CAD", "USD", QDate(2010, 9, 19), false);
+  QCOMPARE(price.date(), QDate(2010, 9, 18));
+  QCOMPARE(price.from(), QString("USD"));
+  QCOMPARE(price.rate("USD"), MyMoneyMoney(1, 2));
+  QCOMPARE(m->price("CAD", "USD", QDate(2010, 9, 18), true).rate("USD"), MyMoneyMoney(1, 2));
+
+  // on the same date the direct price wins
+  price = m->price("CAD", "USD", QDate(2010, 9, 20), true);
+  QCOMPARE(price.from(), QString("CAD"));
+  QCOMPARE(price.rate("USD"), MyMoneyMoney(75, 100));
+
+  QCOMPARE(m->price("CAD", "USD", QDate(2010, 9, 17), false).rate("USD"), MyMoneyMoney(80, 100));
+}
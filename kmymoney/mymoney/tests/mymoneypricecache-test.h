@@ -0,0 +1,40 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MYMONEYPRICECACHETEST_H
+#define MYMONEYPRICECACHETEST_H
+
+#include <QObject>
+
+#include "mymoneypricecache.h"
+
+class MyMoneyPriceCacheTest : public QObject
+{
+  Q_OBJECT
+
+protected:
+  MyMoneyPriceCache* m;
+
+private Q_SLOTS:
+  void init();
+  void cleanup();
+  void testInsert();
+  void testClear();
+  void testExactDate();
+  void testPreviousDate();
+  void testReciprocal();
+};
+
+#endif
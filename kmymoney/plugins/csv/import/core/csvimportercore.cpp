@@ -1254,7 +1254,7 @@ QList<eMyMoney::Transaction::Action> CSVImporterCore::createValidActionTypes(MyM
 
 bool CSVImporterCore::sortSecurities(QSet<QString>& onlySymbols, QSet<QString>& onlyNames, QMap<QString, QString>& mapSymbolName)
 {
-  QList<MyMoneySecurity> securityList = MyMoneyFile::instance()->securityList();
+  auto file = MyMoneyFile::instance();
   int symbolCol = m_profile->m_colTypeNum.value(Column::Symbol, -1);
   int nameCol = m_profile->m_colTypeNum.value(Column::Name, -1);
 
@@ -1279,11 +1279,8 @@ bool CSVImporterCore::sortSecurities(QSet<QString>& onlySymbols, QSet<QString>&
 
   // try to find names for symbols
   for (QSet<QString>::iterator symbol = onlySymbols.begin(); symbol != onlySymbols.end();) {
-    QList<MyMoneySecurity> filteredSecurities;
-    foreach (const auto sec, securityList) {
-      if ((*symbol).compare(sec.tradingSymbol(), Qt::CaseInsensitive) == 0)
-        filteredSecurities.append(sec);      // gather all securities that by matched by symbol
-    }
+    // gather all securities that are matched by symbol
+    const QList<MyMoneySecurity> filteredSecurities = file->securitiesBySymbol(*symbol);
 
     if (filteredSecurities.count() == 1) {                                  // single security matched by the symbol so...
       mapSymbolName.insert(*symbol, filteredSecurities.first().name());
@@ -1298,11 +1295,8 @@ bool CSVImporterCore::sortSecurities(QSet<QString>& onlySymbols, QSet<QString>&
 
   // try to find symbols for names
   for (QSet<QString>::iterator name = onlyNames.begin(); name != onlyNames.end();) {
-    QList<MyMoneySecurity> filteredSecurities;
-    foreach (const auto sec, securityList) {
-      if ((*name).compare(sec.name(), Qt::CaseInsensitive) == 0)
-        filteredSecurities.append(sec);      // gather all securities that by matched by name
-    }
+    // gather all securities that are matched by name
+    const QList<MyMoneySecurity> filteredSecurities = file->securitiesByName(*name, Qt::CaseInsensitive);
 
     if (filteredSecurities.count() == 1) {                                  // single security matched by the name so...
       mapSymbolName.insert(filteredSecurities.first().tradingSymbol(), *name);
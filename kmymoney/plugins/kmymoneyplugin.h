@@ -22,6 +22,8 @@
 
 #include <kmm_plugin_export.h>
 
+#include <functional>
+
 // ----------------------------------------------------------------------------
 // QT Includes
 
@@ -307,6 +309,24 @@ public:
    */
   virtual bool save(const QUrl &url) = 0;
 
+  /**
+   * @brief Saves storage into file without blocking the caller
+   *
+   * The data is captured when this method is called. The file is written
+   * while the user continues to work and @a finished is called with the
+   * result once it is done. The default implementation saves synchronously.
+   *
+   * @param url URL of the file
+   * @param finished called in the context of the caller when the save is done
+   * @return true if saving has been started
+   */
+  virtual bool saveInBackground(const QUrl &url, std::function<void(bool)> finished)
+  {
+    const auto rc = save(url);
+    finished(rc);
+    return rc;
+  }
+
   /**
    * @brief Saves storage into file
    * @param url URL of the file
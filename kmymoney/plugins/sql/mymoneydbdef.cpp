@@ -36,7 +36,7 @@
 #include <alkimia/alkvalue.h>
 
 //***************** THE CURRENT VERSION OF THE DATABASE LAYOUT ****************
-unsigned int MyMoneyDbDef::m_currentVersion = 12;
+unsigned int MyMoneyDbDef::m_currentVersion = 13;
 
 // ************************* Build table descriptions ****************************
 MyMoneyDbDef::MyMoneyDbDef()
@@ -192,6 +192,7 @@ void MyMoneyDbDef::TagSplits()
   appendField(MyMoneyDbColumn("tagId", "varchar(32)", PRIMARYKEY, NOTNULL));
   appendField(MyMoneyDbIntColumn("splitId", MyMoneyDbIntColumn::SMALL, UNSIGNED, PRIMARYKEY, NOTNULL));
   MyMoneyDbTable t("kmmTagSplits", fields);
+  t.addIndex("kmmTagSplitstag", QStringList("tagId"), false);
   t.buildSQLStrings();
   m_tables[t.name()] = t;
 }
@@ -244,6 +245,7 @@ void MyMoneyDbDef::Transactions()
   appendField(MyMoneyDbColumn("currencyId", "char(3)"));
   appendField(MyMoneyDbTextColumn("bankId"));
   MyMoneyDbTable t("kmmTransactions", fields);
+  t.addIndex("kmmTransactionspostDate", QStringList("postDate"), false);
   t.buildSQLStrings();
   m_tables[t.name()] = t;
 }
@@ -274,6 +276,7 @@ void MyMoneyDbDef::Splits()
   QStringList list;
   list << "accountId" << "txType";
   t.addIndex("kmmSplitsaccount_type", list, false);
+  t.addIndex("kmmSplitspayee", QStringList("payeeId"), false);
   t.buildSQLStrings();
   m_tables[t.name()] = t;
 }
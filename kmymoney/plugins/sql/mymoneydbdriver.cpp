@@ -68,6 +68,7 @@ public:
   QString intString(const MyMoneyDbIntColumn& c) const final override;
   QString timestampString(const MyMoneyDbDatetimeColumn& c) const final override;
   QString tableOptionString() const final override;
+  QString fractionToNumberString(const QString& columnName) const final override;
   QString highestNumberFromIdString(const QString& tableName, const QString& tableField, const int prefixLength) const final override;
   QStringList tables(QSql::TableType tt, const QSqlDatabase& db) const final override;
 };
@@ -108,6 +109,7 @@ public:
   QString modifyColumnString(const QString& tableName, const QString& columnName, const MyMoneyDbColumn& newDef) const final override;
   QString intString(const MyMoneyDbIntColumn& c) const final override;
   QString textString(const MyMoneyDbTextColumn& c) const final override;
+  QString fractionToNumberString(const QString& columnName) const final override;
   QString highestNumberFromIdString(const QString& tableName, const QString& tableField, const int prefixLength) const final override;
 };
 
@@ -129,6 +131,10 @@ public:
   QString intString(const MyMoneyDbIntColumn& c) const final override;
   bool requiresExternalFile() const final override;
   bool requiresCreation() const final override;
+  QMap<QString, QString> bulkLoadSettings() const final override;
+  QString settingQueryString(const QString& setting) const final override;
+  QString settingUpdateString(const QString& setting, const QString& value) const final override;
+  QString fractionToNumberString(const QString& columnName) const final override;
   bool isPasswordSupported() const override;
 };
 
@@ -638,6 +644,67 @@ QString MyMoneyDbDriver::tableOptionString() const
   return "";
 }
 
+//***********************************************
+// Define the bulk load statements
+// So far, only SQLite requires special handling. The journal and
+// the sync to disk are skipped until the data has been written.
+// The values active before are read and restored afterwards.
+QMap<QString, QString> MyMoneyDbDriver::bulkLoadSettings() const
+{
+  return QMap<QString, QString>();
+}
+
+QString MyMoneyDbDriver::settingQueryString(const QString&) const
+{
+  return QString();
+}
+
+QString MyMoneyDbDriver::settingUpdateString(const QString&, const QString&) const
+{
+  return QString();
+}
+
+QMap<QString, QString> MyMoneySqlite3Driver::bulkLoadSettings() const
+{
+  QMap<QString, QString> settings;
+  settings["synchronous"] = "OFF";
+  settings["journal_mode"] = "MEMORY";
+  settings["cache_size"] = "-65536";
+  return settings;
+}
+
+QString MyMoneySqlite3Driver::settingQueryString(const QString& setting) const
+{
+  return QString("PRAGMA %1;").arg(setting);
+}
+
+QString MyMoneySqlite3Driver::settingUpdateString(const QString& setting, const QString& value) const
+{
+  return QString("PRAGMA %1 = %2;").arg(setting, value);
+}
+
+//***********************************************
+// Define the expression converting a fraction string into a number
+QString MyMoneyDbDriver::fractionToNumberString(const QString&) const
+{
+  return QString();
+}
+
+QString MyMoneyMysqlDriver::fractionToNumberString(const QString& columnName) const
+{
+  return QString("((SUBSTRING_INDEX(%1, '/', 1) + 0.0) / (CASE WHEN LOCATE('/', %1) > 0 THEN SUBSTRING_INDEX(%1, '/', -1) + 0.0 ELSE 1.0 END))").arg(columnName);
+}
+
+QString MyMoneyPostgresqlDriver::fractionToNumberString(const QString& columnName) const
+{
+  return QString("(CAST(SPLIT_PART(%1, '/', 1) AS NUMERIC) / CAST(COALESCE(NULLIF(SPLIT_PART(%1, '/', 2), ''), '1') AS NUMERIC))").arg(columnName);
+}
+
+QString MyMoneySqlite3Driver::fractionToNumberString(const QString& columnName) const
+{
+  return QString("(CASE WHEN INSTR(%1, '/') > 0 THEN CAST(SUBSTR(%1, 1, INSTR(%1, '/') - 1) AS REAL) / CAST(SUBSTR(%1, INSTR(%1, '/') + 1) AS REAL) ELSE CAST(%1 AS REAL) END)").arg(columnName);
+}
+
 //***********************************************
 // Define the highestIdNum string
 // PostgreSQL and Oracle return errors when a non-numerical string is cast to an integer, so a regex is used to skip strings that aren't entirely numerical after the prefix is removed
@@ -165,6 +165,35 @@ public:
    */
   virtual QString tableOptionString() const;
 
+  /**
+   * Some DBMS can be tuned for writing a large amount of data
+   * into an empty database, e.g. when saving a file as database
+   * @return the names of the settings to change mapped to their values
+   */
+  virtual QMap<QString, QString> bulkLoadSettings() const;
+
+  /**
+   * @param setting name of a setting returned by bulkLoadSettings()
+   * @return SQL statement returning the current value of @a setting
+   */
+  virtual QString settingQueryString(const QString& setting) const;
+
+  /**
+   * @param setting name of a setting returned by bulkLoadSettings()
+   * @param value new value of @a setting
+   * @return SQL statement changing the value of @a setting
+   */
+  virtual QString settingUpdateString(const QString& setting, const QString& value) const;
+
+  /**
+   * Amounts are stored as fractions like "-1234/100". This returns an
+   * SQL expression which converts such a column into a number, so that
+   * it can be compared in a WHERE clause.
+   * @param columnName name of the column holding the fraction
+   * @return the SQL expression or an empty string if not supported
+   */
+  virtual QString fractionToNumberString(const QString& columnName) const;
+
   /**
    * @return The SQL string to find the highest ID number with an arbitrary prefix
    */
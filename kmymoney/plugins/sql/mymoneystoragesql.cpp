@@ -23,6 +23,8 @@
 // ----------------------------------------------------------------------------
 // System Includes
 
+#include <memory>
+
 // ----------------------------------------------------------------------------
 // QT Includes
 
@@ -70,8 +72,7 @@ int MyMoneyStorageSql::open(const QUrl &url, int openMode, bool clear)
     d->m_driver = MyMoneyDbDriver::create(QUrlQuery(url).queryItemValue("driver"));
     //get the input options
     QStringList options = QUrlQuery(url).queryItemValue("options").split(',');
-    d->m_loadAll = true; // force loading whole database into memory since unification of storages
-                   // options.contains("loadAll")/*|| m_mode == 0*/;
+    d->m_loadAll = options.contains("loadAll");
     d->m_override = options.contains("override");
 
     // create the database connection
@@ -127,6 +128,7 @@ int MyMoneyStorageSql::open(const QUrl &url, int openMode, bool clear)
               query.exec(QStringLiteral("SELECT count(*) FROM sqlite_master")); // SQLCipher recommended way to check if password is correct
               if (query.next()) {
                 query.finish();
+                setPassword(passphrase); // connections opened by readOnlyCopy() need it as well
                 rc = d->createTables(); // check all tables are present, create if not
                 break;
               }
@@ -220,6 +222,21 @@ int MyMoneyStorageSql::open(const QUrl &url, int openMode, bool clear)
   }
 }
 
+bool MyMoneyStorageSql::openForReading()
+{
+  Q_D(MyMoneyStorageSql);
+  d->m_driver = MyMoneyDbDriver::create(driverName());
+  if (!QSqlDatabase::open()) {
+    d->buildError(QSqlQuery(*this), Q_FUNC_INFO, "opening database for reading");
+    return false;
+  }
+  if (driverName().compare(QLatin1String("QSQLCIPHER")) == 0 && !password().isEmpty()) {
+    QSqlQuery query(*this);
+    query.exec(QString::fromLatin1("PRAGMA key = '%1'").arg(password()));
+  }
+  return true;
+}
+
 void MyMoneyStorageSql::close(bool logoff)
 {
   Q_D(MyMoneyStorageSql);
@@ -255,24 +272,18 @@ bool MyMoneyStorageSql::readFile()
   try {
     d->readFileInfo();
     d->readInstitutions();
-    if (d->m_loadAll) {
-      readPayees();
-    } else {
-      QList<QString> user;
-      user.append(QString("USER"));
-      readPayees(user);
-    }
+    readPayees();
     readTags();
     d->readCurrencies();
     d->readSecurities();
     d->readAccounts();
-    if (d->m_loadAll) {
+    // without loadAll the transactions and prices are
+    // fetched by the storage when they are needed
+    if (d->m_loadAll)
       d->readTransactions();
-    } else {
-      if (d->m_preferred.filterSet().singleFilter.accountFilter) readTransactions(d->m_preferred);
-    }
     d->readSchedules();
-    d->readPrices();
+    if (d->m_loadAll)
+      d->readPrices();
     d->readReports();
     d->readBudgets();
     d->readOnlineJobs();
@@ -294,6 +305,12 @@ bool MyMoneyStorageSql::readFile()
   // as a side-effect.
 }
 
+bool MyMoneyStorageSql::loadAll() const
+{
+  Q_D(const MyMoneyStorageSql);
+  return d->m_loadAll;
+}
+
 // The following is called from 'SaveAsDatabase'
 bool MyMoneyStorageSql::writeFile()
 {
@@ -313,20 +330,36 @@ bool MyMoneyStorageSql::writeFile()
       query.exec("PRAGMA foreign_keys = ON"); // this is needed for "ON UPDATE" and "ON DELETE" to work
     }
 
-    MyMoneyDbTransaction t(*this, Q_FUNC_INFO);
-    d->writeInstitutions();
-    d->writePayees();
-    d->writeTags();
-    d->writeAccounts();
-    d->writeTransactions();
-    d->writeSchedules();
-    d->writeSecurities();
-    d->writePrices();
-    d->writeCurrencies();
-    d->writeReports();
-    d->writeBudgets();
-    d->writeOnlineJobs();
-    d->writeFileInfo();
+    // a freshly created database, e.g. when saving a file as database,
+    // is filled in bulk mode with the indexes being created at the end
+    const auto bulkLoad = d->m_newDatabase && (getRecCount(QLatin1String("kmmTransactions")) == 0);
+    auto rc = true;
+    {
+      MyMoneyStorageSqlPrivate::BulkLoadMode bulkLoadMode(d, bulkLoad);
+      {
+        MyMoneyDbTransaction t(*this, Q_FUNC_INFO);
+        if (bulkLoad)
+          d->dropBulkLoadIndexes();
+        d->writeInstitutions();
+        d->writePayees();
+        d->writeTags();
+        d->writeAccounts();
+        d->writeTransactions();
+        d->writeSchedules();
+        d->writeSecurities();
+        d->writePrices();
+        d->writeCurrencies();
+        d->writeReports();
+        d->writeBudgets();
+        d->writeOnlineJobs();
+        d->writeFileInfo();
+        if (bulkLoad)
+          d->createBulkLoadIndexes();
+      }
+      // the data is committed at this point, but the caller
+      // needs to know if the connection kept the bulk settings
+      rc = bulkLoadMode.restore();
+    }
     // this seems to be nonsense, but it clears the dirty flag
     // as a side-effect.
     //m_storage->setLastModificationDate(m_storage->lastModificationDate());
@@ -338,7 +371,9 @@ bool MyMoneyStorageSql::writeFile()
     // this seems to be nonsense, but it clears the dirty flag
     // as a side-effect.
     d->m_storage->setLastModificationDate(d->m_storage->lastModificationDate());
-    return true;
+    if (d->m_storage->source() == this)
+      d->m_storage->clearRemovedTransactionIds();
+    return rc;
   } catch (const QString &) {
     return false;
   }
@@ -1910,188 +1945,119 @@ QMap<QString, MyMoneyTransaction> MyMoneyStorageSql::fetchTransactions() const
 QMap<QString, MyMoneyTransaction> MyMoneyStorageSql::fetchTransactions(const MyMoneyTransactionFilter& filter) const
 {
   Q_D(const MyMoneyStorageSql);
-  // analyze the filter
-//  if (m_transactionListRead) return; // all list already in memory
-  // if the filter is restricted to certain accounts/categories
-  // check if we already have them all in memory
-  QStringList accounts;
-  QString inQuery;
-  filter.accounts(accounts);
-  filter.categories(accounts);
-//  QStringList::iterator it;
-//  bool allAccountsLoaded = true;
-//  for (it = accounts.begin(); it != accounts.end(); ++it) {
-//    if (m_accountsLoaded.find(*it) == m_accountsLoaded.end()) {
-//      allAccountsLoaded = false;
-//      break;
-//    }
-//  }
-//  if (allAccountsLoaded) return;
-  /* Some filter combinations do not lend themselves to implementation
-  * in SQL, or are likely to require such extensive reading of the database
-  * as to make it easier to just read everything into memory.  */
-  bool canImplementFilter = true;
-  MyMoneyMoney m1, m2;
-  if (filter.amountFilter(m1, m2)) {
-    d->alert("Amount Filter Set");
-    canImplementFilter = false;
-  }
-  QString n1, n2;
-  if (filter.numberFilter(n1, n2)) {
-    d->alert("Number filter set");
-    canImplementFilter = false;
-  }
-  int t1;
-  if (filter.firstType(t1)) {
-    d->alert("Type filter set");
-    canImplementFilter = false;
-  }
-//  int s1;
-//  if (filter.firstState(s1)) {
-//    alert("State filter set");
-//    canImplementFilter = false;
-//  }
-  QRegExp t2;
-  if (filter.textFilter(t2)) {
-    d->alert("text filter set");
-    canImplementFilter = false;
-  }
-  MyMoneyTransactionFilter::FilterSet s = filter.filterSet();
-  if (s.singleFilter.validityFilter) {
-    d->alert("Validity filter set");
-    canImplementFilter = false;
-  }
-  if (!canImplementFilter) {
-    QMap<QString, MyMoneyTransaction> transactionList =  fetchTransactions();
-
-    std::remove_if(transactionList.begin(), transactionList.end(), FilterFail(filter));
-    return transactionList;
-  }
-
-  bool splitFilterActive = false; // the split filter is active if we are selecting on fields in the split table
-  // get start and end dates
-  QDate start = filter.fromDate();
-  QDate end = filter.toDate();
-  // not entirely sure if the following is correct, but at best, saves a lot of reads, at worst
-  // it only causes us to read a few more transactions that strictly necessary (I think...)
-  if (start == MyMoneyStorageSqlPrivate::m_startDate) start = QDate();
-  bool txFilterActive = ((start != QDate()) || (end != QDate())); // and this for fields in the transaction table
-
-  QString whereClause = "";
-  QString subClauseconnector = " WHERE txType = 'N' AND ";
-  // payees
+  /* The filter is translated into a superset of the transactions it
+  * accepts: conditions the database cannot check exactly are either
+  * widened or left out. The caller applies the filter to the result. */
+
+  // conditions on a single split
+  QStringList splitClauses;
+
   QStringList payees;
   if (filter.payees(payees)) {
-    QString itemConnector = "payeeId IN (";
-    QString payeesClause = "";
-    foreach (const QString& it, payees) {
-      payeesClause.append(QString("%1'%2'")
-                          .arg(itemConnector).arg(it));
-      itemConnector = ", ";
-    }
-    if (!payeesClause.isEmpty()) {
-      whereClause += subClauseconnector + payeesClause + ')';
-      subClauseconnector = " AND ";
-    }
-    splitFilterActive = true;
+    if (payees.isEmpty())
+      splitClauses << "(payeeId IS NULL OR payeeId = '')";
+    else
+      splitClauses << QString("payeeId IN %1").arg(MyMoneyStorageSqlPrivate::sqlList(payees));
   }
 
-  //tags
   QStringList tags;
   if (filter.tags(tags)) {
-    QString itemConnector = "splitId IN ( SELECT splitId FROM kmmTagSplits WHERE kmmTagSplits.transactionId = kmmSplits.transactionId AND tagId IN (";
-    QString tagsClause = "";
-    foreach (const QString& it, tags) {
-      tagsClause.append(QString("%1'%2'")
-                        .arg(itemConnector).arg(it));
-      itemConnector = ", ";
-    }
-    if (!tagsClause.isEmpty()) {
-      whereClause += subClauseconnector + tagsClause + ')';
-      subClauseconnector = " AND ";
-    }
-    splitFilterActive = true;
-  }
-
-  // accounts and categories
-  if (!accounts.isEmpty()) {
-    splitFilterActive = true;
-    QString itemConnector = "accountId IN (";
-    QString accountsClause = "";
-    foreach (const QString& it, accounts) {
-      accountsClause.append(QString("%1 '%2'")
-                            .arg(itemConnector).arg(it));
-      itemConnector = ", ";
-    }
-    if (!accountsClause.isEmpty()) {
-      whereClause += subClauseconnector + accountsClause + ')';
-      subClauseconnector = " AND (";
-    }
+    const QString tagSplits("SELECT 1 FROM kmmTagSplits WHERE kmmTagSplits.transactionId = kmmSplits.transactionId AND kmmTagSplits.splitId = kmmSplits.splitId");
+    if (tags.isEmpty())
+      splitClauses << QString("NOT EXISTS (%1)").arg(tagSplits);
+    else
+      splitClauses << QString("EXISTS (%1 AND tagId IN %2)").arg(tagSplits, MyMoneyStorageSqlPrivate::sqlList(tags));
   }
 
-  // split states
-  QList <int> splitStates;
-  if (filter.states(splitStates)) {
-    splitFilterActive = true;
-    QString itemConnector = " reconcileFlag IN (";
-    QString statesClause = "";
-    foreach (int it, splitStates) {
-      statesClause.append(QString(" %1 '%2'").arg(itemConnector)
-                          .arg(d->splitState(TransactionFilter::State(it))));
-      itemConnector = ',';
+  QList<int> states;
+  if (filter.states(states) && !states.isEmpty()) {
+    const auto clause = d->stateFilterClause(states);
+    if (!clause.isEmpty())
+      splitClauses << clause;
+  }
+
+  QList<int> types;
+  if (filter.types(types) && !types.isEmpty())
+    splitClauses << d->typeFilterClause(types);
+
+  QString n1, n2;
+  if (filter.numberFilter(n1, n2)) {
+    // only numerical limits compare the same way in all DBMS
+    const QRegExp digits(QLatin1String("[0-9]*"));
+    if (digits.exactMatch(n1) && digits.exactMatch(n2)) {
+      if (!n1.isEmpty())
+        splitClauses << QString("COALESCE(checkNumber, '') >= '%1'").arg(n1);
+      if (!n2.isEmpty())
+        splitClauses << QString("COALESCE(checkNumber, '') <= '%1'").arg(n2);
     }
-    if (!statesClause.isEmpty()) {
-      whereClause += subClauseconnector + statesClause + ')';
-      subClauseconnector = " AND (";
+  }
+
+  MyMoneyMoney m1, m2;
+  if (filter.amountFilter(m1, m2)) {
+    const auto value = d->m_driver->fractionToNumberString("value");
+    const auto shares = d->m_driver->fractionToNumberString("shares");
+    if (!value.isEmpty()) {
+      // widen the range to cover rounding differences of the DBMS
+      const auto from = QString::number(m1.abs().toDouble() * (1.0 - 1e-9) - 1e-9, 'g', 17);
+      const auto to = QString::number(m2.abs().toDouble() * (1.0 + 1e-9) + 1e-9, 'g', 17);
+      splitClauses << QString("(ABS(%1) BETWEEN %3 AND %4 OR ABS(%2) BETWEEN %3 AND %4)").arg(value, shares, from, to);
     }
   }
-  // I've given up trying to work out the logic. we keep getting the wrong number of close brackets
-  int obc = whereClause.count('(');
-  int cbc = whereClause.count(')');
-  if (cbc > obc) {
-    qDebug() << "invalid where clause " << whereClause;
-    qFatal("aborting");
-  }
-  while (cbc < obc) {
-    whereClause.append(')');
-    cbc++;
-  }
-  // if the split filter is active, but the where clause and the date filter is empty
-  // it means we already have all the transactions for the specified filter
-  // in memory, so just exit
-  if ((splitFilterActive) && (whereClause.isEmpty()) && (!txFilterActive)) {
-    qDebug("all transactions already in storage");
-    return fetchTransactions();
+
+  QRegExp exp;
+  if (filter.textFilter(exp) && !filter.isInvertingText()) {
+    const auto clause = d->textFilterClause(exp);
+    if (!clause.isEmpty())
+      splitClauses << clause;
   }
 
-  // if we have neither a split filter, nor a tx (date) filter
-  // it's effectively a read all
-  if ((!splitFilterActive) && (!txFilterActive)) {
-    //qDebug("reading all transactions");
+  // accounts and categories may be referenced by other splits of the transaction
+  QStringList accounts;
+  if (filter.accounts(accounts) && !accounts.isEmpty())
+    splitClauses << QString("transactionId IN (SELECT transactionId FROM kmmSplits WHERE txType = 'N' AND accountId IN %1)").arg(MyMoneyStorageSqlPrivate::sqlList(accounts));
+
+  QStringList categories;
+  if (filter.categories(categories) && !categories.isEmpty())
+    splitClauses << QString("transactionId IN (SELECT transactionId FROM kmmSplits WHERE txType = 'N' AND accountId IN %1)").arg(MyMoneyStorageSqlPrivate::sqlList(categories));
+
+  // build a date clause which is valid for the transaction and the split table
+  QDate start = filter.fromDate();
+  QDate end = filter.toDate();
+  if (start == MyMoneyStorageSqlPrivate::m_startDate)
+    start = QDate();
+  QStringList dateClauses;
+  if (end.isValid())
+    dateClauses << QString("postDate < '%1'").arg(end.addDays(1).toString(Qt::ISODate));
+  if (start.isValid())
+    dateClauses << QString("postDate >= '%1'").arg(start.toString(Qt::ISODate));
+  const auto dateClause = dateClauses.join(" AND ");
+
+  if (splitClauses.isEmpty() && dateClause.isEmpty())
     return fetchTransactions();
-  }
-  // build a date clause for the transaction table
-  QString dateClause;
-  QString connector = "";
-  if (end != QDate()) {
-    dateClause = QString("(postDate < '%1')").arg(end.addDays(1).toString(Qt::ISODate));
-    connector = " AND ";
-  }
-  if (start != QDate()) {
-    dateClause += QString("%1 (postDate >= '%2')").arg(connector).arg(start.toString(Qt::ISODate));
-  }
-  // now get a list of transaction ids
-  // if we have only a date filter, we need to build the list from the tx table
-  // otherwise we need to build from the split table
-  if (splitFilterActive) {
-    inQuery = QString("(SELECT DISTINCT transactionId FROM kmmSplits %1)").arg(whereClause);
+
+  QString inQuery;
+  if (splitClauses.isEmpty()) {
+    inQuery = QString("(SELECT id FROM kmmTransactions WHERE txType = 'N' AND %1)").arg(dateClause);
   } else {
-    inQuery = QString("(SELECT DISTINCT id FROM kmmTransactions WHERE %1)").arg(dateClause);
-    txFilterActive = false; // kill off the date filter now
+    splitClauses.prepend("txType = 'N'");
+    splitClauses += dateClauses;
+    inQuery = QString("(SELECT DISTINCT transactionId FROM kmmSplits WHERE %1)").arg(splitClauses.join(" AND "));
   }
-
   return fetchTransactions(inQuery, dateClause);
-  //FIXME: if we have an accounts-only filter, recalc balances on loaded accounts
+}
+
+QMap<QString, MyMoneyTransaction> MyMoneyStorageSql::fetchAccountTransactions(const QStringList& accountIds) const
+{
+  if (accountIds.isEmpty())
+    return fetchTransactions();
+  return fetchTransactions(QString("(SELECT DISTINCT transactionId FROM kmmSplits WHERE txType = 'N' AND accountId IN ('%1'))")
+                           .arg(accountIds.join("', '")));
+}
+
+MyMoneyTransaction MyMoneyStorageSql::fetchTransaction(const QString& id) const
+{
+  const auto list = fetchTransactions(QString("('%1')").arg(id));
+  return list.isEmpty() ? MyMoneyTransaction() : list.first();
 }
 
 ulong MyMoneyStorageSql::transactionCount(const QString& aid) const
@@ -2112,12 +2078,12 @@ QHash<QString, ulong> MyMoneyStorageSql::transactionCountMap() const
 bool MyMoneyStorageSql::isReferencedByTransaction(const QString& id) const
 {
   Q_D(const MyMoneyStorageSql);
-  //FIXME-ALEX should I add sub query for kmmTagSplits here?
   QSqlQuery q(*const_cast <MyMoneyStorageSql*>(this));
   q.prepare("SELECT COUNT(*) FROM kmmTransactions "
             "INNER JOIN kmmSplits ON kmmTransactions.id = kmmSplits.transactionId "
             "WHERE kmmTransactions.currencyId = :ID OR kmmSplits.payeeId = :ID "
-            "OR kmmSplits.accountId = :ID OR kmmSplits.costCenterId = :ID");
+            "OR kmmSplits.accountId = :ID OR kmmSplits.costCenterId = :ID "
+            "OR kmmSplits.transactionId IN (SELECT transactionId FROM kmmTagSplits WHERE tagId = :ID)");
   q.bindValue(":ID", id);
   if ((!q.exec()) || (!q.next())) { // krazy:exclude=crashy
     d->buildError(q, Q_FUNC_INFO, "error retrieving reference count");
@@ -2662,6 +2628,110 @@ ulong MyMoneyStorageSql::getNextTransactionId() const
   return d->getNextId<&MyMoneyStorageSqlPrivate::m_hiIdTransactions>(QLatin1String("kmmTransactions"), QLatin1String("id"), 1);
 }
 
+ulong MyMoneyStorageSql::lastTransactionId() const
+{
+  return getNextTransactionId() - 1;
+}
+
+/**
+  * Provides the transactions and prices of the database to a snapshot
+  * of the storage, see MyMoneyStorageSql::readOnlyCopy(). A connection
+  * can only be used by the thread which created it, so the reader keeps
+  * the settings and opens its own connection when data is fetched first.
+  */
+class MyMoneyStorageSqlReader : public IMyMoneyStorageSource
+{
+public:
+  explicit MyMoneyStorageSqlReader(const MyMoneyStorageSql& sql) :
+    m_driverName(sql.driverName()),
+    m_databaseName(sql.databaseName()),
+    m_hostName(sql.hostName()),
+    m_userName(sql.userName()),
+    m_password(sql.password()),
+    m_connectOptions(sql.connectOptions()),
+    m_port(sql.port())
+  {
+  }
+
+  ~MyMoneyStorageSqlReader() override
+  {
+    // the reader never logged on, so it must not log off
+    if (m_sql)
+      m_sql->close(false);
+  }
+
+  QMap<QString, MyMoneyTransaction> fetchAccountTransactions(const QStringList& accountIds) const override
+  {
+    return connection()->fetchAccountTransactions(accountIds);
+  }
+
+  QMap<QString, MyMoneyTransaction> fetchTransactions(const MyMoneyTransactionFilter& filter) const override
+  {
+    return connection()->fetchTransactions(filter);
+  }
+
+  MyMoneyTransaction fetchTransaction(const QString& id) const override
+  {
+    return connection()->fetchTransaction(id);
+  }
+
+  MyMoneyPriceList fetchPrices(const QStringList& fromIdList, const QStringList& toIdList, bool forUpdate = false) const override
+  {
+    return connection()->fetchPrices(fromIdList, toIdList, forUpdate);
+  }
+
+  bool isReferencedByTransaction(const QString& id) const override
+  {
+    return connection()->isReferencedByTransaction(id);
+  }
+
+  ulong lastTransactionId() const override
+  {
+    return connection()->lastTransactionId();
+  }
+
+  IMyMoneyStorageSource* readOnlyCopy() const override
+  {
+    return connection()->readOnlyCopy();
+  }
+
+private:
+  MyMoneyStorageSql* connection() const
+  {
+    if (!m_sql) {
+      QUrlQuery query;
+      query.addQueryItem(QStringLiteral("driver"), m_driverName);
+      QUrl url;
+      url.setQuery(query);
+      std::unique_ptr<MyMoneyStorageSql> sql(new MyMoneyStorageSql(nullptr, url));
+      sql->setDatabaseName(m_databaseName);
+      sql->setHostName(m_hostName);
+      sql->setUserName(m_userName);
+      sql->setPassword(m_password);
+      sql->setConnectOptions(m_connectOptions);
+      sql->setPort(m_port);
+      if (!sql->openForReading())
+        throw MYMONEYEXCEPTION(sql->lastError());
+      m_sql = std::move(sql);
+    }
+    return m_sql.get();
+  }
+
+  const QString m_driverName;
+  const QString m_databaseName;
+  const QString m_hostName;
+  const QString m_userName;
+  const QString m_password;
+  const QString m_connectOptions;
+  const int     m_port;
+  mutable std::unique_ptr<MyMoneyStorageSql> m_sql;
+};
+
+IMyMoneyStorageSource* MyMoneyStorageSql::readOnlyCopy() const
+{
+  return new MyMoneyStorageSqlReader(*this);
+}
+
 ulong MyMoneyStorageSql::getNextOnlineJobId() const
 {
   Q_D(const MyMoneyStorageSql);
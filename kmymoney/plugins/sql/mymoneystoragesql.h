@@ -26,6 +26,7 @@
 #include <QSharedData>
 
 #include "imymoneystorageformat.h"
+#include "imymoneystoragesource.h"
 #include "mymoneyunittestable.h"
 
 // This is a convenience functor to make it easier to use STL algorithms
@@ -72,7 +73,7 @@ namespace eMyMoney { namespace TransactionFilter { enum class State; } }
   */
 
 class MyMoneyStorageSqlPrivate;
-class MyMoneyStorageSql : public IMyMoneyOperationsFormat, public QSqlDatabase, public QSharedData
+class MyMoneyStorageSql : public IMyMoneyOperationsFormat, public IMyMoneyStorageSource, public QSqlDatabase, public QSharedData
 {
   Q_DISABLE_COPY(MyMoneyStorageSql)
   friend class MyMoneyDbDef;
@@ -97,6 +98,17 @@ public:
   *
    */
   int open(const QUrl &url, int openMode, bool clear = false);
+  /**
+   * MyMoneyStorageSql - open a connection only used to read data
+   *
+   * The connection settings must have been made by the caller. Unlike
+   * open(), the tables are not checked and the user does not log on, so
+   * the database is neither locked nor changed. See readOnlyCopy().
+   *
+   * @return true if the connection has been opened
+   *
+   */
+  bool openForReading();
   /**
    * MyMoneyStorageSql close the database
    *
@@ -111,6 +123,14 @@ public:
    *
    */
   bool readFile();
+  /**
+   * Returns whether readFile() loads all transactions and prices or whether
+   * they are provided to the storage on demand, see MyMoneyStorageMgr::setSource()
+   *
+   * @return true if the whole database is read into memory
+   *
+   */
+  bool loadAll() const;
   /**
    * MyMoneyStorageSql write/update the database from storage
    *
@@ -218,7 +238,7 @@ public:
   QMap<QString, MyMoneyCostCenter> fetchCostCenters(const QStringList& idList, bool forUpdate = false) const;
   QMap<QString, MyMoneyCostCenter> fetchCostCenters() const;
 
-  MyMoneyPriceList fetchPrices(const QStringList& fromIdList, const QStringList& toIdList, bool forUpdate = false) const;
+  MyMoneyPriceList fetchPrices(const QStringList& fromIdList, const QStringList& toIdList, bool forUpdate = false) const override;
   MyMoneyPriceList fetchPrices() const;
 
   MyMoneyPrice fetchSinglePrice(const QString& fromId, const QString& toId, const QDate& date_, bool exactDate, bool = false) const;
@@ -236,13 +256,17 @@ public:
   QMap<QString, MyMoneyTransaction> fetchTransactions(const QString& tidList) const;
   QMap<QString, MyMoneyTransaction> fetchTransactions() const;
 
-  QMap<QString, MyMoneyTransaction> fetchTransactions(const MyMoneyTransactionFilter& filter) const;
+  QMap<QString, MyMoneyTransaction> fetchTransactions(const MyMoneyTransactionFilter& filter) const override;
+  QMap<QString, MyMoneyTransaction> fetchAccountTransactions(const QStringList& accountIds) const override;
+  MyMoneyTransaction fetchTransaction(const QString& id) const override;
   payeeIdentifier fetchPayeeIdentifier(const QString& id) const;
 
   QMap<QString, payeeIdentifier> fetchPayeeIdentifiers(const QStringList& idList) const;
   QMap<QString, payeeIdentifier> fetchPayeeIdentifiers() const;
 
-  bool isReferencedByTransaction(const QString& id) const;
+  bool isReferencedByTransaction(const QString& id) const override;
+  ulong lastTransactionId() const override;
+  IMyMoneyStorageSource* readOnlyCopy() const override;
 
   void readPayees(const QString&);
   void readPayees(const QList<QString>& payeeList);
@@ -38,6 +38,7 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QList>
+#include <QSet>
 #include <QSqlRecord>
 #include <QMap>
 #include <QFile>
@@ -86,23 +87,6 @@
 
 using namespace eMyMoney;
 
-class FilterFail
-{
-public:
-  explicit FilterFail(const MyMoneyTransactionFilter& filter) : m_filter(filter) {}
-
-  inline bool operator()(const QPair<QString, MyMoneyTransaction>& transactionPair) {
-    return (*this)(transactionPair.second);
-  }
-
-  inline bool operator()(const MyMoneyTransaction& transaction) {
-    return !m_filter.match(transaction);
-  }
-
-private:
-  MyMoneyTransactionFilter m_filter;
-};
-
 //*****************************************************************************
 // Create a class to handle db transactions using scope
 //
@@ -188,6 +172,9 @@ public:
 #define MYMONEYEXCEPTIONSQL(exceptionMessage) MYMONEYEXCEPTION(buildError(query, Q_FUNC_INFO, exceptionMessage))
 #define MYMONEYEXCEPTIONSQL_D(exceptionMessage) MYMONEYEXCEPTION(d->buildError(query, Q_FUNC_INFO, exceptionMessage))
 
+// number of transactions inserted with one execBatch() call into an empty database
+static const int BulkInsertCount = 1000;
+
 class MyMoneyStorageSqlPrivate
 {
   Q_DISABLE_COPY(MyMoneyStorageSqlPrivate)
@@ -511,23 +498,35 @@ public:
   {
     Q_Q(MyMoneyStorageSql);
     // first, get a list of what's on the database (see writeInstitutions)
-    QList<QString> dbList;
+    QSet<QString> dbList;
     QSqlQuery query(*q);
     query.prepare("SELECT id FROM kmmTransactions WHERE txType = 'N';");
     if (!query.exec()) throw MYMONEYEXCEPTIONSQL("building Transaction list"); // krazy:exclude=crashy
-    while (query.next()) dbList.append(query.value(0).toString());
+    while (query.next()) dbList.insert(query.value(0).toString());
 
-    MyMoneyTransactionFilter filter;
-    filter.setReportAllSplits(false);
+    // if the transactions are loaded on demand from this database, the
+    // ones not in memory are unchanged and only the removed ones are deleted
+    const bool onDemand = (m_storage->source() == q);
     QList<MyMoneyTransaction> list;
-    m_storage->transactionList(list, filter);
+    if (onDemand) {
+      list = m_storage->loadedTransactionList();
+    } else {
+      MyMoneyTransactionFilter filter;
+      filter.setReportAllSplits(false);
+      m_storage->transactionList(list, filter);
+    }
     signalProgress(0, list.count(), "Writing Transactions...");
+    // only a database created for this write is filled in batches
+    if (dbList.isEmpty() && m_newDatabase) {
+      insertTransactionList(list, "N");
+      return;
+    }
     QSqlQuery q2(*q);
     query.prepare(m_db.m_tables["kmmTransactions"].updateString());
     q2.prepare(m_db.m_tables["kmmTransactions"].insertString());
     foreach (const MyMoneyTransaction& it, list) {
       if (dbList.contains(it.id())) {
-        dbList.removeAll(it.id());
+        dbList.remove(it.id());
         writeTransaction(it.id(), it, query, "N");
       } else {
         writeTransaction(it.id(), it, q2, "N");
@@ -535,7 +534,19 @@ public:
       signalProgress(++m_transactions, 0);
     }
 
-    if (!dbList.isEmpty()) {
+    if (onDemand) {
+      foreach (const QString& it, m_storage->removedTransactionIds()) {
+        if (dbList.contains(it))
+          deleteTransaction(it);
+      }
+      // the counters only cover the transactions written above
+      query.prepare("SELECT COUNT(*) FROM kmmTransactions WHERE txType = 'N';");
+      if (!query.exec() || !query.next()) throw MYMONEYEXCEPTIONSQL("counting Transactions"); // krazy:exclude=crashy
+      m_transactions = query.value(0).toULongLong();
+      query.prepare("SELECT COUNT(*) FROM kmmSplits WHERE txType = 'N';");
+      if (!query.exec() || !query.next()) throw MYMONEYEXCEPTIONSQL("counting Splits"); // krazy:exclude=crashy
+      m_splits = query.value(0).toULongLong();
+    } else if (!dbList.isEmpty()) {
       foreach (const QString& it, dbList) {
         deleteTransaction(it);
       }
@@ -1244,9 +1255,22 @@ public:
    const QString& type,
    const QList<int>& splitIdList,
    QSqlQuery& query)
+  {
+    SplitBatch batch;
+    appendSplitList(batch, txId, splitList, type, splitIdList);
+    deleteKeyValuePairs("SPLIT", batch.kvpIdList);
+    writeSplitBatch(batch, query);
+  }
+
+  /**
+    * The column values of splits which are written to the database
+    * with a single execBatch() call, see writeSplitBatch()
+    */
+  struct SplitBatch
   {
     QVariantList txIdList;
     QVariantList typeList;
+    QVariantList splitIdList;
     QVariantList payeeIdList;
     QVariantList reconcileDateList;
     QVariantList actionList;
@@ -1265,76 +1289,291 @@ public:
     QVariantList bankIdList;
     QVariantList kvpIdList;
     QList<QMap<QString, QString> > kvpPairsList;
+    QVariantList tagIdList;
+    QVariantList tagTxIdList;
+    QVariantList tagSplitIdList;
+  };
 
+  void appendSplitList
+  (SplitBatch& batch,
+   const QString& txId,
+   const QList<MyMoneySplit>& splitList,
+   const QString& type,
+   const QList<int>& splitIdList)
+  {
     int i = 0;
     foreach (const MyMoneySplit& s, splitList) {
-      txIdList << txId;
-      typeList << type;
-      payeeIdList << s.payeeId();
+      batch.txIdList << txId;
+      batch.typeList << type;
+      batch.splitIdList << splitIdList[i];
+      batch.payeeIdList << s.payeeId();
       if (s.reconcileDate() == QDate())
-        reconcileDateList << s.reconcileDate();
+        batch.reconcileDateList << s.reconcileDate();
       else
-        reconcileDateList << s.reconcileDate().toString(Qt::ISODate);
-      actionList << s.action();
-      reconcileFlagList << (int)s.reconcileFlag();
-      valueList << s.value().toString();
-      valueFormattedList << s.value().formatMoney("", -1, false).replace(QChar(','), QChar('.'));
-      sharesList << s.shares().toString();
+        batch.reconcileDateList << s.reconcileDate().toString(Qt::ISODate);
+      batch.actionList << s.action();
+      batch.reconcileFlagList << (int)s.reconcileFlag();
+      batch.valueList << s.value().toString();
+      batch.valueFormattedList << s.value().formatMoney("", -1, false).replace(QChar(','), QChar('.'));
+      batch.sharesList << s.shares().toString();
       MyMoneyAccount acc = m_storage->account(s.accountId());
       MyMoneySecurity sec = m_storage->security(acc.currencyId());
-      sharesFormattedList << s.price().
+      batch.sharesFormattedList << s.price().
       formatMoney("", MyMoneyMoney::denomToPrec(sec.smallestAccountFraction()), false).
       replace(QChar(','), QChar('.'));
       MyMoneyMoney price = s.actualPrice();
       if (!price.isZero()) {
-        priceList << price.toString();
-        priceFormattedList << price.formatMoney
+        batch.priceList << price.toString();
+        batch.priceFormattedList << price.formatMoney
         ("", sec.pricePrecision(), false)
         .replace(QChar(','), QChar('.'));
       } else {
-        priceList << QString();
-        priceFormattedList << QString();
-      }
-      memoList << s.memo();
-      accountIdList << s.accountId();
-      costCenterIdList << s.costCenterId();
-      checkNumberList << s.number();
-      postDateList << m_txPostDate.toString(Qt::ISODate); // FIXME: when Tom puts date into split object
-      bankIdList << s.bankID();
-
-      kvpIdList << QString(txId + QString::number(splitIdList[i]));
-      kvpPairsList << s.pairs();
+        batch.priceList << QString();
+        batch.priceFormattedList << QString();
+      }
+      batch.memoList << s.memo();
+      batch.accountIdList << s.accountId();
+      batch.costCenterIdList << s.costCenterId();
+      batch.checkNumberList << s.number();
+      batch.postDateList << m_txPostDate.toString(Qt::ISODate); // FIXME: when Tom puts date into split object
+      batch.bankIdList << s.bankID();
+
+      batch.kvpIdList << QString(txId + QString::number(splitIdList[i]));
+      batch.kvpPairsList << s.pairs();
+
+      foreach (const auto tagId, s.tagIdList()) {
+        batch.tagIdList << tagId;
+        batch.tagTxIdList << txId;
+        batch.tagSplitIdList << splitIdList[i];
+      }
       ++i;
     }
+  }
 
-    query.bindValue(":transactionId", txIdList);
-    query.bindValue(":txType", typeList);
-    QVariantList iList;
-    // qCopy segfaults here, so do it with a hand-rolled loop
-    foreach (int it_s, splitIdList) {
-      iList << it_s;
+  /**
+    * Writes the splits in @a batch and their key/value pairs using @a query
+    * which is prepared with the insert or update string of kmmSplits.
+    * The tags are written separately by writeTagSplitBatch().
+    */
+  void writeSplitBatch(const SplitBatch& batch, QSqlQuery& query)
+  {
+    query.bindValue(":transactionId", batch.txIdList);
+    query.bindValue(":txType", batch.typeList);
+    query.bindValue(":splitId", batch.splitIdList);
+    query.bindValue(":payeeId", batch.payeeIdList);
+    query.bindValue(":reconcileDate", batch.reconcileDateList);
+    query.bindValue(":action", batch.actionList);
+    query.bindValue(":reconcileFlag", batch.reconcileFlagList);
+    query.bindValue(":value", batch.valueList);
+    query.bindValue(":valueFormatted", batch.valueFormattedList);
+    query.bindValue(":shares", batch.sharesList);
+    query.bindValue(":sharesFormatted", batch.sharesFormattedList);
+    query.bindValue(":price", batch.priceList);
+    query.bindValue(":priceFormatted", batch.priceFormattedList);
+    query.bindValue(":memo", batch.memoList);
+    query.bindValue(":accountId", batch.accountIdList);
+    query.bindValue(":costCenterId", batch.costCenterIdList);
+    query.bindValue(":checkNumber", batch.checkNumberList);
+    query.bindValue(":postDate", batch.postDateList);
+    query.bindValue(":bankId", batch.bankIdList);
+    if (!query.execBatch()) throw MYMONEYEXCEPTIONSQL("writing Split");
+    writeKeyValuePairs("SPLIT", batch.kvpIdList, batch.kvpPairsList);
+  }
+
+  void writeTagSplitBatch(const SplitBatch& batch)
+  {
+    Q_Q(MyMoneyStorageSql);
+    if (batch.tagIdList.isEmpty())
+      return;
+    QSqlQuery query(*q);
+    query.prepare(m_db.m_tables["kmmTagSplits"].insertString());
+    query.bindValue(":tagId", batch.tagIdList);
+    query.bindValue(":splitId", batch.tagSplitIdList);
+    query.bindValue(":transactionId", batch.tagTxIdList);
+    if (!query.execBatch()) throw MYMONEYEXCEPTIONSQL("writing tagSplits");
+  }
+
+  /**
+    * Inserts the transactions in @a list, which must not exist in the
+    * database yet. Instead of a few statements per transaction, the
+    * transactions, splits, tags and key/value pairs of BulkInsertCount
+    * transactions are inserted with one execBatch() call per table.
+    */
+  void insertTransactionList(const QList<MyMoneyTransaction>& list, const QString& type)
+  {
+    Q_Q(MyMoneyStorageSql);
+    QSqlQuery query(*q);
+    QSqlQuery splitQuery(*q);
+    query.prepare(m_db.m_tables["kmmTransactions"].insertString());
+    splitQuery.prepare(m_db.m_tables["kmmSplits"].insertString());
+
+    for (auto first = 0; first < list.count(); first += BulkInsertCount) {
+      QVariantList idList;
+      QVariantList typeList;
+      QVariantList postDateList;
+      QVariantList memoList;
+      QVariantList entryDateList;
+      QVariantList currencyIdList;
+      QVariantList bankIdList;
+      QList<QMap<QString, QString> > kvpPairsList;
+      SplitBatch batch;
+
+      const auto last = qMin(first + BulkInsertCount, list.count());
+      for (auto i = first; i < last; ++i) {
+        const auto& tx = list.at(i);
+        idList << tx.id();
+        typeList << type;
+        postDateList << tx.postDate().toString(Qt::ISODate);
+        memoList << tx.memo();
+        entryDateList << tx.entryDate().toString(Qt::ISODate);
+        currencyIdList << tx.commodity();
+        bankIdList << tx.bankID();
+        kvpPairsList << tx.pairs();
+
+        m_txPostDate = tx.postDate(); // FIXME: TEMP till Tom puts date in split object
+        const auto splitList = tx.splits();
+        QList<int> splitIdList;
+        for (auto splitId = 0; splitId < splitList.count(); ++splitId)
+          splitIdList << splitId;
+        appendSplitList(batch, tx.id(), splitList, type, splitIdList);
+      }
+
+      query.bindValue(":id", idList);
+      query.bindValue(":txType", typeList);
+      query.bindValue(":postDate", postDateList);
+      query.bindValue(":memo", memoList);
+      query.bindValue(":entryDate", entryDateList);
+      query.bindValue(":currencyId", currencyIdList);
+      query.bindValue(":bankId", bankIdList);
+      if (!query.execBatch()) throw MYMONEYEXCEPTIONSQL("writing Transaction");
+      writeKeyValuePairs("TRANSACTION", idList, kvpPairsList);
+
+      writeSplitBatch(batch, splitQuery);
+      writeTagSplitBatch(batch);
+
+      m_transactions += idList.count();
+      m_splits += batch.txIdList.count();
+      signalProgress(m_transactions, 0);
     }
+    m_hiIdTransactions = 0;
+  }
 
-    query.bindValue(":splitId", iList);
-    query.bindValue(":payeeId", payeeIdList);
-    query.bindValue(":reconcileDate", reconcileDateList);
-    query.bindValue(":action", actionList);
-    query.bindValue(":reconcileFlag", reconcileFlagList);
-    query.bindValue(":value", valueList);
-    query.bindValue(":valueFormatted", valueFormattedList);
-    query.bindValue(":shares", sharesList);
-    query.bindValue(":sharesFormatted", sharesFormattedList);
-    query.bindValue(":price", priceList);
-    query.bindValue(":priceFormatted", priceFormattedList);
-    query.bindValue(":memo", memoList);
-    query.bindValue(":accountId", accountIdList);
-    query.bindValue(":costCenterId", costCenterIdList);
-    query.bindValue(":checkNumber", checkNumberList);
-    query.bindValue(":postDate", postDateList);
-    query.bindValue(":bankId", bankIdList);
-    if (!query.execBatch()) throw MYMONEYEXCEPTIONSQL("writing Split");
-    deleteKeyValuePairs("SPLIT", kvpIdList);
-    writeKeyValuePairs("SPLIT", kvpIdList, kvpPairsList);
+  /**
+    * Switches the database into the driver specific mode for writing a
+    * large amount of data into a freshly created database while it
+    * exists. The settings active before are restored by restore() or on
+    * destruction at the latest, because the connection stays in use after
+    * the data has been written. Some settings cannot be changed within a
+    * commit unit, so the object must outlive the MyMoneyDbTransaction
+    * writing the data.
+    */
+  class BulkLoadMode
+  {
+  public:
+    BulkLoadMode(MyMoneyStorageSqlPrivate* d, bool enable) : m_d(d)
+    {
+      if (!enable)
+        return;
+      const auto settings = d->m_driver->bulkLoadSettings();
+      m_previous = d->readSettings(settings.keys());
+      try {
+        d->writeSettings(settings);
+      } catch (const MyMoneyException &) {
+        restore();
+        throw;
+      }
+    }
+
+    ~BulkLoadMode()
+    {
+      restore();
+    }
+
+    /**
+      * Restores the settings active before.
+      *
+      * @retval true   the settings were restored or never changed
+      * @retval false  the settings could not be restored, the reason
+      *                is available through lastError()
+      */
+    bool restore()
+    {
+      if (m_previous.isEmpty())
+        return true;
+      const auto previous = m_previous;
+      m_previous.clear();
+      try {
+        m_d->writeSettings(previous);
+      } catch (const MyMoneyException &e) {
+        qWarning() << "Restoring the database settings failed:" << e.what();
+        m_d->m_error = QString::fromLatin1(e.what());
+        return false;
+      }
+      return true;
+    }
+
+  private:
+
+    MyMoneyStorageSqlPrivate* m_d;
+    QMap<QString, QString> m_previous;
+  };
+
+  QMap<QString, QString> readSettings(const QStringList& names)
+  {
+    Q_Q(MyMoneyStorageSql);
+    QSqlQuery query(*q);
+    QMap<QString, QString> settings;
+    foreach (const auto& name, names) {
+      if (!query.exec(m_driver->settingQueryString(name)) || !query.next())
+        throw MYMONEYEXCEPTIONSQL(QString::fromLatin1("reading setting %1").arg(name)); // krazy:exclude=crashy
+      settings[name] = query.value(0).toString();
+    }
+    return settings;
+  }
+
+  void writeSettings(const QMap<QString, QString>& settings)
+  {
+    Q_Q(MyMoneyStorageSql);
+    QSqlQuery query(*q);
+    for (auto it = settings.constBegin(); it != settings.constEnd(); ++it) {
+      if (!query.exec(m_driver->settingUpdateString(it.key(), it.value())))
+        throw MYMONEYEXCEPTIONSQL(QString::fromLatin1("changing setting %1").arg(it.key())); // krazy:exclude=crashy
+    }
+  }
+
+  /**
+    * Drops the indexes of the tables receiving most of the rows, so that
+    * they are built once by createBulkLoadIndexes() after all rows are written
+    */
+  void dropBulkLoadIndexes()
+  {
+    Q_Q(MyMoneyStorageSql);
+    QSqlQuery query(*q);
+    foreach (const auto& tableName, bulkLoadTables()) {
+      const MyMoneyDbTable& t = m_db.m_tables[tableName];
+      for (MyMoneyDbTable::index_iterator i = t.indexBegin(); i != t.indexEnd(); ++i) {
+        if (!query.exec(m_driver->dropIndexString(t.name(), t.name() + '_' + i->name() + "_idx")))
+          throw MYMONEYEXCEPTIONSQL(QString::fromLatin1("dropping index from %1").arg(t.name())); // krazy:exclude=crashy
+      }
+    }
+  }
+
+  void createBulkLoadIndexes()
+  {
+    Q_Q(MyMoneyStorageSql);
+    QSqlQuery query(*q);
+    foreach (const auto& tableName, bulkLoadTables()) {
+      const MyMoneyDbTable& t = m_db.m_tables[tableName];
+      for (MyMoneyDbTable::index_iterator i = t.indexBegin(); i != t.indexEnd(); ++i) {
+        if (!query.exec((*i).generateDDL(m_driver)))
+          throw MYMONEYEXCEPTIONSQL(QString::fromLatin1("creating index on %1").arg(t.name())); // krazy:exclude=crashy
+      }
+    }
+  }
+
+  static QStringList bulkLoadTables()
+  {
+    return QStringList() << QLatin1String("kmmTransactions") << QLatin1String("kmmSplits") << QLatin1String("kmmTagSplits") << QLatin1String("kmmKeyValuePairs");
   }
 
   void writeSchedule(const MyMoneySchedule& sch, QSqlQuery& query, bool insert)
@@ -1962,6 +2201,132 @@ public:
     return rc;
   }
 
+  /**
+   * @return the SQL list "('a', 'b')" of the ids in @a list
+   */
+  static QString sqlList(const QStringList& list)
+  {
+    return QString("('%1')").arg(list.join("', '"));
+  }
+
+  /**
+   * @return all accounts of the storage including the standard accounts
+   */
+  QList<MyMoneyAccount> allAccounts() const
+  {
+    QList<MyMoneyAccount> accounts;
+    m_storage->accountList(accounts);
+    accounts << m_storage->asset() << m_storage->liability() << m_storage->expense() << m_storage->income() << m_storage->equity();
+    return accounts;
+  }
+
+  /**
+   * Returns the condition on kmmSplits for the split states in @a states
+   * of a MyMoneyTransactionFilter. Unknown reconcile flags are treated
+   * as not reconciled, just like MyMoneyTransactionFilter::splitState() does.
+   */
+  QString stateFilterClause(const QList<int>& states) const
+  {
+    const QList<TransactionFilter::State> known = {
+      TransactionFilter::State::NotReconciled,
+      TransactionFilter::State::Cleared,
+      TransactionFilter::State::Reconciled,
+      TransactionFilter::State::Frozen
+    };
+
+    QStringList flags;
+    if (states.contains((int)TransactionFilter::State::NotReconciled)) {
+      for (const auto state : known) {
+        if (!states.contains((int)state))
+          flags << QString::number(splitState(state));
+      }
+      return flags.isEmpty() ? QString() : QString("reconcileFlag NOT IN %1").arg(sqlList(flags));
+    }
+
+    for (const auto state : known) {
+      if (states.contains((int)state))
+        flags << QString::number(splitState(state));
+    }
+    return flags.isEmpty() ? QString("1 = 0") : QString("reconcileFlag IN %1").arg(sqlList(flags));
+  }
+
+  /**
+   * Returns the condition on kmmSplits for the transaction types in @a types
+   * of a MyMoneyTransactionFilter. Splits of income and expense accounts only
+   * match the type All, the others any of the remaining types.
+   */
+  QString typeFilterClause(const QList<int>& types) const
+  {
+    QStringList categories;
+    foreach (const auto account, allAccounts()) {
+      if (account.isIncomeExpense())
+        categories << account.id();
+    }
+
+    QStringList clauses;
+    if (types.contains((int)TransactionFilter::Type::All) && !categories.isEmpty())
+      clauses << QString("accountId IN %1").arg(sqlList(categories));
+
+    auto others = types;
+    others.removeAll((int)TransactionFilter::Type::All);
+    if (!others.isEmpty()) {
+      QStringList conditions;
+      if (!categories.isEmpty())
+        conditions << QString("accountId NOT IN %1").arg(sqlList(categories));
+      // deposits have a positive value
+      if (others == QList<int>({(int)TransactionFilter::Type::Deposits}))
+        conditions << "value NOT LIKE '-%'";
+      clauses << (conditions.isEmpty() ? QString("1 = 1") : QString("(%1)").arg(conditions.join(" AND ")));
+    }
+    return clauses.isEmpty() ? QString("1 = 0") : QString("(%1)").arg(clauses.join(" OR "));
+  }
+
+  /**
+   * Returns the condition on kmmSplits for the text filter @a exp or an
+   * empty string, if it cannot be checked by the database. Only plain
+   * words are supported, as they cannot be part of a formatted amount or
+   * an id. The names of accounts, payees and tags are matched here using
+   * @a exp, the memo and the number are compared case insensitively
+   * by the database.
+   */
+  QString textFilterClause(const QRegExp& exp) const
+  {
+    const auto text = exp.pattern();
+    if (!QRegExp(QLatin1String("[A-Za-z ]*[A-Za-z][A-Za-z ]*")).exactMatch(text))
+      return QString();
+
+    const auto pattern = text.toLower();
+    QStringList clauses;
+    clauses << QString("LOWER(memo) LIKE '%%1%'").arg(pattern);
+    clauses << QString("LOWER(checkNumber) LIKE '%%1%'").arg(pattern);
+
+    QStringList ids;
+    foreach (const auto account, allAccounts()) {
+      if (account.name().contains(exp))
+        ids << account.id();
+    }
+    if (!ids.isEmpty())
+      clauses << QString("accountId IN %1").arg(sqlList(ids));
+
+    ids.clear();
+    foreach (const auto payee, m_storage->payeeList()) {
+      if (payee.name().contains(exp))
+        ids << payee.id();
+    }
+    if (!ids.isEmpty())
+      clauses << QString("payeeId IN %1").arg(sqlList(ids));
+
+    ids.clear();
+    foreach (const auto tag, m_storage->tagList()) {
+      if (tag.name().contains(exp))
+        ids << tag.id();
+    }
+    if (!ids.isEmpty())
+      clauses << QString("EXISTS (SELECT 1 FROM kmmTagSplits WHERE kmmTagSplits.transactionId = kmmSplits.transactionId AND kmmTagSplits.splitId = kmmSplits.splitId AND tagId IN %1)").arg(sqlList(ids));
+
+    return QString("(%1)").arg(clauses.join(" OR "));
+  }
+
   QDate getDate(const QString& date) const
   {
     return (date.isNull() ? QDate() : QDate::fromString(date, Qt::ISODate));
@@ -2172,6 +2537,10 @@ public:
           if ((rc = upgradeToV12()) != 0) return (1);
           ++m_dbVersion;
           break;
+        case 12:
+          if ((rc = upgradeToV13()) != 0) return (1);
+          ++m_dbVersion;
+          break;
         default:
           qWarning("Unknown version number in database - %d", m_dbVersion);
       }
@@ -2530,6 +2899,32 @@ public:
     return 0;
   }
 
+  int upgradeToV13()
+  {
+    Q_Q(MyMoneyStorageSql);
+    MyMoneyDbTransaction dbtrans(*q, Q_FUNC_INFO);
+    QSqlQuery query(*q);
+
+    // add the indexes used to search for transactions
+    const QList<QPair<QString, QString> > indexes = {
+      qMakePair(QString("kmmTransactions"), QString("kmmTransactionspostDate")),
+      qMakePair(QString("kmmSplits"), QString("kmmSplitspayee")),
+      qMakePair(QString("kmmTagSplits"), QString("kmmTagSplitstag"))
+    };
+    for (const auto& index : indexes) {
+      const MyMoneyDbTable& t = m_db.m_tables[index.first];
+      for (MyMoneyDbTable::index_iterator i = t.indexBegin(); i != t.indexEnd(); ++i) {
+        if (i->name() != index.second)
+          continue;
+        if (!query.exec(i->generateDDL(m_driver) + ';')) {
+          buildError(query, Q_FUNC_INFO, QString("Error adding index %1 to %2").arg(index.second, index.first));
+          return 1;
+        }
+      }
+    }
+    return 0;
+  }
+
   int createTables()
   {
     Q_Q(MyMoneyStorageSql);
@@ -59,6 +59,9 @@
 
 using namespace Icons;
 
+// number of transactions kept in memory when they are loaded on demand
+static const uint TransactionCacheSize = 50000;
+
 QUrlQuery SQLStorage::convertOldUrl(const QUrl& url)
 {
   const auto key = QLatin1String("driver");
@@ -196,6 +199,9 @@ MyMoneyStorageMgr *SQLStorage::open(const QUrl &url)
     return nullptr;
   }
 //  reader->setProgressCallback(0);
+  // keep the connection to provide the transactions and prices on demand
+  if (!reader->loadAll())
+    storage->setSource(reader.release(), TransactionCacheSize);
   return storage;
 }
 
@@ -211,8 +217,15 @@ bool SQLStorage::save(const QUrl &url)
     KMessageBox::error(nullptr, i18n("Tried to access a file when it has not been opened"));
     return (rc);
   }
-  auto writer = new MyMoneyStorageSql(MyMoneyFile::instance()->storage(), url);
-  writer->open(url, QIODevice::ReadWrite);
+  auto storage = MyMoneyFile::instance()->storage();
+  // the database providing the data on demand keeps the user
+  // logged on, so it needs to write the changes itself
+  auto writer = dynamic_cast<MyMoneyStorageSql*>(storage->source());
+  const auto ownWriter = !writer || url != dbUrl;
+  if (ownWriter) {
+    writer = new MyMoneyStorageSql(storage, url);
+    writer->open(url, QIODevice::ReadWrite);
+  }
 //  writer->setProgressCallback(&KMyMoneyView::progressCallback);
   if (!writer->writeFile()) {
     KMessageBox::detailedError(nullptr,
@@ -225,7 +238,8 @@ bool SQLStorage::save(const QUrl &url)
     rc = true;
   }
   writer->setProgressCallback(0);
-  delete writer;
+  if (ownWriter)
+    delete writer;
   return rc;
 }
 
@@ -0,0 +1,326 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mymoneystoragesql-test.h"
+
+#include <memory>
+
+#include <QtTest>
+#include <QColor>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+#include "../mymoneystoragesql.h"
+#include "mymoneystoragemgr.h"
+#include "mymoneyfile.h"
+#include "mymoneyaccount.h"
+#include "mymoneysplit.h"
+#include "mymoneytag.h"
+#include "mymoneytransaction.h"
+#include "mymoneytransactionfilter.h"
+#include "mymoneymoney.h"
+#include "mymoneyenums.h"
+#include "misc/platformtools.h"
+
+QTEST_GUILESS_MAIN(MyMoneyStorageSqlTest)
+
+/**
+  * Returns a storage with @a count transactions, each with two splits.
+  * Every tenth transaction carries a key/value pair and a tag.
+  */
+static MyMoneyStorageMgr* storageWithTransactions(int count)
+{
+  const QDate start(2000, 1, 1);
+  const QString tagId(QStringLiteral("G000001"));
+  QMap<QString, MyMoneyTransaction> map;
+  for (auto i = 0; i < count; ++i) {
+    MyMoneyTransaction t;
+    t.setPostDate(start.addDays(i / 10));
+    t.setEntryDate(start.addDays(i / 10));
+    t.setMemo(QString::fromLatin1("Transaction %1").arg(i));
+    t.setCommodity(QStringLiteral("USD"));
+    if (i % 10 == 0)
+      t.setValue(QStringLiteral("key"), QString::number(i));
+
+    MyMoneySplit s;
+    s.setAccountId(MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Asset));
+    s.setShares(MyMoneyMoney(i, 100));
+    s.setValue(MyMoneyMoney(i, 100));
+    if (i % 10 == 0)
+      s.setTagIdList(QList<QString>() << tagId);
+    t.addSplit(s);
+
+    s.clearId();
+    s.setTagIdList(QList<QString>());
+    s.setAccountId(MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Expense));
+    s.setShares(MyMoneyMoney(-i, 100));
+    s.setValue(MyMoneyMoney(-i, 100));
+    t.addSplit(s);
+
+    MyMoneyTransaction transaction(QString::fromLatin1("T%1").arg(i + 1, 18, 10, QLatin1Char('0')), t);
+    map[transaction.uniqueSortKey()] = transaction;
+  }
+
+  auto storage = new MyMoneyStorageMgr;
+  QMap<QString, MyMoneyTag> tags;
+  tags[tagId] = MyMoneyTag(tagId, MyMoneyTag(QStringLiteral("Tag"), QColor()));
+  storage->loadTags(tags);
+  storage->loadTransactions(map);
+  return storage;
+}
+
+QUrl MyMoneyStorageSqlTest::databaseUrl(const QString& fileName) const
+{
+  return QUrl(QString::fromLatin1("sql://%1@localhost/%2?driver=QSQLITE&mode=single&options=loadAll").arg(platformTools::osUsername(), fileName));
+}
+
+bool MyMoneyStorageSqlTest::saveAsDatabase(MyMoneyStorageMgr* storage, const QUrl& url)
+{
+  MyMoneyFile::instance()->attachStorage(storage);
+  auto writer = std::make_unique<MyMoneyStorageSql>(storage, url);
+  auto rc = (writer->open(url, QIODevice::WriteOnly, true) == 0) && writer->writeFile();
+  writer.reset();
+  MyMoneyFile::instance()->detachStorage(storage);
+  return rc;
+}
+
+void MyMoneyStorageSqlTest::initTestCase()
+{
+  if (!QSqlDatabase::drivers().contains(QStringLiteral("QSQLITE")))
+    QSKIP("SQLite driver not available", SkipAll);
+}
+
+void MyMoneyStorageSqlTest::testSaveAsDatabase()
+{
+  QTemporaryDir dir;
+  const auto url = databaseUrl(dir.filePath(QStringLiteral("save-as.sqlite")));
+  QScopedPointer<MyMoneyStorageMgr> storage(storageWithTransactions(2500));
+  QVERIFY(saveAsDatabase(storage.data(), url));
+
+  MyMoneyStorageMgr loaded;
+  {
+    auto reader = std::make_unique<MyMoneyStorageSql>(&loaded, url);
+    QCOMPARE(reader->open(url, QIODevice::ReadWrite), 0);
+    QVERIFY(reader->readFile());
+
+    // the indexes dropped while writing exist again
+    QSqlQuery query(*reader);
+    QVERIFY(query.exec(QStringLiteral("SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND name IN ('kmmSplits_kmmSplitsaccount_type_idx', 'kmmKeyValuePairs_type_id_idx');")));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 2);
+  }
+
+  QCOMPARE(loaded.transactionCount(QString()), 2500u);
+  foreach (const auto id, QStringList() << QStringLiteral("T000000000000000001") << QStringLiteral("T000000000000001234")) {
+    const auto expected = storage->transaction(id);
+    const auto t = loaded.transaction(id);
+    QCOMPARE(t.postDate(), expected.postDate());
+    QCOMPARE(t.memo(), expected.memo());
+    QCOMPARE(t.pairs(), expected.pairs());
+    QCOMPARE(t.splitCount(), 2u);
+    for (auto i = 0; i < 2; ++i) {
+      QCOMPARE(t.splits().at(i).accountId(), expected.splits().at(i).accountId());
+      QCOMPARE(t.splits().at(i).value(), expected.splits().at(i).value());
+      QCOMPARE(t.splits().at(i).tagIdList(), expected.splits().at(i).tagIdList());
+    }
+  }
+}
+
+void MyMoneyStorageSqlTest::testSaveExistingDatabase()
+{
+  QTemporaryDir dir;
+  const auto url = databaseUrl(dir.filePath(QStringLiteral("existing.sqlite")));
+  QScopedPointer<MyMoneyStorageMgr> storage(storageWithTransactions(100));
+  QVERIFY(saveAsDatabase(storage.data(), url));
+
+  // a database which contains transactions is updated row by row
+  auto t = storage->transaction(QStringLiteral("T000000000000000010"));
+  t.setMemo(QStringLiteral("Changed"));
+  storage->startTransaction();
+  storage->modifyTransaction(t);
+  storage->removeTransaction(storage->transaction(QStringLiteral("T000000000000000020")));
+  storage->commitTransaction();
+
+  MyMoneyFile::instance()->attachStorage(storage.data());
+  {
+    auto writer = std::make_unique<MyMoneyStorageSql>(storage.data(), url);
+    QCOMPARE(writer->open(url, QIODevice::ReadWrite), 0);
+    QVERIFY(writer->writeFile());
+  }
+  MyMoneyFile::instance()->detachStorage(storage.data());
+
+  MyMoneyStorageMgr loaded;
+  {
+    auto reader = std::make_unique<MyMoneyStorageSql>(&loaded, url);
+    QCOMPARE(reader->open(url, QIODevice::ReadWrite), 0);
+    QVERIFY(reader->readFile());
+  }
+  QCOMPARE(loaded.transactionCount(QString()), 99u);
+  QCOMPARE(loaded.transaction(QStringLiteral("T000000000000000010")).memo(), QStringLiteral("Changed"));
+}
+
+void MyMoneyStorageSqlTest::testBulkLoadRestoresSettings()
+{
+  QTemporaryDir dir;
+  const auto url = databaseUrl(dir.filePath(QStringLiteral("settings.sqlite")));
+  QScopedPointer<MyMoneyStorageMgr> storage(storageWithTransactions(100));
+
+  MyMoneyFile::instance()->attachStorage(storage.data());
+  {
+    auto writer = std::make_unique<MyMoneyStorageSql>(storage.data(), url);
+    QCOMPARE(writer->open(url, QIODevice::WriteOnly, true), 0);
+
+    QSqlQuery query(*writer);
+    QVERIFY(query.exec(QStringLiteral("PRAGMA journal_mode = WAL;")));
+    QVERIFY(query.exec(QStringLiteral("PRAGMA synchronous = NORMAL;")));
+    QVERIFY(query.exec(QStringLiteral("PRAGMA cache_size = -1234;")));
+    QVERIFY(writer->writeFile());
+
+    // the settings used for writing in bulk are not kept
+    QVERIFY(query.exec(QStringLiteral("PRAGMA journal_mode;")) && query.next());
+    QCOMPARE(query.value(0).toString(), QStringLiteral("wal"));
+    QVERIFY(query.exec(QStringLiteral("PRAGMA synchronous;")) && query.next());
+    QCOMPARE(query.value(0).toInt(), 1);
+    QVERIFY(query.exec(QStringLiteral("PRAGMA cache_size;")) && query.next());
+    QCOMPARE(query.value(0).toInt(), -1234);
+  }
+  MyMoneyFile::instance()->detachStorage(storage.data());
+}
+
+void MyMoneyStorageSqlTest::testReadOnlyCopy()
+{
+  QTemporaryDir dir;
+  const auto url = databaseUrl(dir.filePath(QStringLiteral("copy.sqlite")));
+  QScopedPointer<MyMoneyStorageMgr> storage(storageWithTransactions(100));
+  QVERIFY(saveAsDatabase(storage.data(), url));
+
+  MyMoneyStorageMgr loaded;
+  auto reader = std::make_unique<MyMoneyStorageSql>(&loaded, url);
+  QCOMPARE(reader->open(url, QIODevice::ReadWrite), 0);
+  MyMoneyFile::instance()->attachStorage(&loaded);
+
+  // the copy opens a connection of its own when data is fetched
+  std::unique_ptr<IMyMoneyStorageSource> copy(reader->readOnlyCopy());
+  const auto expense = MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Expense);
+  QCOMPARE(copy->fetchAccountTransactions(QStringList(expense)).count(), 100);
+  QCOMPARE(copy->fetchTransaction(QStringLiteral("T000000000000000042")).memo(), QStringLiteral("Transaction 41"));
+  copy.reset();
+
+  MyMoneyFile::instance()->detachStorage(&loaded);
+
+  // the user of the original connection is still logged on
+  QSqlQuery query(*reader);
+  QVERIFY(query.exec(QStringLiteral("SELECT logonUser FROM kmmFileInfo;")) && query.next());
+  QVERIFY(!query.value(0).toString().isEmpty());
+}
+
+void MyMoneyStorageSqlTest::testFetchTransactionsFilter_data()
+{
+  QTest::addColumn<MyMoneyTransactionFilter>("filter");
+  QTest::addColumn<int>("fetched");
+  QTest::addColumn<int>("matched");
+
+  MyMoneyTransactionFilter filter;
+  filter.setDateFilter(QDate(2000, 1, 5), QDate(2000, 1, 10));
+  QTest::newRow("date") << filter << 60 << 60;
+
+  filter = MyMoneyTransactionFilter();
+  filter.addTag(QStringLiteral("G000001"));
+  QTest::newRow("tag") << filter << 250 << 250;
+
+  filter = MyMoneyTransactionFilter();
+  filter.setAmountFilter(MyMoneyMoney(1000, 100), MyMoneyMoney(1050, 100));
+  QTest::newRow("amount") << filter << 51 << 51;
+
+  filter = MyMoneyTransactionFilter();
+  filter.setTextFilter(QRegExp(QStringLiteral("Tag")));
+  QTest::newRow("text") << filter << 250 << 250;
+
+  filter = MyMoneyTransactionFilter();
+  filter.addState((int)eMyMoney::TransactionFilter::State::Cleared);
+  QTest::newRow("state") << filter << 0 << 0;
+
+  // the database cannot exclude deposits with a value of zero
+  filter = MyMoneyTransactionFilter();
+  filter.addType((int)eMyMoney::TransactionFilter::Type::Deposits);
+  QTest::newRow("type") << filter << 2500 << 2499;
+
+  filter = MyMoneyTransactionFilter();
+  filter.setDateFilter(QDate(2000, 1, 1), QDate(2000, 3, 10));
+  filter.addTag(QStringLiteral("G000001"));
+  filter.setAmountFilter(MyMoneyMoney(0, 100), MyMoneyMoney(200, 100));
+  QTest::newRow("combined") << filter << 21 << 21;
+}
+
+void MyMoneyStorageSqlTest::testFetchTransactionsFilter()
+{
+  QFETCH(MyMoneyTransactionFilter, filter);
+  QFETCH(int, fetched);
+  QFETCH(int, matched);
+
+  QTemporaryDir dir;
+  const auto url = databaseUrl(dir.filePath(QStringLiteral("filter.sqlite")));
+  QScopedPointer<MyMoneyStorageMgr> storage(storageWithTransactions(2500));
+  QVERIFY(saveAsDatabase(storage.data(), url));
+
+  MyMoneyStorageMgr loaded;
+  auto reader = std::make_unique<MyMoneyStorageSql>(&loaded, url);
+  QCOMPARE(reader->open(url, QIODevice::ReadWrite), 0);
+  QVERIFY(reader->readFile());
+  MyMoneyFile::instance()->attachStorage(&loaded);
+
+  // the database returns a superset of the matching transactions
+  const auto list = reader->fetchTransactions(filter);
+  QStringList ids;
+  foreach (auto transaction, list) {
+    if (filter.match(transaction))
+      ids << transaction.id();
+  }
+
+  MyMoneyTransactionFilter all;
+  QStringList expected;
+  foreach (const auto transaction, loaded.transactionList(all)) {
+    if (filter.match(transaction))
+      expected << transaction.id();
+  }
+
+  MyMoneyFile::instance()->detachStorage(&loaded);
+
+  QCOMPARE(list.count(), fetched);
+  QCOMPARE(ids.count(), matched);
+  QCOMPARE(ids, expected);
+}
+
+void MyMoneyStorageSqlTest::benchmarkSaveAsDatabase_data()
+{
+  QTest::addColumn<int>("count");
+
+  QTest::newRow("10000 transactions") << 10000;
+  QTest::newRow("50000 transactions") << 50000;
+}
+
+void MyMoneyStorageSqlTest::benchmarkSaveAsDatabase()
+{
+  QFETCH(int, count);
+
+  QScopedPointer<MyMoneyStorageMgr> storage(storageWithTransactions(count));
+  QTemporaryDir dir;
+  auto run = 0;
+  QBENCHMARK {
+    const auto url = databaseUrl(dir.filePath(QString::fromLatin1("benchmark%1.sqlite").arg(++run)));
+    QVERIFY(saveAsDatabase(storage.data(), url));
+  }
+}
@@ -0,0 +1,44 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MYMONEYSTORAGESQLTEST_H
+#define MYMONEYSTORAGESQLTEST_H
+
+#include <QObject>
+#include <QUrl>
+
+class MyMoneyStorageMgr;
+
+class MyMoneyStorageSqlTest : public QObject
+{
+  Q_OBJECT
+
+private:
+  QUrl databaseUrl(const QString& fileName) const;
+  bool saveAsDatabase(MyMoneyStorageMgr* storage, const QUrl& url);
+
+private Q_SLOTS:
+  void initTestCase();
+  void testSaveAsDatabase();
+  void testSaveExistingDatabase();
+  void testBulkLoadRestoresSettings();
+  void testReadOnlyCopy();
+  void testFetchTransactionsFilter_data();
+  void testFetchTransactionsFilter();
+  void benchmarkSaveAsDatabase_data();
+  void benchmarkSaveAsDatabase();
+};
+
+#endif
@@ -19,6 +19,8 @@
 
 #include "listtable.h"
 
+#include <algorithm>
+
 // ----------------------------------------------------------------------------
 // QT Includes
 
@@ -42,13 +44,12 @@
 #include "mymoneysplit.h"
 #include "mymoneytransaction.h"
 #include "mymoneyreport.h"
-#include "kmymoneysettings.h"
 #include "mymoneyenums.h"
 
 namespace reports
 {
 
-QVector<ListTable::cellTypeE> ListTable::TableRow::m_sortCriteria;
+thread_local QVector<ListTable::cellTypeE> ListTable::TableRow::m_sortCriteria;
 
 // ****************************************************************************
 //
@@ -56,14 +57,148 @@ QVector<ListTable::cellTypeE> ListTable::TableRow::m_sortCriteria;
 //
 // ****************************************************************************
 
+QString ListTable::TableCell::toString() const
+{
+  switch (m_type) {
+    case Text:
+      return m_text;
+    case Money:
+      return m_money.toString();
+    case Date:
+      return QDate::fromJulianDay(m_number).toString(Qt::ISODate);
+    case Number:
+      return QString::number(m_number);
+    default:
+      break;
+  }
+  return QString();
+}
+
+MyMoneyMoney ListTable::TableCell::toMoney() const
+{
+  switch (m_type) {
+    case Text:
+      return MyMoneyMoney(m_text);
+    case Money:
+      return m_money;
+    case Number:
+      return MyMoneyMoney(m_number, 1);
+    default:
+      break;
+  }
+  return MyMoneyMoney();
+}
+
+QDate ListTable::TableCell::toDate() const
+{
+  switch (m_type) {
+    case Text:
+      return QDate::fromString(m_text, Qt::ISODate);
+    case Date:
+      return QDate::fromJulianDay(m_number);
+    default:
+      break;
+  }
+  return QDate();
+}
+
+int ListTable::TableCell::toInt() const
+{
+  switch (m_type) {
+    case Text:
+      return m_text.toInt();
+    case Number:
+      return m_number;
+    default:
+      break;
+  }
+  return 0;
+}
+
+bool ListTable::TableCell::operator< (const TableCell& _compare) const
+{
+  if (m_type != _compare.m_type)
+    return toString() < _compare.toString();
+
+  switch (m_type) {
+    case Text:
+      return m_text < _compare.m_text;
+    case Money:
+      return m_money < _compare.m_money;
+    case Date:
+    case Number:
+      return m_number < _compare.m_number;
+    default:
+      break;
+  }
+  return false;
+}
+
+bool ListTable::TableCell::operator== (const TableCell& _compare) const
+{
+  if (m_type != _compare.m_type)
+    return toString() == _compare.toString();
+
+  switch (m_type) {
+    case Text:
+      return m_text == _compare.m_text;
+    case Money:
+      return m_money == _compare.m_money;
+    case Date:
+    case Number:
+      return m_number == _compare.m_number;
+    default:
+      break;
+  }
+  return true;
+}
+
+static bool lessThanCellType(const QPair<ListTable::cellTypeE, ListTable::TableCell>& cell, ListTable::cellTypeE cellType)
+{
+  return cell.first < cellType;
+}
+
+const ListTable::TableCell& ListTable::TableRow::cell(cellTypeE cellType) const
+{
+  static const TableCell emptyCell;
+  const auto it = std::lower_bound(m_cells.constBegin(), m_cells.constEnd(), cellType, lessThanCellType);
+  if (it != m_cells.constEnd() && (*it).first == cellType)
+    return (*it).second;
+  return emptyCell;
+}
+
+void ListTable::TableRow::set(cellTypeE cellType, const TableCell& cell)
+{
+  const auto it = std::lower_bound(m_cells.begin(), m_cells.end(), cellType, lessThanCellType);
+  if (it != m_cells.end() && (*it).first == cellType)
+    (*it).second = cell;
+  else
+    m_cells.insert(it, qMakePair(cellType, cell));
+}
+
+void ListTable::TableRow::remove(cellTypeE cellType)
+{
+  const auto it = std::lower_bound(m_cells.begin(), m_cells.end(), cellType, lessThanCellType);
+  if (it != m_cells.end() && (*it).first == cellType)
+    m_cells.erase(it);
+}
+
+bool ListTable::TableRow::contains(cellTypeE cellType) const
+{
+  const auto it = std::lower_bound(m_cells.constBegin(), m_cells.constEnd(), cellType, lessThanCellType);
+  return it != m_cells.constEnd() && (*it).first == cellType;
+}
+
 bool ListTable::TableRow::operator< (const TableRow& _compare) const
 {
   bool result = false;
   foreach (const auto criterion, m_sortCriteria) {
-    if (this->operator[](criterion) < _compare[criterion]) {
+    const auto& left = cell(criterion);
+    const auto& right = _compare.cell(criterion);
+    if (left < right) {
       result = true;
       break;
-    } else if (this->operator[](criterion) > _compare[criterion]) {
+    } else if (right < left) {
       break;
     }
   }
@@ -96,17 +231,28 @@ bool ListTable::TableRow::operator> (const TableRow& _compare) const
    *
  */
 
-ListTable::ListTable(const MyMoneyReport& _report):
-    ReportTable(_report)
+ListTable::ListTable(const MyMoneyReport& _report, ReportProgress* progress, const ReportSettings& settings):
+    ReportTable(_report, progress, settings)
 {
 }
 
-void ListTable::render(QString& result, QString& csv) const
+bool ListTable::render(QTextStream* htmlStream, QTextStream* csvStream, int maxRows) const
 {
   MyMoneyFile* file = MyMoneyFile::instance();
 
-  result.clear();
-  csv.clear();
+  // the output is collected row by row and written to the streams
+  // as soon as a row is complete, so that large tables are never
+  // kept in memory as a whole
+  QString result;
+  QString csv;
+  const auto flush = [&]() {
+    if (htmlStream)
+      *htmlStream << result;
+    if (csvStream)
+      *csvStream << csv;
+    result.clear();
+    csv.clear();
+  };
 
   // retrieve the configuration parameters from the report definition.
   // the things that we care about for query reports are:
@@ -145,6 +291,8 @@ void ListTable::render(QString& result, QString& csv) const
 
   bool row_odd = true;
   bool isLowestGroupTotal = true;  // hack to inform whether to put separator line or not
+  int shownRows = 0;
+  bool complete = true;
 
   // ***DV***
   MyMoneyMoney startingBalance;
@@ -152,6 +300,8 @@ void ListTable::render(QString& result, QString& csv) const
   for (QList<TableRow>::ConstIterator it_row = m_rows.constBegin();
        it_row != m_rows.constEnd();
        ++it_row) {
+    flush();
+
     /* rank can be:
      * 0 - opening balance
      * 1 - major split of transaction
@@ -160,7 +310,7 @@ void ListTable::render(QString& result, QString& csv) const
      * 4 - first totals row
      * 5 - middle totals row
      */
-    const int rowRank = (*it_row).value(ctRank).toInt();
+    const int rowRank = (*it_row).cell(ctRank).toInt();
     // detect whether any of groups changed and display new group header in that case
     for (int i = 0; i < m_group.count(); ++i) {
       QString curGrpName = (*it_row).value(m_group.at(i));
@@ -215,7 +365,7 @@ void ListTable::render(QString& result, QString& csv) const
             if (isLowestGroupTotal && m_config.isHideTransactions()) {
               result.append(QLatin1String("<tr class=\"sectionfootermiddle\">"));
               isLowestGroupTotal = false;
-            } else if ((*nextRow).value(ctRank) == QLatin1String("5")) {
+            } else if ((*nextRow).cell(ctRank).toInt() == 5) {
               result.append(QLatin1String("<tr class=\"sectionfooterfirst\">"));
             } else {
               result.append(QLatin1String("<tr class=\"sectionfooter\">"));
@@ -225,7 +375,7 @@ void ListTable::render(QString& result, QString& csv) const
           }
         } else if (rowRank == 5) {
           if (nextRow != m_rows.end()) {
-            if ((*nextRow).value(ctRank) == QLatin1String("5"))
+            if ((*nextRow).cell(ctRank).toInt() == 5)
               result.append(QLatin1String("<tr class=\"sectionfootermiddle\">"));
             else
               result.append(QLatin1String("<tr class=\"sectionfooterlast\">"));
@@ -240,18 +390,27 @@ void ListTable::render(QString& result, QString& csv) const
       continue;
     }
 
+    if (maxRows >= 0 && shownRows >= maxRows) {
+      // drop the row and the group headers started for it
+      result.clear();
+      csv.clear();
+      complete = false;
+      break;
+    }
+    ++shownRows;
+
     //
     // Columns
     //
 
     QList<cellTypeE>::ConstIterator it_column = columns.constBegin();
     while (it_column != columns.constEnd()) {
-      QString data = (*it_row).value(*it_column);
+      TableCell data = (*it_row).cell(*it_column);
 
       // ***DV***
       if (rowRank == 2) {
         if (*it_column == ctValue)
-          data = (*it_row).value(ctSplit);
+          data = (*it_row).cell(ctSplit);
         else if (*it_column == ctPostDate
                  || *it_column == ctNumber
                  || *it_column == ctPayee
@@ -262,15 +421,15 @@ void ListTable::render(QString& result, QString& csv) const
                  || *it_column == ctBalance
                  || *it_column == ctAccount
                  || *it_column == ctName)
-          data.clear();
+          data = TableCell();
       }
 
       // ***DV***
       else if (rowRank == 0 || rowRank == 3) {
         if (*it_column == ctBalance) {
-          data = (*it_row).value(ctBalance);
+          data = (*it_row).cell(ctBalance);
           if ((*it_row).value(ctID) == QLatin1String("A")) {          // opening balance?
-            startingBalance = MyMoneyMoney(data);
+            startingBalance = data.toMoney();
             balanceChange = MyMoneyMoney();
           }
         }
@@ -279,14 +438,14 @@ void ListTable::render(QString& result, QString& csv) const
           if ((*it_column == ctPayee) ||
               (*it_column == ctCategory) ||
               (*it_column == ctMemo)) {
-            if (!(*it_row).value(ctShares).isEmpty()) {
-              data = ((*it_row).value(ctID) == QLatin1String("A"))
+            if (!(*it_row).cell(ctShares).isEmpty()) {
+              data = TableCell(((*it_row).value(ctID) == QLatin1String("A"))
                   ? i18n("Initial Market Value")
-                  : i18n("Ending Market Value");
+                  : i18n("Ending Market Value"));
             } else {
-              data = ((*it_row).value(ctID) == QLatin1String("A"))
+              data = TableCell(((*it_row).value(ctID) == QLatin1String("A"))
                   ? i18n("Opening Balance")
-                  : i18n("Closing Balance");
+                  : i18n("Closing Balance"));
             }
             need_label = false;
           }
@@ -296,15 +455,15 @@ void ListTable::render(QString& result, QString& csv) const
       // but not printed on split lines
       else if (*it_column == ctBalance && rowRank == 1) {
         // Take the balance off the deepest group iterator
-        balanceChange += MyMoneyMoney((*it_row).value(ctValue, QLatin1String("0")));
-        data = (balanceChange + startingBalance).toString();
+        balanceChange += (*it_row).money(ctValue);
+        data = TableCell(balanceChange + startingBalance);
       } else if ((rowRank == 4 || rowRank == 5)) {
         // display total title but only if first column doesn't contain any data
         if (it_column == columns.constBegin() && data.isEmpty()) {
           result.append(QString::fromLatin1("<td class=\"left%1\">").arg((*it_row).value(ctDepth)));
           if (rowRank == 4) {
-            if (!(*it_row).value(ctDepth).isEmpty())
-              result += i18nc("Total balance", "Total") + QLatin1Char(' ') + prevGrpNames.at((*it_row).value(ctDepth).toInt());
+            if (!(*it_row).cell(ctDepth).isEmpty())
+              result += i18nc("Total balance", "Total") + QLatin1Char(' ') + prevGrpNames.at((*it_row).cell(ctDepth).toInt());
             else
               result += i18n("Grand Total");
           }
@@ -345,13 +504,13 @@ void ListTable::render(QString& result, QString& csv) const
             result.append(QString::fromLatin1("<td%1></td>")
                           .arg((*it_column == ctValue) ? QLatin1String(" class=\"value\"") : QString()));
             csv.append(QLatin1String("\"\","));
-          } else if (MyMoneyMoney(data) == MyMoneyMoney::autoCalc) {
+          } else if (data.toMoney() == MyMoneyMoney::autoCalc) {
             result.append(QString::fromLatin1("<td%1>%3%2%4</td>")
                           .arg((*it_column == ctValue) ? QLatin1String(" class=\"value\"") : QString(),
                                i18n("Calculated"), tlinkBegin, tlinkEnd));
             csv.append(QString::fromLatin1("\"%1\",").arg(i18n("Calculated")));
           } else {
-            auto value = MyMoneyMoney(data);
+            auto value = data.toMoney();
             auto valueStr = value.formatMoney(fraction);
             csv.append(QString::fromLatin1("\"%1 %2\",")
                        .arg(currencyID, valueStr));
@@ -359,7 +518,7 @@ void ListTable::render(QString& result, QString& csv) const
             QString colorBegin;
             QString colorEnd;
             if ((rowRank == 4 || rowRank == 5) && value.isNegative()) {
-              colorBegin = QString::fromLatin1("<font color=%1>").arg(KMyMoneySettings::schemeColor(SchemeColor::Negative).name());
+              colorBegin = QString::fromLatin1("<font color=%1>").arg(m_settings.negativeColor.name());
               colorEnd = QLatin1String("</font>");
             }
 
@@ -376,20 +535,20 @@ void ListTable::render(QString& result, QString& csv) const
             result.append(QLatin1String("<td></td>"));
             csv.append(QLatin1String("\"\","));
           } else {
-            auto value = MyMoneyMoney(data) * MyMoneyMoney(100, 1);
+            auto value = data.toMoney() * MyMoneyMoney(100, 1);
             auto valueStr = value.formatMoney(fraction);
             csv.append(QString::fromLatin1("%1%,").arg(valueStr));
 
             QString colorBegin;
             QString colorEnd;
             if ((rowRank == 4 || rowRank == 5) && value.isNegative()) {
-              colorBegin = QString::fromLatin1("<font color=%1>").arg(KMyMoneySettings::schemeColor(SchemeColor::Negative).name());
+              colorBegin = QString::fromLatin1("<font color=%1>").arg(m_settings.negativeColor.name());
               colorEnd = QLatin1String("</font>");
             }
 
             if ((rowRank == 4 || rowRank == 5) && value.isNegative())
               valueStr = QString::fromLatin1("<font color=%1>%2</font>")
-                  .arg(KMyMoneySettings::schemeColor(SchemeColor::Negative).name(), valueStr);
+                  .arg(m_settings.negativeColor.name(), valueStr);
             result.append(QString::fromLatin1("<td>%2%4%1%%5%3</td>").arg(valueStr, tlinkBegin, tlinkEnd, colorBegin, colorEnd));
           }
           break;
@@ -397,10 +556,10 @@ void ListTable::render(QString& result, QString& csv) const
         {
           int pricePrecision = file->security(file->account((*it_row).value(ctAccountID)).currencyId()).pricePrecision();
           result.append(QString::fromLatin1("<td>%3%2&nbsp;%1%4</td>")
-                        .arg(MyMoneyMoney(data).formatMoney(QString(), pricePrecision),
+                        .arg(data.toMoney().formatMoney(QString(), pricePrecision),
                              currencyID, tlinkBegin, tlinkEnd));
           csv.append(QString::fromLatin1("\"%1 %2\",").arg(currencyID,
-                                                              MyMoneyMoney(data).formatMoney(QString(), pricePrecision, false)));
+                                                              data.toMoney().formatMoney(QString(), pricePrecision, false)));
         }
           break;
         case cgShares:
@@ -409,25 +568,29 @@ void ListTable::render(QString& result, QString& csv) const
             csv.append(QLatin1String("\"\","));
           } else {
             int sharesPrecision = MyMoneyMoney::denomToPrec(file->security(file->account((*it_row).value(ctAccountID)).currencyId()).smallestAccountFraction());
-            result += QString::fromLatin1("<td>%2%1%3</td>").arg(MyMoneyMoney(data).formatMoney(QString(), sharesPrecision),
+            const auto shares = data.toMoney();
+            result += QString::fromLatin1("<td>%2%1%3</td>").arg(shares.formatMoney(QString(), sharesPrecision),
                                                                     tlinkBegin, tlinkEnd);
-            csv.append(QString::fromLatin1("\"%1\",").arg(MyMoneyMoney(data).formatMoney(QString(), sharesPrecision, false)));
+            csv.append(QString::fromLatin1("\"%1\",").arg(shares.formatMoney(QString(), sharesPrecision, false)));
           }
           break;
         case cgDate:
-          // do this before we possibly change data
-          csv.append(QString::fromLatin1("\"%1\",").arg(data));
+        {
+          csv.append(QString::fromLatin1("\"%1\",").arg(data.toString()));
 
           // if we have a locale() then use its date formatter
-          if (!data.isEmpty()) {
-            QDate qd = QDate::fromString(data, Qt::ISODate);
-            data = QLocale().toString(qd, QLocale::ShortFormat);
-          }
-          result.append(QString::fromLatin1("<td class=\"left%4\">%2%1%3</td>").arg(data, tlinkBegin, tlinkEnd, QString::number(prevGrpNames.count() - 1)));
+          QString text;
+          if (!data.isEmpty())
+            text = QLocale().toString(data.toDate(), QLocale::ShortFormat);
+          result.append(QString::fromLatin1("<td class=\"left%4\">%2%1%3</td>").arg(text, tlinkBegin, tlinkEnd, QString::number(prevGrpNames.count() - 1)));
+        }
           break;
         default:
-          result.append(QString::fromLatin1("<td class=\"left%4\">%2%1%3</td>").arg(data, tlinkBegin, tlinkEnd, QString::number(prevGrpNames.count() - 1)));
-          csv.append(QString::fromLatin1("\"%1\",").arg(data));
+        {
+          const auto text = data.toString();
+          result.append(QString::fromLatin1("<td class=\"left%4\">%2%1%3</td>").arg(text, tlinkBegin, tlinkEnd, QString::number(prevGrpNames.count() - 1)));
+          csv.append(QString::fromLatin1("\"%1\",").arg(text));
+        }
           break;
       }
       ++it_column;
@@ -438,21 +601,26 @@ void ListTable::render(QString& result, QString& csv) const
     csv.chop(1);  // remove final comma
     csv.append(QLatin1Char('\n'));
   }
+
+  if (!complete) {
+    result.append(QString::fromLatin1("<tr class=\"sectionfooter\"><td class=\"left0\" colspan=\"%1\">%2 <a href=reports?command=more>%3</a></td></tr>\n")
+                  .arg(QString::number(columns.count()),
+                       i18np("Only the first row of the report is shown.", "Only the first %1 rows of the report are shown.", maxRows),
+                       i18n("Show more rows")));
+  }
   result.append(QLatin1String("</table>\n"));
+  flush();
+  return complete;
 }
 
-QString ListTable::renderHTML() const
+bool ListTable::writeHTML(QTextStream& stream, int maxRows) const
 {
-  QString html, csv;
-  render(html, csv);
-  return html;
+  return render(&stream, nullptr, maxRows);
 }
 
-QString ListTable::renderCSV() const
+void ListTable::writeCSV(QTextStream& stream) const
 {
-  QString html, csv;
-  render(html, csv);
-  return csv;
+  render(nullptr, &stream);
 }
 
 void ListTable::dump(const QString& file, const QString& context) const
@@ -460,10 +628,12 @@ void ListTable::dump(const QString& file, const QString& context) const
   QFile g(file);
   g.open(QIODevice::WriteOnly | QIODevice::Text);
 
+  QTextStream stream(&g);
   if (! context.isEmpty())
-    QTextStream(&g) << context.arg(renderHTML());
+    stream << context.arg(renderHTML());
   else
-    QTextStream(&g) << renderHTML();
+    writeHTML(stream, -1);
+  stream.flush();
   g.close();
 }
 
@@ -473,7 +643,7 @@ void ListTable::includeInvestmentSubAccounts()
   // that all stock accounts for the selected investment
   // account are also selected.
   // In case we get called for a non investment only report we quit
-  if (KMyMoneySettings::expertMode() || !m_config.isInvestmentsOnly()) {
+  if (m_settings.expertMode || !m_config.isInvestmentsOnly()) {
     return;
   }
 
@@ -24,7 +24,8 @@
 // QT Includes
 
 #include <QVector>
-#include <QMap>
+#include <QPair>
+#include <QDate>
 
 // ----------------------------------------------------------------------------
 // KDE Includes
@@ -33,6 +34,7 @@
 // Project Includes
 
 #include "reporttable.h"
+#include "mymoneymoney.h"
 
 class MyMoneyReport;
 
@@ -56,9 +58,9 @@ class ReportAccount;
 class ListTable : public ReportTable
 {
 public:
-  explicit ListTable(const MyMoneyReport&);
-  QString renderHTML() const final override;
-  QString renderCSV() const final override;
+  explicit ListTable(const MyMoneyReport&, ReportProgress* progress = nullptr, const ReportSettings& settings = ReportSettings::current());
+  bool writeHTML(QTextStream& stream, int maxRows) const final override;
+  void writeCSV(QTextStream& stream) const final override;
   void drawChart(KReportChartView&) const final override {}
   void dump(const QString& file, const QString& context = QString()) const final override;
   void init();
@@ -91,16 +93,106 @@ public:
                    ctAction, ctTag, ctPayee, ctEquityType, ctType, ctName,
                    ctDepth, ctRowsCount, ctTax, ctFavorite, ctDescription, ctOccurrence, ctPaymentType
                  };
+  /**
+    * Contains the value of a single cell in the table.
+    *
+    * Amounts, dates and numbers are kept in their native type, so
+    * they can be summed up and sorted without parsing them again.
+    * They are only converted to text when the table gets rendered.
+    */
+  class TableCell
+  {
+  public:
+    enum Type { Empty, Text, Money, Date, Number };
+
+    TableCell() : m_type(Empty), m_number(0) {}
+    explicit TableCell(const QString& text) : m_type(text.isEmpty() ? Empty : Text), m_text(text), m_number(0) {}
+    explicit TableCell(const MyMoneyMoney& money) : m_type(Money), m_money(money), m_number(0) {}
+    explicit TableCell(const QDate& date) : m_type(date.isValid() ? Date : Empty), m_number(date.isValid() ? date.toJulianDay() : 0) {}
+    explicit TableCell(int number) : m_type(Number), m_number(number) {}
+
+    Type type() const {
+      return m_type;
+    }
+    bool isEmpty() const {
+      return m_type == Empty;
+    }
+
+    /**
+      * Returns the cell as text. Amounts use MyMoneyMoney::toString()
+      * and dates the ISO format.
+      */
+    QString toString() const;
+    MyMoneyMoney toMoney() const;
+    QDate toDate() const;
+    int toInt() const;
+
+    /**
+      * Cells of the same type are compared by their value,
+      * all others by their text.
+      */
+    bool operator< (const TableCell&) const;
+    bool operator== (const TableCell&) const;
+    bool operator!= (const TableCell& _compare) const {
+      return !(*this == _compare);
+    }
+
+  private:
+    Type m_type;
+    QString m_text;
+    MyMoneyMoney m_money;
+    qint64 m_number;
+  };
+
   /**
     * Contains a single row in the table.
     *
-    * Each column is a key/value pair, both strings.  This class is just
-    * a QMap with the added ability to specify which columns you'd like to
-    * use as a sort key when you qHeapSort a list of these TableRows
+    * The cells are kept in a vector ordered by their column, so a row
+    * only needs a single allocation. This class adds the ability to
+    * specify which columns you'd like to use as a sort key when you
+    * qSort a list of these TableRows
     */
-  class TableRow: public QMap<cellTypeE, QString>
+  class TableRow
   {
   public:
+    /**
+      * Returns the cell of column @a cellType or an empty cell if it is not set
+      */
+    const TableCell& cell(cellTypeE cellType) const;
+
+    void set(cellTypeE cellType, const TableCell& cell);
+    void set(cellTypeE cellType, const QString& text) {
+      set(cellType, TableCell(text));
+    }
+    void set(cellTypeE cellType, const MyMoneyMoney& money) {
+      set(cellType, TableCell(money));
+    }
+    void set(cellTypeE cellType, const QDate& date) {
+      set(cellType, TableCell(date));
+    }
+    void set(cellTypeE cellType, int number) {
+      set(cellType, TableCell(number));
+    }
+    void remove(cellTypeE cellType);
+
+    bool contains(cellTypeE cellType) const;
+    bool isEmpty() const {
+      return m_cells.isEmpty();
+    }
+
+    /**
+      * Returns the text of column @a cellType
+      */
+    QString value(cellTypeE cellType) const {
+      return cell(cellType).toString();
+    }
+    QString operator[](cellTypeE cellType) const {
+      return cell(cellType).toString();
+    }
+    MyMoneyMoney money(cellTypeE cellType) const {
+      return cell(cellType).toMoney();
+    }
+
     bool operator< (const TableRow&) const;
     bool operator<= (const TableRow&) const;
     bool operator> (const TableRow&) const;
@@ -110,7 +202,9 @@ public:
       m_sortCriteria = _criteria;
     }
   private:
-    static QVector<cellTypeE> m_sortCriteria;
+    QVector<QPair<cellTypeE, TableCell> > m_cells;
+    // per thread, so that reports can be sorted in several threads at once
+    static thread_local QVector<cellTypeE> m_sortCriteria;
   };
 
   const QList<TableRow>& rows() {
@@ -118,7 +212,15 @@ public:
   }
 
 protected:
-  void render(QString&, QString&) const;
+  /**
+   * Writes the table as html to @a htmlStream and as comma separated values
+   * to @a csvStream row by row. Either stream may be @c nullptr. At most
+   * @a maxRows rows are written unless @a maxRows is negative, a
+   * truncated html table ends with a link to show more rows.
+   *
+   * @return @c true if all rows have been written
+   */
+  bool render(QTextStream* htmlStream, QTextStream* csvStream, int maxRows = -1) const;
 
   /**
    * If not in expert mode, include all subaccounts for each selected
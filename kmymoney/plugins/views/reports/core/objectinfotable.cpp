@@ -69,7 +69,7 @@ namespace reports
   *
   */
 
-ObjectInfoTable::ObjectInfoTable(const MyMoneyReport& _report): ListTable(_report)
+ObjectInfoTable::ObjectInfoTable(const MyMoneyReport& _report, ReportProgress* progress, const ReportSettings& settings): ListTable(_report, progress, settings)
 {
   // separated into its own method to allow debugging (setting breakpoints
   // directly in ctors somehow does not work for me (ipwizard))
@@ -184,24 +184,24 @@ void ObjectInfoTable::constructScheduleTable()
       }
 
       // help for sort and render functions
-      scheduleRow[ctRank] = QLatin1Char('1');
+      scheduleRow.set(ctRank, 1);
 
       //schedule data
-      scheduleRow[ctID] = schedule.id();
-      scheduleRow[ctName] = schedule.name();
-      scheduleRow[ctNextDueDate] = schedule.nextDueDate().toString(Qt::ISODate);
-      scheduleRow[ctType] = KMyMoneyUtils::scheduleTypeToString(schedule.type());
-      scheduleRow[ctOccurrence] = i18nc("Frequency of schedule", schedule.occurrenceToString().toLatin1());
-      scheduleRow[ctPaymentType] = KMyMoneyUtils::paymentMethodToString(schedule.paymentType());
+      scheduleRow.set(ctID, schedule.id());
+      scheduleRow.set(ctName, schedule.name());
+      scheduleRow.set(ctNextDueDate, schedule.nextDueDate());
+      scheduleRow.set(ctType, KMyMoneyUtils::scheduleTypeToString(schedule.type()));
+      scheduleRow.set(ctOccurrence, i18nc("Frequency of schedule", schedule.occurrenceToString().toLatin1()));
+      scheduleRow.set(ctPaymentType, KMyMoneyUtils::paymentMethodToString(schedule.paymentType()));
 
       //scheduleRow["category"] = account.name();
 
       //to get the payee we must look into the splits of the transaction
       MyMoneyTransaction transaction = schedule.transaction();
       MyMoneySplit split = transaction.splitByAccount(account.id(), true);
-      scheduleRow[ctValue] = (split.value() * xr).toString();
+      scheduleRow.set(ctValue, split.value() * xr);
       MyMoneyPayee payee = file->payee(split.payeeId());
-      scheduleRow[ctPayee] = payee.name();
+      scheduleRow.set(ctPayee, payee.name());
       m_rows += scheduleRow;
 
       //the text matches the main split
@@ -218,28 +218,28 @@ void ObjectInfoTable::constructScheduleTable()
           TableRow splitRow;
           ReportAccount splitAcc((*split_it).accountId());
 
-          splitRow[ctRank] = QLatin1Char('2');
-          splitRow[ctID] = schedule.id();
-          splitRow[ctName] = schedule.name();
-          splitRow[ctPayee] = payee.name();
-          splitRow[ctType] = KMyMoneyUtils::scheduleTypeToString(schedule.type());
-          splitRow[ctNextDueDate] = schedule.nextDueDate().toString(Qt::ISODate);
+          splitRow.set(ctRank, 2);
+          splitRow.set(ctID, schedule.id());
+          splitRow.set(ctName, schedule.name());
+          splitRow.set(ctPayee, payee.name());
+          splitRow.set(ctType, KMyMoneyUtils::scheduleTypeToString(schedule.type()));
+          splitRow.set(ctNextDueDate, schedule.nextDueDate());
 
           if ((*split_it).value() == MyMoneyMoney::autoCalc) {
-            splitRow[ctSplit] = MyMoneyMoney::autoCalc.toString();
+            splitRow.set(ctSplit, MyMoneyMoney::autoCalc);
           } else if (! splitAcc.isIncomeExpense()) {
-            splitRow[ctSplit] = (*split_it).value().toString();
+            splitRow.set(ctSplit, (*split_it).value());
           } else {
-            splitRow[ctSplit] = (- (*split_it).value()).toString();
+            splitRow.set(ctSplit, - (*split_it).value());
           }
 
           //if it is an assett account, mark it as a transfer
           if (! splitAcc.isIncomeExpense()) {
-            splitRow[ctCategory] = ((* split_it).value().isNegative())
+            splitRow.set(ctCategory, ((* split_it).value().isNegative())
                                    ? i18n("Transfer from %1" , splitAcc.fullName())
-                                   : i18n("Transfer to %1" , splitAcc.fullName());
+                                   : i18n("Transfer to %1" , splitAcc.fullName()));
           } else {
-            splitRow [ctCategory] = splitAcc.fullName();
+            splitRow.set(ctCategory, splitAcc.fullName());
           }
 
           //add the split only if it matches the text or it matches the main split
@@ -250,7 +250,7 @@ void ObjectInfoTable::constructScheduleTable()
             if (splits.count() > 2) {
               m_rows += splitRow;
             } else {
-              m_rows.last()[ctCategory] = splitRow [ctCategory];
+              m_rows.last().set(ctCategory, splitRow.cell(ctCategory));
             }
           }
         }
@@ -278,27 +278,27 @@ void ObjectInfoTable::constructAccountTable()
         && account.accountType() != eMyMoney::Account::Type::Stock
         && !account.isClosed()) {
       MyMoneyMoney value;
-      accountRow[ctRank] = QLatin1Char('1');
-      accountRow[ctTopCategory] = MyMoneyAccount::accountTypeToString(account.accountGroup());
+      accountRow.set(ctRank, 1);
+      accountRow.set(ctTopCategory, MyMoneyAccount::accountTypeToString(account.accountGroup()));
       if (!account.institutionId().isEmpty()) {
-        accountRow[ctInstitution] = (file->institution(account.institutionId())).name();
+        accountRow.set(ctInstitution, (file->institution(account.institutionId())).name());
       } else {
-        accountRow[ctInstitution] = QStringLiteral("Accounts with no institution assigned");
+        accountRow.set(ctInstitution, QStringLiteral("Accounts with no institution assigned"));
       }
-      accountRow[ctType] = MyMoneyAccount::accountTypeToString(account.accountType());
-      accountRow[ctName] = account.name();
-      accountRow[ctNumber] = account.number();
-      accountRow[ctDescription] = account.description();
-      accountRow[ctOpeningDate] = account.openingDate().toString(Qt::ISODate);
+      accountRow.set(ctType, MyMoneyAccount::accountTypeToString(account.accountType()));
+      accountRow.set(ctName, account.name());
+      accountRow.set(ctNumber, account.number());
+      accountRow.set(ctDescription, account.description());
+      accountRow.set(ctOpeningDate, account.openingDate());
       //accountRow["currency"] = (file->currency(account.currencyId())).tradingSymbol();
-      accountRow[ctCurrencyName] = (file->currency(account.currencyId())).name();
-      accountRow[ctBalanceWarning] = account.value("minBalanceEarly");
-      accountRow[ctMaxBalanceLimit] = account.value("minBalanceAbsolute");
-      accountRow[ctCreditWarning] = account.value("maxCreditEarly");
-      accountRow[ctMaxCreditLimit] = account.value("maxCreditAbsolute");
-      accountRow[ctTax] = account.value("Tax") == QLatin1String("Yes") ? i18nc("Is this a tax account?", "Yes") : QString();
-      accountRow[ctOpeningBalance] = account.value("OpeningBalanceAccount") == QLatin1String("Yes") ? i18nc("Is this an opening balance account?", "Yes") : QString();
-      accountRow[ctFavorite] = account.value("PreferredAccount") == QLatin1String("Yes") ? i18nc("Is this a favorite account?", "Yes") : QString();
+      accountRow.set(ctCurrencyName, (file->currency(account.currencyId())).name());
+      accountRow.set(ctBalanceWarning, account.value("minBalanceEarly"));
+      accountRow.set(ctMaxBalanceLimit, account.value("minBalanceAbsolute"));
+      accountRow.set(ctCreditWarning, account.value("maxCreditEarly"));
+      accountRow.set(ctMaxCreditLimit, account.value("maxCreditAbsolute"));
+      accountRow.set(ctTax, account.value("Tax") == QLatin1String("Yes") ? i18nc("Is this a tax account?", "Yes") : QString());
+      accountRow.set(ctOpeningBalance, account.value("OpeningBalanceAccount") == QLatin1String("Yes") ? i18nc("Is this an opening balance account?", "Yes") : QString());
+      accountRow.set(ctFavorite, account.value("PreferredAccount") == QLatin1String("Yes") ? i18nc("Is this a favorite account?", "Yes") : QString());
 
       //investment accounts show the balances of all its subaccounts
       if (account.accountType() == eMyMoney::Account::Type::Investment) {
@@ -312,7 +312,7 @@ void ObjectInfoTable::constructAccountTable()
         MyMoneyMoney xr = account.baseCurrencyPrice(QDate::currentDate()).reduce();
         value = value * xr;
       }
-      accountRow[ctCurrentBalance] = value.toString();
+      accountRow.set(ctCurrentBalance, value);
 
       m_rows += accountRow;
     }
@@ -339,31 +339,31 @@ void ObjectInfoTable::constructAccountLoanTable()
         xr = account.baseCurrencyPrice(QDate::currentDate()).reduce();
       }
 
-      accountRow[ctRank] = QLatin1Char('1');
-      accountRow[ctTopCategory] = MyMoneyAccount::accountTypeToString(account.accountGroup());
+      accountRow.set(ctRank, 1);
+      accountRow.set(ctTopCategory, MyMoneyAccount::accountTypeToString(account.accountGroup()));
       if (!account.institutionId().isEmpty()) {
-        accountRow[ctInstitution] = (file->institution(account.institutionId())).name();
+        accountRow.set(ctInstitution, (file->institution(account.institutionId())).name());
       } else {
-        accountRow[ctInstitution] = QStringLiteral("Accounts with no institution assigned");
+        accountRow.set(ctInstitution, QStringLiteral("Accounts with no institution assigned"));
       }
-      accountRow[ctType] = MyMoneyAccount::accountTypeToString(account.accountType());
-      accountRow[ctName] = account.name();
-      accountRow[ctNumber] = account.number();
-      accountRow[ctDescription] = account.description();
-      accountRow[ctOpeningDate] = account.openingDate().toString(Qt::ISODate);
+      accountRow.set(ctType, MyMoneyAccount::accountTypeToString(account.accountType()));
+      accountRow.set(ctName, account.name());
+      accountRow.set(ctNumber, account.number());
+      accountRow.set(ctDescription, account.description());
+      accountRow.set(ctOpeningDate, account.openingDate());
       //accountRow["currency"] = (file->currency(account.currencyId())).tradingSymbol();
-      accountRow[ctCurrencyName] = (file->currency(account.currencyId())).name();
-      accountRow[ctPayee] = file->payee(loan.payee()).name();
-      accountRow[ctLoanAmount] = (loan.loanAmount() * xr).toString();
-      accountRow[ctInterestRate] = (loan.interestRate(QDate::currentDate()) / MyMoneyMoney(100, 1) * xr).toString();
-      accountRow[ctNextInterestChange] = loan.nextInterestChange().toString(Qt::ISODate);
-      accountRow[ctPeriodicPayment] = (loan.periodicPayment() * xr).toString();
-      accountRow[ctFinalPayment] = (loan.finalPayment() * xr).toString();
-      accountRow[ctFavorite] = account.value("PreferredAccount") == QLatin1String("Yes") ? i18nc("Is this a favorite account?", "Yes") : QString();
+      accountRow.set(ctCurrencyName, (file->currency(account.currencyId())).name());
+      accountRow.set(ctPayee, file->payee(loan.payee()).name());
+      accountRow.set(ctLoanAmount, loan.loanAmount() * xr);
+      accountRow.set(ctInterestRate, loan.interestRate(QDate::currentDate()) / MyMoneyMoney(100, 1) * xr);
+      accountRow.set(ctNextInterestChange, loan.nextInterestChange());
+      accountRow.set(ctPeriodicPayment, loan.periodicPayment() * xr);
+      accountRow.set(ctFinalPayment, loan.finalPayment() * xr);
+      accountRow.set(ctFavorite, account.value("PreferredAccount") == QLatin1String("Yes") ? i18nc("Is this a favorite account?", "Yes") : QString());
 
       MyMoneyMoney value = file->balance(account.id());
       value = value * xr;
-      accountRow[ctCurrentBalance] = value.toString();
+      accountRow.set(ctCurrentBalance, value);
       m_rows += accountRow;
     }
     ++it_account;
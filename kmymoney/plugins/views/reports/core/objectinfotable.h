@@ -53,7 +53,7 @@ class ReportAccount;
 class ObjectInfoTable : public ListTable
 {
 public:
-  explicit ObjectInfoTable(const MyMoneyReport&);
+  explicit ObjectInfoTable(const MyMoneyReport&, ReportProgress* progress = nullptr, const ReportSettings& settings = ReportSettings::current());
   void init();
 
 protected:
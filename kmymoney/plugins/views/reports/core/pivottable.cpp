@@ -36,7 +36,6 @@
 #include "pivotgrid.h"
 #include "reportdebug.h"
 #include "kreportchartview.h"
-#include "kmymoneysettings.h"
 #include "kmymoneyutils.h"
 #include "mymoneyforecast.h"
 #include "mymoneyprice.h"
@@ -89,8 +88,8 @@ void Debug::output(const QString& _text)
     qDebug("%s%s(): %s", qPrintable(m_sTabs), qPrintable(m_methodName), qPrintable(_text));
 }
 
-PivotTable::PivotTable(const MyMoneyReport& _report):
-    ReportTable(_report),
+PivotTable::PivotTable(const MyMoneyReport& _report, ReportProgress* progress, const ReportSettings& settings):
+    ReportTable(_report, progress, settings),
     m_runningSumsCalculated(false)
 {
   init();
@@ -260,6 +259,7 @@ void PivotTable::init()
     QList<MyMoneyTransaction>::const_iterator it_transaction = transactions.constBegin();
     int colofs = columnValue(m_beginDate) - m_startColumn;
     while (it_transaction != transactions.constEnd()) {
+      setProgress(it_transaction - transactions.constBegin(), transactions.count());
       MyMoneyTransaction tx = (*it_transaction);
       if (m_openingBalanceTransactions.contains(tx.id())) {
         ++it_transaction;
@@ -279,7 +279,7 @@ void PivotTable::init()
         MyMoneySchedule sched = file->schedule(tx.value("kmm-schedule-id"));
         const MyMoneySplit& split = tx.amortizationSplit();
         if (!split.id().isEmpty()) {
-          ReportAccount splitAccount(file->account(split.accountId()));
+          const ReportAccount& splitAccount = reportAccount(split.accountId());
           eMyMoney::Account::Type type = splitAccount.accountGroup();
           QString outergroup = MyMoneyAccount::accountTypeToString(type);
 
@@ -315,7 +315,7 @@ void PivotTable::init()
       QList<MyMoneySplit> splits = tx.splits();
       QList<MyMoneySplit>::const_iterator it_split = splits.constBegin();
       while (it_split != splits.constEnd()) {
-        ReportAccount splitAccount((*it_split).accountId());
+        const ReportAccount& splitAccount = reportAccount((*it_split).accountId());
 
         // Each split must be further filtered, because if even one split matches,
         // the ENTIRE transaction is returned with all splits (even non-matching ones)
@@ -612,6 +612,7 @@ void PivotTable::createAccountRows()
   QList<MyMoneyAccount>::const_iterator it_account = accounts.constBegin();
 
   while (it_account != accounts.constEnd()) {
+    setProgress(it_account - accounts.constBegin(), accounts.count());
     ReportAccount account(*it_account);
 
     // only include this item if its account group is included in this report
@@ -727,12 +728,15 @@ void PivotTable::calculateRunningSums()
 
   m_runningSumsCalculated = true;
 
+  const auto rows = gridRowCount();
+  auto row = 0;
   PivotGrid::iterator it_outergroup = m_grid.begin();
   while (it_outergroup != m_grid.end()) {
     PivotOuterGroup::iterator it_innergroup = (*it_outergroup).begin();
     while (it_innergroup != (*it_outergroup).end()) {
       PivotInnerGroup::iterator it_row = (*it_innergroup).begin();
       while (it_row != (*it_innergroup).end()) {
+        setProgress(row++, rows);
 #if 0
         MyMoneyMoney runningsum = it_row.value()[0];
         int column = m_startColumn;
@@ -772,7 +776,7 @@ MyMoneyMoney PivotTable::cellBalance(const QString& outergroup, const ReportAcco
     if (newrow.isEmpty())
       return MyMoneyMoney();
 
-    row = ReportAccount(newrow);
+    row = reportAccount(newrow);
   }
 
   // ensure the row already exists (and its parental hierarchy)
@@ -905,7 +909,7 @@ void PivotTable::calculateBudgetMapping()
     QList<MyMoneyBudget::AccountGroup> baccounts = budget.getaccounts();
     QList<MyMoneyBudget::AccountGroup>::const_iterator it_bacc = baccounts.constBegin();
     while (it_bacc != baccounts.constEnd()) {
-      ReportAccount splitAccount((*it_bacc).id());
+      const ReportAccount& splitAccount = reportAccount((*it_bacc).id());
 
       //include the budget account only if it is included in the report
       if (m_config.includes(splitAccount)) {
@@ -1006,12 +1010,15 @@ void PivotTable::convertToBaseCurrency()
   QList<ERowType> rowTypeList = m_rowTypeList;
   rowTypeList.removeOne(eAverage);
 
+  const auto rows = gridRowCount();
+  auto row = 0;
   PivotGrid::iterator it_outergroup = m_grid.begin();
   while (it_outergroup != m_grid.end()) {
     PivotOuterGroup::iterator it_innergroup = (*it_outergroup).begin();
     while (it_innergroup != (*it_outergroup).end()) {
       PivotInnerGroup::iterator it_row = (*it_innergroup).begin();
       while (it_row != (*it_innergroup).end()) {
+        setProgress(row++, rows);
         auto column = 0;
         while (column < m_numColumns) {
           if (it_row.value()[eActual].count() <= column)
@@ -1050,6 +1057,16 @@ void PivotTable::convertToBaseCurrency()
   }
 }
 
+int PivotTable::gridRowCount() const
+{
+  auto rows = 0;
+  foreach (const auto outergroup, m_grid) {
+    foreach (const auto innergroup, outergroup)
+      rows += innergroup.count();
+  }
+  return rows;
+}
+
 void PivotTable::convertToDeepCurrency()
 {
   DEBUG_ENTER(Q_FUNC_INFO);
@@ -1250,7 +1267,7 @@ void PivotTable::assignCell(const QString& outergroup, const ReportAccount& _row
     if (newrow.isEmpty())
       return;
 
-    row = ReportAccount(newrow);
+    row = reportAccount(newrow);
   }
 
   // ensure the row already exists (and its parental hierarchy)
@@ -1316,7 +1333,7 @@ void PivotTable::createRow(const QString& outergroup, const ReportAccount& row,
     m_grid[outergroup][innergroup][row] = PivotGridRowSet(m_numColumns);
 
     if (recursive && !row.isTopLevel())
-      createRow(outergroup, row.parent(), recursive);
+      createRow(outergroup, reportAccount(row.parentAccountId()), recursive);
   }
 }
 
@@ -1342,7 +1359,7 @@ QDate PivotTable::columnDate(int column) const
     return m_beginDate.addMonths(m_config.columnPitch() * column).addDays(-m_startColumn);
 }
 
-QString PivotTable::renderCSV() const
+void PivotTable::writeCSV(QTextStream& stream) const
 {
   DEBUG_ENTER(Q_FUNC_INFO);
 
@@ -1357,39 +1374,39 @@ QString PivotTable::renderCSV() const
   // Table Header
   //
 
-  QString result = i18n("Account");
+  stream << i18n("Account");
 
   auto column = 0;
   while (column < m_numColumns) {
-    result += QString(",%1").arg(QString(m_columnHeadings[column++]));
+    stream << QString(",%1").arg(QString(m_columnHeadings[column++]));
     if (m_rowTypeList.size() > 1) {
       QString separator;
       separator = separator.fill(',', m_rowTypeList.size() - 1);
-      result += separator;
+      stream << separator;
     }
   }
 
   //show total columns
   if (m_config.isShowingRowTotals())
-    result += QString(",%1").arg(i18nc("Total balance", "Total"));
+    stream << QString(",%1").arg(i18nc("Total balance", "Total"));
 
-  result += '\n';
+  stream << '\n';
 
   // Row Type Header
   if (m_rowTypeList.size() > 1) {
     column = 0;
     while (column < m_numColumns) {
       for (int i = 0; i < m_rowTypeList.size(); ++i) {
-        result += QString(",%1").arg(m_columnTypeHeaderList[i]);
+        stream << QString(",%1").arg(m_columnTypeHeaderList[i]);
       }
       column++;
     }
     if (m_config.isShowingRowTotals()) {
       for (int i = 0; i < m_rowTypeList.size(); ++i) {
-        result += QString(",%1").arg(m_columnTypeHeaderList[i]);
+        stream << QString(",%1").arg(m_columnTypeHeaderList[i]);
       }
     }
-    result += '\n';
+    stream << '\n';
   }
 
   //
@@ -1404,7 +1421,7 @@ QString PivotTable::renderCSV() const
     //
 
     if (!(m_config.isIncludingPrice() || m_config.isIncludingAveragePrice()))
-      result += it_outergroup.key() + '\n';
+      stream << it_outergroup.key() + '\n';
 
     //
     // Inner Groups
@@ -1508,7 +1525,7 @@ QString PivotTable::renderCSV() const
       bool isUsed = false;
       if (m_config.detailLevel() == eMyMoney::Report::DetailLevel::All && ((*it_innergroup).size() > 1)) {
         // Print the individual rows
-        result += innergroupdata;
+        stream << innergroupdata;
 
         if (m_config.isConvertCurrency() && m_config.isShowingColumnTotals()) {
           // Start the TOTALS row
@@ -1553,7 +1570,7 @@ QString PivotTable::renderCSV() const
       }
 
       if (isUsed) {
-        result += finalRow;
+        stream << finalRow;
         ++rownum;
       }
       ++it_innergroup;
@@ -1564,21 +1581,21 @@ QString PivotTable::renderCSV() const
     //
 
     if (m_config.isConvertCurrency() && m_config.isShowingColumnTotals()) {
-      result += QString("%1 %2").arg(i18nc("Total balance", "Total")).arg(it_outergroup.key());
+      stream << QString("%1 %2").arg(i18nc("Total balance", "Total")).arg(it_outergroup.key());
       column = 0;
       while (column < m_numColumns) {
         for (int i = 0; i < m_rowTypeList.size(); ++i)
-          result += QString(",\"%1\"").arg((*it_outergroup).m_total[ m_rowTypeList[i] ][column].formatMoney(QString(), precision, false));
+          stream << QString(",\"%1\"").arg((*it_outergroup).m_total[ m_rowTypeList[i] ][column].formatMoney(QString(), precision, false));
 
         column++;
       }
 
       if (m_config.isShowingRowTotals()) {
         for (int i = 0; i < m_rowTypeList.size(); ++i)
-          result += QString(",\"%1\"").arg((*it_outergroup).m_total[ m_rowTypeList[i] ].m_total.formatMoney(QString(), precision, false));
+          stream << QString(",\"%1\"").arg((*it_outergroup).m_total[ m_rowTypeList[i] ].m_total.formatMoney(QString(), precision, false));
       }
 
-      result += '\n';
+      stream << '\n';
     }
     ++it_outergroup;
   }
@@ -1588,26 +1605,25 @@ QString PivotTable::renderCSV() const
   //
 
   if (m_config.isConvertCurrency() && m_config.isShowingColumnTotals()) {
-    result += i18n("Grand Total");
+    stream << i18n("Grand Total");
     auto totalcolumn = 0;
     while (totalcolumn < m_numColumns) {
       for (int i = 0; i < m_rowTypeList.size(); ++i)
-        result += QString(",\"%1\"").arg(m_grid.m_total[ m_rowTypeList[i] ][totalcolumn].formatMoney(QString(), precision, false));
+        stream << QString(",\"%1\"").arg(m_grid.m_total[ m_rowTypeList[i] ][totalcolumn].formatMoney(QString(), precision, false));
 
       totalcolumn++;
     }
 
     if (m_config.isShowingRowTotals()) {
       for (int i = 0; i < m_rowTypeList.size(); ++i)
-        result += QString(",\"%1\"").arg(m_grid.m_total[ m_rowTypeList[i] ].m_total.formatMoney(QString(), precision, false));
+        stream << QString(",\"%1\"").arg(m_grid.m_total[ m_rowTypeList[i] ].m_total.formatMoney(QString(), precision, false));
     }
 
-    result += '\n';
+    stream << '\n';
   }
-  return result;
 }
 
-QString PivotTable::renderHTML() const
+bool PivotTable::writeHTML(QTextStream& stream, int /* maxRows */) const
 {
   DEBUG_ENTER(Q_FUNC_INFO);
 
@@ -1625,7 +1641,7 @@ QString PivotTable::renderHTML() const
   //
   // Table Header
   //
-  QString result = QString("\n\n<table class=\"report\" cellspacing=\"0\">\n"
+  stream << QString("\n\n<table class=\"report\" cellspacing=\"0\">\n"
                     "<thead><tr class=\"itemheader\">\n<th>%1</th>").arg(i18n("Account"));
 
   QString headerspan;
@@ -1635,18 +1651,18 @@ QString PivotTable::renderHTML() const
 
   auto column = 0;
   while (column < m_numColumns)
-    result += QString("<th%1>%2</th>").arg(headerspan, QString(m_columnHeadings[column++]).replace(QRegExp(" "), "<br>"));
+    stream << QString("<th%1>%2</th>").arg(headerspan, QString(m_columnHeadings[column++]).replace(QRegExp(" "), "<br>"));
 
   if (m_config.isShowingRowTotals())
-    result += QString("<th%1>%2</th>").arg(headerspan).arg(i18nc("Total balance", "Total"));
+    stream << QString("<th%1>%2</th>").arg(headerspan).arg(i18nc("Total balance", "Total"));
 
-  result += "</tr></thead>\n";
+  stream << "</tr></thead>\n";
 
   //
   // Header for multiple columns
   //
   if (span > 1) {
-    result += "<tr><td></td>";
+    stream << "<tr><td></td>";
 
     column = 0;
     while (column < m_numColumns) {
@@ -1655,7 +1671,7 @@ QString PivotTable::renderHTML() const
         lb = leftborder;
 
       for (int i = 0; i < m_rowTypeList.size(); ++i) {
-        result += QString("<td%2>%1</td>")
+        stream << QString("<td%2>%1</td>")
                   .arg(m_columnTypeHeaderList[i])
                   .arg(i == 0 ? lb : QString());
       }
@@ -1663,12 +1679,12 @@ QString PivotTable::renderHTML() const
     }
     if (m_config.isShowingRowTotals()) {
       for (int i = 0; i < m_rowTypeList.size(); ++i) {
-        result += QString("<td%2>%1</td>")
+        stream << QString("<td%2>%1</td>")
                   .arg(m_columnTypeHeaderList[i])
                   .arg(i == 0 ? leftborder : QString());
       }
     }
-    result += "</tr>";
+    stream << "</tr>";
   }
 
 
@@ -1705,7 +1721,7 @@ QString PivotTable::renderHTML() const
       //
 
       if (!(m_config.isIncludingPrice() || m_config.isIncludingAveragePrice()))
-        result += QString("<tr class=\"sectionheader\"><td class=\"left\"%1>%2</td></tr>\n").arg(colspan).arg((*it_outergroup).m_displayName);
+        stream << QString("<tr class=\"sectionheader\"><td class=\"left\"%1>%2</td></tr>\n").arg(colspan).arg((*it_outergroup).m_displayName);
 
       // Skip the inner groups if the report only calls for outer group totals to be shown
       if (m_config.detailLevel() != eMyMoney::Report::DetailLevel::Group) {
@@ -1818,7 +1834,7 @@ QString PivotTable::renderHTML() const
           bool isUsed = false;
           if (m_config.detailLevel() == eMyMoney::Report::DetailLevel::All && ((*it_innergroup).size() > 1)) {
             // Print the individual rows
-            result += innergroupdata;
+            stream << innergroupdata;
 
             if (m_config.isConvertCurrency() && m_config.isShowingColumnTotals()) {
               // Start the TOTALS row
@@ -1878,7 +1894,7 @@ QString PivotTable::renderHTML() const
 
             finalRow += "</tr>\n";
             if (isUsed) {
-              result += finalRow;
+              stream << finalRow;
               ++rownum;
             }
           }
@@ -1894,7 +1910,7 @@ QString PivotTable::renderHTML() const
       //
 
       if (m_config.isConvertCurrency() && m_config.isShowingColumnTotals()) {
-        result += QString("<tr class=\"sectionfooter\"><td class=\"left\">%1&nbsp;%2</td>").arg(i18nc("Total balance", "Total")).arg((*it_outergroup).m_displayName);
+        stream << QString("<tr class=\"sectionfooter\"><td class=\"left\">%1&nbsp;%2</td>").arg(i18nc("Total balance", "Total")).arg((*it_outergroup).m_displayName);
         column = 0;
         while (column < m_numColumns) {
           QString lb;
@@ -1902,7 +1918,7 @@ QString PivotTable::renderHTML() const
             lb = leftborder;
 
           for (int i = 0; i < m_rowTypeList.size(); ++i) {
-            result += QString("<td%2>%1</td>")
+            stream << QString("<td%2>%1</td>")
                       .arg(coloredAmount((*it_outergroup).m_total[ m_rowTypeList[i] ][column], QString(), precision))
                       .arg(i == 0 ? lb : QString());
           }
@@ -1912,12 +1928,12 @@ QString PivotTable::renderHTML() const
 
         if (m_config.isShowingRowTotals()) {
           for (int i = 0; i < m_rowTypeList.size(); ++i) {
-            result += QString("<td%2>%1</td>")
+            stream << QString("<td%2>%1</td>")
                       .arg(coloredAmount((*it_outergroup).m_total[ m_rowTypeList[i] ].m_total, QString(), precision))
                       .arg(i == 0 ? leftborder : QString());
           }
         }
-        result += "</tr>\n";
+        stream << "</tr>\n";
       }
 
       ++it_outergroup;
@@ -1931,8 +1947,8 @@ QString PivotTable::renderHTML() const
   //
 
   if (m_config.isConvertCurrency() && m_config.isShowingColumnTotals()) {
-    result += QString("<tr class=\"spacer\"><td>&nbsp;</td></tr>\n");
-    result += QString("<tr class=\"reportfooter\"><td class=\"left\">%1</td>").arg(i18n("Grand Total"));
+    stream << QString("<tr class=\"spacer\"><td>&nbsp;</td></tr>\n");
+    stream << QString("<tr class=\"reportfooter\"><td class=\"left\">%1</td>").arg(i18n("Grand Total"));
     auto totalcolumn = 0;
     while (totalcolumn < m_numColumns) {
       QString lb;
@@ -1940,7 +1956,7 @@ QString PivotTable::renderHTML() const
         lb = leftborder;
 
       for (int i = 0; i < m_rowTypeList.size(); ++i) {
-        result += QString("<td%2>%1</td>")
+        stream << QString("<td%2>%1</td>")
                   .arg(coloredAmount(m_grid.m_total[ m_rowTypeList[i] ][totalcolumn], QString(), precision))
                   .arg(i == 0 ? lb : QString());
       }
@@ -1950,23 +1966,25 @@ QString PivotTable::renderHTML() const
 
     if (m_config.isShowingRowTotals()) {
       for (int i = 0; i < m_rowTypeList.size(); ++i) {
-        result += QString("<td%2>%1</td>")
+        stream << QString("<td%2>%1</td>")
                   .arg(coloredAmount(m_grid.m_total[ m_rowTypeList[i] ].m_total, QString(), precision))
                   .arg(i == 0 ? leftborder : QString());
       }
     }
 
-    result += "</tr>\n";
+    stream << "</tr>\n";
   }
-  result += "</table>\n";
-  return result;
+  stream << "</table>\n";
+  return true;
 }
 
 void PivotTable::dump(const QString& file, const QString& /* context */) const
 {
   QFile g(file);
   g.open(QIODevice::WriteOnly);
-  QTextStream(&g) << renderHTML();
+  QTextStream stream(&g);
+  writeHTML(stream, -1);
+  stream.flush();
   g.close();
 }
 
@@ -1980,7 +1998,7 @@ QString PivotTable::coloredAmount(const MyMoneyMoney& amount, const QString& cur
   const auto value = amount.formatMoney(currencySymbol, prec);
   if (amount.isNegative())
     return QString::fromLatin1("<font color=%1>%2</font>")
-        .arg(KMyMoneySettings::schemeColor(SchemeColor::Negative).name(), value);
+        .arg(m_settings.negativeColor.name(), value);
   else
     return value;
 }
@@ -2024,7 +2042,7 @@ void PivotTable::calculateBudgetDiff()
 void PivotTable::calculateForecast()
 {
   //setup forecast
-  MyMoneyForecast forecast = KMyMoneyUtils::forecast();
+  MyMoneyForecast forecast = m_settings.forecast;
 
   //since this is a net worth forecast we want to include all account even those that are not in use
   forecast.setIncludeUnusedAccounts(true);
@@ -2183,7 +2201,7 @@ void PivotTable::calculateMovingAverage()
             QDate averageEnd = columnDate(column).addDays(delta);
             for (QDate averageDate = averageStart; averageDate <= averageEnd; averageDate = averageDate.addDays(1)) {
               if (m_config.isConvertCurrency()) {
-                totalPrice += it_row.key().deepCurrencyPrice(averageDate) * it_row.key().baseCurrencyPrice(averageDate);
+                totalPrice += deepBaseCurrencyPrice(it_row.key(), averageDate);
               } else {
                 totalPrice += it_row.key().deepCurrencyPrice(averageDate);
               }
@@ -2235,7 +2253,7 @@ void PivotTable::calculateMovingAverage()
             QDate averageEnd = columnDate(column);
             for (QDate averageDate = averageStart; averageDate <= averageEnd; averageDate = averageDate.addDays(1)) {
               if (m_config.isConvertCurrency()) {
-                totalPrice += it_row.key().deepCurrencyPrice(averageDate) * it_row.key().baseCurrencyPrice(averageDate);
+                totalPrice += deepBaseCurrencyPrice(it_row.key(), averageDate);
               } else {
                 totalPrice += it_row.key().deepCurrencyPrice(averageDate);
               }
@@ -2345,7 +2363,7 @@ void PivotTable::includeInvestmentSubAccounts()
   // account are also selected
   QStringList accountList;
   if (m_config.accounts(accountList)) {
-    if (!KMyMoneySettings::expertMode()) {
+    if (!m_settings.expertMode) {
       foreach (const auto sAccount, accountList) {
         auto acc = MyMoneyFile::instance()->account(sAccount);
         if (acc.accountType() == eMyMoney::Account::Type::Investment) {
@@ -73,8 +73,10 @@ public:
     * Create a Pivot table style report
     *
     * @param _report The configuration parameters for this report
+    * @param progress receives the progress of the computation
+    * @param settings the user settings to compute the report with
     */
-  explicit PivotTable(const MyMoneyReport& _report);
+  explicit PivotTable(const MyMoneyReport& _report, ReportProgress* progress = nullptr, const ReportSettings& settings = ReportSettings::current());
 
   /**
     * virtual Destructor
@@ -82,17 +84,16 @@ public:
   virtual ~PivotTable() {}
 
   /**
-    * Render the report body to an HTML stream.
+    * Render the report body to an HTML stream. The rows of a pivot
+    * table are accounts, so they are always written completely.
     *
-    * @return QString HTML string representing the report body
+    * @return always @c true
     */
-  QString renderHTML() const final override;
+  bool writeHTML(QTextStream& stream, int maxRows) const final override;
   /**
     * Render the report to a comma-separated-values stream.
-    *
-    * @return QString CSV string representing the report
     */
-  QString renderCSV() const final override;
+  void writeCSV(QTextStream& stream) const final override;
 
   /**
     * Render the report to a graphical chart
@@ -292,6 +293,12 @@ protected:
     */
   void convertToBaseCurrency();
 
+  /**
+    * Returns the number of rows in the grid. Used to report the
+    * progress of the passes which visit all rows.
+    */
+  int gridRowCount() const;
+
   /**
     * Convert each value in the grid to the account/category's deep currency
     *
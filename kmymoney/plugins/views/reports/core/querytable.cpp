@@ -69,7 +69,7 @@ namespace reports
   *
   */
 
-QueryTable::QueryTable(const MyMoneyReport& _report): ListTable(_report)
+QueryTable::QueryTable(const MyMoneyReport& _report, ReportProgress* progress, const ReportSettings& settings): ListTable(_report, progress, settings)
 {
   // separated into its own method to allow debugging (setting breakpoints
   // directly in ctors somehow does not work for me (ipwizard))
@@ -279,13 +279,13 @@ void QueryTable::constructTotalRows()
   const auto rows = m_rows.count();
   for (int i = 0; i < rows-1; ++i) {
     // it should be unlikely that total row is at the top of rows, so...
-    if ((m_rows.at(i)[ctRank] == QLatin1String("5")) || (m_rows.at(i)[ctTopAccount].isEmpty())) {
+    if ((m_rows.at(i).cell(ctRank).toInt() == 5) || (m_rows.at(i).cell(ctTopAccount).isEmpty())) {
       m_rows.move(i, rows - 1);                       // ...move it at the end
       --i; // check the same slot again
-    } else if (m_rows.at(i)[ctRank] == QLatin1String("4")) {
+    } else if (m_rows.at(i).cell(ctRank).toInt() == 4) {
       // search last entry of same topAccount
       auto last = i+1;
-      while ((m_rows.at(i)[ctTopAccount] == m_rows.at(last)[ctTopAccount]) && (last < (rows - 1))) {
+      while ((m_rows.at(i).cell(ctTopAccount) == m_rows.at(last).cell(ctTopAccount)) && (last < (rows - 1))) {
         ++last;
       }
       // move subtotal to last entry
@@ -326,7 +326,7 @@ void QueryTable::constructTotalRows()
     iNextRow = iCurrentRow + 1;
 
     // total rows are useless at summing so remove whole block of them at once
-    while (iNextRow != m_rows.count() && (m_rows.at(iNextRow).value(ctRank) == QLatin1String("4") || m_rows.at(iNextRow).value(ctRank) == QLatin1String("5"))) {
+    while (iNextRow != m_rows.count() && (m_rows.at(iNextRow).cell(ctRank).toInt() == 4 || m_rows.at(iNextRow).cell(ctRank).toInt() == 5)) {
       stashedTotalRows.append(m_rows.takeAt(iNextRow)); // ...but stash them just in case
     }
 
@@ -334,11 +334,11 @@ void QueryTable::constructTotalRows()
 
     // sum all subtotal values for lowest group
     QString currencyID = m_rows.at(iCurrentRow).value(ctCurrency);
-    if (m_rows.at(iCurrentRow).value(ctRank) == QLatin1String("1")) { // don't sum up on balance (rank = 0 || rank = 3) and minor split (rank = 2)
+    if (m_rows.at(iCurrentRow).cell(ctRank).toInt() == 1) { // don't sum up on balance (rank = 0 || rank = 3) and minor split (rank = 2)
       foreach (auto subtotal, subtotals) {
         if (!totalCurrency.contains(currencyID))
           totalCurrency[currencyID].append(totalGroups);
-        totalCurrency[currencyID].last()[subtotal] += MyMoneyMoney(m_rows.at(iCurrentRow)[subtotal]);
+        totalCurrency[currencyID].last()[subtotal] += m_rows.at(iCurrentRow).money(subtotal);
       }
       totalCurrency[currencyID].last()[ctRowsCount] += MyMoneyMoney::ONE;
     }
@@ -346,7 +346,7 @@ void QueryTable::constructTotalRows()
     auto levelToClose = groups.count();
     if (!lastRow) {
       for (int i = 0; i < groups.count(); ++i) {
-        if (m_rows.at(iCurrentRow)[groups.at(i)] != m_rows.at(iNextRow)[groups.at(i)]) {
+        if (m_rows.at(iCurrentRow).cell(groups.at(i)) != m_rows.at(iNextRow).cell(groups.at(i))) {
           levelToClose = i;
           break;
         }
@@ -359,14 +359,14 @@ void QueryTable::constructTotalRows()
       bool isMainCurrencyTotal = true;
       QMap<QString, QList<QMap<cellTypeE, MyMoneyMoney>>>::iterator currencyGrp = totalCurrency.begin();
       while (currencyGrp != totalCurrency.end()) {
-        if (!MyMoneyMoney((*currencyGrp).at(i + 1).value(ctRowsCount)).isZero()) {    // if no rows summed up, then no totals row
+        if (!(*currencyGrp).at(i + 1).value(ctRowsCount).isZero()) {    // if no rows summed up, then no totals row
           TableRow totalsRow;
           // sum all subtotal values for higher groups (excluding grand total) and reset lowest group values
           QMap<cellTypeE, MyMoneyMoney>::iterator upperGrp = (*currencyGrp)[i].begin();
           QMap<cellTypeE, MyMoneyMoney>::iterator lowerGrp = (*currencyGrp)[i + 1].begin();
 
           while(upperGrp != (*currencyGrp)[i].end()) {
-            totalsRow[lowerGrp.key()] = lowerGrp.value().toString();  // fill totals row with subtotal values...
+            totalsRow.set(lowerGrp.key(), lowerGrp.value());  // fill totals row with subtotal values...
             (*upperGrp) += (*lowerGrp);
             //          (*lowerGrp) = MyMoneyMoney();
             ++upperGrp;
@@ -376,15 +376,15 @@ void QueryTable::constructTotalRows()
           // custom total values calculations
           foreach (auto subtotal, subtotals) {
             if (subtotal == ctReturnInvestment)
-              totalsRow[subtotal] = helperROI((*currencyGrp).at(i + 1).value(ctBuys) - (*currencyGrp).at(i + 1).value(ctReinvestIncome), (*currencyGrp).at(i + 1).value(ctSells),
+              totalsRow.set(subtotal, helperROI((*currencyGrp).at(i + 1).value(ctBuys) - (*currencyGrp).at(i + 1).value(ctReinvestIncome), (*currencyGrp).at(i + 1).value(ctSells),
                                               (*currencyGrp).at(i + 1).value(ctStartingBalance), (*currencyGrp).at(i + 1).value(ctEndingBalance) + (*currencyGrp).at(i + 1).value(ctMarketValue),
-                                              (*currencyGrp).at(i + 1).value(ctCashIncome));
+                                              (*currencyGrp).at(i + 1).value(ctCashIncome)));
             else if (subtotal == ctPercentageGain) {
               const MyMoneyMoney denominator = (*currencyGrp).at(i + 1).value(ctBuys).abs();
-              totalsRow[subtotal] = denominator.isZero() ? QString():
-                  (((*currencyGrp).at(i + 1).value(ctBuys) + (*currencyGrp).at(i + 1).value(ctMarketValue)) / denominator).toString();
+              totalsRow.set(subtotal, denominator.isZero() ? TableCell() :
+                  TableCell(((*currencyGrp).at(i + 1).value(ctBuys) + (*currencyGrp).at(i + 1).value(ctMarketValue)) / denominator));
             } else if (subtotal == ctPrice)
-              totalsRow[subtotal] = MyMoneyMoney((*currencyGrp).at(i + 1).value(ctPrice) / (*currencyGrp).at(i + 1).value(ctRowsCount)).toString();
+              totalsRow.set(subtotal, (*currencyGrp).at(i + 1).value(ctPrice) / (*currencyGrp).at(i + 1).value(ctRowsCount));
           }
 
           // total values that aren't calculated here, but are taken untouched from external source, e.g. constructPerformanceRow
@@ -394,7 +394,7 @@ void QueryTable::constructTotalRows()
                 continue;
               foreach (auto subtotal, subtotals) {
                 if (subtotal == ctReturn)
-                  totalsRow[ctReturn] = stashedTotalRows.takeAt(j)[ctReturn];
+                  totalsRow.set(ctReturn, stashedTotalRows.takeAt(j).cell(ctReturn));
               }
               break;
             }
@@ -402,19 +402,19 @@ void QueryTable::constructTotalRows()
 
           (*currencyGrp).replace(i + 1, totalsValues);
           for (int j = 0; j < groups.count(); ++j) {
-            totalsRow[groups.at(j)] = m_rows.at(iCurrentRow)[groups.at(j)];   // ...and identification
+            totalsRow.set(groups.at(j), m_rows.at(iCurrentRow).cell(groups.at(j)));   // ...and identification
           }
 
           currencyID = currencyGrp.key();
           if (currencyID.isEmpty() && totalCurrency.count() > 1)
             currencyID = file->baseCurrency().id();
-          totalsRow[ctCurrency] = currencyID;
+          totalsRow.set(ctCurrency, currencyID);
           if (isMainCurrencyTotal) {
-            totalsRow[ctRank] = QLatin1Char('4');
+            totalsRow.set(ctRank, 4);
             isMainCurrencyTotal = false;
           } else
-            totalsRow[ctRank] = QLatin1Char('5');
-          totalsRow[ctDepth] = QString::number(i);
+            totalsRow.set(ctRank, 5);
+          totalsRow.set(ctDepth, i);
           totalsRow.remove(ctRowsCount);
 
           m_rows.insert(iNextRow++, totalsRow);  // iCurrentRow and iNextRow can diverge here by more than one
@@ -431,44 +431,44 @@ void QueryTable::constructTotalRows()
         TableRow totalsRow;
         QMap<cellTypeE, MyMoneyMoney>::const_iterator grandTotalGrp = (*currencyGrp)[0].constBegin();
         while(grandTotalGrp != (*currencyGrp)[0].constEnd()) {
-          totalsRow[grandTotalGrp.key()] = grandTotalGrp.value().toString();
+          totalsRow.set(grandTotalGrp.key(), grandTotalGrp.value());
           ++grandTotalGrp;
         }
 
         foreach (auto subtotal, subtotals) {
           if (subtotal == ctReturnInvestment)
-            totalsRow[subtotal] = helperROI((*currencyGrp).at(0).value(ctBuys) - (*currencyGrp).at(0).value(ctReinvestIncome), (*currencyGrp).at(0).value(ctSells),
+            totalsRow.set(subtotal, helperROI((*currencyGrp).at(0).value(ctBuys) - (*currencyGrp).at(0).value(ctReinvestIncome), (*currencyGrp).at(0).value(ctSells),
                                             (*currencyGrp).at(0).value(ctStartingBalance), (*currencyGrp).at(0).value(ctEndingBalance) + (*currencyGrp).at(0).value(ctMarketValue),
-                                            (*currencyGrp).at(0).value(ctCashIncome));
+                                            (*currencyGrp).at(0).value(ctCashIncome)));
           else if (subtotal == ctPercentageGain)
-            totalsRow[subtotal] = (((*currencyGrp).at(0).value(ctBuys) + (*currencyGrp).at(0).value(ctMarketValue)) / (*currencyGrp).at(0).value(ctBuys).abs()).toString();
+            totalsRow.set(subtotal, ((*currencyGrp).at(0).value(ctBuys) + (*currencyGrp).at(0).value(ctMarketValue)) / (*currencyGrp).at(0).value(ctBuys).abs());
           else if (subtotal == ctPrice)
-            totalsRow[subtotal] = MyMoneyMoney((*currencyGrp).at(0).value(ctPrice) / (*currencyGrp).at(0).value(ctRowsCount)).toString();
+            totalsRow.set(subtotal, (*currencyGrp).at(0).value(ctPrice) / (*currencyGrp).at(0).value(ctRowsCount));
         }
 
         if (!stashedTotalRows.isEmpty()) {
           for (int j = 0; j < stashedTotalRows.count(); ++j) {
             foreach (auto subtotal, subtotals) {
               if (subtotal == ctReturn)
-                totalsRow[ctReturn] = stashedTotalRows.takeAt(j)[ctReturn];
+                totalsRow.set(ctReturn, stashedTotalRows.takeAt(j).cell(ctReturn));
             }
           }
         }
 
         for (int j = 0; j < groups.count(); ++j) {
-          totalsRow[groups.at(j)] = QString();      // no identification
+          totalsRow.remove(groups.at(j));      // no identification
         }
 
         currencyID = currencyGrp.key();
         if (currencyID.isEmpty() && totalCurrency.count() > 1)
           currencyID = file->baseCurrency().id();
-        totalsRow[ctCurrency] = currencyID;
+        totalsRow.set(ctCurrency, currencyID);
         if (isMainCurrencyTotal) {
-          totalsRow[ctRank] = QLatin1Char('4');
+          totalsRow.set(ctRank, 4);
           isMainCurrencyTotal = false;
         } else
-          totalsRow[ctRank] = QLatin1Char('5');
-        totalsRow[ctDepth] = QString();
+          totalsRow.set(ctRank, 5);
+        totalsRow.remove(ctDepth);
 
         m_rows.append(totalsRow);
         ++currencyGrp;
@@ -529,26 +529,34 @@ void QueryTable::constructTransactionTable()
   //get all transactions for this report
   QList<MyMoneyTransaction> transactions = file->transactionList(report);
   for (QList<MyMoneyTransaction>::const_iterator it_transaction = transactions.constBegin(); it_transaction != transactions.constEnd(); ++it_transaction) {
+    setProgress(it_transaction - transactions.constBegin(), transactions.count());
 
     TableRow qA, qS;
     QDate pd;
     QList<QString> tagIdListCache;
 
-    qA[ctID] = qS[ctID] = (* it_transaction).id();
-    qA[ctEntryDate] = qS[ctEntryDate] = (* it_transaction).entryDate().toString(Qt::ISODate);
-    qA[ctPostDate] = qS[ctPostDate] = (* it_transaction).postDate().toString(Qt::ISODate);
-    qA[ctCommodity] = qS[ctCommodity] = (* it_transaction).commodity();
+    qA.set(ctID, (* it_transaction).id());
+    qS.set(ctID, qA.cell(ctID));
+    qA.set(ctEntryDate, (* it_transaction).entryDate());
+    qS.set(ctEntryDate, qA.cell(ctEntryDate));
+    qA.set(ctPostDate, (* it_transaction).postDate());
+    qS.set(ctPostDate, qA.cell(ctPostDate));
+    qA.set(ctCommodity, (* it_transaction).commodity());
+    qS.set(ctCommodity, qA.cell(ctCommodity));
 
     pd = (* it_transaction).postDate();
-    qA[ctMonth] = qS[ctMonth] = i18n("Month of %1", QDate(pd.year(), pd.month(), 1).toString(Qt::ISODate));
-    qA[ctWeek] = qS[ctWeek] = i18n("Week of %1", pd.addDays(1 - pd.dayOfWeek()).toString(Qt::ISODate));
+    qA.set(ctMonth, i18n("Month of %1", QDate(pd.year(), pd.month(), 1).toString(Qt::ISODate)));
+    qS.set(ctMonth, qA.cell(ctMonth));
+    qA.set(ctWeek, i18n("Week of %1", pd.addDays(1 - pd.dayOfWeek()).toString(Qt::ISODate)));
+    qS.set(ctWeek, qA.cell(ctWeek));
 
     if (!m_containsNonBaseCurrency && (*it_transaction).commodity() != file->baseCurrency().id())
       m_containsNonBaseCurrency = true;
     if (report.isConvertCurrency())
-      qA[ctCurrency] = qS[ctCurrency] = file->baseCurrency().id();
+      qA.set(ctCurrency, file->baseCurrency().id());
     else
-      qA[ctCurrency] = qS[ctCurrency] = (*it_transaction).commodity();
+      qA.set(ctCurrency, (*it_transaction).commodity());
+    qS.set(ctCurrency, qA.cell(ctCurrency));
 
     // to handle splits, we decide on which account to base the split
     // (a reference point or point of view so to speak). here we take the
@@ -561,7 +569,7 @@ void QueryTable::constructTransactionTable()
     QList<MyMoneySplit>::const_iterator myBegin, it_split;
 
     for (it_split = splits.constBegin(), myBegin = splits.constEnd(); it_split != splits.constEnd(); ++it_split) {
-      ReportAccount splitAcc((* it_split).accountId());
+      const ReportAccount& splitAcc = reportAccount((*it_split).accountId());
       // always put split with a "stock" account if it exists
       if (splitAcc.isInvest())
         break;
@@ -606,7 +614,7 @@ void QueryTable::constructTransactionTable()
 
     bool loan_special_case = false;
     if (m_config.queryColumns() & eMyMoney::Report::QueryColumn::Loan) {
-      ReportAccount splitAcc((*it_split).accountId());
+      const ReportAccount& splitAcc = reportAccount((*it_split).accountId());
       loan_special_case = splitAcc.isLoan();
     }
 
@@ -622,7 +630,7 @@ void QueryTable::constructTransactionTable()
     QMap<QString, MyMoneyMoney> xrMap; // container for conversion rates from given currency to myBeginCurrency
     do {
       MyMoneyMoney xr;
-      ReportAccount splitAcc((* it_split).accountId());
+      ReportAccount splitAcc = reportAccount((*it_split).accountId());
       QString splitCurrency;
       if (splitAcc.isInvest())
         splitCurrency = file->account(file->account((*it_split).accountId()).parentAccountId()).currencyId();
@@ -658,16 +666,19 @@ void QueryTable::constructTransactionTable()
                                            (*it_transaction).postDate());  // ...so check conversion rate...
           if (price.isValid()) {
             xr *= price.rate(baseCurrency);                                // ...and multiply it by current price...
-            qA[ctCurrency] = qS[ctCurrency] = baseCurrency;
-          } else
-            qA[ctCurrency] = qS[ctCurrency] = myBeginCurrency;             // ...and set information about non-baseCurrency
+            qA.set(ctCurrency, baseCurrency);
+            qS.set(ctCurrency, qA.cell(ctCurrency));
+          } else {
+            qA.set(ctCurrency, myBeginCurrency);             // ...and set information about non-baseCurrency
+            qS.set(ctCurrency, qA.cell(ctCurrency));
+          }
         }
       } else if (splitAcc.isInvest())
         xr = (*it_split).price();
       else
         xr = MyMoneyMoney::ONE;
 
-      qA[ctTag].clear();
+      qA.remove(ctTag);
 
       if (it_split == myBegin && splits.count() > 1) {
         include_me = m_config.includes(splitAcc);
@@ -677,24 +688,24 @@ void QueryTable::constructTransactionTable()
           //balances but no transactions if the splits are all filtered out -- asoliverez
           accts.insert(splitAcc.id(), splitAcc);
 
-        qA[ctAccount] = splitAcc.name();
-        qA[ctAccountID] = splitAcc.id();
-        qA[ctTopAccount] = splitAcc.topParentName();
+        qA.set(ctAccount, splitAcc.name());
+        qA.set(ctAccountID, splitAcc.id());
+        qA.set(ctTopAccount, splitAcc.topParentName());
 
         if (splitAcc.isInvest()) {
           // use the institution of the parent for stock accounts
-          institution = splitAcc.parent().institutionId();
+          institution = reportAccount(splitAcc.parentAccountId()).institutionId();
           MyMoneyMoney shares = (*it_split).shares();
 
           int pricePrecision = file->security(splitAcc.currencyId()).pricePrecision();
-          qA[ctAction] = (*it_split).action();
-          qA[ctShares] = shares.isZero() ? QString() : shares.toString();
-          qA[ctPrice] = shares.isZero() ? QString() : xr.convertPrecision(pricePrecision).toString();
+          qA.set(ctAction, (*it_split).action());
+          qA.set(ctShares, shares.isZero() ? TableCell() : TableCell(shares));
+          qA.set(ctPrice, shares.isZero() ? TableCell() : TableCell(xr.convertPrecision(pricePrecision)));
 
           if (((*it_split).action() == MyMoneySplit::actionName(eMyMoney::Split::Action::BuyShares)) && shares.isNegative())
-            qA[ctAction] = "Sell";
+            qA.set(ctAction, "Sell");
 
-          qA[ctInvestAccount] = splitAcc.parent().name();
+          qA.set(ctInvestAccount, reportAccount(splitAcc.parentAccountId()).name());
 
           MyMoneySplit stockSplit = (*it_split);
           MyMoneySplit assetAccountSplit;
@@ -707,7 +718,7 @@ void QueryTable::constructTransactionTable()
           if (!(assetAccountSplit == MyMoneySplit())) {
             for (it_split = splits.begin(); it_split != splits.end(); ++it_split) {
               if ((*it_split) == assetAccountSplit) {
-                splitAcc = ReportAccount(assetAccountSplit.accountId()); // switch over from stock split to asset split because amount in stock split doesn't take fees/interests into account
+                splitAcc = reportAccount(assetAccountSplit.accountId()); // switch over from stock split to asset split because amount in stock split doesn't take fees/interests into account
                 myBegin = it_split;                       // set myBegin to asset split, so stock split can be listed in details under splits
                 myBeginCurrency = (file->account((*myBegin).accountId())).currencyId();
                 if (!m_containsNonBaseCurrency && myBeginCurrency != baseCurrency)
@@ -717,13 +728,16 @@ void QueryTable::constructTransactionTable()
                     MyMoneyPrice price = file->price(myBeginCurrency, baseCurrency, (*it_transaction).postDate());
                     if (price.isValid()) {
                       xr = price.rate(baseCurrency);
-                      qA[ctCurrency] = qS[ctCurrency] = baseCurrency;
-                    } else
-                      qA[ctCurrency] = qS[ctCurrency] = myBeginCurrency;
+                      qA.set(ctCurrency, baseCurrency);
+                      qS.set(ctCurrency, qA.cell(ctCurrency));
+                    } else {
+                      qA.set(ctCurrency, myBeginCurrency);
+                      qS.set(ctCurrency, qA.cell(ctCurrency));
+                    }
                   } else
                     xr = MyMoneyMoney::ONE;
 
-                  qA[ctPrice] = shares.isZero() ? QString() : (stockSplit.price() * xr / (*it_split).price()).toString();
+                  qA.set(ctPrice, shares.isZero() ? TableCell() : TableCell(stockSplit.price() * xr / (*it_split).price()));
                   // put conversion rate for all splits with this currency, so...
                   // every split of transaction have the same conversion rate
                   xrMap.insert(splitCurrency, MyMoneyMoney::ONE / (*it_split).price());
@@ -734,44 +748,46 @@ void QueryTable::constructTransactionTable()
             }
           }
         } else
-          qA[ctPrice] = xr.toString();
+          qA.set(ctPrice, xr);
 
         a_fullname = splitAcc.fullName();
         a_memo = (*it_split).memo();
 
         transaction_text = m_config.match((*it_split));
 
-        qA[ctInstitution] = institution.isEmpty()
+        qA.set(ctInstitution, institution.isEmpty()
                             ? i18n("No Institution")
-                            : file->institution(institution).name();
+                            : file->institution(institution).name());
 
-        qA[ctPayee] = payee.isEmpty()
+        qA.set(ctPayee, payee.isEmpty()
                       ? i18n("[Empty Payee]")
-                      : file->payee(payee).name().simplified();
+                      : file->payee(payee).name().simplified());
 
         if (tag_special_case) {
           tagIdListCache = tagIdList;
         } else {
+          QString tags = qA.value(ctTag);
           QString delimiter;
           foreach(const auto tagId, tagIdList) {
-            qA[ctTag] += delimiter + file->tag(tagId).name().simplified();
+            tags += delimiter + file->tag(tagId).name().simplified();
             delimiter = QLatin1Char(',');
           }
+          qA.set(ctTag, tags);
         }
-        qA[ctReconcileDate] = (*it_split).reconcileDate().toString(Qt::ISODate);
-        qA[ctReconcileFlag] = KMyMoneyUtils::reconcileStateToString((*it_split).reconcileFlag(), true);
-        qA[ctNumber] = (*it_split).number();
+        qA.set(ctReconcileDate, (*it_split).reconcileDate());
+        qA.set(ctReconcileFlag, KMyMoneyUtils::reconcileStateToString((*it_split).reconcileFlag(), true));
+        qA.set(ctNumber, (*it_split).number());
 
-        qA[ctMemo] = a_memo;
+        qA.set(ctMemo, a_memo);
 
-        qA[ctValue] = ((*it_split).shares() * xr).convert(fraction).toString();
+        qA.set(ctValue, ((*it_split).shares() * xr).convert(fraction));
 
-        qS[ctReconcileDate] = qA[ctReconcileDate];
-        qS[ctReconcileFlag] = qA[ctReconcileFlag];
-        qS[ctNumber] = qA[ctNumber];
+        qS.set(ctReconcileDate, qA.cell(ctReconcileDate));
+        qS.set(ctReconcileFlag, qA.cell(ctReconcileFlag));
+        qS.set(ctNumber, qA.cell(ctNumber));
 
-        qS[ctTopCategory] = splitAcc.topParentName();
-        qS[ctCategoryType] = i18n("Transfer");
+        qS.set(ctTopCategory, splitAcc.topParentName());
+        qS.set(ctCategoryType, i18n("Transfer"));
 
         // only include the configured accounts
         if (include_me) {
@@ -779,10 +795,10 @@ void QueryTable::constructTransactionTable()
           if (loan_special_case) {
 
             // put the principal amount in the "value" column and convert to lowest fraction
-            qA[ctValue] = (-(*it_split).shares() * xr).convert(fraction).toString();
+            qA.set(ctValue, (-(*it_split).shares() * xr).convert(fraction));
 
-            qA[ctRank] = QLatin1Char('1');
-            qA[ctSplit].clear();
+            qA.set(ctRank, 1);
+            qA.remove(ctSplit);
 
           } else {
             if ((splits.count() > 2) && use_summary) {
@@ -790,10 +806,10 @@ void QueryTable::constructTransactionTable()
               // add the "summarized" split transaction
               // this is the sub-total of the split detail
               // convert to lowest fraction
-              qA[ctRank] = QLatin1Char('1');
-              qA[ctCategory] = i18n("[Split Transaction]");
-              qA[ctTopCategory] = i18nc("Split transaction", "Split");
-              qA[ctCategoryType] = i18nc("Split transaction", "Split");
+              qA.set(ctRank, 1);
+              qA.set(ctCategory, i18n("[Split Transaction]"));
+              qA.set(ctTopCategory, i18nc("Split transaction", "Split"));
+              qA.set(ctCategoryType, i18nc("Split transaction", "Split"));
               m_rows += qA;
             }
           }
@@ -808,10 +824,10 @@ void QueryTable::constructTransactionTable()
 
             if ((*it_split).action() == MyMoneySplit::actionName(eMyMoney::Split::Action::Amortization)) {
               // put the payment in the "payment" column and convert to lowest fraction
-              qA[ctPayee] = value.toString();
+              qA.set(ctPayee, value);
             } else if ((*it_split).action() == MyMoneySplit::actionName(eMyMoney::Split::Action::Interest)) {
               // put the interest in the "interest" column and convert to lowest fraction
-              qA[ctInterest] = value.toString();
+              qA.set(ctInterest, value);
             } else if (splits.count() > 2) {
               // [dv: This comment carried from the original code. I am
               // not exactly clear on what it means or why we do this.]
@@ -821,8 +837,8 @@ void QueryTable::constructTransactionTable()
               // the transaction.  I wish there was a better way.
             } else {
               // accumulate everything else in the "fees" column
-              MyMoneyMoney n0 = MyMoneyMoney(qA[ctFees]);
-              qA[ctFees] = (n0 + value).toString();
+              MyMoneyMoney n0 = qA.money(ctFees);
+              qA.set(ctFees, n0 + value);
             }
             // we don't add qA here for a loan transaction. we'll add one
             // qA after all of the split components have been processed.
@@ -839,17 +855,18 @@ void QueryTable::constructTransactionTable()
 
             //this is when the splits are going to be shown as children of the main split
             if ((splits.count() > 2) && use_summary) {
-              qA[ctValue].clear();
+              qA.remove(ctValue);
 
               //convert to lowest fraction
-              qA[ctSplit] = (-(*it_split).shares() * xr).convert(fraction).toString();
-              qA[ctRank] = QLatin1Char('2');
-              qA[ctTag] = "";
-              QString delimiter = "";
+              qA.set(ctSplit, (-(*it_split).shares() * xr).convert(fraction));
+              qA.set(ctRank, 2);
+              QString tags;
+              QString delimiter;
               for (int i = 0; i < tagIdList.size(); i++) {
-                qA[ctTag] += delimiter + file->tag(tagIdList[i]).name().simplified();
+                tags += delimiter + file->tag(tagIdList[i]).name().simplified();
                 delimiter = ", ";
               }
+              qA.set(ctTag, tags);
             } else {
               //this applies when the transaction has only 2 splits, or each split is going to be
               //shown separately, eg. transactions by category
@@ -859,34 +876,34 @@ void QueryTable::constructTransactionTable()
                 case eMyMoney::Report::RowType::Tag:
                 case eMyMoney::Report::RowType::Payee:
                   if (splitAcc.isIncomeExpense())
-                    qA[ctValue] = (-(*it_split).shares() * xr).convert(fraction).toString(); // needed for category reports, in case of multicurrency transaction it breaks it
+                    qA.set(ctValue, (-(*it_split).shares() * xr).convert(fraction)); // needed for category reports, in case of multicurrency transaction it breaks it
                   break;
                 default:
                   break;
               }
-              qA[ctSplit].clear();
-              qA[ctRank] = QLatin1Char('1');
+              qA.remove(ctSplit);
+              qA.set(ctRank, 1);
             }
 
-            qA [ctMemo] = (*it_split).memo();
+            qA.set(ctMemo, (*it_split).memo());
 
             if (!m_containsNonBaseCurrency && splitAcc.currencyId() != file->baseCurrency().id())
               m_containsNonBaseCurrency = true;
             if (report.isConvertCurrency())
-              qS[ctCurrency] = file->baseCurrency().id();
+              qS.set(ctCurrency, file->baseCurrency().id());
             else
-              qS[ctCurrency] = splitAcc.currency().id();
+              qS.set(ctCurrency, splitAcc.currency().id());
 
             if (! splitAcc.isIncomeExpense()) {
-              qA[ctCategory] = ((*it_split).shares().isNegative()) ?
+              qA.set(ctCategory, ((*it_split).shares().isNegative()) ?
                                i18n("Transfer from %1", splitAcc.fullName())
-                               : i18n("Transfer to %1", splitAcc.fullName());
-              qA[ctTopCategory] = splitAcc.topParentName();
-              qA[ctCategoryType] = i18n("Transfer");
+                               : i18n("Transfer to %1", splitAcc.fullName()));
+              qA.set(ctTopCategory, splitAcc.topParentName());
+              qA.set(ctCategoryType, i18n("Transfer"));
             } else {
-              qA [ctCategory] = splitAcc.fullName();
-              qA [ctTopCategory] = splitAcc.topParentName();
-              qA [ctCategoryType] = MyMoneyAccount::accountTypeToString(splitAcc.accountGroup());
+              qA.set(ctCategory, splitAcc.fullName());
+              qA.set(ctTopCategory, splitAcc.topParentName());
+              qA.set(ctCategoryType, MyMoneyAccount::accountTypeToString(splitAcc.accountGroup()));
             }
 
             if (splits.count() > 1) {
@@ -903,13 +920,15 @@ void QueryTable::constructTransactionTable()
                             || m_config.match((*it_split))))) {
                   if (tag_special_case) {
                     if (tagIdListCache.isEmpty()) {
-                      qA[ctTag] = i18n("[No Tag]");
+                      qA.set(ctTag, i18n("[No Tag]"));
                     } else {
+                      QString tags = qA.value(ctTag);
                       QString delimiter;
                       foreach(const auto tagId, tagIdListCache) {
-                        qA[ctTag] += delimiter + file->tag(tagId).name().simplified();
+                        tags += delimiter + file->tag(tagId).name().simplified();
                         delimiter = QLatin1Char(',');
                       }
+                      qA.set(ctTag, tags);
                     }
                   }
                   m_rows += qA;
@@ -923,43 +942,45 @@ void QueryTable::constructTransactionTable()
             !(splitAcc.isInvest() && include_me)) || splits.count() == 1) { // otherwise stock split is displayed twice in report
           if (! splitAcc.isIncomeExpense()) {
             //multiply by currency and convert to lowest fraction
-            qS[ctValue] = ((*it_split).shares() * xr).convert(fraction).toString();
+            qS.set(ctValue, ((*it_split).shares() * xr).convert(fraction));
 
-            qS[ctRank] = QLatin1Char('1');
+            qS.set(ctRank, 1);
 
-            qS[ctAccount] = splitAcc.name();
-            qS[ctAccountID] = splitAcc.id();
-            qS[ctTopAccount] = splitAcc.topParentName();
+            qS.set(ctAccount, splitAcc.name());
+            qS.set(ctAccountID, splitAcc.id());
+            qS.set(ctTopAccount, splitAcc.topParentName());
 
             if (splits.count() > 1) {
-              qS[ctCategory] = ((*it_split).shares().isNegative())
+              qS.set(ctCategory, ((*it_split).shares().isNegative())
                               ? i18n("Transfer to %1", a_fullname)
-                              : i18n("Transfer from %1", a_fullname);
+                              : i18n("Transfer from %1", a_fullname));
             } else {
-              qS[ctCategory] = i18n("*** UNASSIGNED ***");
+              qS.set(ctCategory, i18n("*** UNASSIGNED ***"));
             }
-            qS[ctInstitution] = institution.isEmpty()
+            qS.set(ctInstitution, institution.isEmpty()
                                 ? i18n("No Institution")
-                                : file->institution(institution).name();
+                                : file->institution(institution).name());
 
-            qS[ctMemo] = (*it_split).memo().isEmpty()
+            qS.set(ctMemo, (*it_split).memo().isEmpty()
                          ? a_memo
-                         : (*it_split).memo();
+                         : (*it_split).memo());
 
             //FIXME-ALEX When is used this? I can't find in which condition we arrive here... maybe this code is useless?
             if (tagIdList.isEmpty()) {
-              qS[ctTag] = i18n("[No Tag]");
+              qS.set(ctTag, i18n("[No Tag]"));
             } else {
+              QString tags = qS.value(ctTag);
               QString delimiter;
               foreach(const auto tagId, tagIdList) {
-                qS[ctTag] += delimiter + file->tag(tagId).name().simplified();
+                tags += delimiter + file->tag(tagId).name().simplified();
                 delimiter = QLatin1Char(',');
               }
+              qS.set(ctTag, tags);
             }
 
-            qS[ctPayee] = payee.isEmpty()
-                          ? qA[ctPayee]
-                          : file->payee(payee).name().simplified();
+            qS.set(ctPayee, payee.isEmpty()
+                          ? qA.value(ctPayee)
+                          : file->payee(payee).name().simplified());
 
             //check the specific split against the filter for text and amount
             //TODO this should be done at the engine, but I have no clear idea how -- asoliverez
@@ -1020,8 +1041,7 @@ void QueryTable::constructTransactionTable()
   QDate startDate, endDate;
 
   report.validDateRange(startDate, endDate);
-  QString strStartDate = startDate.toString(Qt::ISODate);
-  QString strEndDate = endDate.toString(Qt::ISODate);
+  const QDate reportStartDate = startDate;
   startDate = startDate.addDays(-1);
 
   for (auto it_account = accts.constBegin(); it_account != accts.constEnd(); ++it_account) {
@@ -1047,8 +1067,8 @@ void QueryTable::constructTransactionTable()
 
     //get price and convert currency if necessary
     if (m_config.isConvertCurrency()) {
-      startPrice = (account.deepCurrencyPrice(startDate) * account.baseCurrencyPrice(startDate)).reduce();
-      endPrice = (account.deepCurrencyPrice(endDate) * account.baseCurrencyPrice(endDate)).reduce();
+      startPrice = deepBaseCurrencyPrice(account, startDate).reduce();
+      endPrice = deepBaseCurrencyPrice(account, endDate).reduce();
     } else {
       startPrice = account.deepCurrencyPrice(startDate).reduce();
       endPrice = account.deepCurrencyPrice(endDate).reduce();
@@ -1065,38 +1085,38 @@ void QueryTable::constructTransactionTable()
     if (!m_containsNonBaseCurrency && account.currency().id() != file->baseCurrency().id())
       m_containsNonBaseCurrency = true;
     if (m_config.isConvertCurrency())
-      qA[ctCurrency] = file->baseCurrency().id();
+      qA.set(ctCurrency, file->baseCurrency().id());
     else
-      qA[ctCurrency] = account.currency().id();
+      qA.set(ctCurrency, account.currency().id());
 
-    qA[ctAccountID] = account.id();
-    qA[ctAccount] = account.name();
-    qA[ctTopAccount] = account.topParentName();
-    qA[ctInstitution] = institution.isEmpty() ? i18n("No Institution") : file->institution(institution).name();
-    qA[ctRank] = QLatin1Char('0');
+    qA.set(ctAccountID, account.id());
+    qA.set(ctAccount, account.name());
+    qA.set(ctTopAccount, account.topParentName());
+    qA.set(ctInstitution, institution.isEmpty() ? i18n("No Institution") : file->institution(institution).name());
+    qA.set(ctRank, 0);
 
-    qA[ctPrice] = startPrice.convertPrecision(account.currency().pricePrecision()).toString();
+    qA.set(ctPrice, startPrice.convertPrecision(account.currency().pricePrecision()));
     if (account.isInvest()) {
-      qA[ctShares] = startShares.toString();
+      qA.set(ctShares, startShares);
     }
 
-    qA[ctPostDate] = strStartDate;
-    qA[ctBalance] = startBalance.convert(fraction).toString();
-    qA[ctValue].clear();
-    qA[ctID] = QLatin1Char('A');
+    qA.set(ctPostDate, reportStartDate);
+    qA.set(ctBalance, startBalance.convert(fraction));
+    qA.remove(ctValue);
+    qA.set(ctID, QStringLiteral("A"));
     m_rows += qA;
 
     //ending balance
-    qA[ctPrice] = endPrice.convertPrecision(account.currency().pricePrecision()).toString();
+    qA.set(ctPrice, endPrice.convertPrecision(account.currency().pricePrecision()));
 
     if (account.isInvest()) {
-      qA[ctShares] = endShares.toString();
+      qA.set(ctShares, endShares);
     }
 
-    qA[ctPostDate] = strEndDate;
-    qA[ctBalance] = endBalance.toString();
-    qA[ctRank] = QLatin1Char('3');
-    qA[ctID] = QLatin1Char('Z');
+    qA.set(ctPostDate, endDate);
+    qA.set(ctBalance, endBalance);
+    qA.set(ctRank, 3);
+    qA.set(ctID, QStringLiteral("Z"));
     m_rows += qA;
   }
 }
@@ -1349,7 +1369,7 @@ void QueryTable::constructPerformanceRow(const ReportAccount& account, TableRow&
   int fraction = account.currency().smallestAccountFraction();
   MyMoneyMoney price;
   if (m_config.isConvertCurrency())
-    price = account.deepCurrencyPrice(startingDate) * account.baseCurrencyPrice(startingDate);
+    price = deepBaseCurrencyPrice(account, startingDate);
   else
     price = account.deepCurrencyPrice(startingDate);
 
@@ -1360,7 +1380,7 @@ void QueryTable::constructPerformanceRow(const ReportAccount& account, TableRow&
 
   //calculate ending balance
   if (m_config.isConvertCurrency())
-    price = account.deepCurrencyPrice(endingDate) * account.baseCurrencyPrice(endingDate);
+    price = deepBaseCurrencyPrice(account, endingDate);
   else
     price = account.deepCurrencyPrice(endingDate);
 
@@ -1394,10 +1414,10 @@ void QueryTable::constructPerformanceRow(const ReportAccount& account, TableRow&
     all.append(cfList.at(Sells));
     all.append(cfList.at(CashIncome));
 
-    result[ctSells] = sellsTotal.toString();
-    result[ctCashIncome] = cashIncomeTotal.toString();
-    result[ctReinvestIncome] = reinvestIncomeTotal.toString();
-    result[ctEndingBalance] = endingBal.toString();
+    result.set(ctSells, sellsTotal);
+    result.set(ctCashIncome, cashIncomeTotal);
+    result.set(ctReinvestIncome, reinvestIncomeTotal);
+    result.set(ctEndingBalance, endingBal);
     break;
   case eMyMoney::Report::InvestmentSum::Owned:
     buysTotal = cfList.at(BuysOfOwned).total();
@@ -1407,8 +1427,8 @@ void QueryTable::constructPerformanceRow(const ReportAccount& account, TableRow&
     all.append(cfList.at(BuysOfOwned));
     all.append(CashFlowListItem(endingDate, endingBal));
 
-    result[ctReinvestIncome] = reinvestIncomeTotal.toString();
-    result[ctMarketValue] = endingBal.toString();
+    result.set(ctReinvestIncome, reinvestIncomeTotal);
+    result.set(ctMarketValue, endingBal);
     break;
   case eMyMoney::Report::InvestmentSum::Sold:
     buysTotal = cfList.at(BuysOfSells).total();
@@ -1422,8 +1442,8 @@ void QueryTable::constructPerformanceRow(const ReportAccount& account, TableRow&
     all.append(cfList.at(Sells));
     all.append(cfList.at(CashIncome));
 
-    result[ctSells] = sellsTotal.toString();
-    result[ctCashIncome] = cashIncomeTotal.toString();
+    result.set(ctSells, sellsTotal);
+    result.set(ctCashIncome, cashIncomeTotal);
     break;
   case eMyMoney::Report::InvestmentSum::Period:
   default:
@@ -1442,18 +1462,18 @@ void QueryTable::constructPerformanceRow(const ReportAccount& account, TableRow&
     all.append(CashFlowListItem(startingDate, -startingBal));
     all.append(CashFlowListItem(endingDate, endingBal));
 
-    result[ctSells] = sellsTotal.toString();
-    result[ctCashIncome] = cashIncomeTotal.toString();
-    result[ctReinvestIncome] = reinvestIncomeTotal.toString();
-    result[ctStartingBalance] = startingBal.toString();
-    result[ctEndingBalance] = endingBal.toString();
+    result.set(ctSells, sellsTotal);
+    result.set(ctCashIncome, cashIncomeTotal);
+    result.set(ctReinvestIncome, reinvestIncomeTotal);
+    result.set(ctStartingBalance, startingBal);
+    result.set(ctEndingBalance, endingBal);
     break;
   }
 
-  result[ctBuys] = buysTotal.toString();
-  result[ctReturn] = helperIRR(all);
-  result[ctReturnInvestment] = helperROI(buysTotal - reinvestIncomeTotal, sellsTotal, startingBal, endingBal, cashIncomeTotal);
-  result[ctEquityType] = MyMoneySecurity::securityTypeToString(file->security(account.currencyId()).securityType());
+  result.set(ctBuys, buysTotal);
+  result.set(ctReturn, helperIRR(all));
+  result.set(ctReturnInvestment, helperROI(buysTotal - reinvestIncomeTotal, sellsTotal, startingBal, endingBal, cashIncomeTotal));
+  result.set(ctEquityType, MyMoneySecurity::securityTypeToString(file->security(account.currencyId()).securityType()));
 }
 
 void QueryTable::constructCapitalGainRow(const ReportAccount& account, TableRow& result) const
@@ -1485,7 +1505,7 @@ void QueryTable::constructCapitalGainRow(const ReportAccount& account, TableRow&
 
     //calculate ending balance
     if (m_config.isConvertCurrency())
-      price = account.deepCurrencyPrice(endingDate) * account.baseCurrencyPrice(endingDate);
+      price = deepBaseCurrencyPrice(account, endingDate);
     else
       price = account.deepCurrencyPrice(endingDate);
 
@@ -1497,14 +1517,14 @@ void QueryTable::constructCapitalGainRow(const ReportAccount& account, TableRow&
     buysTotal = cfList.at(BuysOfOwned).total() - cfList.at(ReinvestIncome).total();
 
     int pricePrecision = file->security(account.currencyId()).pricePrecision();
-    result[ctBuys] = buysTotal.toString();
-    result[ctShares] = shList.at(BuysOfOwned).toString();
-    result[ctBuyPrice] = (buysTotal.abs() / shList.at(BuysOfOwned)).convertPrecision(pricePrecision).toString();
-    result[ctLastPrice] = price.toString();
-    result[ctMarketValue] = endingBal.toString();
-    result[ctCapitalGain] = (buysTotal + endingBal).toString();
-    result[ctPercentageGain] = buysTotal.isZero() ? QString() :
-        ((buysTotal + endingBal)/buysTotal.abs()).toString();
+    result.set(ctBuys, buysTotal);
+    result.set(ctShares, shList.at(BuysOfOwned));
+    result.set(ctBuyPrice, (buysTotal.abs() / shList.at(BuysOfOwned)).convertPrecision(pricePrecision));
+    result.set(ctLastPrice, price);
+    result.set(ctMarketValue, endingBal);
+    result.set(ctCapitalGain, buysTotal + endingBal);
+    result.set(ctPercentageGain, buysTotal.isZero() ? TableCell() :
+        TableCell((buysTotal + endingBal)/buysTotal.abs()));
     break;
   }
   case eMyMoney::Report::InvestmentSum::Sold:
@@ -1518,21 +1538,21 @@ void QueryTable::constructCapitalGainRow(const ReportAccount& account, TableRow&
         longTermBuysOfSellsTotal.isZero() && longTermSellsOfBuys.isZero())
       return;
 
-    result[ctBuys] = buysTotal.toString();
-    result[ctSells] = sellsTotal.toString();
-    result[ctCapitalGain] = (buysTotal + sellsTotal).toString();
+    result.set(ctBuys, buysTotal);
+    result.set(ctSells, sellsTotal);
+    result.set(ctCapitalGain, buysTotal + sellsTotal);
     if (m_config.isShowingSTLTCapitalGains()) {
-      result[ctBuysLT] = longTermBuysOfSellsTotal.toString();
-      result[ctSellsLT] = longTermSellsOfBuys.toString();
-      result[ctCapitalGainLT] = (longTermBuysOfSellsTotal + longTermSellsOfBuys).toString();
-      result[ctBuysST] = (buysTotal - longTermBuysOfSellsTotal).toString();
-      result[ctSellsST] = (sellsTotal - longTermSellsOfBuys).toString();
-      result[ctCapitalGainST] = ((buysTotal - longTermBuysOfSellsTotal) + (sellsTotal - longTermSellsOfBuys)).toString();
+      result.set(ctBuysLT, longTermBuysOfSellsTotal);
+      result.set(ctSellsLT, longTermSellsOfBuys);
+      result.set(ctCapitalGainLT, longTermBuysOfSellsTotal + longTermSellsOfBuys);
+      result.set(ctBuysST, buysTotal - longTermBuysOfSellsTotal);
+      result.set(ctSellsST, sellsTotal - longTermSellsOfBuys);
+      result.set(ctCapitalGainST, (buysTotal - longTermBuysOfSellsTotal) + (sellsTotal - longTermSellsOfBuys));
     }
     break;
   }
 
-  result[ctEquityType] = MyMoneySecurity::securityTypeToString(file->security(account.currencyId()).securityType());
+  result.set(ctEquityType, MyMoneySecurity::securityTypeToString(file->security(account.currencyId()).securityType()));
 }
 
 void QueryTable::constructAccountTable()
@@ -1546,6 +1566,7 @@ void QueryTable::constructAccountTable()
   QList<MyMoneyAccount> accounts;
   file->accountList(accounts);
   for (auto it_account = accounts.constBegin(); it_account != accounts.constEnd(); ++it_account) {
+    setProgress(it_account - accounts.constBegin(), accounts.count());
     // Note, "Investment" accounts are never included in account rows because
     // they don't contain anything by themselves.  In reports, they are only
     // useful as a "topaccount" aggregator of stock accounts
@@ -1566,13 +1587,13 @@ void QueryTable::constructAccountTable()
           constructPerformanceRow(account, qaccountrow, accountCashflow);
           if (!qaccountrow.isEmpty()) {
             // assuming that that report is grouped by topaccount
-            qaccountrow[ctTopAccount] = account.topParentName();
+            qaccountrow.set(ctTopAccount, account.topParentName());
             if (!m_containsNonBaseCurrency && account.currency().id() != file->baseCurrency().id())
               m_containsNonBaseCurrency = true;
             if (m_config.isConvertCurrency())
-              qaccountrow[ctCurrency] = file->baseCurrency().id();
+              qaccountrow.set(ctCurrency, file->baseCurrency().id());
             else
-              qaccountrow[ctCurrency] = account.currency().id();
+              qaccountrow.set(ctCurrency, account.currency().id());
 
             if (!currencyCashFlow.value(qaccountrow.value(ctCurrency)).contains(qaccountrow.value(ctTopAccount)))
               currencyCashFlow[qaccountrow.value(ctCurrency)].insert(qaccountrow.value(ctTopAccount), accountCashflow);   // create cashflow for unknown account...
@@ -1597,9 +1618,9 @@ void QueryTable::constructAccountTable()
           netprice = netprice.reduce();
           shares = shares.reduce();
           int pricePrecision = file->security(account.currencyId()).pricePrecision();
-          qaccountrow[ctPrice] = netprice.convertPrecision(pricePrecision).toString();
-          qaccountrow[ctValue] = (netprice * shares).convert(fraction).toString();
-          qaccountrow[ctShares] = shares.toString();
+          qaccountrow.set(ctPrice, netprice.convertPrecision(pricePrecision));
+          qaccountrow.set(ctValue, (netprice * shares).convert(fraction));
+          qaccountrow.set(ctShares, shares);
 
           QString iid = account.institutionId();
 
@@ -1608,53 +1629,53 @@ void QueryTable::constructAccountTable()
             iid = account.topParent().institutionId();
 
           if (iid.isEmpty())
-            qaccountrow[ctInstitution] = i18nc("No institution", "None");
+            qaccountrow.set(ctInstitution, i18nc("No institution", "None"));
           else
-            qaccountrow[ctInstitution] = file->institution(iid).name();
+            qaccountrow.set(ctInstitution, file->institution(iid).name());
 
-          qaccountrow[ctType] = MyMoneyAccount::accountTypeToString(account.accountType());
+          qaccountrow.set(ctType, MyMoneyAccount::accountTypeToString(account.accountType()));
         }
       }
 
       if (qaccountrow.isEmpty()) // don't add the account if there are no calculated values
         continue;
 
-      qaccountrow[ctRank] = QLatin1Char('1');
-      qaccountrow[ctAccount] = account.name();
-      qaccountrow[ctAccountID] = account.id();
-      qaccountrow[ctTopAccount] = account.topParentName();
+      qaccountrow.set(ctRank, 1);
+      qaccountrow.set(ctAccount, account.name());
+      qaccountrow.set(ctAccountID, account.id());
+      qaccountrow.set(ctTopAccount, account.topParentName());
       if (!m_containsNonBaseCurrency && account.currency().id() != file->baseCurrency().id())
         m_containsNonBaseCurrency = true;
       if (m_config.isConvertCurrency())
-        qaccountrow[ctCurrency] = file->baseCurrency().id();
+        qaccountrow.set(ctCurrency, file->baseCurrency().id());
       else
-        qaccountrow[ctCurrency] = account.currency().id();
+        qaccountrow.set(ctCurrency, account.currency().id());
       m_rows.append(qaccountrow);
     }
   }
 
   if (m_config.queryColumns() == eMyMoney::Report::QueryColumn::Performance && m_config.isShowingColumnTotals()) {
     TableRow qtotalsrow;
-    qtotalsrow[ctRank] = QLatin1Char('4'); // add identification of row as total
+    qtotalsrow.set(ctRank, 4); // add identification of row as total
     QMap<QString, CashFlowList> currencyGrandCashFlow;
 
     QMap<QString, QMap<QString, CashFlowList>>::iterator currencyAccGrp = currencyCashFlow.begin();
     while (currencyAccGrp != currencyCashFlow.end()) {
       // convert map of top accounts with cashflows to TableRow
       for (QMap<QString, CashFlowList>::iterator topAccount = (*currencyAccGrp).begin(); topAccount != (*currencyAccGrp).end(); ++topAccount) {
-        qtotalsrow[ctTopAccount] = topAccount.key();
-        qtotalsrow[ctReturn] = helperIRR(topAccount.value());
-        qtotalsrow[ctCurrency] = currencyAccGrp.key();
+        qtotalsrow.set(ctTopAccount, topAccount.key());
+        qtotalsrow.set(ctReturn, helperIRR(topAccount.value()));
+        qtotalsrow.set(ctCurrency, currencyAccGrp.key());
         currencyGrandCashFlow[currencyAccGrp.key()] += topAccount.value();  // cumulative sum of cashflows of each topaccount
         m_rows.append(qtotalsrow);            // rows aren't sorted yet, so no problem with adding them randomly at the end
       }
       ++currencyAccGrp;
     }
     QMap<QString, CashFlowList>::iterator currencyGrp = currencyGrandCashFlow.begin();
-    qtotalsrow[ctTopAccount].clear();          // empty topaccount because it's grand cashflow
+    qtotalsrow.remove(ctTopAccount);          // empty topaccount because it's grand cashflow
     while (currencyGrp != currencyGrandCashFlow.end()) {
-      qtotalsrow[ctReturn] = helperIRR(currencyGrp.value());
-      qtotalsrow[ctCurrency] = currencyGrp.key();
+      qtotalsrow.set(ctReturn, helperIRR(currencyGrp.value()));
+      qtotalsrow.set(ctCurrency, currencyGrp.key());
       m_rows.append(qtotalsrow);
       ++currencyGrp;
     }
@@ -1678,25 +1699,33 @@ void QueryTable::constructSplitsTable()
   //get all transactions for this report
   QList<MyMoneyTransaction> transactions = file->transactionList(report);
   for (QList<MyMoneyTransaction>::const_iterator it_transaction = transactions.constBegin(); it_transaction != transactions.constEnd(); ++it_transaction) {
+    setProgress(it_transaction - transactions.constBegin(), transactions.count());
 
     TableRow qA, qS;
     QDate pd;
 
-    qA[ctID] = qS[ctID] = (* it_transaction).id();
-    qA[ctEntryDate] = qS[ctEntryDate] = (* it_transaction).entryDate().toString(Qt::ISODate);
-    qA[ctPostDate] = qS[ctPostDate] = (* it_transaction).postDate().toString(Qt::ISODate);
-    qA[ctCommodity] = qS[ctCommodity] = (* it_transaction).commodity();
+    qA.set(ctID, (* it_transaction).id());
+    qS.set(ctID, qA.cell(ctID));
+    qA.set(ctEntryDate, (* it_transaction).entryDate());
+    qS.set(ctEntryDate, qA.cell(ctEntryDate));
+    qA.set(ctPostDate, (* it_transaction).postDate());
+    qS.set(ctPostDate, qA.cell(ctPostDate));
+    qA.set(ctCommodity, (* it_transaction).commodity());
+    qS.set(ctCommodity, qA.cell(ctCommodity));
 
     pd = (* it_transaction).postDate();
-    qA[ctMonth] = qS[ctMonth] = i18n("Month of %1", QDate(pd.year(), pd.month(), 1).toString(Qt::ISODate));
-    qA[ctWeek] = qS[ctWeek] = i18n("Week of %1", pd.addDays(1 - pd.dayOfWeek()).toString(Qt::ISODate));
+    qA.set(ctMonth, i18n("Month of %1", QDate(pd.year(), pd.month(), 1).toString(Qt::ISODate)));
+    qS.set(ctMonth, qA.cell(ctMonth));
+    qA.set(ctWeek, i18n("Week of %1", pd.addDays(1 - pd.dayOfWeek()).toString(Qt::ISODate)));
+    qS.set(ctWeek, qA.cell(ctWeek));
 
     if (!m_containsNonBaseCurrency && (*it_transaction).commodity() != file->baseCurrency().id())
       m_containsNonBaseCurrency = true;
     if (report.isConvertCurrency())
-      qA[ctCurrency] = qS[ctCurrency] = file->baseCurrency().id();
+      qA.set(ctCurrency, file->baseCurrency().id());
     else
-      qA[ctCurrency] = qS[ctCurrency] = (*it_transaction).commodity();
+      qA.set(ctCurrency, (*it_transaction).commodity());
+    qS.set(ctCurrency, qA.cell(ctCurrency));
 
     // to handle splits, we decide on which account to base the split
     // (a reference point or point of view so to speak). here we take the
@@ -1709,7 +1738,7 @@ void QueryTable::constructSplitsTable()
     //S_end = splits.end();
 
     for (it_split = splits.constBegin(), myBegin = splits.constEnd(); it_split != splits.constEnd(); ++it_split) {
-      ReportAccount splitAcc((* it_split).accountId());
+      const ReportAccount& splitAcc = reportAccount((*it_split).accountId());
       // always put split with a "stock" account if it exists
       if (splitAcc.isInvest())
         break;
@@ -1745,7 +1774,7 @@ void QueryTable::constructSplitsTable()
     // split entries (qS) normally.
     bool loan_special_case = false;
     if (m_config.queryColumns() & eMyMoney::Report::QueryColumn::Loan) {
-      ReportAccount splitAcc((*it_split).accountId());
+      const ReportAccount& splitAcc = reportAccount((*it_split).accountId());
       loan_special_case = splitAcc.isLoan();
     }
 
@@ -1757,7 +1786,7 @@ void QueryTable::constructSplitsTable()
     }
 
     //the account of the beginning splits
-    ReportAccount myBeginAcc((*myBegin).accountId());
+    const ReportAccount& myBeginAcc = reportAccount((*myBegin).accountId());
 
     bool include_me = true;
     QString a_fullname;
@@ -1766,7 +1795,7 @@ void QueryTable::constructSplitsTable()
 
     do {
       MyMoneyMoney xr;
-      ReportAccount splitAcc((* it_split).accountId());
+      const ReportAccount& splitAcc = reportAccount((*it_split).accountId());
 
       //get fraction for account
       int fraction = splitAcc.currency().smallestAccountFraction();
@@ -1781,7 +1810,7 @@ void QueryTable::constructSplitsTable()
       const QList<QString> tagIdList = (*it_split).tagIdList();
 
       if (m_config.isConvertCurrency()) {
-        xr = (splitAcc.deepCurrencyPrice((*it_transaction).postDate()) * splitAcc.baseCurrencyPrice((*it_transaction).postDate())).reduce();
+        xr = deepBaseCurrencyPrice(splitAcc, (*it_transaction).postDate()).reduce();
       } else {
         xr = splitAcc.deepCurrencyPrice((*it_transaction).postDate()).reduce();
       }
@@ -1794,17 +1823,17 @@ void QueryTable::constructSplitsTable()
       if (splitAcc.isInvest()) {
 
         // use the institution of the parent for stock accounts
-        institution = splitAcc.parent().institutionId();
+        institution = reportAccount(splitAcc.parentAccountId()).institutionId();
         MyMoneyMoney shares = (*it_split).shares();
         int pricePrecision = file->security(splitAcc.currencyId()).pricePrecision();
-        qA[ctAction] = (*it_split).action();
-        qA[ctShares] = shares.isZero() ? QString() : (*it_split).shares().toString();
-        qA[ctPrice] = shares.isZero() ? QString() : xr.convertPrecision(pricePrecision).toString();
+        qA.set(ctAction, (*it_split).action());
+        qA.set(ctShares, shares.isZero() ? TableCell() : TableCell((*it_split).shares()));
+        qA.set(ctPrice, shares.isZero() ? TableCell() : TableCell(xr.convertPrecision(pricePrecision)));
 
         if (((*it_split).action() == MyMoneySplit::actionName(eMyMoney::Split::Action::BuyShares)) && (*it_split).shares().isNegative())
-          qA[ctAction] = "Sell";
+          qA.set(ctAction, "Sell");
 
-        qA[ctInvestAccount] = splitAcc.parent().name();
+        qA.set(ctInvestAccount, reportAccount(splitAcc.parentAccountId()).name());
       }
 
       include_me = m_config.includes(splitAcc);
@@ -1812,56 +1841,58 @@ void QueryTable::constructSplitsTable()
       a_memo = (*it_split).memo();
 
       int pricePrecision = file->security(splitAcc.currencyId()).pricePrecision();
-      qA[ctPrice] = xr.convertPrecision(pricePrecision).toString();
-      qA[ctAccount] = splitAcc.name();
-      qA[ctAccountID] = splitAcc.id();
-      qA[ctTopAccount] = splitAcc.topParentName();
+      qA.set(ctPrice, xr.convertPrecision(pricePrecision));
+      qA.set(ctAccount, splitAcc.name());
+      qA.set(ctAccountID, splitAcc.id());
+      qA.set(ctTopAccount, splitAcc.topParentName());
 
-      qA[ctInstitution] = institution.isEmpty()
+      qA.set(ctInstitution, institution.isEmpty()
                           ? i18n("No Institution")
-                          : file->institution(institution).name();
+                          : file->institution(institution).name());
 
       //FIXME-ALEX Is this useless? Isn't constructSplitsTable called only for cashflow type report?
+      QString tags = qA.value(ctTag);
       QString delimiter;
       foreach(const auto tagId, tagIdList) {
-        qA[ctTag] += delimiter + file->tag(tagId).name().simplified();
+        tags += delimiter + file->tag(tagId).name().simplified();
         delimiter = QLatin1Char(',');
       }
+      qA.set(ctTag, tags);
 
-      qA[ctPayee] = payee.isEmpty()
+      qA.set(ctPayee, payee.isEmpty()
                     ? i18n("[Empty Payee]")
-                    : file->payee(payee).name().simplified();
+                    : file->payee(payee).name().simplified());
 
-      qA[ctReconcileDate] = (*it_split).reconcileDate().toString(Qt::ISODate);
-      qA[ctReconcileFlag] = KMyMoneyUtils::reconcileStateToString((*it_split).reconcileFlag(), true);
-      qA[ctNumber] = (*it_split).number();
+      qA.set(ctReconcileDate, (*it_split).reconcileDate());
+      qA.set(ctReconcileFlag, KMyMoneyUtils::reconcileStateToString((*it_split).reconcileFlag(), true));
+      qA.set(ctNumber, (*it_split).number());
 
-      qA[ctMemo] = a_memo;
+      qA.set(ctMemo, a_memo);
 
-      qS[ctReconcileDate] = qA[ctReconcileDate];
-      qS[ctReconcileFlag] = qA[ctReconcileFlag];
-      qS[ctNumber] = qA[ctNumber];
+      qS.set(ctReconcileDate, qA.cell(ctReconcileDate));
+      qS.set(ctReconcileFlag, qA.cell(ctReconcileFlag));
+      qS.set(ctNumber, qA.cell(ctNumber));
 
-      qS[ctTopCategory] = splitAcc.topParentName();
+      qS.set(ctTopCategory, splitAcc.topParentName());
 
       // only include the configured accounts
       if (include_me) {
         // add the "summarized" split transaction
         // this is the sub-total of the split detail
         // convert to lowest fraction
-        qA[ctValue] = ((*it_split).shares() * xr).convert(fraction).toString();
-        qA[ctRank] = QLatin1Char('1');
+        qA.set(ctValue, ((*it_split).shares() * xr).convert(fraction));
+        qA.set(ctRank, 1);
 
         //fill in account information
         if (! splitAcc.isIncomeExpense() && it_split != myBegin) {
-          qA[ctAccount] = ((*it_split).shares().isNegative()) ?
+          qA.set(ctAccount, ((*it_split).shares().isNegative()) ?
                           i18n("Transfer to %1", myBeginAcc.fullName())
-                          : i18n("Transfer from %1", myBeginAcc.fullName());
+                          : i18n("Transfer from %1", myBeginAcc.fullName()));
         } else if (it_split == myBegin) {
           //handle the main split
           if ((splits.count() > 2)) {
             //if it is the main split and has multiple splits, note that
-            qA[ctAccount] = i18n("[Split Transaction]");
+            qA.set(ctAccount, i18n("[Split Transaction]"));
           } else {
             //fill the account name of the second split
             QList<MyMoneySplit>::const_iterator tempSplit = splits.constBegin();
@@ -1871,24 +1902,24 @@ void QueryTable::constructSplitsTable()
               ++tempSplit;
 
             //show the name of the category, or "transfer to/from" if it as an account
-            ReportAccount tempSplitAcc((*tempSplit).accountId());
+            const ReportAccount& tempSplitAcc = reportAccount((*tempSplit).accountId());
             if (! tempSplitAcc.isIncomeExpense()) {
-              qA[ctAccount] = ((*it_split).shares().isNegative()) ?
+              qA.set(ctAccount, ((*it_split).shares().isNegative()) ?
                               i18n("Transfer to %1", tempSplitAcc.fullName())
-                              : i18n("Transfer from %1", tempSplitAcc.fullName());
+                              : i18n("Transfer from %1", tempSplitAcc.fullName()));
             } else {
-              qA[ctAccount] = tempSplitAcc.fullName();
+              qA.set(ctAccount, tempSplitAcc.fullName());
             }
           }
         } else {
           //in any other case, fill in the account name of the main split
-          qA[ctAccount] = myBeginAcc.fullName();
+          qA.set(ctAccount, myBeginAcc.fullName());
         }
 
         //category data is always the one of the split
-        qA [ctCategory] = splitAcc.fullName();
-        qA [ctTopCategory] = splitAcc.topParentName();
-        qA [ctCategoryType] = MyMoneyAccount::accountTypeToString(splitAcc.accountGroup());
+        qA.set(ctCategory, splitAcc.fullName());
+        qA.set(ctTopCategory, splitAcc.topParentName());
+        qA.set(ctCategoryType, MyMoneyAccount::accountTypeToString(splitAcc.accountGroup()));
 
         m_rows += qA;
 
@@ -1933,8 +1964,7 @@ void QueryTable::constructSplitsTable()
   QDate startDate, endDate;
 
   report.validDateRange(startDate, endDate);
-  QString strStartDate = startDate.toString(Qt::ISODate);
-  QString strEndDate = endDate.toString(Qt::ISODate);
+  const QDate reportStartDate = startDate;
   startDate = startDate.addDays(-1);
 
   for (auto it_account = accts.constBegin(); it_account != accts.constEnd(); ++it_account) {
@@ -1960,8 +1990,8 @@ void QueryTable::constructSplitsTable()
 
     //get price and convert currency if necessary
     if (m_config.isConvertCurrency()) {
-      startPrice = (account.deepCurrencyPrice(startDate) * account.baseCurrencyPrice(startDate)).reduce();
-      endPrice = (account.deepCurrencyPrice(endDate) * account.baseCurrencyPrice(endDate)).reduce();
+      startPrice = deepBaseCurrencyPrice(account, startDate).reduce();
+      endPrice = deepBaseCurrencyPrice(account, endDate).reduce();
     } else {
       startPrice = account.deepCurrencyPrice(startDate).reduce();
       endPrice = account.deepCurrencyPrice(endDate).reduce();
@@ -1978,39 +2008,39 @@ void QueryTable::constructSplitsTable()
     if (!m_containsNonBaseCurrency && account.currency().id() != file->baseCurrency().id())
       m_containsNonBaseCurrency = true;
     if (m_config.isConvertCurrency())
-      qA[ctCurrency] = file->baseCurrency().id();
+      qA.set(ctCurrency, file->baseCurrency().id());
     else
-      qA[ctCurrency] = account.currency().id();
+      qA.set(ctCurrency, account.currency().id());
 
-    qA[ctAccountID] = account.id();
-    qA[ctAccount] = account.name();
-    qA[ctTopAccount] = account.topParentName();
-    qA[ctInstitution] = institution.isEmpty() ? i18n("No Institution") : file->institution(institution).name();
-    qA[ctRank] = QLatin1Char('0');
+    qA.set(ctAccountID, account.id());
+    qA.set(ctAccount, account.name());
+    qA.set(ctTopAccount, account.topParentName());
+    qA.set(ctInstitution, institution.isEmpty() ? i18n("No Institution") : file->institution(institution).name());
+    qA.set(ctRank, 0);
 
     int pricePrecision = file->security(account.currencyId()).pricePrecision();
-    qA[ctPrice] = startPrice.convertPrecision(pricePrecision).toString();
+    qA.set(ctPrice, startPrice.convertPrecision(pricePrecision));
     if (account.isInvest()) {
-      qA[ctShares] = startShares.toString();
+      qA.set(ctShares, startShares);
     }
 
-    qA[ctPostDate] = strStartDate;
-    qA[ctBalance] = startBalance.convert(fraction).toString();
-    qA[ctValue].clear();
-    qA[ctID] = QLatin1Char('A');
+    qA.set(ctPostDate, reportStartDate);
+    qA.set(ctBalance, startBalance.convert(fraction));
+    qA.remove(ctValue);
+    qA.set(ctID, QStringLiteral("A"));
     m_rows += qA;
 
-    qA[ctRank] = QLatin1Char('3');
+    qA.set(ctRank, 3);
     //ending balance
-    qA[ctPrice] = endPrice.convertPrecision(pricePrecision).toString();
+    qA.set(ctPrice, endPrice.convertPrecision(pricePrecision));
 
     if (account.isInvest()) {
-      qA[ctShares] = endShares.toString();
+      qA.set(ctShares, endShares);
     }
 
-    qA[ctPostDate] = strEndDate;
-    qA[ctBalance] = endBalance.toString();
-    qA[ctID] = QLatin1Char('Z');
+    qA.set(ctPostDate, endDate);
+    qA.set(ctBalance, endBalance);
+    qA.set(ctID, QStringLiteral("Z"));
     m_rows += qA;
   }
 }
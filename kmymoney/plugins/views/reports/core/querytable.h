@@ -58,7 +58,7 @@ class ReportAccount;
 class QueryTable : public ListTable
 {
 public:
-  explicit QueryTable(const MyMoneyReport&);
+  explicit QueryTable(const MyMoneyReport&, ReportProgress* progress = nullptr, const ReportSettings& settings = ReportSettings::current());
   void init();
 
 protected:
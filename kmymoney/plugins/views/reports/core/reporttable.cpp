@@ -21,6 +21,7 @@
 // QT Includes
 
 #include <QFile>
+#include <QTextStream>
 
 // ----------------------------------------------------------------------------
 // KDE Includes
@@ -36,16 +37,38 @@
 #include "mymoneysecurity.h"
 #include "mymoneyexception.h"
 
-reports::ReportTable::ReportTable(const MyMoneyReport& _report):
+reports::ReportSettings reports::ReportSettings::current()
+{
+  ReportSettings settings;
+  settings.expertMode = KMyMoneySettings::expertMode();
+  settings.negativeColor = KMyMoneySettings::schemeColor(SchemeColor::Negative);
+  settings.cssFile = KMyMoneySettings::cssFileDefault();
+  settings.variableCSS = KMyMoneyUtils::variableCSS();
+  settings.forecast = KMyMoneyUtils::forecast();
+  return settings;
+}
+
+reports::ReportTable::ReportTable(const MyMoneyReport& _report, ReportProgress* progress, const ReportSettings& settings):
     m_resourceHtml("html"),
     m_reportStyleSheet("reportstylesheet"),
     m_cssFileDefault("kmymoney.css"),
+    m_progress(progress),
     m_config(_report),
+    m_settings(settings),
     m_containsNonBaseCurrency(false)
 
 {
 }
 
+void reports::ReportTable::setProgress(int current, int total) const
+{
+  if (!m_progress)
+    return;
+  if (m_progress->isCanceled())
+    throw MYMONEYEXCEPTION_CSTRING("Report computation canceled");
+  m_progress->setProgress(current, total);
+}
+
 QString reports::ReportTable::cssFileNameGet()
 {
   QString cssfilename;
@@ -57,7 +80,7 @@ QString reports::ReportTable::cssFileNameGet()
 
   if (cssfilename.isEmpty() || !QFile::exists(cssfilename)) {
     // if no report specific stylesheet was found, try to use the configured one
-    cssfilename = KMyMoneySettings::cssFileDefault();
+    cssfilename = m_settings.cssFile;
   }
 
   if (cssfilename.isEmpty() || !QFile::exists(cssfilename)) {
@@ -73,6 +96,23 @@ QString reports::ReportTable::cssFileNameGet()
   return cssfilename;
 }
 
+const reports::ReportAccount& reports::ReportTable::reportAccount(const QString& accountId) const
+{
+  auto it = m_reportAccounts.constFind(accountId);
+  if (it == m_reportAccounts.constEnd())
+    it = m_reportAccounts.insert(accountId, QSharedPointer<ReportAccount>::create(accountId));
+  return **it;
+}
+
+MyMoneyMoney reports::ReportTable::deepBaseCurrencyPrice(const ReportAccount& account, const QDate& date) const
+{
+  const auto key = qMakePair(account.currencyId(), date);
+  auto it = m_deepBaseCurrencyPrices.constFind(key);
+  if (it == m_deepBaseCurrencyPrices.constEnd())
+    it = m_deepBaseCurrencyPrices.insert(key, account.deepCurrencyPrice(date) * account.baseCurrencyPrice(date));
+  return *it;
+}
+
 QString reports::ReportTable::renderHeader(const QString& title, const QByteArray& encoding, bool includeCSS)
 {
   QString header = QString("<!DOCTYPE HTML PUBLIC")
@@ -105,7 +145,7 @@ QString reports::ReportTable::renderHeader(const QString& title, const QByteArra
               + QUrl::fromLocalFile(cssfilename).url() + "\">\n";
   }
 
-  header += KMyMoneyUtils::variableCSS();
+  header += m_settings.variableCSS;
 
   header += "</head>\n<body>\n";
 
@@ -117,51 +157,75 @@ QString reports::ReportTable::renderFooter()
   return "</body>\n</html>\n";
 }
 
+QString reports::ReportTable::renderHTML() const
+{
+  QString result;
+  QTextStream stream(&result);
+  writeHTML(stream, -1);
+  return result;
+}
+
+QString reports::ReportTable::renderCSV() const
+{
+  QString result;
+  QTextStream stream(&result);
+  writeCSV(stream);
+  return result;
+}
+
 QString reports::ReportTable::renderReport(const QString &type, const QByteArray& encoding, const QString &title, bool includeCSS)
 {
-  MyMoneyFile* file = MyMoneyFile::instance();
   QString result;
+  QTextStream stream(&result);
+  renderReport(stream, type, encoding, title, includeCSS);
+  return result;
+}
+
+bool reports::ReportTable::renderReport(QTextStream& stream, const QString &type, const QByteArray& encoding, const QString &title, bool includeCSS, int maxRows)
+{
+  MyMoneyFile* file = MyMoneyFile::instance();
+  auto complete = true;
 
   if (type == QLatin1String("html")) {
     //this renders the HEAD tag and sets the correct css file
-    result = renderHeader(title, encoding, includeCSS);
+    stream << renderHeader(title, encoding, includeCSS);
 
     try {
       // report's name
-      result.append(QString::fromLatin1("<h2 class=\"report\">%1</h2>\n").arg(m_config.name()));
+      stream << QString::fromLatin1("<h2 class=\"report\">%1</h2>\n").arg(m_config.name());
 
       // report's date range
-      result.append(QString::fromLatin1("<div class=\"subtitle\">%1</div>\n"
-                                        "<div class=\"gap\">&nbsp;</div>\n").arg(i18nc("Report date range", "%1 through %2",
-                                                                                       m_config.fromDate().toString(Qt::SystemLocaleShortDate),
-                                                                                       m_config.toDate().toString(Qt::SystemLocaleShortDate))));
+      stream << QString::fromLatin1("<div class=\"subtitle\">%1</div>\n"
+                                    "<div class=\"gap\">&nbsp;</div>\n").arg(i18nc("Report date range", "%1 through %2",
+                                                                                   m_config.fromDate().toString(Qt::SystemLocaleShortDate),
+                                                                                   m_config.toDate().toString(Qt::SystemLocaleShortDate)));
       // report's currency information
       if (m_containsNonBaseCurrency)
-        result.append(QString::fromLatin1("<div class=\"subtitle\">%1</div>\n"
-                                          "<div class=\"gap\">&nbsp;</div>\n").arg(m_config.isConvertCurrency() ?
-                                                                                     i18n("All currencies converted to %1" , file->baseCurrency().name()) :
-                                                                                     i18n("All values shown in %1 unless otherwise noted" , file->baseCurrency().name())));
+        stream << QString::fromLatin1("<div class=\"subtitle\">%1</div>\n"
+                                      "<div class=\"gap\">&nbsp;</div>\n").arg(m_config.isConvertCurrency() ?
+                                                                                 i18n("All currencies converted to %1" , file->baseCurrency().name()) :
+                                                                                 i18n("All values shown in %1 unless otherwise noted" , file->baseCurrency().name()));
 
       //this method is implemented by each concrete class
-      result.append(renderHTML());
+      complete = writeHTML(stream, maxRows);
     } catch (const MyMoneyException &e) {
-      result.append(QString::fromLatin1("<h1>%1</h1><p>%2</p>").arg(i18n("Unable to generate report"),
-                                                                    i18n("There was an error creating your report: \"%1\".\nPlease report this error to the developer's list: kmymoney-devel@kde.org", e.what())));
+      stream << QString::fromLatin1("<h1>%1</h1><p>%2</p>").arg(i18n("Unable to generate report"),
+                                                                i18n("There was an error creating your report: \"%1\".\nPlease report this error to the developer's list: kmymoney-devel@kde.org", e.what()));
     }
 
     //this renders a common footer
-    result.append(QLatin1String("</body>\n</html>\n"));
+    stream << QLatin1String("</body>\n</html>\n");
   } else if (type == QLatin1String("csv")) {
-    result.append(QString::fromLatin1("\"Report: %1\"\n").arg(m_config.name()));
-    result.append(QString::fromLatin1("%1\n").arg(i18nc("Report date range", "%1 through %2",
-                                                        m_config.fromDate().toString(Qt::SystemLocaleShortDate),
-                                                        m_config.toDate().toString(Qt::SystemLocaleShortDate))));
+    stream << QString::fromLatin1("\"Report: %1\"\n").arg(m_config.name());
+    stream << QString::fromLatin1("%1\n").arg(i18nc("Report date range", "%1 through %2",
+                                                    m_config.fromDate().toString(Qt::SystemLocaleShortDate),
+                                                    m_config.toDate().toString(Qt::SystemLocaleShortDate)));
     if (m_containsNonBaseCurrency)
-      result.append(QString::fromLatin1("%1\n").arg(m_config.isConvertCurrency() ?
-                                                      i18n("All currencies converted to %1" , file->baseCurrency().name()) :
-                                                      i18n("All values shown in %1 unless otherwise noted" , file->baseCurrency().name())));
-    result.append(renderCSV());
+      stream << QString::fromLatin1("%1\n").arg(m_config.isConvertCurrency() ?
+                                                  i18n("All currencies converted to %1" , file->baseCurrency().name()) :
+                                                  i18n("All values shown in %1 unless otherwise noted" , file->baseCurrency().name()));
+    writeCSV(stream);
   }
 
-  return result;
+  return complete;
 }
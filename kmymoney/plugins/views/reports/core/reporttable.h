@@ -22,6 +22,10 @@
 // QT Includes
 
 #include <QObject>
+#include <QColor>
+#include <QHash>
+#include <QPair>
+#include <QSharedPointer>
 
 // ----------------------------------------------------------------------------
 // KDE Includes
@@ -30,12 +34,57 @@
 // Project Includes
 
 #include "mymoneyreport.h"
+#include "mymoneyforecast.h"
+#include "reportaccount.h"
+
+class QTextStream;
 
 namespace reports
 {
 
 class KReportChartView;
 
+/**
+  * Interface through which a report table reports the progress of its
+  * computation and learns whether the computation should be stopped.
+  */
+class ReportProgress
+{
+public:
+  virtual ~ReportProgress() {}
+
+  /**
+    * Called by the table with the number of @a current items
+    * processed so far out of @a total items
+    */
+  virtual void setProgress(int current, int total) = 0;
+
+  /**
+    * Returns @c true if the table should stop its computation
+    */
+  virtual bool isCanceled() const = 0;
+};
+
+/**
+  * The user settings a report table depends on. They are read once on the
+  * thread owning the application settings, so that the table can be
+  * computed and rendered by a ReportWorker in another thread.
+  */
+struct ReportSettings
+{
+  bool            expertMode;
+  QColor          negativeColor;
+  QString         cssFile;
+  QString         variableCSS;
+  MyMoneyForecast forecast;
+
+  /**
+    * Returns the current settings. Must only be called on the
+    * thread which owns KMyMoneySettings, usually the GUI thread.
+    */
+  static ReportSettings current();
+};
+
 /**
   * This class serves as base class definition for the concrete report classes
   * This class is abstract but it contains common code used by all children classes
@@ -43,6 +92,8 @@ class KReportChartView;
 class ReportTable : public QObject
 {
   Q_OBJECT
+  KMM_MYMONEY_UNIT_TESTABLE
+
 private:
 
   /**
@@ -80,8 +131,33 @@ private:
    */
   QString m_cssFileDefault;
 
+  /**
+   * The accounts resolved by reportAccount() so far, keyed by account id.
+   * The objects are kept on the heap so that references handed out by
+   * reportAccount() are not moved when the hash grows.
+   */
+  mutable QHash<QString, QSharedPointer<ReportAccount>> m_reportAccounts;
+
+  /**
+   * The prices resolved by deepBaseCurrencyPrice() so far, keyed by
+   * the id of the account's currency or security and the date
+   */
+  mutable QHash<QPair<QString, QDate>, MyMoneyMoney> m_deepBaseCurrencyPrices;
+
+  /**
+   * Receives the progress of the computation, may be @c nullptr
+   */
+  ReportProgress* m_progress;
+
 protected:
-  ReportTable(const MyMoneyReport &_report);
+  ReportTable(const MyMoneyReport &_report, ReportProgress* progress, const ReportSettings& settings);
+
+  /**
+   * Reports that @a current out of @a total items have been processed.
+   *
+   * @throws MyMoneyException if the computation has been canceled
+   */
+  void setProgress(int current, int total) const;
 
   /**
    * Constructs html header.
@@ -101,14 +177,50 @@ protected:
   QString renderFooter();
 
   /**
-   * Constructs the body of the report. Implemented by the concrete classes
+   * Writes the body of the report to @a stream while it is produced.
+   * Implemented by the concrete classes
    * @see PivotTable
    * @see ListTable
-   * @return QString with the html body of the report
+   *
+   * @param stream  stream receiving the html body of the report
+   * @param maxRows maximum number of table rows to write, all rows
+   *                are written if it is negative
+   * @return @c true if all rows have been written
+   */
+  virtual bool writeHTML(QTextStream& stream, int maxRows) const = 0;
+
+  /**
+   * Returns the ReportAccount for the account with @a accountId. The
+   * account and its name hierarchy are resolved only on the first call
+   * for an id, later calls during the same report run return the
+   * same object.
+   *
+   * @param accountId id of the account
+   * @return reference to the cached ReportAccount, which stays valid
+   *         for the lifetime of the table
+   */
+  const ReportAccount& reportAccount(const QString& accountId) const;
+
+  /**
+   * Returns the price to convert a value of @a account from its deep
+   * currency into the base currency on @a date. This is the product of
+   * ReportAccount::deepCurrencyPrice() and ReportAccount::baseCurrencyPrice(),
+   * but the chain security to trading currency to base currency is
+   * resolved only once per security and date during a report run.
+   *
+   * @param account the account whose value is converted
+   * @param date the date of the price
+   * @return the conversion price
    */
-  virtual QString renderHTML() const = 0;
+  MyMoneyMoney deepBaseCurrencyPrice(const ReportAccount& account, const QDate& date) const;
 
   MyMoneyReport m_config;
+
+  /**
+   * The user settings the report is computed and rendered with
+   */
+  const ReportSettings m_settings;
+
   /**
    * Does the report contain any non-base currency
    */
@@ -118,11 +230,24 @@ public:
   virtual ~ReportTable() {}
 
   /**
-   * Constructs a comma separated-file of the report. Implemented by the concrete classes
+   * Writes the report as comma separated values to @a stream while
+   * it is produced. Implemented by the concrete classes
    * @see PivotTable
    * @see ListTable
    */
-  virtual QString renderCSV() const = 0;
+  virtual void writeCSV(QTextStream& stream) const = 0;
+
+  /**
+   * Constructs the body of the report.
+   *
+   * @return QString with the html body of the report
+   */
+  QString renderHTML() const;
+
+  /**
+   * Constructs a comma separated-file of the report.
+   */
+  QString renderCSV() const;
 
   /**
    * Renders a graph from the report. Implemented by the concrete classes
@@ -144,6 +269,26 @@ public:
    * @return complete html document
    */
   QString renderReport(const QString &type, const QByteArray& encoding, const QString& title, bool includeCSS = false);
+
+  /**
+   * Writes the complete document to @a stream while it is produced,
+   * so that large reports can be exported without keeping them in
+   * memory as a whole.
+   *
+   * @param stream      stream receiving the document
+   * @param type        type of the document, either "html" or "csv"
+   * @param encoding    character set encoding
+   * @param title       html title of report
+   * @param includeCSS  flag, whether the generated html has
+   *                        to include the css inline or whether
+   *                        the css is referenced as a link to a file
+   * @param maxRows     maximum number of table rows written to an
+   *                    html document, all rows are written if it is
+   *                    negative
+   *
+   * @return @c true if all rows have been written
+   */
+  bool renderReport(QTextStream& stream, const QString &type, const QByteArray& encoding, const QString& title, bool includeCSS = false, int maxRows = -1);
 };
 
 }
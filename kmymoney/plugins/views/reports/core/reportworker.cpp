@@ -0,0 +1,124 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "reportworker.h"
+
+// ----------------------------------------------------------------------------
+// QT Includes
+
+#include <QTextStream>
+
+// ----------------------------------------------------------------------------
+// KDE Includes
+
+// ----------------------------------------------------------------------------
+// Project Includes
+
+#include "mymoneyfile.h"
+#include "mymoneystoragemgr.h"
+#include "mymoneyexception.h"
+#include "mymoneyenums.h"
+#include "pivottable.h"
+#include "querytable.h"
+#include "objectinfotable.h"
+
+using namespace reports;
+
+ReportWorker::ReportWorker(const MyMoneyReport& report, const QByteArray& encoding, int maxRows, QObject* parent) :
+  QThread(parent),
+  m_report(report),
+  m_encoding(encoding),
+  m_maxRows(maxRows),
+  m_settings(ReportSettings::current()),
+  m_complete(false),
+  m_canceled(0),
+  m_percent(-1)
+{
+  const auto storage = MyMoneyFile::instance()->storage();
+  if (!storage)
+    throw MYMONEYEXCEPTION_CSTRING("No storage object attached to MyMoneyFile");
+  m_storage.reset(storage->snapshot());
+}
+
+ReportWorker::~ReportWorker()
+{
+  // the thread must not outlive its snapshot
+  cancel();
+  wait();
+}
+
+void ReportWorker::cancel()
+{
+  m_canceled.storeRelease(1);
+}
+
+bool ReportWorker::isCanceled() const
+{
+  return m_canceled.loadAcquire() != 0;
+}
+
+void ReportWorker::setProgress(int current, int total)
+{
+  const auto percent = total > 0 ? static_cast<int>(qint64(current) * 100 / total) : 0;
+  if (percent != m_percent) {
+    m_percent = percent;
+    emit progress(percent);
+  }
+}
+
+ReportTable* ReportWorker::takeTable()
+{
+  return m_table.release();
+}
+
+void ReportWorker::run()
+{
+  // all engine objects used by this thread come from the snapshot
+  MyMoneyFile file(m_storage.get());
+  MyMoneyFile::setThreadInstance(&file);
+
+  try {
+    switch (m_report.reportType()) {
+      case eMyMoney::Report::ReportType::PivotTable:
+        m_table.reset(new PivotTable(m_report, this, m_settings));
+        break;
+      case eMyMoney::Report::ReportType::QueryTable:
+        m_table.reset(new QueryTable(m_report, this, m_settings));
+        break;
+      case eMyMoney::Report::ReportType::InfoTable:
+        m_table.reset(new ObjectInfoTable(m_report, this, m_settings));
+        break;
+      default:
+        break;
+    }
+
+    if (m_table) {
+      QTextStream stream(&m_html);
+      m_complete = m_table->renderReport(stream, QLatin1String("html"), m_encoding, m_report.name(), false, m_maxRows);
+      // the table is used by the thread which created the worker
+      m_table->moveToThread(thread());
+    }
+  } catch (const MyMoneyException &e) {
+    m_table.reset();
+    m_html.clear();
+    if (!isCanceled())
+      m_errorMessage = QString::fromLatin1(e.what());
+  }
+
+  MyMoneyFile::setThreadInstance(nullptr);
+  file.detachStorage(m_storage.get());
+  // a database connection opened by the snapshot must be closed by this thread
+  m_storage.reset();
+}
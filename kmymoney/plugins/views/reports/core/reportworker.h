@@ -0,0 +1,128 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REPORTWORKER_H
+#define REPORTWORKER_H
+
+#include <memory>
+
+// ----------------------------------------------------------------------------
+// QT Includes
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QString>
+
+// ----------------------------------------------------------------------------
+// KDE Includes
+
+// ----------------------------------------------------------------------------
+// Project Includes
+
+#include "mymoneyreport.h"
+#include "reporttable.h"
+
+class MyMoneyStorageMgr;
+
+namespace reports
+{
+
+/**
+  * Computes a report in a separate thread so that the user interface
+  * stays responsive. The worker reads from a snapshot of the storage
+  * taken when it is created, so the user can continue to modify the
+  * data while the report is computed. Several workers may run at the
+  * same time, each one with its own snapshot. Transactions and prices
+  * which have not been loaded from a database yet are read by the
+  * snapshot in the worker thread, see MyMoneyStorageMgr::snapshot().
+  * The user settings used by the report are read when the worker is
+  * created as well, because they belong to the GUI thread.
+  *
+  * Once the thread has finished, takeTable() returns the computed table
+  * and html() the table rendered as html. Both are empty if the
+  * computation has been canceled or failed, errorMessage() tells why
+  * it failed.
+  */
+class ReportWorker : public QThread, public ReportProgress
+{
+  Q_OBJECT
+
+public:
+  /**
+    * Creates a worker for @a report. The html of the report will
+    * use the character set @a encoding and contain at most @a maxRows
+    * rows of the table, all rows if @a maxRows is negative.
+    *
+    * @throws MyMoneyException if no snapshot of the storage can be
+    *         taken because a transaction is in progress
+    */
+  ReportWorker(const MyMoneyReport& report, const QByteArray& encoding, int maxRows = -1, QObject* parent = nullptr);
+  ~ReportWorker();
+
+  /**
+    * Asks the worker to stop the computation as soon as possible
+    */
+  void cancel();
+
+  bool isCanceled() const final override;
+  void setProgress(int current, int total) final override;
+
+  /**
+    * Returns the computed table and passes its ownership to the caller.
+    * The table lives in the thread which created the worker.
+    */
+  ReportTable* takeTable();
+
+  QString html() const { return m_html; }
+
+  /**
+    * Returns @c true if html() contains all rows of the table
+    */
+  bool isComplete() const { return m_complete; }
+
+  /**
+    * Returns the reason why the report could not be computed
+    * or an empty string if it has been computed or canceled
+    */
+  QString errorMessage() const { return m_errorMessage; }
+
+Q_SIGNALS:
+  /**
+    * Emitted from the worker thread whenever the
+    * computed part of the report changes by a percent
+    */
+  void progress(int percent);
+
+protected:
+  void run() final override;
+
+private:
+  const MyMoneyReport                 m_report;
+  const QByteArray                    m_encoding;
+  const int                           m_maxRows;
+  const ReportSettings                m_settings;
+  std::unique_ptr<MyMoneyStorageMgr>  m_storage;
+  std::unique_ptr<ReportTable>        m_table;
+  QString                             m_html;
+  bool                                m_complete;
+  QString                             m_errorMessage;
+  QAtomicInt                          m_canceled;
+  int                                 m_percent;
+};
+
+}
+
+#endif
@@ -18,6 +18,9 @@
 
 #include "pivottable-test.h"
 
+#include <memory>
+#include <vector>
+
 #include <QList>
 #include <QFile>
 #include <QTest>
@@ -340,6 +343,85 @@ void PivotTableTest::testSubAccount()
 
 }
 
+void PivotTableTest::testReportAccountCache()
+{
+  TransactionHelper t1(QDate(2004, 11, 7), MyMoneySplit::actionName(eMyMoney::Split::Action::Withdrawal), moParent1, acCredit, acParent);
+  TransactionHelper t2(QDate(2004, 11, 7), MyMoneySplit::actionName(eMyMoney::Split::Action::Withdrawal), moChild, acCredit, acChild);
+
+  MyMoneyReport filter;
+  filter.setRowType(eMyMoney::Report::RowType::ExpenseIncome);
+  filter.setDateFilter(QDate(2004, 9, 1), QDate(2005, 1, 1).addDays(-1));
+  filter.setDetailLevel(eMyMoney::Report::DetailLevel::All);
+  PivotTable spending_f(filter);
+
+  // every account referenced by the transactions is resolved exactly once
+  QVERIFY(spending_f.m_reportAccounts.contains(acCredit));
+  QVERIFY(spending_f.m_reportAccounts.contains(acParent));
+  QVERIFY(spending_f.m_reportAccounts.contains(acChild));
+  const auto cached = spending_f.m_reportAccounts.count();
+  const ReportAccount& child = spending_f.reportAccount(acChild);
+  QCOMPARE(&child, spending_f.m_reportAccounts.value(acChild).data());
+  QCOMPARE(spending_f.m_reportAccounts.count(), cached);
+
+  // and yields the same result as a freshly built ReportAccount
+  foreach (const auto id, spending_f.m_reportAccounts.keys()) {
+    const ReportAccount& account = spending_f.reportAccount(id);
+    const ReportAccount fresh(id);
+    QCOMPARE(account.name(), fresh.name());
+    QCOMPARE(account.fullName(), fresh.fullName());
+    QCOMPARE(account.debugName(), fresh.debugName());
+    QCOMPARE(account.hierarchyDepth(), fresh.hierarchyDepth());
+    QCOMPARE(account.parent().id(), fresh.parent().id());
+  }
+
+  // references stay valid while further accounts are added to the cache
+  QList<MyMoneyAccount> accounts;
+  file->accountList(accounts);
+  foreach (const auto acc, accounts)
+    spending_f.reportAccount(acc.id());
+  QVERIFY(spending_f.m_reportAccounts.count() > cached);
+  QCOMPARE(&spending_f.reportAccount(acChild), &child);
+  QCOMPARE(child.fullName(), ReportAccount(acChild).fullName());
+}
+
+void PivotTableTest::testDeepBaseCurrencyPrice()
+{
+  // a stock traded in CAD needs two prices to get into the base currency
+  MyMoneySecurity equity;
+  equity.setName("Stock CAD");
+  equity.setTradingSymbol("SCAD");
+  equity.setSmallestAccountFraction(1000);
+  equity.setSecurityType(eMyMoney::Security::Type::Stock);
+  equity.setTradingCurrency("CAD");
+  MyMoneyFileTransaction ft;
+  file->addSecurity(equity);
+  file->addPrice(MyMoneyPrice(equity.id(), "CAD", QDate(2004, 1, 1), MyMoneyMoney(10, 1), "test"));
+  file->addPrice(MyMoneyPrice(equity.id(), "CAD", QDate(2004, 6, 1), MyMoneyMoney(12, 1), "test"));
+  file->addPrice(MyMoneyPrice("CAD", "USD", QDate(2004, 1, 1), MyMoneyMoney(75, 100), "test"));
+  ft.commit();
+  acInvestment = makeAccount("Investment", eMyMoney::Account::Type::Investment, moZero, QDate(2004, 1, 1), acAsset);
+  const auto acStock = makeAccount("Stock CAD", eMyMoney::Account::Type::Stock, moZero, QDate(2004, 1, 1), acInvestment, equity.id());
+
+  MyMoneyReport networth_r;
+  networth_r.setRowType(eMyMoney::Report::RowType::AssetLiability);
+  networth_r.setDateFilter(QDate(2004, 1, 1), QDate(2004, 12, 31));
+  networth_r.setConvertCurrency(true);
+  PivotTable networth(networth_r);
+
+  const ReportAccount stock(acStock);
+  const auto cached = networth.m_deepBaseCurrencyPrices.count();
+  foreach (const auto date, QList<QDate>() << QDate(2004, 3, 1) << QDate(2004, 7, 1)) {
+    const auto rate = networth.deepBaseCurrencyPrice(stock, date);
+    QCOMPARE(rate, stock.deepCurrencyPrice(date) * stock.baseCurrencyPrice(date));
+    QCOMPARE(networth.deepBaseCurrencyPrice(stock, date), rate);
+  }
+  QCOMPARE(networth.deepBaseCurrencyPrice(stock, QDate(2004, 3, 1)), MyMoneyMoney(75, 10));
+  QCOMPARE(networth.deepBaseCurrencyPrice(stock, QDate(2004, 7, 1)), MyMoneyMoney(9, 1));
+
+  // each date is resolved once
+  QCOMPARE(networth.m_deepBaseCurrencyPrices.count(), cached + 2);
+}
+
 void PivotTableTest::testFilterIEvsIE()
 {
   // Test that removing an income/spending account will remove the entry from an income/spending report
@@ -1108,3 +1190,49 @@ void PivotTableTest::testHtmlEncoding()
   rx.setCaseSensitivity(Qt::CaseInsensitive);
   QVERIFY(rx.exactMatch(html));
 }
+
+void PivotTableTest::benchmarkInvestmentNetWorth()
+{
+  // 20 stocks with weekly prices over ten years. Half of them are traded
+  // in CAD, so their value needs a second price to get into the base currency.
+  const QDate start(2004, 1, 1);
+  const auto weeks = 10 * 52;
+
+  QStringList stocks;
+  MyMoneyFileTransaction ft;
+  for (auto i = 0; i < 20; ++i) {
+    MyMoneySecurity equity;
+    equity.setName(QString::fromLatin1("Stock %1").arg(i));
+    equity.setTradingSymbol(QString::fromLatin1("STK%1").arg(i));
+    equity.setSmallestAccountFraction(1000);
+    equity.setSecurityType(eMyMoney::Security::Type::Stock);
+    equity.setTradingCurrency(QLatin1String(i % 2 ? "CAD" : "USD"));
+    file->addSecurity(equity);
+    for (auto week = 0; week < weeks; ++week)
+      file->addPrice(MyMoneyPrice(equity.id(), equity.tradingCurrency(), start.addDays(7 * week), MyMoneyMoney(100 + (i + week) % 50, 1), "test"));
+    stocks << equity.id();
+  }
+  for (auto week = 0; week < weeks; ++week)
+    file->addPrice(MyMoneyPrice("CAD", "USD", start.addDays(7 * week), MyMoneyMoney(70 + week % 10, 100), "test"));
+  ft.commit();
+
+  // the helpers remove their transaction when they are destroyed
+  std::vector<std::unique_ptr<InvTransactionHelper>> buys;
+  acInvestment = makeAccount("Investment", eMyMoney::Account::Type::Investment, moZero, start, acAsset);
+  foreach (const auto stock, stocks) {
+    const auto account = makeAccount(file->security(stock).name(), eMyMoney::Account::Type::Stock, moZero, start, acInvestment, stock);
+    for (auto month = 0; month < 120; month += 3)
+      buys.emplace_back(new InvTransactionHelper(start.addMonths(month), MyMoneySplit::actionName(eMyMoney::Split::Action::BuyShares), MyMoneyMoney(10.00), MyMoneyMoney(100.00), account, acChecking, QString()));
+  }
+
+  MyMoneyReport networth_r;
+  networth_r.setRowType(eMyMoney::Report::RowType::AssetLiability);
+  networth_r.setColumnType(eMyMoney::Report::ColumnType::Weeks);
+  networth_r.setDateFilter(start, start.addYears(10).addDays(-1));
+  networth_r.setConvertCurrency(true);
+
+  QBENCHMARK {
+    PivotTable networth(networth_r);
+    QVERIFY(!networth.m_grid["Asset"]["Investment"].m_total[eActual].last().isZero());
+  }
+}
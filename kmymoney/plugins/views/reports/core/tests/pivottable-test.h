@@ -54,6 +54,8 @@ private Q_SLOTS:
   void testSpendingEmpty();
   void testSingleTransaction();
   void testSubAccount();
+  void testReportAccountCache();
+  void testDeepBaseCurrencyPrice();
   void testFilterIEvsIE();
   void testFilterALvsAL();
   void testFilterALvsIE();
@@ -65,6 +67,7 @@ private Q_SLOTS:
   void testInvestment();
   void testBudget();
   void testHtmlEncoding();
+  void benchmarkInvestmentNetWorth();
 };
 
 }
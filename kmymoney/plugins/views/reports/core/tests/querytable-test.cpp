@@ -18,7 +18,12 @@
 
 #include "querytable-test.h"
 
+#include <memory>
+#include <vector>
+
 #include <QFile>
+#include <QBuffer>
+#include <QTextStream>
 #include <QTest>
 
 #include <KLocalizedString>
@@ -26,6 +31,7 @@
 #include "tests/testutilities.h"
 #include "cashflowlist.h"
 #include "querytable.h"
+#include "reportworker.h"
 #include "mymoneyinstitution.h"
 #include "mymoneyaccount.h"
 #include "mymoneysecurity.h"
@@ -308,14 +314,14 @@ void QueryTableTest::testQueryBasics()
   // Test querytable::TableRow::operator> and operator==
 
   QueryTable::TableRow low;
-  low[ListTable::ctPrice] = 'A';
-  low[ListTable::ctLastPrice] = 'B';
-  low[ListTable::ctBuyPrice] = 'C';
+  low.set(ListTable::ctPrice, QStringLiteral("A"));
+  low.set(ListTable::ctLastPrice, QStringLiteral("B"));
+  low.set(ListTable::ctBuyPrice, QStringLiteral("C"));
 
   QueryTable::TableRow high;
-  high[ListTable::ctPrice] = 'A';
-  high[ListTable::ctLastPrice] = 'C';
-  high[ListTable::ctBuyPrice] = 'B';
+  high.set(ListTable::ctPrice, QStringLiteral("A"));
+  high.set(ListTable::ctLastPrice, QStringLiteral("C"));
+  high.set(ListTable::ctBuyPrice, QStringLiteral("B"));
 
   QueryTable::TableRow::setSortCriteria({ListTable::ctPrice, ListTable::ctLastPrice, ListTable::ctBuyPrice});
   QVERIFY(low < high);
@@ -1004,3 +1010,131 @@ void QueryTableTest::testProtectedMethods()
     QFAIL(e.what());
   }
 }
+
+void QueryTableTest::testReportWorker()
+{
+  TransactionHelper t1(QDate(2004, 1, 1), MyMoneySplit::actionName(eMyMoney::Split::Action::Withdrawal), moSolo, acChecking, acSolo);
+  TransactionHelper t2(QDate(2004, 2, 1), MyMoneySplit::actionName(eMyMoney::Split::Action::Withdrawal), moParent1, acCredit, acParent);
+
+  MyMoneyReport filter;
+  filter.setRowType(eMyMoney::Report::RowType::Category);
+  filter.setQueryColumns(static_cast<eMyMoney::Report::QueryColumn>(eMyMoney::Report::QueryColumn::Number | eMyMoney::Report::QueryColumn::Payee | eMyMoney::Report::QueryColumn::Account));
+  filter.setName("Transactions by Category");
+
+  // the worker uses the data as of its creation
+  ReportWorker worker(filter, QByteArray("UTF-8"));
+  TransactionHelper t3(QDate(2004, 3, 1), MyMoneySplit::actionName(eMyMoney::Split::Action::Withdrawal), moParent2, acCredit, acParent);
+  worker.start();
+  QVERIFY(worker.wait());
+
+  QVERIFY(worker.errorMessage().isEmpty());
+  QVERIFY(!worker.html().isEmpty());
+  QScopedPointer<ReportTable> table(worker.takeTable());
+  auto queryTable = dynamic_cast<QueryTable*>(table.data());
+  QVERIFY(queryTable);
+
+  QStringList ids;
+  foreach (const auto row, queryTable->rows())
+    ids << row[ListTable::ctID];
+  QVERIFY(ids.contains(t1.id()));
+  QVERIFY(ids.contains(t2.id()));
+  QVERIFY(!ids.contains(t3.id()));
+
+  // a canceled worker does not deliver a table
+  ReportWorker canceled(filter, QByteArray("UTF-8"));
+  canceled.cancel();
+  canceled.start();
+  QVERIFY(canceled.wait());
+  QVERIFY(canceled.takeTable() == nullptr);
+  QVERIFY(canceled.html().isEmpty());
+  QVERIFY(canceled.errorMessage().isEmpty());
+}
+
+void QueryTableTest::testStreamedRendering()
+{
+  TransactionHelper t1(QDate(2004, 1, 1), MyMoneySplit::actionName(eMyMoney::Split::Action::Withdrawal), moSolo, acChecking, acSolo);
+  TransactionHelper t2(QDate(2004, 2, 1), MyMoneySplit::actionName(eMyMoney::Split::Action::Withdrawal), moParent1, acCredit, acParent);
+  TransactionHelper t3(QDate(2004, 3, 1), MyMoneySplit::actionName(eMyMoney::Split::Action::Withdrawal), moChild, acCredit, acChild);
+
+  MyMoneyReport filter;
+  filter.setRowType(eMyMoney::Report::RowType::Category);
+  filter.setQueryColumns(static_cast<eMyMoney::Report::QueryColumn>(eMyMoney::Report::QueryColumn::Number | eMyMoney::Report::QueryColumn::Payee | eMyMoney::Report::QueryColumn::Account));
+  filter.setName("Transactions by Category");
+
+  QueryTable table(filter);
+  const QByteArray encoding("UTF-8");
+
+  // all rows
+  QString html;
+  QTextStream htmlStream(&html);
+  QVERIFY(table.renderReport(htmlStream, QLatin1String("html"), encoding, filter.name()));
+  QVERIFY(!html.contains(QLatin1String("command=more")));
+
+  // each transaction is shown in the order of the table, starting
+  // with its date linked to the ledger
+  auto transactions = 0;
+  auto pos = 0;
+  foreach (const auto row, table.rows()) {
+    if (row.cell(ListTable::ctRank).toInt() != 1)
+      continue;
+    const auto link = QString::fromLatin1("<a href=ledger?id=%1&tid=%2>%3</a></td>")
+                      .arg(row.value(ListTable::ctAccountID), row.value(ListTable::ctID),
+                           QLocale().toString(row.cell(ListTable::ctPostDate).toDate(), QLocale::ShortFormat));
+    pos = html.indexOf(link, pos);
+    QVERIFY(pos > 0);
+    ++transactions;
+  }
+  QCOMPARE(transactions, 3);
+  QCOMPARE(html.count(QLatin1String("<tr class=\"row-")), transactions);
+
+  // the first row only, followed by a link to the next rows
+  QString page;
+  QTextStream pageStream(&page);
+  QVERIFY(!table.renderReport(pageStream, QLatin1String("html"), encoding, filter.name(), false, 1));
+  QCOMPARE(page.count(QLatin1String("<tr class=\"row-")), 1);
+  QVERIFY(page.endsWith(QLatin1String("</body>\n</html>\n")));
+
+  // the page matches the complete report up to the end of the first
+  // transaction, so no group header is left without its row
+  const auto more = page.indexOf(QLatin1String("<tr class=\"sectionfooter\"><td class=\"left0\" colspan="));
+  QVERIFY(more > 0);
+  QVERIFY(page.indexOf(QLatin1String("command=more"), more) > more);
+  const auto firstRow = html.indexOf(QLatin1String("<tr class=\"row-"));
+  const auto firstRowEnd = html.indexOf(QLatin1String("</tr>\n"), firstRow) + 6;
+  QCOMPARE(page.left(more), html.left(firstRowEnd));
+
+  // the csv written to a device matches the one kept in memory
+  QBuffer buffer;
+  QVERIFY(buffer.open(QIODevice::WriteOnly));
+  QTextStream csvStream(&buffer);
+  csvStream.setCodec("UTF-8");
+  QVERIFY(table.renderReport(csvStream, QLatin1String("csv"), encoding, QString()));
+  csvStream.flush();
+  QCOMPARE(QString::fromUtf8(buffer.data()), table.renderReport(QLatin1String("csv"), encoding, QString()));
+}
+
+void QueryTableTest::benchmarkTransactionReport()
+{
+  // three transactions a day over ten years
+  const QDate start(2004, 1, 1);
+  const auto days = 10 * 365;
+
+  // the helpers remove their transaction when they are destroyed
+  std::vector<std::unique_ptr<TransactionHelper>> transactions;
+  for (auto day = 0; day < days; ++day) {
+    const auto date = start.addDays(day);
+    transactions.emplace_back(new TransactionHelper(date, MyMoneySplit::actionName(eMyMoney::Split::Action::Withdrawal), moSolo, acChecking, acSolo));
+    transactions.emplace_back(new TransactionHelper(date, MyMoneySplit::actionName(eMyMoney::Split::Action::Withdrawal), moParent1, acCredit, acParent));
+    transactions.emplace_back(new TransactionHelper(date, MyMoneySplit::actionName(eMyMoney::Split::Action::Withdrawal), moChild, acCredit, acChild));
+  }
+
+  MyMoneyReport filter;
+  filter.setRowType(eMyMoney::Report::RowType::Category);
+  filter.setQueryColumns(static_cast<eMyMoney::Report::QueryColumn>(eMyMoney::Report::QueryColumn::Number | eMyMoney::Report::QueryColumn::Payee | eMyMoney::Report::QueryColumn::Account));
+  filter.setDateFilter(start, start.addDays(days - 1));
+
+  QBENCHMARK {
+    QueryTable table(filter);
+    QVERIFY(!table.renderHTML().isEmpty());
+  }
+}
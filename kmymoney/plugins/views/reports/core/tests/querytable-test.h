@@ -44,6 +44,9 @@ private Q_SLOTS:
   void testBalanceColumnWithMultipleCurrencies();
   void testTaxReport();
   void testProtectedMethods();
+  void testReportWorker();
+  void testStreamedRendering();
+  void benchmarkTransactionReport();
 };
 
 #endif
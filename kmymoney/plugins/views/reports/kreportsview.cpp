@@ -231,6 +231,11 @@ void KReportsView::slotOpenUrl(const QUrl &url)
       slotCloseCurrent();
     else if (command == QLatin1String("delete"))
       slotDelete();
+    else if (command == QLatin1String("more")) {
+      Q_D(KReportsView);
+      if (auto tab = dynamic_cast<KReportTab*>(d->m_reportTabWidget->currentWidget()))
+        tab->showMoreRows();
+    }
     else
       qWarning() << i18n("Unknown command '%1' in KReportsView::slotOpenUrl()", qPrintable(command));
 
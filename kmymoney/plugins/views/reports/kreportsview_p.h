@@ -28,12 +28,15 @@
 
 #include "kreportsview.h"
 
+#include <memory>
+
 // ----------------------------------------------------------------------------
 // QT Includes
 
 #include <QTreeWidget>
 #include <QTreeWidgetItem>
 #include <QFile>
+#include <QTextStream>
 #include <QTimer>
 #include <QClipboard>
 #include <QList>
@@ -48,6 +51,10 @@
 #include <QMenu>
 #include <QPointer>
 #include <QWheelEvent>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QHBoxLayout>
 #ifdef ENABLE_WEBENGINE
 #include <QWebEngineView>
 #else
@@ -59,6 +66,8 @@
 
 #include <KMessageBox>
 #include <KLocalizedString>
+#include <KGuiItem>
+#include <KStandardGuiItem>
 #include <KChartAbstractCoordinatePlane>
 
 // ----------------------------------------------------------------------------
@@ -82,6 +91,7 @@
 #include "kreportchartview.h"
 #include "pivottable.h"
 #include "reporttable.h"
+#include "reportworker.h"
 #include "reportcontrolimpl.h"
 #include "mymoneyenums.h"
 #include "kmm_printer.h"
@@ -96,6 +106,9 @@ using namespace Icons;
 #define VIEW_HOME           "home"
 #define VIEW_REPORTS        "reports"
 
+// number of rows added to the report shown on screen when more are requested
+#define REPORT_PAGE_ROWS    1000
+
 /**
   * Helper class for KReportView.
   *
@@ -114,6 +127,10 @@ private:
   #endif
   reports::KReportChartView *m_chartView;
   ReportControl             *m_control;
+  QWidget                   *m_progressWidget;
+  QLabel                    *m_progressLabel;
+  QProgressBar              *m_progressBar;
+  QPushButton               *m_cancelButton;
   QVBoxLayout               *m_layout;
   MyMoneyReport m_report;
   bool m_deleteMe;
@@ -122,13 +139,35 @@ private:
   bool m_needReload;
   bool m_isChartViewValid;
   bool m_isTableViewValid;
+  bool m_isTableComplete;
   QPointer<reports::ReportTable> m_table;
 
+  /**
+   * Maximum number of rows shown in the table view,
+   * all rows are shown if it is negative
+   */
+  int m_maxRows;
+
+  /**
+   * The worker computing the report, @c nullptr if it has been computed
+   */
+  reports::ReportWorker* m_worker;
+
   /**
    * Users character set encoding.
    */
   QByteArray m_encoding;
 
+  /**
+   * Takes the result of @a worker once it has finished
+   */
+  void reportFinished(reports::ReportWorker* worker);
+
+  /**
+   * Shows the first m_maxRows rows of the table in the table view
+   */
+  void renderTable();
+
 public:
   KReportTab(QTabWidget* parent, const MyMoneyReport& report, const KReportsView *eventHandler);
   ~KReportTab();
@@ -144,6 +183,10 @@ public:
   void copyToClipboard();
   void saveAs(const QString& filename, bool includeCSS = false);
   void updateReport();
+  /**
+   * Shows the next REPORT_PAGE_ROWS rows of the table
+   */
+  void showMoreRows();
   QString createTable(const QString& links = QString());
   const ReportControl* control() const {
     return m_control;
@@ -201,6 +244,10 @@ KReportTab::KReportTab(QTabWidget* parent, const MyMoneyReport& report, const KR
     #endif
     m_chartView(new KReportChartView(this)),
     m_control(new ReportControl(this)),
+    m_progressWidget(new QWidget(this)),
+    m_progressLabel(new QLabel(m_progressWidget)),
+    m_progressBar(new QProgressBar(m_progressWidget)),
+    m_cancelButton(new QPushButton(m_progressWidget)),
     m_layout(new QVBoxLayout(this)),
     m_report(report),
     m_deleteMe(false),
@@ -209,7 +256,10 @@ KReportTab::KReportTab(QTabWidget* parent, const MyMoneyReport& report, const KR
     m_needReload(true),
     m_isChartViewValid(false),
     m_isTableViewValid(false),
-    m_table(0)
+    m_isTableComplete(true),
+    m_table(0),
+    m_maxRows(REPORT_PAGE_ROWS),
+    m_worker(nullptr)
 {
   m_layout->setSpacing(6);
   m_tableView->setPage(new MyQWebEnginePage(m_tableView));
@@ -224,14 +274,28 @@ KReportTab::KReportTab(QTabWidget* parent, const MyMoneyReport& report, const KR
   m_control->ui->buttonExport->setIcon(Icons::get(Icon::DocumentExport));
   m_control->ui->buttonNew->setIcon(Icons::get(Icon::DocumentNew));
 
+  m_progressBar->setRange(0, 100);
+  KGuiItem::assign(m_cancelButton, KStandardGuiItem::cancel());
+  auto progressLayout = new QHBoxLayout(m_progressWidget);
+  progressLayout->addWidget(m_progressLabel);
+  progressLayout->addWidget(m_progressBar, 10);
+  progressLayout->addWidget(m_cancelButton);
+
   m_chartView->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
   m_chartView->hide();
   m_tableView->hide();
+  m_progressWidget->hide();
   m_layout->addWidget(m_control);
+  m_layout->addWidget(m_progressWidget);
   m_layout->addWidget(m_tableView);
   m_layout->addWidget(m_chartView);
-  m_layout->setStretch(1, 10);
   m_layout->setStretch(2, 10);
+  m_layout->setStretch(3, 10);
+
+  connect(m_cancelButton, &QAbstractButton::clicked, this, [this]() {
+    if (m_worker)
+      m_worker->cancel();
+  });
 
   connect(m_control->ui->buttonChart, &QAbstractButton::clicked,
           eventHandler, &KReportsView::slotToggleChart);
@@ -279,6 +343,7 @@ KReportTab::KReportTab(QTabWidget* parent, const MyMoneyReport& report, const KR
 
 KReportTab::~KReportTab()
 {
+  // a running worker is stopped when it is deleted as our child
   delete m_table;
 }
 
@@ -321,10 +386,33 @@ void KReportTab::print()
           painter.drawText(0, painter.window().height(), file.toLocalFile());
         }
       } else {
+        // print the whole report, not just the rows shown so far,
+        // and show the same rows as before once it has been printed
+        const auto reload = m_table && !m_isTableComplete;
+        if (reload) {
+          const auto maxRows = m_maxRows;
+          m_maxRows = -1;
+          renderTable();
+          m_maxRows = maxRows;
+        }
+        const auto restore = [this, reload]() {
+          if (reload && m_table)
+            renderTable();
+        };
     #ifdef ENABLE_WEBENGINE
-        m_tableView->page()->print(printer, [=] (bool) {});
+        if (reload) {
+          // the page is loaded asynchronously
+          auto connection = std::make_shared<QMetaObject::Connection>();
+          *connection = connect(m_tableView, &QWebEngineView::loadFinished, this, [this, printer, connection, restore](bool) {
+            disconnect(*connection);
+            m_tableView->page()->print(printer, [=] (bool) { restore(); });
+          });
+        } else {
+          m_tableView->page()->print(printer, [=] (bool) {});
+        }
     #else
         m_tableView->print(printer);
+        restore();
     #endif
       }
     }
@@ -333,6 +421,8 @@ void KReportTab::print()
 
 void KReportTab::copyToClipboard()
 {
+  if (!m_table)
+    return;
   QMimeData* pMimeData =  new QMimeData();
   pMimeData->setHtml(m_table->renderReport(QLatin1String("html"), m_encoding, m_report.name(), true));
   QApplication::clipboard()->setMimeData(pMimeData);
@@ -340,17 +430,19 @@ void KReportTab::copyToClipboard()
 
 void KReportTab::saveAs(const QString& filename, bool includeCSS)
 {
+  if (!m_table)
+    return;
   QFile file(filename);
 
   if (file.open(QIODevice::WriteOnly)) {
+    // the report is written while it is rendered
+    QTextStream stream(&file);
     if (QFileInfo(filename).suffix().toLower() == QLatin1String("csv")) {
-      QTextStream(&file) << m_table->renderReport(QLatin1String("csv"), m_encoding, QString());
+      m_table->renderReport(stream, QLatin1String("csv"), m_encoding, QString());
     } else {
-      QString table =
-        m_table->renderReport(QLatin1String("html"), m_encoding, m_report.name(), includeCSS);
-      QTextStream stream(&file);
-      stream << table;
+      m_table->renderReport(stream, QLatin1String("html"), m_encoding, m_report.name(), includeCSS);
     }
+    stream.flush();
     file.close();
   }
 }
@@ -390,33 +482,108 @@ void KReportTab::updateReport()
   delete m_table;
   m_table = 0;
 
-  if (m_report.reportType() == eMyMoney::Report::ReportType::PivotTable) {
-    m_table = new PivotTable(m_report);
-    m_chartEnabled = true;
-  } else if (m_report.reportType() == eMyMoney::Report::ReportType::QueryTable) {
-    m_table = new QueryTable(m_report);
-    m_chartEnabled = false;
-  } else if (m_report.reportType() == eMyMoney::Report::ReportType::InfoTable) {
-    m_table = new ObjectInfoTable(m_report);
-    m_chartEnabled = false;
+  // the result of a computation still running would be outdated
+  if (m_worker) {
+    disconnect(m_worker, &ReportWorker::progress, m_progressBar, &QProgressBar::setValue);
+    m_worker->cancel();
+    m_worker = nullptr;
+  }
+
+  m_chartEnabled = (m_report.reportType() == eMyMoney::Report::ReportType::PivotTable);
+  m_control->ui->buttonChart->setEnabled(false);
+  m_tableView->hide();
+  m_chartView->hide();
+
+  // a new report starts with the first page of rows again
+  m_maxRows = REPORT_PAGE_ROWS;
+
+  // the report is computed in a separate thread from a snapshot of the data
+  try {
+    m_worker = new ReportWorker(m_report, m_encoding, m_maxRows, this);
+  } catch (const MyMoneyException &e) {
+    m_progressLabel->setText(i18n("The report could not be generated: %1", QString::fromLatin1(e.what())));
+    m_progressBar->hide();
+    m_cancelButton->hide();
+    m_progressWidget->show();
+    m_needReload = true;
+    return;
+  }
+
+  const auto worker = m_worker;
+  connect(worker, &ReportWorker::progress, m_progressBar, &QProgressBar::setValue);
+  connect(worker, &QThread::finished, this, [this, worker]() {
+    reportFinished(worker);
+  });
+
+  m_progressLabel->setText(i18n("Generating report..."));
+  m_progressBar->setValue(0);
+  m_progressBar->show();
+  m_cancelButton->show();
+  m_progressWidget->show();
+  worker->start();
+}
+
+void KReportTab::reportFinished(ReportWorker* worker)
+{
+  worker->deleteLater();
+
+  // a newer computation has been started in the meantime
+  if (worker != m_worker)
+    return;
+  m_worker = nullptr;
+
+  m_table = worker->takeTable();
+  if (!m_table) {
+    if (worker->errorMessage().isEmpty())
+      m_progressLabel->setText(i18n("The report has been canceled."));
+    else
+      m_progressLabel->setText(i18n("The report could not be generated: %1", worker->errorMessage()));
+    m_progressBar->hide();
+    m_cancelButton->hide();
+    // try again when the tab is shown the next time
+    m_needReload = true;
+    return;
   }
 
+  m_progressWidget->hide();
   m_control->ui->buttonChart->setEnabled(m_chartEnabled);
 
+  m_tableView->setHtml(worker->html(), QUrl("file://")); // workaround for access permission to css file
+  m_isTableViewValid = true;
+  m_isTableComplete = worker->isComplete();
+
   m_showingChart = !m_showingChart;
   toggleChart();
 }
 
+void KReportTab::renderTable()
+{
+  QString html;
+  QTextStream stream(&html);
+  m_isTableComplete = m_table->renderReport(stream, QLatin1String("html"), m_encoding, m_report.name(), false, m_maxRows);
+  m_tableView->setHtml(html, QUrl("file://")); // workaround for access permission to css file
+  m_isTableViewValid = true;
+}
+
+void KReportTab::showMoreRows()
+{
+  if (!m_table || m_isTableComplete)
+    return;
+  m_maxRows += REPORT_PAGE_ROWS;
+  renderTable();
+}
+
 void KReportTab::toggleChart()
 {
   // for now it will just SHOW the chart.  In the future it actually has to toggle it.
 
+  // the report is still being computed
+  if (!m_table)
+    return;
+
   if (m_showingChart) {
-    if (!m_isTableViewValid) {
-      m_tableView->setHtml(m_table->renderReport(QLatin1String("html"), m_encoding, m_report.name()),
-                                               QUrl("file://")); // workaround for access permission to css file
-    }
-    m_isTableViewValid = true;
+    if (!m_isTableViewValid)
+      renderTable();
     m_tableView->show();
     m_chartView->hide();
 
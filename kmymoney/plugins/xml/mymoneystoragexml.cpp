@@ -26,7 +26,8 @@
 
 #include <QMap>
 #include <QXmlLocator>
-#include <QTextStream>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 #include <QList>
 #include <QDomDocument>
 #include <QDomElement>
@@ -79,7 +80,7 @@ class MyMoneyStorageXML::Private
 {
   friend class MyMoneyStorageXML;
 public:
-  Private() : m_nextTransactionID(0) {}
+  Private() : m_nextTransactionID(0), m_writer(nullptr) {}
 
   QMap<QString, MyMoneyInstitution> iList;
   QMap<QString, MyMoneyAccount> aList;
@@ -99,6 +100,9 @@ public:
   unsigned long     m_nextTransactionID;
   static const int  TRANSACTION_ID_SIZE = 18;
 
+  QXmlStreamWriter* m_writer;
+  QDomElement       m_startedElement;     ///< element whose start tag has already been written
+
   QString nextTransactionID() {
     QString id;
     id.setNum(++m_nextTransactionID);
@@ -113,7 +117,9 @@ namespace test { void writeRCFtoXMLDoc(const MyMoneyReport& filter, QDomDocument
 class MyMoneyXmlContentHandler : public QXmlContentHandler
 {
   friend class MyMoneyXmlContentHandlerTest;
+  friend class MyMoneyXmlStreamReaderTest;
   friend class MyMoneyStorageXML;
+  friend class MyMoneyXmlStreamReader;
   friend bool test::readRCFfromXMLDoc(QList<MyMoneyReport>& list, QDomDocument* doc);
   friend void test::writeRCFtoXMLDoc(const MyMoneyReport& filter, QDomDocument* doc);
 
@@ -183,6 +189,42 @@ private:
   static void writeCostCenter(const MyMoneyCostCenter &costCenter, QDomDocument &document, QDomElement &parent);
 };
 
+/**
+  * This class reads a KMyMoney file from a QXmlStreamReader. Transactions
+  * and their splits, which make up most of a file, are created directly
+  * from the token stream. All other elements are passed on to a
+  * MyMoneyXmlContentHandler which builds a small DOM for each of them.
+  */
+class MyMoneyXmlStreamReader : public QXmlLocator
+{
+  friend class MyMoneyXmlStreamReaderTest;
+
+public:
+  explicit MyMoneyXmlStreamReader(MyMoneyStorageXML* reader);
+
+  /**
+    * Reads the file contained in @a device into the storage of the reader
+    *
+    * @retval true the file was read successfully
+    * @retval false the file could not be parsed, see errorString()
+    */
+  bool read(QIODevice* device);
+  QString errorString() const;
+
+  int columnNumber() const final override;
+  int lineNumber() const final override;
+
+private:
+  MyMoneyStorageXML* m_reader;
+  QXmlStreamReader   m_xml;
+  QString            m_errMsg;
+
+  static QXmlAttributes attributes(const QXmlStreamReader& xml);
+  static void readKeyValueContainer(QXmlStreamReader& xml, MyMoneyKeyValueContainer& container);
+  static MyMoneyTransaction readTransaction(QXmlStreamReader& xml, bool assignEntryDateIfEmpty = true);
+  static MyMoneySplit readSplit(QXmlStreamReader& xml);
+};
+
 MyMoneyXmlContentHandler::MyMoneyXmlContentHandler(MyMoneyStorageXML* reader) :
     m_reader(reader),
     m_loc(0),
@@ -1355,6 +1397,224 @@ void MyMoneyXmlContentHandler::writeCostCenter(const MyMoneyCostCenter &costCent
 
 
 
+MyMoneyXmlStreamReader::MyMoneyXmlStreamReader(MyMoneyStorageXML* reader) :
+    m_reader(reader)
+{
+}
+
+bool MyMoneyXmlStreamReader::read(QIODevice* device)
+{
+  static const auto transactionTag = nodeName(Node::Transaction);
+
+  m_xml.setDevice(device);
+  MyMoneyXmlContentHandler handler(m_reader);
+  handler.setDocumentLocator(this);
+
+  while (!m_xml.atEnd()) {
+    switch (m_xml.readNext()) {
+      case QXmlStreamReader::StartElement:
+        // transactions are created straight from the stream, the
+        // content handler takes care of everything else
+        if (handler.m_level == 0 && m_xml.name().compare(transactionTag, Qt::CaseInsensitive) == 0) {
+          try {
+            auto t0 = readTransaction(m_xml);
+            if (!t0.id().isEmpty()) {
+              MyMoneyTransaction t1(m_reader->d->nextTransactionID(), t0);
+              m_reader->d->tList[t1.uniqueSortKey()] = t1;
+            }
+            m_reader->signalProgress(++handler.m_elementCount, 0);
+          } catch (const MyMoneyException &e) {
+            m_errMsg = i18n("Exception while creating a %1 element: %2", transactionTag, e.what());
+            qWarning() << m_errMsg;
+            return false;
+          }
+        } else if (!handler.startElement(QString(), QString(), m_xml.qualifiedName().toString(), attributes(m_xml))) {
+          m_errMsg = handler.errorString();
+          return false;
+        }
+        break;
+
+      case QXmlStreamReader::EndElement:
+        if (!handler.endElement(QString(), QString(), m_xml.qualifiedName().toString())) {
+          m_errMsg = handler.errorString();
+          return false;
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  if (m_xml.hasError()) {
+    m_errMsg = i18n("%1 in line %2", m_xml.errorString(), m_xml.lineNumber());
+    qWarning() << m_errMsg;
+    return false;
+  }
+  return true;
+}
+
+QString MyMoneyXmlStreamReader::errorString() const
+{
+  return m_errMsg;
+}
+
+int MyMoneyXmlStreamReader::columnNumber() const
+{
+  return m_xml.columnNumber();
+}
+
+int MyMoneyXmlStreamReader::lineNumber() const
+{
+  return m_xml.lineNumber();
+}
+
+QXmlAttributes MyMoneyXmlStreamReader::attributes(const QXmlStreamReader& xml)
+{
+  QXmlAttributes atts;
+  const auto streamAttributes = xml.attributes();
+  for (const auto& attribute : streamAttributes)
+    atts.append(attribute.qualifiedName().toString(), attribute.namespaceUri().toString(), attribute.name().toString(), attribute.value().toString());
+  return atts;
+}
+
+void MyMoneyXmlStreamReader::readKeyValueContainer(QXmlStreamReader& xml, MyMoneyKeyValueContainer& container)
+{
+  static const auto pairTag = elementName(Element::KVP::Pair);
+  static const auto keyAttribute = attributeName(Attribute::KVP::Key);
+  static const auto valueAttribute = attributeName(Attribute::KVP::Value);
+
+  // like the DOM based reader, pick up the pairs on all levels below
+  for (auto depth = 1; depth > 0 && !xml.atEnd();) {
+    switch (xml.readNext()) {
+      case QXmlStreamReader::StartElement:
+        ++depth;
+        if (xml.name() == pairTag) {
+          const auto atts = xml.attributes();
+          container.setValue(atts.value(keyAttribute).toString(), atts.value(valueAttribute).toString());
+        }
+        break;
+      case QXmlStreamReader::EndElement:
+        --depth;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+MyMoneyTransaction MyMoneyXmlStreamReader::readTransaction(QXmlStreamReader& xml, bool assignEntryDateIfEmpty)
+{
+  static const auto transactionTag = nodeName(Node::Transaction);
+  static const auto splitsTag = elementName(Element::Transaction::Splits);
+  static const auto splitTag = elementName(Element::Transaction::Split);
+  static const auto kvpTag = nodeName(Node::KeyValuePairs);
+
+  if (xml.name() != transactionTag)
+    throw MYMONEYEXCEPTION_CSTRING("Node was not TRANSACTION");
+
+  const auto atts = xml.attributes();
+  MyMoneyTransaction transaction(atts.value(attributeName(Attribute::Account::ID)).toString());
+
+  transaction.setPostDate(QDate::fromString(atts.value(attributeName(Attribute::Transaction::PostDate)).toString(), Qt::ISODate));
+  auto entryDate = QDate::fromString(atts.value(attributeName(Attribute::Transaction::EntryDate)).toString(), Qt::ISODate);
+  if (!entryDate.isValid() && assignEntryDateIfEmpty)
+    entryDate = QDate::currentDate();
+  transaction.setEntryDate(entryDate);
+  transaction.setBankID(atts.value(attributeName(Attribute::Transaction::BankID)).toString());
+  transaction.setMemo(atts.value(attributeName(Attribute::Transaction::Memo)).toString());
+  transaction.setCommodity(atts.value(attributeName(Attribute::Transaction::Commodity)).toString());
+
+  while (xml.readNextStartElement()) {
+    if (xml.name() == splitsTag) {
+      // Process any split information found inside the transaction entry.
+      while (xml.readNextStartElement()) {
+        if (xml.name() != splitTag) {
+          xml.skipCurrentElement();
+          continue;
+        }
+        auto s = readSplit(xml);
+
+        if (!transaction.bankID().isEmpty())
+          s.setBankID(transaction.bankID());
+        if (!s.accountId().isEmpty())
+          transaction.addSplit(s);
+        else
+          qDebug("Dropped split because it did not have an account id");
+      }
+
+    } else if (xml.name() == kvpTag) {
+      readKeyValueContainer(xml, transaction);
+
+    } else {
+      xml.skipCurrentElement();
+    }
+  }
+  transaction.setBankID(QString());
+
+  return transaction;
+}
+
+MyMoneySplit MyMoneyXmlStreamReader::readSplit(QXmlStreamReader& xml)
+{
+  static const auto splitTag = nodeName(Node::Split);
+  static const auto tagTag = elementName(Element::Split::Tag);
+  static const auto kvpTag = nodeName(Node::KeyValuePairs);
+
+  if (xml.name() != splitTag)
+    throw MYMONEYEXCEPTION_CSTRING("Node was not SPLIT");
+
+  MyMoneySplit split;
+
+  const auto atts = xml.attributes();
+  split.setPayeeId(atts.value(attributeName(Attribute::Split::Payee)).toString());
+  split.setReconcileDate(QDate::fromString(atts.value(attributeName(Attribute::Split::ReconcileDate)).toString(), Qt::ISODate));
+  split.setAction(atts.value(attributeName(Attribute::Split::Action)).toString());
+  split.setReconcileFlag(static_cast<eMyMoney::Split::State>(atts.value(attributeName(Attribute::Split::ReconcileFlag)).toInt()));
+  split.setMemo(atts.value(attributeName(Attribute::Split::Memo)).toString());
+  split.setValue(MyMoneyMoney(atts.value(attributeName(Attribute::Split::Value)).toString()));
+  split.setShares(MyMoneyMoney(atts.value(attributeName(Attribute::Split::Shares)).toString()));
+  split.setPrice(MyMoneyMoney(atts.value(attributeName(Attribute::Split::Price)).toString()));
+  split.setAccountId(atts.value(attributeName(Attribute::Split::Account)).toString());
+  split.setCostCenterId(atts.value(attributeName(Attribute::Split::CostCenter)).toString());
+  split.setNumber(atts.value(attributeName(Attribute::Split::Number)).toString());
+  split.setBankID(atts.value(attributeName(Attribute::Split::BankID)).toString());
+
+  QList<QString> tagList;
+  auto kvpFound = false;
+  while (xml.readNextStartElement()) {
+    if (xml.name() == tagTag) {
+      tagList << xml.attributes().value(attributeName(Attribute::Split::ID)).toString();
+      xml.skipCurrentElement();
+    } else if (xml.name() == kvpTag && !kvpFound) {
+      // only the first set of pairs is used
+      readKeyValueContainer(xml, split);
+      kvpFound = true;
+    } else {
+      xml.skipCurrentElement();
+    }
+  }
+  split.setTagIdList(tagList);
+
+  auto matchedXml = split.value(attributeName(Attribute::Split::KMMatchedTx));
+  if (!matchedXml.isEmpty()) {
+    // determine between the new and old method to escap the less than symbol
+    if (matchedXml.contains(QLatin1String("&#60;"))) {
+      matchedXml.replace(QLatin1String("&#60;"), QLatin1String("<"));
+    } else {
+      matchedXml.replace(QLatin1String("&lt;"), QLatin1String("<"));
+    }
+    QXmlStreamReader matchedTransaction(matchedXml);
+    // skip the container and position on the transaction
+    matchedTransaction.readNextStartElement();
+    matchedTransaction.readNextStartElement();
+    auto t = readTransaction(matchedTransaction);
+    split.addMatch(t);
+  }
+
+  return split;
+}
+
 MyMoneyStorageXML::MyMoneyStorageXML() :
     m_progressCallback(0),
     m_storage(0),
@@ -1381,20 +1641,12 @@ void MyMoneyStorageXML::readFile(QIODevice* pDevice, MyMoneyStorageMgr* storage)
   m_doc = new QDomDocument;
   Q_CHECK_PTR(m_doc);
 
-  qDebug("reading file");
-  // creating the QXmlInputSource object based on a QIODevice object
-  // reads all data of the underlying object into memory. I have not
-  // found an object that reads on the fly. I tried to derive one myself,
-  // but there could be a severe problem with decoding when reading
-  // blocks of data and not a stream. So I left it the way it is. (ipwizard)
-  QXmlInputSource xml(pDevice);
-
   qDebug("start parsing file");
-  MyMoneyXmlContentHandler mmxml(this);
-  QXmlSimpleReader reader;
-  reader.setContentHandler(&mmxml);
+  // the stream reader pulls the data from the device while
+  // parsing, so the file is never held in memory as a whole
+  MyMoneyXmlStreamReader reader(this);
 
-  if (!reader.parse(&xml, false)) {
+  if (!reader.read(pDevice)) {
     delete m_doc;
     m_doc = 0;
     signalProgress(-1, -1);
@@ -1427,87 +1679,99 @@ void MyMoneyStorageXML::writeFile(QIODevice* qf, MyMoneyStorageMgr* storage)
   m_storage = storage;
 
   // qDebug("XMLWRITER: Starting file write");
+  // The objects are still converted into DOM elements by the various write methods,
+  // but each of them is passed on to the device and dropped right away, so that
+  // the memory needed does not depend on the size of the file.
+  QXmlStreamWriter writer(qf);
+  writer.setAutoFormatting(true);
+  writer.setAutoFormattingIndent(1);
+  d->m_writer = &writer;
+
   m_doc = new QDomDocument(tagName(Tag::KMMFile));
   Q_CHECK_PTR(m_doc);
-  QDomProcessingInstruction instruct = m_doc->createProcessingInstruction("xml", "version=\"1.0\" encoding=\"utf-8\"");
-  m_doc->appendChild(instruct);
 
-  QDomElement mainElement = m_doc->createElement(tagName(Tag::KMMFile));
-  m_doc->appendChild(mainElement);
+  writer.writeStartDocument();
+  writer.writeDTD(QString::fromLatin1("<!DOCTYPE %1>").arg(tagName(Tag::KMMFile)));
+  writer.writeStartElement(tagName(Tag::KMMFile));
 
   QDomElement fileInfo = m_doc->createElement(tagName(Tag::FileInfo));
   writeFileInformation(fileInfo);
-  mainElement.appendChild(fileInfo);
+  finishElement(fileInfo);
 
   QDomElement userInfo = m_doc->createElement(tagName(Tag::User));
   writeUserInformation(userInfo);
-  mainElement.appendChild(userInfo);
+  finishElement(userInfo);
 
   QDomElement institutions = m_doc->createElement(tagName(Tag::Institutions));
   writeInstitutions(institutions);
-  mainElement.appendChild(institutions);
+  finishElement(institutions);
 
   QDomElement payees = m_doc->createElement(tagName(Tag::Payees));
   writePayees(payees);
-  mainElement.appendChild(payees);
+  finishElement(payees);
 
   QDomElement costCenters = m_doc->createElement(tagName(Tag::CostCenters));
   writeCostCenters(costCenters);
-  mainElement.appendChild(costCenters);
+  finishElement(costCenters);
 
   QDomElement tags = m_doc->createElement(tagName(Tag::Tags));
   writeTags(tags);
-  mainElement.appendChild(tags);
+  finishElement(tags);
 
   QDomElement accounts = m_doc->createElement(tagName(Tag::Accounts));
   writeAccounts(accounts);
-  mainElement.appendChild(accounts);
+  finishElement(accounts);
 
   QDomElement transactions = m_doc->createElement(tagName(Tag::Transactions));
   writeTransactions(transactions);
-  mainElement.appendChild(transactions);
+  finishElement(transactions);
 
   QDomElement keyvalpairs = writeKeyValuePairs(m_storage->pairs());
-  mainElement.appendChild(keyvalpairs);
+  finishElement(keyvalpairs);
 
   QDomElement schedules = m_doc->createElement(tagName(Tag::Schedules));
   writeSchedules(schedules);
-  mainElement.appendChild(schedules);
+  finishElement(schedules);
 
   QDomElement equities = m_doc->createElement(tagName(Tag::Securities));
   writeSecurities(equities);
-  mainElement.appendChild(equities);
+  finishElement(equities);
 
   QDomElement currencies = m_doc->createElement(tagName(Tag::Currencies));
   writeCurrencies(currencies);
-  mainElement.appendChild(currencies);
+  finishElement(currencies);
 
   QDomElement prices = m_doc->createElement(tagName(Tag::Prices));
   writePrices(prices);
-  mainElement.appendChild(prices);
+  finishElement(prices);
 
   QDomElement reports = m_doc->createElement(tagName(Tag::Reports));
   writeReports(reports);
-  mainElement.appendChild(reports);
+  finishElement(reports);
 
   QDomElement budgets = m_doc->createElement(tagName(Tag::Budgets));
   writeBudgets(budgets);
-  mainElement.appendChild(budgets);
+  finishElement(budgets);
 
   QDomElement onlineJobs = m_doc->createElement(tagName(Tag::OnlineJobs));
   writeOnlineJobs(onlineJobs);
-  mainElement.appendChild(onlineJobs);
+  finishElement(onlineJobs);
 
-  QTextStream stream(qf);
-  stream.setCodec("UTF-8");
-  stream << m_doc->toString();
+  writer.writeEndElement();
+  writer.writeEndDocument();
 
+  d->m_writer = nullptr;
   delete m_doc;
   m_doc = 0;
 
   //hides the progress bar.
   signalProgress(-1, -1);
 
+  if (writer.hasError()) {
+    m_storage = 0;
+    throw MYMONEYEXCEPTION_CSTRING("Unable to write file");
+  }
+
   // this seems to be nonsense, but it clears the dirty flag
   // as a side-effect.
   m_storage->setLastModificationDate(m_storage->lastModificationDate());
@@ -1515,6 +1779,60 @@ void MyMoneyStorageXML::writeFile(QIODevice* qf, MyMoneyStorageMgr* storage)
   m_storage = 0;
 }
 
+void MyMoneyStorageXML::writeNode(QXmlStreamWriter& writer, const QDomNode& node)
+{
+  if (node.isElement()) {
+    const auto element = node.toElement();
+    writer.writeStartElement(element.tagName());
+    const auto attributes = element.attributes();
+    for (auto i = 0; i < attributes.count(); ++i) {
+      const auto attribute = attributes.item(i).toAttr();
+      writer.writeAttribute(attribute.name(), attribute.value());
+    }
+    for (auto child = element.firstChild(); !child.isNull(); child = child.nextSibling())
+      writeNode(writer, child);
+    writer.writeEndElement();
+
+  } else if (node.isCDATASection()) {
+    writer.writeCDATA(node.nodeValue());
+  } else if (node.isText()) {
+    writer.writeCharacters(node.nodeValue());
+  } else if (node.isComment()) {
+    writer.writeComment(node.nodeValue());
+  }
+}
+
+void MyMoneyStorageXML::flushElement(QDomElement& parent)
+{
+  if (!d->m_writer)
+    return;
+
+  if (d->m_startedElement != parent) {
+    d->m_writer->writeStartElement(parent.tagName());
+    const auto attributes = parent.attributes();
+    for (auto i = 0; i < attributes.count(); ++i) {
+      const auto attribute = attributes.item(i).toAttr();
+      d->m_writer->writeAttribute(attribute.name(), attribute.value());
+    }
+    d->m_startedElement = parent;
+  }
+
+  while (!parent.firstChild().isNull()) {
+    writeNode(*d->m_writer, parent.firstChild());
+    parent.removeChild(parent.firstChild());
+  }
+}
+
+void MyMoneyStorageXML::finishElement(QDomElement& element)
+{
+  if (!d->m_writer || element.isNull())
+    return;
+
+  flushElement(element);
+  d->m_writer->writeEndElement();
+  d->m_startedElement = QDomElement();
+}
+
 bool MyMoneyStorageXML::readFileInformation(const QDomElement& fileInfo)
 {
   signalProgress(0, 3, i18n("Loading file information..."));
@@ -1641,8 +1959,10 @@ void MyMoneyStorageXML::writePayees(QDomElement& payees)
   QList<MyMoneyPayee>::ConstIterator it;
   payees.setAttribute(attributeName(Attribute::General::Count), list.count());
 
-  for (it = list.begin(); it != list.end(); ++it)
+  for (it = list.begin(); it != list.end(); ++it) {
     writePayee(payees, *it);
+    flushElement(payees);
+  }
 }
 
 void MyMoneyStorageXML::writePayee(QDomElement& payee, const MyMoneyPayee& p)
@@ -1682,6 +2002,7 @@ void MyMoneyStorageXML::writeAccounts(QDomElement& accounts)
   int i = 0;
   for (it = list.constBegin(); it != list.constEnd(); ++it) {
     writeAccount(accounts, *it);
+    flushElement(accounts);
     signalProgress(++i, 0);
   }
 }
@@ -1703,6 +2024,7 @@ void MyMoneyStorageXML::writeTransactions(QDomElement& transactions)
   int i = 0;
   for (auto it = list.constBegin(); it != list.constEnd(); ++it) {
     writeTransaction(transactions, *it);
+    flushElement(transactions);
     signalProgress(++i, 0);
   }
 }
@@ -1874,6 +2196,7 @@ void MyMoneyStorageXML::writePrices(QDomElement& prices)
     price.setAttribute(attributeName(Attribute::General::To), it.key().second);
     writePricePair(price, *it);
     prices.appendChild(price);
+    flushElement(prices);
   }
 }
 
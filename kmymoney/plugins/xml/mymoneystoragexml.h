@@ -44,7 +44,9 @@ class QString;
 class QIODevice;
 class QDomElement;
 class QDomDocument;
+class QDomNode;
 class QDate;
+class QXmlStreamWriter;
 
 class MyMoneyStorageMgr;
 class MyMoneyInstitution;
@@ -68,6 +70,7 @@ typedef QMap<MyMoneySecurityPair, MyMoneyPriceEntries> MyMoneyPriceList;
 class MyMoneyStorageXML : public IMyMoneyOperationsFormat
 {
   friend class MyMoneyXmlContentHandler;
+  friend class MyMoneyXmlStreamReader;
 public:
   MyMoneyStorageXML();
   virtual ~MyMoneyStorageXML();
@@ -154,7 +157,24 @@ public:
 
   QDomElement findChildElement(const QString& name, const QDomElement& root);
 
+  /**
+    * Writes the children of @a parent that have been added so far to the
+    * output device and removes them from @a parent. The start tag of @a parent
+    * is written along with the first call. Writers of large groups call this
+    * after each object so that the whole document is never held in memory.
+    * Does nothing if no file is written.
+    */
+  void flushElement(QDomElement& parent);
+
+  /**
+    * Flushes the remaining children of @a element and closes it.
+    */
+  void finishElement(QDomElement& element);
+
 private:
+  static void writeNode(QXmlStreamWriter& writer, const QDomNode& node);
+
+
   void (*m_progressCallback)(int, int, const QString&);
 
 protected:
@@ -0,0 +1,468 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "parallelgzipdevice.h"
+
+#include <zlib.h>
+
+// ----------------------------------------------------------------------------
+// QT Includes
+
+#include <QByteArray>
+#include <QQueue>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+static const int BLOCK_SIZE = 128 * 1024;           ///< uncompressed size of a block compressed by one thread
+static const int DICTIONARY_SIZE = 32 * 1024;       ///< the maximum distance of a deflate back reference
+static const int INPUT_SIZE = 64 * 1024;            ///< amount of compressed data read at once
+static const int MAX_READ_AHEAD = 16;               ///< number of inflated blocks kept ready for the consumer
+
+class ParallelGzipDevice::Private
+{
+public:
+  /**
+    * Compresses one block of data into a piece of a raw deflate stream
+    */
+  class CompressionJob : public QRunnable
+  {
+  public:
+    CompressionJob(Private* owner, const QByteArray& input, const QByteArray& dictionary, bool last) :
+      m_owner(owner),
+      m_input(input),
+      m_dictionary(dictionary),
+      m_last(last),
+      m_crc(0),
+      m_failed(false),
+      m_done(false)
+    {
+      setAutoDelete(false);
+    }
+
+    void run() final override
+    {
+      z_stream stream = {};
+      auto ok = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+      if (ok && !m_dictionary.isEmpty())
+        ok = deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(m_dictionary.constData()), m_dictionary.size()) == Z_OK;
+
+      if (ok) {
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(m_input.constData()));
+        stream.avail_in = m_input.size();
+        m_output.resize(deflateBound(&stream, m_input.size()) + 64);
+        auto used = 0;
+        forever {
+          stream.next_out = reinterpret_cast<Bytef*>(m_output.data()) + used;
+          stream.avail_out = m_output.size() - used;
+          // all but the last block end on a byte boundary without
+          // the final bit being set so that the next one can follow
+          const auto rc = deflate(&stream, m_last ? Z_FINISH : Z_SYNC_FLUSH);
+          used = m_output.size() - stream.avail_out;
+          if (rc == Z_STREAM_ERROR) {
+            ok = false;
+            break;
+          }
+          if (stream.avail_out != 0)
+            break;
+          m_output.resize(m_output.size() + BLOCK_SIZE / 4);
+        }
+        m_output.resize(used);
+      }
+      deflateEnd(&stream);
+
+      m_crc = crc32(0L, reinterpret_cast<const Bytef*>(m_input.constData()), m_input.size());
+
+      QMutexLocker lock(&m_owner->m_mutex);
+      m_failed = !ok;
+      m_done = true;
+      m_owner->m_jobDone.wakeAll();
+    }
+
+    Private*    m_owner;
+    QByteArray  m_input;
+    QByteArray  m_dictionary;
+    QByteArray  m_output;
+    const bool  m_last;
+    uLong       m_crc;
+    bool        m_failed;
+    bool        m_done;       ///< protected by Private::m_mutex
+  };
+
+  /**
+    * Inflates the compressed data ahead of the consumer
+    */
+  class InflateThread : public QThread
+  {
+  public:
+    explicit InflateThread(Private* owner) : m_owner(owner) {}
+
+    void run() final override
+    {
+      z_stream stream = {};
+      // 16 selects the gzip format
+      auto ok = inflateInit2(&stream, MAX_WBITS + 16) == Z_OK;
+      auto memberComplete = false;
+      QByteArray input(INPUT_SIZE, Qt::Uninitialized);
+      QString errorMessage;
+
+      while (ok) {
+        if (stream.avail_in == 0) {
+          const auto count = m_owner->m_device->read(input.data(), input.size());
+          if (count < 0) {
+            errorMessage = m_owner->m_device->errorString();
+            break;
+          }
+          if (count == 0) {
+            if (!memberComplete)
+              errorMessage = QStringLiteral("Unexpected end of compressed data");
+            break;
+          }
+          stream.next_in = reinterpret_cast<Bytef*>(input.data());
+          stream.avail_in = count;
+        }
+
+        if (memberComplete) {
+          // another gzip member follows
+          inflateReset(&stream);
+          memberComplete = false;
+        }
+
+        QByteArray output(BLOCK_SIZE, Qt::Uninitialized);
+        stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        stream.avail_out = output.size();
+        const auto rc = inflate(&stream, Z_NO_FLUSH);
+        if (rc == Z_STREAM_END) {
+          memberComplete = true;
+        } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+          errorMessage = QString::fromLatin1(stream.msg ? stream.msg : "Invalid compressed data");
+          break;
+        }
+        output.resize(output.size() - stream.avail_out);
+
+        if (!output.isEmpty()) {
+          QMutexLocker lock(&m_owner->m_mutex);
+          while (m_owner->m_blocks.count() >= MAX_READ_AHEAD && !m_owner->m_stop)
+            m_owner->m_spaceAvailable.wait(&m_owner->m_mutex);
+          if (m_owner->m_stop)
+            break;
+          m_owner->m_blocks.enqueue(output);
+          m_owner->m_dataAvailable.wakeAll();
+        }
+      }
+      inflateEnd(&stream);
+
+      QMutexLocker lock(&m_owner->m_mutex);
+      m_owner->m_readError = errorMessage;
+      m_owner->m_inflateFinished = true;
+      m_owner->m_dataAvailable.wakeAll();
+    }
+
+  private:
+    Private* m_owner;
+  };
+
+  Private(QIODevice* device, bool autoDeleteDevice) :
+    m_device(device),
+    m_autoDeleteDevice(autoDeleteDevice),
+    m_crc(0),
+    m_size(0),
+    m_writeFailed(false),
+    m_inflateThread(nullptr),
+    m_position(0),
+    m_inflateFinished(false),
+    m_stop(false)
+  {
+  }
+
+  ~Private()
+  {
+    if (m_autoDeleteDevice)
+      delete m_device;
+  }
+
+  /**
+    * Hands the collected data over to a compression thread
+    */
+  void compressBuffer(bool last)
+  {
+    auto job = new CompressionJob(this, m_buffer, m_dictionary, last);
+    m_dictionary = m_buffer.right(DICTIONARY_SIZE);
+    m_buffer.clear();
+    m_buffer.reserve(BLOCK_SIZE);
+    m_jobs.enqueue(job);
+    m_pool.start(job);
+  }
+
+  /**
+    * Writes the compressed blocks to the underlying device in their
+    * original order. Unless @a all is set, this only waits for the
+    * oldest block if too many blocks are pending.
+    */
+  void writeCompressedBlocks(bool all)
+  {
+    while (!m_jobs.isEmpty()) {
+      auto job = m_jobs.head();
+      {
+        QMutexLocker lock(&m_mutex);
+        if (!job->m_done && !all && m_jobs.count() <= 2 * m_pool.maxThreadCount())
+          break;
+        while (!job->m_done)
+          m_jobDone.wait(&m_mutex);
+      }
+      m_jobs.dequeue();
+
+      if (!m_writeFailed) {
+        if (job->m_failed) {
+          m_writeFailed = true;
+          m_writeError = QStringLiteral("Compression failed");
+        } else if (m_device->write(job->m_output) != job->m_output.size()) {
+          m_writeFailed = true;
+          m_writeError = m_device->errorString();
+        }
+        m_crc = crc32_combine(m_crc, job->m_crc, job->m_input.size());
+        m_size += job->m_input.size();
+      }
+      delete job;
+    }
+  }
+
+  void writeHeader()
+  {
+    // magic, deflate, no flags, no modification time, no extra flags, OS unknown
+    static const char header[] = { '\x1f', '\x8b', '\x08', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\xff' };
+    if (m_device->write(header, sizeof(header)) != sizeof(header)) {
+      m_writeFailed = true;
+      m_writeError = m_device->errorString();
+    }
+  }
+
+  void writeTrailer()
+  {
+    char trailer[8];
+    for (auto i = 0; i < 4; ++i) {
+      trailer[i] = static_cast<char>((m_crc >> (8 * i)) & 0xff);
+      trailer[i + 4] = static_cast<char>((m_size >> (8 * i)) & 0xff);
+    }
+    if (!m_writeFailed && m_device->write(trailer, sizeof(trailer)) != sizeof(trailer)) {
+      m_writeFailed = true;
+      m_writeError = m_device->errorString();
+    }
+  }
+
+  void stopInflateThread()
+  {
+    if (!m_inflateThread)
+      return;
+    {
+      QMutexLocker lock(&m_mutex);
+      m_stop = true;
+      m_spaceAvailable.wakeAll();
+    }
+    m_inflateThread->wait();
+    delete m_inflateThread;
+    m_inflateThread = nullptr;
+  }
+
+  QIODevice*                m_device;
+  const bool                m_autoDeleteDevice;
+
+  QMutex                    m_mutex;
+
+  // writing
+  QThreadPool               m_pool;
+  QQueue<CompressionJob*>   m_jobs;
+  QWaitCondition            m_jobDone;
+  QByteArray                m_buffer;
+  QByteArray                m_dictionary;
+  uLong                     m_crc;
+  quint64                   m_size;
+  bool                      m_writeFailed;
+  QString                   m_writeError;
+
+  // reading
+  InflateThread*            m_inflateThread;
+  QByteArray                m_current;          ///< block currently consumed, owned by the reading thread
+  int                       m_position;
+  QQueue<QByteArray>        m_blocks;           ///< protected by m_mutex
+  QWaitCondition            m_dataAvailable;
+  QWaitCondition            m_spaceAvailable;
+  bool                      m_inflateFinished;  ///< protected by m_mutex
+  bool                      m_stop;             ///< protected by m_mutex
+  QString                   m_readError;        ///< protected by m_mutex
+};
+
+ParallelGzipDevice::ParallelGzipDevice(QIODevice* device, bool autoDeleteDevice) :
+  QIODevice(),
+  d(new Private(device, autoDeleteDevice))
+{
+}
+
+ParallelGzipDevice::~ParallelGzipDevice()
+{
+  if (isOpen())
+    close();
+  delete d;
+}
+
+void ParallelGzipDevice::setThreadCount(int count)
+{
+  d->m_pool.setMaxThreadCount(qMax(1, count));
+}
+
+bool ParallelGzipDevice::hasError() const
+{
+  if (d->m_writeFailed)
+    return true;
+  QMutexLocker lock(&d->m_mutex);
+  return !d->m_readError.isEmpty();
+}
+
+bool ParallelGzipDevice::open(OpenMode mode)
+{
+  if (mode != QIODevice::ReadOnly && mode != QIODevice::WriteOnly) {
+    setErrorString(QStringLiteral("Only reading or writing is supported"));
+    return false;
+  }
+
+  if (!d->m_device->isOpen() && !d->m_device->open(mode)) {
+    setErrorString(d->m_device->errorString());
+    return false;
+  }
+
+  d->m_writeFailed = false;
+  d->m_writeError.clear();
+  d->m_readError.clear();
+
+  if (mode == QIODevice::WriteOnly) {
+    d->m_crc = crc32(0L, Z_NULL, 0);
+    d->m_size = 0;
+    d->m_buffer.clear();
+    d->m_buffer.reserve(BLOCK_SIZE);
+    d->m_dictionary.clear();
+    d->writeHeader();
+
+  } else {
+    d->m_current.clear();
+    d->m_position = 0;
+    d->m_blocks.clear();
+    d->m_inflateFinished = false;
+    d->m_stop = false;
+    d->m_inflateThread = new Private::InflateThread(d);
+    d->m_inflateThread->start();
+  }
+
+  return QIODevice::open(mode);
+}
+
+void ParallelGzipDevice::close()
+{
+  if (!isOpen())
+    return;
+
+  if (openMode() & QIODevice::WriteOnly) {
+    // the last block is written even if it is empty, because it carries the final bit
+    d->compressBuffer(true);
+    d->writeCompressedBlocks(true);
+    d->writeTrailer();
+    if (d->m_writeFailed)
+      setErrorString(d->m_writeError);
+  } else {
+    d->stopInflateThread();
+    d->m_blocks.clear();
+    d->m_current.clear();
+  }
+
+  d->m_device->close();
+  QIODevice::close();
+}
+
+bool ParallelGzipDevice::isSequential() const
+{
+  return true;
+}
+
+bool ParallelGzipDevice::atEnd() const
+{
+  if (!(openMode() & QIODevice::ReadOnly))
+    return true;
+
+  if (QIODevice::bytesAvailable() > 0 || d->m_position < d->m_current.size())
+    return false;
+
+  QMutexLocker lock(&d->m_mutex);
+  return d->m_blocks.isEmpty() && d->m_inflateFinished;
+}
+
+qint64 ParallelGzipDevice::bytesAvailable() const
+{
+  auto available = QIODevice::bytesAvailable() + d->m_current.size() - d->m_position;
+  QMutexLocker lock(&d->m_mutex);
+  for (const auto& block : qAsConst(d->m_blocks))
+    available += block.size();
+  return available;
+}
+
+qint64 ParallelGzipDevice::readData(char* data, qint64 maxSize)
+{
+  qint64 copied = 0;
+  while (copied < maxSize) {
+    if (d->m_position == d->m_current.size()) {
+      QMutexLocker lock(&d->m_mutex);
+      // don't wait for more data if we already have some
+      while (d->m_blocks.isEmpty() && !d->m_inflateFinished && copied == 0)
+        d->m_dataAvailable.wait(&d->m_mutex);
+      if (d->m_blocks.isEmpty()) {
+        if (copied == 0 && !d->m_readError.isEmpty()) {
+          setErrorString(d->m_readError);
+          return -1;
+        }
+        break;
+      }
+      d->m_current = d->m_blocks.dequeue();
+      d->m_position = 0;
+      d->m_spaceAvailable.wakeAll();
+    }
+
+    const auto count = qMin(maxSize - copied, static_cast<qint64>(d->m_current.size() - d->m_position));
+    memcpy(data + copied, d->m_current.constData() + d->m_position, count);
+    d->m_position += count;
+    copied += count;
+  }
+  return copied;
+}
+
+qint64 ParallelGzipDevice::writeData(const char* data, qint64 maxSize)
+{
+  if (d->m_writeFailed) {
+    setErrorString(d->m_writeError);
+    return -1;
+  }
+
+  qint64 written = 0;
+  while (written < maxSize) {
+    const auto count = qMin(maxSize - written, static_cast<qint64>(BLOCK_SIZE - d->m_buffer.size()));
+    d->m_buffer.append(data + written, count);
+    written += count;
+    if (d->m_buffer.size() == BLOCK_SIZE) {
+      d->compressBuffer(false);
+      d->writeCompressedBlocks(false);
+    }
+  }
+  return written;
+}
@@ -0,0 +1,91 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARALLELGZIPDEVICE_H
+#define PARALLELGZIPDEVICE_H
+
+// ----------------------------------------------------------------------------
+// QT Includes
+
+#include <QIODevice>
+
+/**
+  * A gzip compression device which uses multiple threads.
+  *
+  * When opened for writing, the data is split into blocks which are
+  * compressed concurrently on all cores. Each block uses the end of
+  * the previous block as dictionary and all but the last block are
+  * terminated with a sync flush, so the blocks form a single deflate
+  * stream. The result is a regular gzip file which can be read by
+  * any gzip decoder.
+  *
+  * When opened for reading, the data is inflated by a worker thread
+  * which stays a few blocks ahead of the consumer. Any gzip file
+  * (including files consisting of multiple members) can be read.
+  *
+  * The device is sequential, seeking is not supported.
+  */
+class ParallelGzipDevice : public QIODevice
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(ParallelGzipDevice)
+
+public:
+  /**
+    * @param device the device holding the compressed data
+    * @param autoDeleteDevice if @c true, @a device is deleted along with this object
+    */
+  explicit ParallelGzipDevice(QIODevice* device, bool autoDeleteDevice = true);
+  ~ParallelGzipDevice() override;
+
+  /**
+    * Opens the device and the underlying device in @a mode which
+    * must be either QIODevice::ReadOnly or QIODevice::WriteOnly.
+    */
+  bool open(OpenMode mode) override;
+
+  /**
+    * Writes all pending data (when writing) or stops the worker
+    * thread (when reading) and closes the underlying device.
+    */
+  void close() override;
+
+  bool isSequential() const override;
+  bool atEnd() const override;
+  qint64 bytesAvailable() const override;
+
+  /**
+    * Sets the number of threads used for compression. The default
+    * is the number of cores. Must be called before open().
+    */
+  void setThreadCount(int count);
+
+  /**
+    * Returns @c true if compressing, decompressing or accessing the
+    * underlying device failed. The reason is available through errorString().
+    * The state is kept after the device has been closed.
+    */
+  bool hasError() const;
+
+protected:
+  qint64 readData(char* data, qint64 maxSize) override;
+  qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+  class Private;
+  Private* const d;
+};
+
+#endif
@@ -0,0 +1,326 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mymoneyxmlstreamreader-test.h"
+
+#include <QtTest>
+#include <QBuffer>
+#include "../mymoneystoragexml.cpp"
+#include "mymoneyfile.h"
+#include "mymoneytransactionfilter.h"
+
+QTEST_GUILESS_MAIN(MyMoneyXmlStreamReaderTest)
+
+/**
+  * Gives access to the way files have been read before
+  * MyMoneyXmlStreamReader existed
+  */
+class ContentHandlerStorageXML : public MyMoneyStorageXML
+{
+public:
+  bool readWithContentHandler(QIODevice* device, MyMoneyStorageMgr* storage) {
+    m_storage = storage;
+    QXmlInputSource xml(device);
+    MyMoneyXmlContentHandler handler(this);
+    QXmlSimpleReader reader;
+    reader.setContentHandler(&handler);
+    const auto rc = reader.parse(&xml, false);
+    m_storage = nullptr;
+    return rc;
+  }
+};
+
+static const QString transactionXml = QString(
+    "<!DOCTYPE TEST>\n"
+    "<TRANSACTION-CONTAINER>\n"
+    "<TRANSACTION postdate=\"2010-03-05\" memo=\"\" id=\"T000000000000004189\" commodity=\"EUR\" entrydate=\"2010-03-08\" >\n"
+    " <SPLITS>\n"
+    "  <SPLIT payee=\"P000010\" reconciledate=\"\" shares=\"-125000/100\" action=\"Transfer\" bankid=\"A000076-2010-03-05-b6850c0-1\" number=\"\" reconcileflag=\"1\" memo=\"UMBUCHUNG\" value=\"-125000/100\" id=\"S0001\" account=\"A000076\" >\n"
+    "   <TAG id=\"G000001\"/>\n"
+    "   <TAG id=\"G000002\"/>\n"
+    "   <KEYVALUEPAIRS>\n"
+    "    <PAIR key=\"kmm-match-split\" value=\"S0002\" />\n"
+    "    <PAIR key=\"kmm-matched-tx\" value=\"&#60;!DOCTYPE MATCH>\n"
+    "    &#60;CONTAINER>\n"
+    "     &#60;TRANSACTION postdate=&quot;2010-03-05&quot; memo=&quot;UMBUCHUNG&quot; id=&quot;&quot; commodity=&quot;EUR&quot; entrydate=&quot;2010-03-08&quot; >\n"
+    "      &#60;SPLITS>\n"
+    "       &#60;SPLIT payee=&quot;P000010&quot; reconciledate=&quot;&quot; shares=&quot;125000/100&quot; action=&quot;Transfer&quot; bankid=&quot;&quot; number=&quot;&quot; reconcileflag=&quot;0&quot; memo=&quot;UMBUCHUNG&quot; value=&quot;125000/100&quot; id=&quot;S0001&quot; account=&quot;A000087&quot; />\n"
+    "       &#60;SPLIT payee=&quot;P000010&quot; reconciledate=&quot;&quot; shares=&quot;-125000/100&quot; action=&quot;&quot; bankid=&quot;A000076-2010-03-05-b6850c0-1&quot; number=&quot;&quot; reconcileflag=&quot;0&quot; memo=&quot;UMBUCHUNG&quot; value=&quot;-125000/100&quot; id=&quot;S0002&quot; account=&quot;A000076&quot; />\n"
+    "      &#60;/SPLITS>\n"
+    "      &#60;KEYVALUEPAIRS>\n"
+    "       &#60;PAIR key=&quot;Imported&quot; value=&quot;true&quot; />\n"
+    "      &#60;/KEYVALUEPAIRS>\n"
+    "     &#60;/TRANSACTION>\n"
+    "    &#60;/CONTAINER>\n"
+    "\" />\n"
+    "    <PAIR key=\"kmm-orig-memo\" value=\"\" />\n"
+    "   </KEYVALUEPAIRS>\n"
+    "  </SPLIT>\n"
+    "  <SPLIT payee=\"P000010\" reconciledate=\"\" shares=\"125000/100\" action=\"Transfer\" bankid=\"\" number=\"\" reconcileflag=\"0\" memo=\"\" value=\"125000/100\" id=\"S0002\" account=\"A000087\" />\n"
+    "  <SPLIT payee=\"P000010\" reconciledate=\"\" shares=\"1/100\" action=\"\" bankid=\"\" number=\"\" reconcileflag=\"0\" memo=\"dropped\" value=\"1/100\" id=\"S0003\" account=\"\" />\n"
+    " </SPLITS>\n"
+    " <KEYVALUEPAIRS>\n"
+    "  <PAIR key=\"key\" value=\"value\" />\n"
+    " </KEYVALUEPAIRS>\n"
+    "</TRANSACTION>\n"
+    "</TRANSACTION-CONTAINER>\n"
+  );
+
+static QMap<QString, MyMoneyTransaction> dailyTransactions(int count)
+{
+  const QDate start(2000, 1, 1);
+  QMap<QString, MyMoneyTransaction> map;
+  for (auto i = 0; i < count; ++i) {
+    MyMoneyTransaction t;
+    t.setPostDate(start.addDays(i / 10));
+    t.setEntryDate(start.addDays(i / 10));
+    t.setMemo(QString::fromLatin1("Transaction <%1> & more").arg(i));
+    t.setCommodity(QStringLiteral("USD"));
+    if (i % 7 == 0)
+      t.setValue(QStringLiteral("key"), QString::number(i));
+
+    MyMoneySplit s;
+    s.setAccountId(MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Asset));
+    s.setShares(MyMoneyMoney(i, 100));
+    s.setValue(MyMoneyMoney(i, 100));
+    s.setMemo(QStringLiteral("\"quoted\""));
+    if (i % 5 == 0)
+      s.setTagIdList(QStringList() << QStringLiteral("G000001"));
+    t.addSplit(s);
+
+    s.clearId();
+    s.setAccountId(MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Expense));
+    s.setShares(MyMoneyMoney(-i, 100));
+    s.setValue(MyMoneyMoney(-i, 100));
+    s.setReconcileFlag(eMyMoney::Split::State::Cleared);
+    s.setReconcileDate(start);
+    t.addSplit(s);
+
+    MyMoneyTransaction transaction(QString::fromLatin1("T%1").arg(i + 1, 18, 10, QLatin1Char('0')), t);
+    map[transaction.uniqueSortKey()] = transaction;
+  }
+  return map;
+}
+
+static QByteArray writeFile(int transactionCount)
+{
+  MyMoneyStorageMgr storage;
+  storage.loadTransactions(dailyTransactions(transactionCount));
+
+  QByteArray data;
+  QBuffer buffer(&data);
+  buffer.open(QIODevice::WriteOnly);
+  MyMoneyFile::instance()->attachStorage(&storage);
+  MyMoneyStorageXML writer;
+  writer.writeFile(&buffer, &storage);
+  MyMoneyFile::instance()->detachStorage(&storage);
+  return data;
+}
+
+static QList<MyMoneyTransaction> transactions(const MyMoneyStorageMgr& storage)
+{
+  MyMoneyTransactionFilter filter;
+  filter.setReportAllSplits(false);
+  return storage.transactionList(filter);
+}
+
+void MyMoneyXmlStreamReaderTest::readTransaction()
+{
+  QDomDocument doc;
+  doc.setContent(transactionXml);
+  const auto expected = MyMoneyXmlContentHandler::readTransaction(doc.documentElement().firstChild().toElement());
+
+  QXmlStreamReader xml(transactionXml);
+  xml.readNextStartElement();
+  xml.readNextStartElement();
+  try {
+    const auto t = MyMoneyXmlStreamReader::readTransaction(xml);
+    QCOMPARE(t.id(), QStringLiteral("T000000000000004189"));
+    QCOMPARE(t.postDate(), QDate(2010, 3, 5));
+    QCOMPARE(t.entryDate(), QDate(2010, 3, 8));
+    QCOMPARE(t.commodity(), QStringLiteral("EUR"));
+    QCOMPARE(t.pairs().count(), 1);
+    QCOMPARE(t.value(QStringLiteral("key")), QStringLiteral("value"));
+    QCOMPARE(t.splits().count(), 2);
+    QCOMPARE(t.splits()[0].pairs().count(), 3);
+    QCOMPARE(t.splits()[0].tagIdList(), QStringList() << "G000001" << "G000002");
+    QCOMPARE(t.splits()[1].pairs().count(), 0);
+    QVERIFY(t.splits()[0].isMatched());
+
+    const auto ti = t.splits()[0].matchedTransaction();
+    QCOMPARE(ti.pairs().count(), 1);
+    QVERIFY(ti.isImported());
+    QCOMPARE(ti.splits().count(), 2);
+
+    QVERIFY(t == expected);
+  } catch (const MyMoneyException &) {
+    QFAIL("Unexpected exception");
+  }
+
+  // the reader is positioned behind the transaction
+  QVERIFY(xml.isEndElement());
+  QCOMPARE(xml.name().toString(), QStringLiteral("TRANSACTION"));
+
+  // other elements are rejected
+  QXmlStreamReader other(QStringLiteral("<TRANS-ACTION/>"));
+  other.readNextStartElement();
+  try {
+    MyMoneyXmlStreamReader::readTransaction(other);
+    QFAIL("Missing expected exception");
+  } catch (const MyMoneyException &) {
+  }
+}
+
+void MyMoneyXmlStreamReaderTest::readSplit()
+{
+  const QString splitXml(
+    "<SPLIT payee=\"P000001\" reconciledate=\"2001-01-01\" shares=\"96379/100\" action=\"Deposit\" bankid=\"SPID\" number=\"124\" reconcileflag=\"2\" memo=\"MyMemo\" value=\"96379/1000\" account=\"A000076\" costcenter=\"C000001\">\n"
+    " <TAG id=\"G000001\"/>\n"
+    " <KEYVALUEPAIRS>\n"
+    "  <PAIR key=\"first\" value=\"1\" />\n"
+    " </KEYVALUEPAIRS>\n"
+    " <KEYVALUEPAIRS>\n"
+    "  <PAIR key=\"second\" value=\"2\" />\n"
+    " </KEYVALUEPAIRS>\n"
+    "</SPLIT>\n");
+
+  QDomDocument doc;
+  doc.setContent(splitXml);
+  const auto expected = MyMoneyXmlContentHandler::readSplit(doc.documentElement());
+
+  QXmlStreamReader xml(splitXml);
+  xml.readNextStartElement();
+  const auto s = MyMoneyXmlStreamReader::readSplit(xml);
+  QCOMPARE(s.payeeId(), QStringLiteral("P000001"));
+  QCOMPARE(s.reconcileDate(), QDate(2001, 1, 1));
+  QCOMPARE(s.shares(), MyMoneyMoney(96379, 100));
+  QCOMPARE(s.value(), MyMoneyMoney(96379, 1000));
+  QCOMPARE(s.number(), QStringLiteral("124"));
+  QCOMPARE(s.bankID(), QStringLiteral("SPID"));
+  QCOMPARE(s.reconcileFlag(), eMyMoney::Split::State::Reconciled);
+  QCOMPARE(s.action(), QStringLiteral("Deposit"));
+  QCOMPARE(s.accountId(), QStringLiteral("A000076"));
+  QCOMPARE(s.costCenterId(), QStringLiteral("C000001"));
+  QCOMPARE(s.memo(), QStringLiteral("MyMemo"));
+  QCOMPARE(s.tagIdList(), QStringList() << "G000001");
+  // only the first set of pairs is used
+  QCOMPARE(s.pairs().count(), 1);
+  QCOMPARE(s.value(QStringLiteral("first")), QStringLiteral("1"));
+  QVERIFY(s == expected);
+}
+
+void MyMoneyXmlStreamReaderTest::readFile()
+{
+  const auto data = writeFile(500);
+
+  QBuffer buffer;
+  buffer.setData(data);
+  buffer.open(QIODevice::ReadOnly);
+  MyMoneyStorageMgr expected;
+  ContentHandlerStorageXML contentHandlerReader;
+  QVERIFY(contentHandlerReader.readWithContentHandler(&buffer, &expected));
+  buffer.close();
+
+  buffer.open(QIODevice::ReadOnly);
+  MyMoneyStorageMgr storage;
+  MyMoneyStorageXML reader;
+  try {
+    reader.readFile(&buffer, &storage);
+  } catch (const MyMoneyException &e) {
+    QFAIL(e.what());
+  }
+
+  QCOMPARE(storage.accountList().count(), expected.accountList().count());
+  QCOMPARE(storage.transactionCount(QString()), 500u);
+  const auto list = transactions(storage);
+  const auto expectedList = transactions(expected);
+  QCOMPARE(list.count(), expectedList.count());
+  for (auto i = 0; i < list.count(); ++i)
+    QVERIFY(list.at(i) == expectedList.at(i));
+
+  const auto original = dailyTransactions(500).values();
+  QCOMPARE(list.first().memo(), original.first().memo());
+  QCOMPARE(list.last().splits().last().memo(), original.last().splits().last().memo());
+  QCOMPARE(list.first().value(QStringLiteral("key")), QStringLiteral("0"));
+}
+
+void MyMoneyXmlStreamReaderTest::readFileError()
+{
+  QBuffer buffer;
+  buffer.setData(QByteArrayLiteral("<!DOCTYPE KMYMONEY-FILE>\n<KMYMONEY-FILE>\n<TRANSACTIONS count=\"1\">\n<TRANSACTION id=\"T1\">\n</TRANSACTIONS>\n"));
+  buffer.open(QIODevice::ReadOnly);
+
+  MyMoneyStorageMgr storage;
+  MyMoneyStorageXML reader;
+  try {
+    reader.readFile(&buffer, &storage);
+    QFAIL("Missing expected exception");
+  } catch (const MyMoneyException &) {
+  }
+}
+
+void MyMoneyXmlStreamReaderTest::writeFileStreamed()
+{
+  const auto data = writeFile(50);
+  QVERIFY(data.startsWith("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<!DOCTYPE KMYMONEY-FILE>\n<KMYMONEY-FILE>"));
+
+  QDomDocument doc;
+  QVERIFY(doc.setContent(data));
+  QCOMPARE(doc.doctype().name(), QStringLiteral("KMYMONEY-FILE"));
+
+  const auto root = doc.documentElement();
+  QStringList groups;
+  for (auto child = root.firstChildElement(); !child.isNull(); child = child.nextSiblingElement())
+    groups << child.tagName();
+  QCOMPARE(groups, QStringList({"FILEINFO", "USER", "INSTITUTIONS", "PAYEES", "COSTCENTERS", "TAGS",
+                                "ACCOUNTS", "TRANSACTIONS", "KEYVALUEPAIRS", "SCHEDULES", "SECURITIES",
+                                "CURRENCIES", "PRICES", "REPORTS", "BUDGETS", "ONLINEJOBS"}));
+
+  const auto transactionGroup = root.firstChildElement(QStringLiteral("TRANSACTIONS"));
+  QCOMPARE(transactionGroup.attribute(QStringLiteral("count")), QStringLiteral("50"));
+  QCOMPARE(transactionGroup.elementsByTagName(QStringLiteral("TRANSACTION")).count(), 50);
+}
+
+void MyMoneyXmlStreamReaderTest::benchmarkReadFile_data()
+{
+  QTest::addColumn<int>("count");
+  QTest::addColumn<bool>("streaming");
+
+  QTest::newRow("content handler, 20000 transactions") << 20000 << false;
+  QTest::newRow("stream reader, 20000 transactions") << 20000 << true;
+}
+
+void MyMoneyXmlStreamReaderTest::benchmarkReadFile()
+{
+  QFETCH(int, count);
+  QFETCH(bool, streaming);
+
+  const auto data = writeFile(count);
+
+  QBENCHMARK {
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    MyMoneyStorageMgr storage;
+    if (streaming) {
+      MyMoneyStorageXML reader;
+      reader.readFile(&buffer, &storage);
+    } else {
+      ContentHandlerStorageXML reader;
+      QVERIFY(reader.readWithContentHandler(&buffer, &storage));
+    }
+    QCOMPARE(storage.transactionCount(QString()), static_cast<unsigned int>(count));
+  }
+}
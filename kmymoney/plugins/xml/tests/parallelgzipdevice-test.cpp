@@ -0,0 +1,255 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "parallelgzipdevice-test.h"
+
+#include <zlib.h>
+
+#include <QtTest>
+#include <QBuffer>
+#include <QTemporaryFile>
+#include <QThread>
+
+#include "../parallelgzipdevice.h"
+#include "../mymoneystoragexml.h"
+#include "mymoneystoragemgr.h"
+#include "mymoneyfile.h"
+#include "mymoneyaccount.h"
+#include "mymoneysplit.h"
+#include "mymoneytransaction.h"
+#include "mymoneymoney.h"
+#include "mymoneyenums.h"
+
+QTEST_GUILESS_MAIN(ParallelGzipDeviceTest)
+
+static QByteArray testData(int size)
+{
+  QByteArray data;
+  data.reserve(size + 100);
+  for (auto i = 0; data.size() < size; ++i) {
+    data.append(QString::fromLatin1("<TRANSACTION id=\"T%1\" postdate=\"%2\" memo=\"%3\"/>\n")
+                .arg(i, 18, 10, QLatin1Char('0'))
+                .arg(QDate(2000, 1, 1).addDays(i / 10).toString(Qt::ISODate))
+                .arg(qHash(i)).toLatin1());
+  }
+  data.truncate(size);
+  return data;
+}
+
+static QByteArray compress(const QByteArray& data, int threads)
+{
+  QByteArray compressed;
+  ParallelGzipDevice device(new QBuffer(&compressed));
+  device.setThreadCount(threads);
+  device.open(QIODevice::WriteOnly);
+  device.write(data);
+  device.close();
+  return compressed;
+}
+
+static QByteArray uncompress(const QByteArray& compressed, bool* failed = nullptr)
+{
+  ParallelGzipDevice device(new QBuffer(const_cast<QByteArray*>(&compressed)));
+  device.open(QIODevice::ReadOnly);
+  const auto data = device.readAll();
+  if (failed)
+    *failed = device.hasError();
+  device.close();
+  return data;
+}
+
+static MyMoneyStorageMgr* storageWithTransactions(int count)
+{
+  const QDate start(2000, 1, 1);
+  QMap<QString, MyMoneyTransaction> map;
+  for (auto i = 0; i < count; ++i) {
+    MyMoneyTransaction t;
+    t.setPostDate(start.addDays(i / 10));
+    t.setEntryDate(start.addDays(i / 10));
+    t.setMemo(QString::fromLatin1("Transaction %1").arg(i));
+    t.setCommodity(QStringLiteral("USD"));
+
+    MyMoneySplit s;
+    s.setAccountId(MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Asset));
+    s.setShares(MyMoneyMoney(i, 100));
+    s.setValue(MyMoneyMoney(i, 100));
+    t.addSplit(s);
+
+    s.clearId();
+    s.setAccountId(MyMoneyAccount::stdAccName(eMyMoney::Account::Standard::Expense));
+    s.setShares(MyMoneyMoney(-i, 100));
+    s.setValue(MyMoneyMoney(-i, 100));
+    t.addSplit(s);
+
+    MyMoneyTransaction transaction(QString::fromLatin1("T%1").arg(i + 1, 18, 10, QLatin1Char('0')), t);
+    map[transaction.uniqueSortKey()] = transaction;
+  }
+
+  auto storage = new MyMoneyStorageMgr;
+  storage->loadTransactions(map);
+  return storage;
+}
+
+void ParallelGzipDeviceTest::roundTrip_data()
+{
+  QTest::addColumn<int>("size");
+  QTest::addColumn<int>("threads");
+
+  QTest::newRow("empty") << 0 << 4;
+  QTest::newRow("small") << 1000 << 4;
+  QTest::newRow("two blocks") << 256 * 1024 << 4;
+  QTest::newRow("3 MB, one thread") << 3 * 1024 * 1024 + 17 << 1;
+  QTest::newRow("3 MB, four threads") << 3 * 1024 * 1024 + 17 << 4;
+}
+
+void ParallelGzipDeviceTest::roundTrip()
+{
+  QFETCH(int, size);
+  QFETCH(int, threads);
+
+  const auto data = testData(size);
+  const auto compressed = compress(data, threads);
+  QVERIFY(compressed.startsWith("\x1f\x8b"));
+  if (size > 1000)
+    QVERIFY(compressed.size() < data.size() / 2);
+
+  bool failed;
+  QCOMPARE(uncompress(compressed, &failed), data);
+  QVERIFY(!failed);
+}
+
+void ParallelGzipDeviceTest::writeStandardGzip()
+{
+  // the result must be readable by any gzip decoder, here zlib's own gz functions
+  const auto data = testData(1024 * 1024 + 5);
+  QTemporaryFile file;
+  QVERIFY(file.open());
+  file.write(compress(data, 4));
+  file.close();
+
+  auto gz = gzopen(QFile::encodeName(file.fileName()).constData(), "rb");
+  QVERIFY(gz);
+  QByteArray result(data.size() + 100, '\0');
+  const auto count = gzread(gz, result.data(), result.size());
+  gzclose(gz);
+  result.resize(qMax(count, 0));
+  QCOMPARE(result, data);
+}
+
+void ParallelGzipDeviceTest::readStandardGzip()
+{
+  // a file written by zlib with two gzip members
+  const auto data = testData(700 * 1024);
+  const auto half = data.size() / 2;
+  QTemporaryFile file;
+  QVERIFY(file.open());
+  file.close();
+  const auto fileName = QFile::encodeName(file.fileName());
+  auto gz = gzopen(fileName.constData(), "wb");
+  QVERIFY(gz);
+  gzwrite(gz, data.constData(), half);
+  gzclose(gz);
+  gz = gzopen(fileName.constData(), "ab");
+  QVERIFY(gz);
+  gzwrite(gz, data.constData() + half, data.size() - half);
+  gzclose(gz);
+
+  ParallelGzipDevice device(new QFile(file.fileName()));
+  QVERIFY(device.open(QIODevice::ReadOnly));
+  QCOMPARE(device.readAll(), data);
+  QVERIFY(device.atEnd());
+  QVERIFY(!device.hasError());
+}
+
+void ParallelGzipDeviceTest::readTruncated()
+{
+  const auto data = testData(1024 * 1024);
+  auto compressed = compress(data, 4);
+  compressed.chop(100);
+
+  bool failed;
+  const auto result = uncompress(compressed, &failed);
+  QVERIFY(failed);
+  QVERIFY(result.size() < data.size());
+  QVERIFY(data.startsWith(result));
+}
+
+void ParallelGzipDeviceTest::benchmarkSave_data()
+{
+  QTest::addColumn<int>("threads");
+
+  QTest::newRow("one thread, 50000 transactions") << 1;
+  QTest::newRow(qPrintable(QString::fromLatin1("%1 threads, 50000 transactions").arg(QThread::idealThreadCount()))) << QThread::idealThreadCount();
+}
+
+void ParallelGzipDeviceTest::benchmarkSave()
+{
+  QFETCH(int, threads);
+
+  QScopedPointer<MyMoneyStorageMgr> storage(storageWithTransactions(50000));
+  MyMoneyFile::instance()->attachStorage(storage.data());
+
+  QBENCHMARK {
+    QByteArray compressed;
+    ParallelGzipDevice device(new QBuffer(&compressed));
+    device.setThreadCount(threads);
+    device.open(QIODevice::WriteOnly);
+    MyMoneyStorageXML writer;
+    writer.writeFile(&device, storage.data());
+    device.close();
+    QVERIFY(!device.hasError());
+  }
+
+  MyMoneyFile::instance()->detachStorage(storage.data());
+}
+
+void ParallelGzipDeviceTest::benchmarkLoad_data()
+{
+  QTest::addColumn<bool>("compressed");
+
+  QTest::newRow("uncompressed, 50000 transactions") << false;
+  QTest::newRow("compressed, 50000 transactions") << true;
+}
+
+void ParallelGzipDeviceTest::benchmarkLoad()
+{
+  QFETCH(bool, compressed);
+
+  QScopedPointer<MyMoneyStorageMgr> storage(storageWithTransactions(50000));
+  QByteArray data;
+  QBuffer buffer(&data);
+  buffer.open(QIODevice::WriteOnly);
+  MyMoneyFile::instance()->attachStorage(storage.data());
+  MyMoneyStorageXML writer;
+  writer.writeFile(&buffer, storage.data());
+  MyMoneyFile::instance()->detachStorage(storage.data());
+  buffer.close();
+
+  if (compressed)
+    data = compress(data, QThread::idealThreadCount());
+
+  QBENCHMARK {
+    QScopedPointer<QIODevice> device;
+    if (compressed)
+      device.reset(new ParallelGzipDevice(new QBuffer(&data)));
+    else
+      device.reset(new QBuffer(&data));
+    device->open(QIODevice::ReadOnly);
+    MyMoneyStorageMgr loaded;
+    MyMoneyStorageXML reader;
+    reader.readFile(device.data(), &loaded);
+    QCOMPARE(loaded.transactionCount(QString()), 50000u);
+  }
+}
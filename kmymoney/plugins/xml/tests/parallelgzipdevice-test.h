@@ -0,0 +1,37 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARALLELGZIPDEVICETEST_H
+#define PARALLELGZIPDEVICETEST_H
+
+#include <QObject>
+
+class ParallelGzipDeviceTest : public QObject
+{
+  Q_OBJECT
+
+private Q_SLOTS:
+  void roundTrip_data();
+  void roundTrip();
+  void writeStandardGzip();
+  void readStandardGzip();
+  void readTruncated();
+  void benchmarkSave_data();
+  void benchmarkSave();
+  void benchmarkLoad_data();
+  void benchmarkLoad();
+};
+
+#endif
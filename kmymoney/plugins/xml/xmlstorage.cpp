@@ -24,6 +24,7 @@
 // QT Includes
 
 #include <QTimer>
+#include <QThread>
 #include <QFile>
 #include <QTemporaryFile>
 #include <QFileDialog>
@@ -56,6 +57,7 @@
 #include "kgpgfile.h"
 #include "kgpgkeyselectiondlg.h"
 #include "kmymoneyenums.h"
+#include "parallelgzipdevice.h"
 
 using namespace Icons;
 
@@ -69,8 +71,138 @@ static constexpr char recoveryKeyId[] = "59B0F826D2B08440";
 #define RECOVER_KEY_EXPIRATION_WARNING 30
 #endif
 
+/**
+  * Writes the data of @a storage into @a localFile using @a pWriter. The file is
+  * compressed unless @a plaintext is set and encrypted if @a keyList is not empty.
+  * If @a parallelCompression is set, all cores are used for the compression.
+  * No user interaction takes place, so this can also run in a worker thread.
+  */
+static void writeToLocalFile(const QString& localFile, IMyMoneyOperationsFormat* pWriter, MyMoneyStorageMgr* storage, bool plaintext, const QString& keyList, bool encryptRecover, bool parallelCompression)
+{
+  // Permissions to apply to new file
+  QFileDevice::Permissions fmode = QFileDevice::ReadUser | QFileDevice::WriteUser;
+
+  // Create a temporary file if needed
+  QString writeFile = localFile;
+  QTemporaryFile tmpFile(writeFile);
+  if (QFile::exists(localFile)) {
+    tmpFile.open();
+    writeFile = tmpFile.fileName();
+    tmpFile.close();
+    // Since file is going to be replaced, stash the original permissions so they can be restored
+    fmode = QFile::permissions(localFile);
+  }
+
+  std::unique_ptr<QIODevice> device;
+
+  if (!keyList.isEmpty()) {
+    std::unique_ptr<KGPGFile> kgpg = std::unique_ptr<KGPGFile>(new KGPGFile{writeFile});
+    if (kgpg) {
+      for(const QString& key: keyList.split(',', QString::SkipEmptyParts)) {
+        kgpg->addRecipient(key.toLatin1());
+      }
+
+      if (encryptRecover) {
+        kgpg->addRecipient(recoveryKeyId);
+      }
+      device = std::unique_ptr<decltype(device)::element_type>(kgpg.release());
+    }
+  } else if (parallelCompression && !plaintext) {
+    // The second parameter of ParallelGzipDevice means that ParallelGzipDevice will delete the QFile object
+    device = std::unique_ptr<decltype(device)::element_type>(new ParallelGzipDevice{new QFile(writeFile), true});
+  } else {
+    QFile *file = new QFile(writeFile);
+    // The second parameter of KCompressionDevice means that KCompressionDevice will delete the QFile object
+    device = std::unique_ptr<decltype(device)::element_type>(new KCompressionDevice{file, true, (plaintext) ? KCompressionDevice::None : COMPRESSION_TYPE});
+  }
+
+  if (!device || !device->open(QIODevice::WriteOnly)) {
+    throw MYMONEYEXCEPTION(QString::fromLatin1("Unable to open file '%1' for writing.").arg(localFile));
+  }
+
+  pWriter->writeFile(device.get(), storage);
+  device->close();
+
+  // Check for errors if possible, only possible for KGPGFile and ParallelGzipDevice
+  QFileDevice *fileDevice = qobject_cast<QFileDevice*>(device.get());
+  if (fileDevice && fileDevice->error() != QFileDevice::NoError) {
+    throw MYMONEYEXCEPTION(QString::fromLatin1("Failure while writing to '%1'").arg(localFile));
+  }
+  const auto gzipDevice = qobject_cast<ParallelGzipDevice*>(device.get());
+  if (gzipDevice && gzipDevice->hasError()) {
+    throw MYMONEYEXCEPTION(QString::fromLatin1("Failure while writing to '%1'").arg(localFile));
+  }
+
+  if (writeFile != localFile) {
+    // This simple comparison is possible because the strings are equal if no temporary file was created.
+    // If a temporary file was created, it is made in a way that the name is definitely different. So no
+    // symlinks etc. have to be evaluated.
+
+    // on Windows QTemporaryFile does not release file handle even after close()
+    // so QFile::rename(writeFile, localFile) will fail since Windows does not allow moving files in use
+    // as a workaround QFile::copy is used instead of QFile::rename below
+    // writeFile (i.e. tmpFile) will be deleted by QTemporaryFile dtor when it falls out of scope
+    if (!QFile::remove(localFile) || !QFile::copy(writeFile, localFile))
+      throw MYMONEYEXCEPTION(QString::fromLatin1("Failure while writing to '%1'").arg(localFile));
+  }
+  QFile::setPermissions(localFile, fmode);
+}
+
+/**
+  * Writes a snapshot of the storage in a separate thread so that the
+  * user can continue to work while the file is written, compressed
+  * and encrypted. The thread owns the writer and the snapshot.
+  */
+class XMLStorageWriter : public QThread
+{
+public:
+  XMLStorageWriter(const QString& localFile, IMyMoneyOperationsFormat* pWriter, MyMoneyStorageMgr* snapshot, bool plaintext, const QString& keyList, bool encryptRecover) :
+    m_localFile(localFile),
+    m_writer(pWriter),
+    m_storage(snapshot),
+    m_plaintext(plaintext),
+    m_keyList(keyList),
+    m_encryptRecover(encryptRecover),
+    m_backupCopies(KMyMoneySettings::autoBackupCopies()),
+    m_parallelCompression(KMyMoneySettings::parallelCompression())
+  {
+  }
+
+  void run() final override
+  {
+    try {
+      if (m_backupCopies)
+        KBackup::numberedBackupFile(m_localFile, QString(), QStringLiteral("~"), m_backupCopies);
+      writeToLocalFile(m_localFile, m_writer.get(), m_storage.get(), m_plaintext, m_keyList, m_encryptRecover, m_parallelCompression);
+    } catch (const MyMoneyException &e) {
+      m_errorMessage = QString::fromLatin1(e.what());
+    }
+  }
+
+  QString localFile() const { return m_localFile; }
+
+  /**
+    * Returns the reason why the file could not be written
+    * or an empty string if it has been written successfully
+    */
+  QString errorMessage() const { return m_errorMessage; }
+
+private:
+  const QString                               m_localFile;
+  std::unique_ptr<IMyMoneyOperationsFormat>   m_writer;
+  std::unique_ptr<MyMoneyStorageMgr>          m_storage;
+  const bool                                  m_plaintext;
+  const QString                               m_keyList;
+  const bool                                  m_encryptRecover;
+  const unsigned int                          m_backupCopies;
+  const bool                                  m_parallelCompression;
+  QString                                     m_errorMessage;
+};
+
 XMLStorage::XMLStorage(QObject *parent, const QVariantList &args) :
-  KMyMoneyPlugin::Plugin(parent, "xmlstorage"/*must be the same as X-KDE-PluginInfo-Name*/)
+  KMyMoneyPlugin::Plugin(parent, "xmlstorage"/*must be the same as X-KDE-PluginInfo-Name*/),
+  m_backgroundWriter(nullptr),
+  m_backgroundStorage(nullptr)
 {
   Q_UNUSED(args)
   setComponentName("xmlstorage", i18n("XML storage"));
@@ -81,6 +213,13 @@ XMLStorage::XMLStorage(QObject *parent, const QVariantList &args) :
 
 XMLStorage::~XMLStorage()
 {
+  // don't leave a partially written file behind
+  if (m_backgroundWriter) {
+    m_backgroundWriter->wait();
+    if (!m_backgroundWriter->errorMessage().isEmpty())
+      qWarning("Unable to write changes to: %s\nReason: %s", qPrintable(m_backgroundWriter->localFile()), qPrintable(m_backgroundWriter->errorMessage()));
+    delete m_backgroundWriter;
+  }
   qDebug("Plugins: xmlstorage unloaded");
 }
 
@@ -129,7 +268,13 @@ MyMoneyStorageMgr *XMLStorage::open(const QUrl &url)
   QIODevice* qfile = nullptr;
   QString sFileHeader(qbaFileHeader);
   if (sFileHeader == QString("\037\213")) {        // gzipped?
-    qfile = new KCompressionDevice(fileName, COMPRESSION_TYPE);
+    if (KMyMoneySettings::parallelCompression()) {
+      // inflate ahead in a separate thread while the file is parsed
+      qfile = new ParallelGzipDevice(new QFile(fileName));
+      haveAt = false;
+    } else {
+      qfile = new KCompressionDevice(fileName, COMPRESSION_TYPE);
+    }
   } else if (sFileHeader == QString("--") ||        // PGP ASCII armored?
              sFileHeader == QString("\205\001") ||  // PGP binary?
              sFileHeader == QString("\205\002")) {  // PGP binary?
@@ -246,6 +391,9 @@ QUrl XMLStorage::openUrl() const
 
 bool XMLStorage::save(const QUrl &url)
 {
+  // make sure we don't write the file while a background save is still at it
+  finishBackgroundSave();
+
   QString filename = url.toLocalFile();
 
   if (!appInterface()->fileOpen()) {
@@ -253,21 +401,10 @@ bool XMLStorage::save(const QUrl &url)
     return false;
   }
 
-  std::unique_ptr<IMyMoneyOperationsFormat> storageWriter;
+  bool plaintext;
+  std::unique_ptr<IMyMoneyOperationsFormat> storageWriter(createWriter(filename, plaintext));
 
-  // If this file ends in ".ANON.XML" then this should be written using the
-  // anonymous writer.
-  bool plaintext = filename.right(4).toLower() == ".xml";
-  if (filename.right(9).toLower() == ".anon.xml")
-    storageWriter = std::make_unique<MyMoneyStorageANON>();
-  else
-    storageWriter = std::make_unique<MyMoneyStorageXML>();
-
-  QString keyList;
-  if (!appInterface()->filenameURL().isEmpty())
-    keyList = MyMoneyFile::instance()->value("kmm-encryption-key");
-  if (keyList.isEmpty())
-    keyList = m_encryptionKeys;
+  const auto keyList = encryptionKeyList();
 
   // actually, url should be the parameter to this function
   // but for now, this would involve too many changes
@@ -313,6 +450,98 @@ bool XMLStorage::save(const QUrl &url)
   return rc;
 }
 
+bool XMLStorage::saveInBackground(const QUrl &url, std::function<void(bool)> finished)
+{
+  // uploading to a remote location is left to the regular save
+  if (!url.isLocalFile())
+    return StoragePlugin::saveInBackground(url, finished);
+
+  finishBackgroundSave();
+
+  if (!appInterface()->fileOpen()) {
+    KMessageBox::error(nullptr, i18n("Tried to access a file when it has not been opened"));
+    return false;
+  }
+
+  const auto filename = url.toLocalFile();
+  bool plaintext;
+  std::unique_ptr<IMyMoneyOperationsFormat> storageWriter(createWriter(filename, plaintext));
+
+  bool encryptRecover;
+  const auto keyList = encryptionKeys(plaintext, encryptionKeyList(), encryptRecover);
+
+  const auto storage = MyMoneyFile::instance()->storage();
+  std::unique_ptr<MyMoneyStorageMgr> snapshot;
+  try {
+    snapshot.reset(storage->snapshot());
+  } catch (const MyMoneyException &e) {
+    KMessageBox::error(nullptr, QString::fromLatin1(e.what()));
+    return false;
+  }
+
+  // the file receives the data as of now, so only changes
+  // made from here on make the storage dirty again
+  storage->setLastModificationDate(storage->lastModificationDate());
+
+  m_backgroundStorage = storage;
+  m_backgroundFinished = finished;
+  m_backgroundWriter = new XMLStorageWriter(filename, storageWriter.release(), snapshot.release(), plaintext, keyList, encryptRecover);
+  const auto writer = m_backgroundWriter;
+  connect(writer, &QThread::finished, this, [this, writer]() {
+    // the result may have been collected already by finishBackgroundSave()
+    if (writer == m_backgroundWriter)
+      finishBackgroundSave();
+  });
+  writer->start();
+  return true;
+}
+
+void XMLStorage::finishBackgroundSave()
+{
+  if (!m_backgroundWriter)
+    return;
+
+  const auto writer = m_backgroundWriter;
+  m_backgroundWriter = nullptr;
+  writer->wait();
+  writer->deleteLater();
+
+  const auto rc = writer->errorMessage().isEmpty();
+  if (!rc) {
+    qWarning("Unable to write changes to: %s\nReason: %s", qPrintable(writer->localFile()), qPrintable(writer->errorMessage()));
+    KMessageBox::error(nullptr, writer->errorMessage());
+    // the file might have been closed in the meantime
+    if (MyMoneyFile::instance()->storage() == m_backgroundStorage)
+      MyMoneyFile::instance()->setDirty();
+  }
+
+  auto finished = m_backgroundFinished;
+  m_backgroundFinished = nullptr;
+  m_backgroundStorage = nullptr;
+  if (finished)
+    finished(rc);
+}
+
+IMyMoneyOperationsFormat* XMLStorage::createWriter(const QString& filename, bool& plaintext)
+{
+  // If this file ends in ".ANON.XML" then this should be written using the
+  // anonymous writer.
+  plaintext = filename.right(4).toLower() == ".xml";
+  if (filename.right(9).toLower() == ".anon.xml")
+    return new MyMoneyStorageANON;
+  return new MyMoneyStorageXML;
+}
+
+QString XMLStorage::encryptionKeyList() const
+{
+  QString keyList;
+  if (!appInterface()->filenameURL().isEmpty())
+    keyList = MyMoneyFile::instance()->value("kmm-encryption-key");
+  if (keyList.isEmpty())
+    keyList = m_encryptionKeys;
+  return keyList;
+}
+
 bool XMLStorage::saveAs()
 {
   auto rc = false;
@@ -418,10 +647,20 @@ void XMLStorage::ungetString(QIODevice *qfile, char *buf, int len)
 }
 
 void XMLStorage::saveToLocalFile(const QString& localFile, IMyMoneyOperationsFormat* pWriter, bool plaintext, const QString& keyList)
+{
+  bool encryptRecover;
+  const auto keys = encryptionKeys(plaintext, keyList, encryptRecover);
+
+  pWriter->setProgressCallback(appInterface()->progressCallback());
+  writeToLocalFile(localFile, pWriter, MyMoneyFile::instance()->storage(), plaintext, keys, encryptRecover, KMyMoneySettings::parallelCompression());
+  pWriter->setProgressCallback(0);
+}
+
+QString XMLStorage::encryptionKeys(bool plaintext, const QString& keyList, bool& encryptRecover)
 {
   // Check GPG encryption
   bool encryptFile = true;
-  bool encryptRecover = false;
+  encryptRecover = false;
   if (!keyList.isEmpty()) {
     if (!KGPGFile::GPGAvailable()) {
       KMessageBox::sorry(nullptr, i18n("GPG does not seem to be installed on your system. Please make sure that GPG can be found using the standard search path. This time, encryption is disabled."), i18n("GPG not found"));
@@ -452,20 +691,6 @@ void XMLStorage::saveToLocalFile(const QString& localFile, IMyMoneyOperationsFor
     }
   }
 
-  // Permissions to apply to new file
-  QFileDevice::Permissions fmode = QFileDevice::ReadUser | QFileDevice::WriteUser;
-
-  // Create a temporary file if needed
-  QString writeFile = localFile;
-  QTemporaryFile tmpFile(writeFile);
-  if (QFile::exists(localFile)) {
-    tmpFile.open();
-    writeFile = tmpFile.fileName();
-    tmpFile.close();
-    // Since file is going to be replaced, stash the original permissions so they can be restored
-    fmode = QFile::permissions(localFile);
-  }
-
   /**
    * @brief Automatically restore settings when scope is left
    */
@@ -485,57 +710,12 @@ void XMLStorage::saveToLocalFile(const QString& localFile, IMyMoneyOperationsFor
 
   MyMoneyFileTransaction ft;
   MyMoneyFile::instance()->deletePair("kmm-encryption-key");
-  std::unique_ptr<QIODevice> device;
-
-  if (!keyList.isEmpty() && encryptFile && !plaintext) {
-    std::unique_ptr<KGPGFile> kgpg = std::unique_ptr<KGPGFile>(new KGPGFile{writeFile});
-    if (kgpg) {
-      for(const QString& key: keyList.split(',', QString::SkipEmptyParts)) {
-        kgpg->addRecipient(key.toLatin1());
-      }
-
-      if (encryptRecover) {
-        kgpg->addRecipient(recoveryKeyId);
-      }
-      MyMoneyFile::instance()->setValue("kmm-encryption-key", keyList);
-      device = std::unique_ptr<decltype(device)::element_type>(kgpg.release());
-    }
-  } else {
-    QFile *file = new QFile(writeFile);
-    // The second parameter of KCompressionDevice means that KCompressionDevice will delete the QFile object
-    device = std::unique_ptr<decltype(device)::element_type>(new KCompressionDevice{file, true, (plaintext) ? KCompressionDevice::None : COMPRESSION_TYPE});
-  }
-
+  const auto encrypt = !keyList.isEmpty() && encryptFile && !plaintext;
+  if (encrypt)
+    MyMoneyFile::instance()->setValue("kmm-encryption-key", keyList);
   ft.commit();
 
-  if (!device || !device->open(QIODevice::WriteOnly)) {
-    throw MYMONEYEXCEPTION(QString::fromLatin1("Unable to open file '%1' for writing.").arg(localFile));
-  }
-
-  pWriter->setProgressCallback(appInterface()->progressCallback());
-  pWriter->writeFile(device.get(), MyMoneyFile::instance()->storage());
-  device->close();
-
-  // Check for errors if possible, only possible for KGPGFile
-  QFileDevice *fileDevice = qobject_cast<QFileDevice*>(device.get());
-  if (fileDevice && fileDevice->error() != QFileDevice::NoError) {
-    throw MYMONEYEXCEPTION(QString::fromLatin1("Failure while writing to '%1'").arg(localFile));
-  }
-
-  if (writeFile != localFile) {
-    // This simple comparison is possible because the strings are equal if no temporary file was created.
-    // If a temporary file was created, it is made in a way that the name is definitely different. So no
-    // symlinks etc. have to be evaluated.
-
-    // on Windows QTemporaryFile does not release file handle even after close()
-    // so QFile::rename(writeFile, localFile) will fail since Windows does not allow moving files in use
-    // as a workaround QFile::copy is used instead of QFile::rename below
-    // writeFile (i.e. tmpFile) will be deleted by QTemporaryFile dtor when it falls out of scope
-    if (!QFile::remove(localFile) || !QFile::copy(writeFile, localFile))
-      throw MYMONEYEXCEPTION(QString::fromLatin1("Failure while writing to '%1'").arg(localFile));
-  }
-  QFile::setPermissions(localFile, fmode);
-  pWriter->setProgressCallback(0);
+  return encrypt ? keyList : QString();
 }
 
 void XMLStorage::checkRecoveryKeyValidity()
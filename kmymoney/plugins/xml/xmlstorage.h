@@ -33,6 +33,8 @@
 class QIODevice;
 
 class MyMoneyStorageMgr;
+class IMyMoneyOperationsFormat;
+class XMLStorageWriter;
 
 class XMLStorage : public KMyMoneyPlugin::Plugin, public KMyMoneyPlugin::StoragePlugin
 {
@@ -45,6 +47,7 @@ public:
 
   MyMoneyStorageMgr *open(const QUrl &url) override;
   bool save(const QUrl &url) override;
+  bool saveInBackground(const QUrl &url, std::function<void(bool)> finished) override;
   bool saveAs() override;
   eKMyMoney::StorageType storageType() const override;
   QString fileExtension() const override;
@@ -71,11 +74,45 @@ private:
     */
   void saveToLocalFile(const QString& localFile, IMyMoneyOperationsFormat* pWriter, bool plaintext, const QString& keyList);
 
+  /**
+    * Checks whether the file can be encrypted for the keys in @a keyList
+    * and asks the user for confirmation. The encryption key information
+    * kept in the storage is updated accordingly.
+    *
+    * @param plaintext whether to override any compression & encryption settings
+    * @param keyList QString containing a comma separated list of keys to be used for encryption
+    * @param encryptRecover returns whether the file should also be encrypted with the recover key
+    *
+    * @return the keys to be used for encryption or an empty string if the file will not be encrypted
+    */
+  QString encryptionKeys(bool plaintext, const QString& keyList, bool& encryptRecover);
+
+  /**
+    * Returns the writer to be used for @a filename and sets @a plaintext
+    * if the file is stored uncompressed and unencrypted
+    */
+  static IMyMoneyOperationsFormat* createWriter(const QString& filename, bool& plaintext);
+
+  /**
+    * Returns the comma separated list of keys the file should be encrypted for
+    */
+  QString encryptionKeyList() const;
+
+  /**
+    * Waits until a save started by saveInBackground() is done and
+    * reports its result.
+    */
+  void finishBackgroundSave();
+
   void checkRecoveryKeyValidity();
 
   QString m_encryptionKeys;
 
   QUrl fileUrl;
+
+  XMLStorageWriter*           m_backgroundWriter;
+  MyMoneyStorageMgr*          m_backgroundStorage;      ///< the storage the running background save has been started for
+  std::function<void(bool)>   m_backgroundFinished;
 };
 
 #endif
@@ -124,6 +124,8 @@ void KGlobalLedgerView::executeCustomAction(eView::Action action)
   Q_D(KGlobalLedgerView);
   switch(action) {
     case eView::Action::Refresh:
+      // the settings might have changed, so load the view again
+      d->resetPendingChanges();
       refresh();
       break;
 
@@ -161,7 +163,9 @@ void KGlobalLedgerView::refresh()
   if (isVisible()) {
     if (!d->m_inEditMode) {
       setUpdatesEnabled(false);
-      d->loadView();
+      // apply the changes made to the engine if possible
+      if (!d->updateView())
+        d->loadView();
       setUpdatesEnabled(true);
       d->m_needsRefresh = false;
       // force a new account if the current one is empty
@@ -55,6 +55,7 @@
 #include "mymoneymoney.h"
 #include "mymoneyaccount.h"
 #include "mymoneyfile.h"
+#include "mymoneychanges.h"
 #include "kmymoneyaccountcombo.h"
 #include "kbalancewarning.h"
 #include "transactionmatcher.h"
@@ -91,6 +92,13 @@
 using namespace eMenu;
 using namespace eMyMoney;
 
+/**
+  * The number of changed transactions up to which
+  * KGlobalLedgerViewPrivate::updateView() updates the
+  * register instead of loading it again
+  */
+static const int maxIncrementalTransactionChanges = 100;
+
 /**
   * helper class implementing an event filter to detect mouse button press
   * events on widgets outside a given set of widgets. This is used internally
@@ -252,6 +260,7 @@ public:
     m_needLoad(true),
     m_newAccountLoaded(true),
     m_inEditMode(false),
+    m_pendingChangeSets(0),
     m_transactionEditor(nullptr),
     m_balanceWarning(nullptr),
     m_moveToAccountSelector(nullptr),
@@ -368,6 +377,10 @@ public:
     m_formFrame->setFrameShadow(QFrame::Raised);
     vbox->addWidget(m_formFrame);
 
+    q->connect(MyMoneyFile::instance(), &MyMoneyFile::objectsChanged, q, [this](const MyMoneyChanges& changes) {
+      m_pendingChanges = changes;
+      ++m_pendingChangeSets;
+    });
     q->connect(MyMoneyFile::instance(), &MyMoneyFile::dataChanged, q, &KGlobalLedgerView::refresh);
     q->connect(MyMoneyFile::instance(), &MyMoneyFile::dataChanged, q, &KGlobalLedgerView::slotUpdateMoveToAccountMenu);
     q->connect(m_register, static_cast<void (KMyMoneyRegister::Register::*)(KMyMoneyRegister::Transaction *)>(&KMyMoneyRegister::Register::focusChanged), m_form, &KMyMoneyTransactionForm::TransactionForm::slotSetTransaction);
@@ -518,6 +531,9 @@ public:
     KMyMoneyRegister::SelectedTransactions list;
     emit q->selectByVariant(QVariantList {QVariant::fromValue(list)}, eView::Intent::SelectRegisterTransactions);
 
+    // the view is loaded from scratch
+    resetPendingChanges();
+
     QMap<QString, bool> isSelected;
     QString focusItemId;
     QString backUpFocusItemId;  // in case the focus item is removed
@@ -573,28 +589,15 @@ public:
       QString key;
       QDate reconciliationDate = m_reconciliationDate;
 
-      MyMoneyTransactionFilter filter(m_currentAccount.id());
-      // if it's an investment account, we also take care of
-      // the sub-accounts (stock accounts)
-      if (m_currentAccount.accountType() == eMyMoney::Account::Type::Investment)
-        filter.addAccount(m_currentAccount.accountList());
+      MyMoneyTransactionFilter filter = transactionFilter();
 
       if (isReconciliationAccount()) {
         key = "kmm-sort-reconcile";
         sortOrder = KMyMoneySettings::sortReconcileView();
-        filter.addState((int)eMyMoney::TransactionFilter::State::NotReconciled);
-        filter.addState((int)eMyMoney::TransactionFilter::State::Cleared);
       } else {
-        filter.setDateFilter(KMyMoneySettings::startDate().date(), QDate());
         key = "kmm-sort-std";
         sortOrder = KMyMoneySettings::sortNormalView();
-        if (KMyMoneySettings::hideReconciledTransactions()
-            && !m_currentAccount.isIncomeExpense()) {
-          filter.addState((int)eMyMoney::TransactionFilter::State::NotReconciled);
-          filter.addState((int)eMyMoney::TransactionFilter::State::Cleared);
-        }
       }
-      filter.setReportAllSplits(true);
 
       // check if we have an account override of the sort order
       if (!m_currentAccount.value(key).isEmpty())
@@ -886,6 +889,253 @@ public:
     emit q->selectByVariant(QVariantList {QVariant::fromValue(actualSelection)}, eView::Intent::SelectRegisterTransactions);
   }
 
+  /**
+    * Returns the filter which selects the transactions
+    * of the current account shown in the register
+    */
+  MyMoneyTransactionFilter transactionFilter() const
+  {
+    MyMoneyTransactionFilter filter(m_currentAccount.id());
+    // if it's an investment account, we also take care of
+    // the sub-accounts (stock accounts)
+    if (m_currentAccount.accountType() == eMyMoney::Account::Type::Investment)
+      filter.addAccount(m_currentAccount.accountList());
+
+    if (isReconciliationAccount()) {
+      filter.addState((int)eMyMoney::TransactionFilter::State::NotReconciled);
+      filter.addState((int)eMyMoney::TransactionFilter::State::Cleared);
+    } else {
+      filter.setDateFilter(KMyMoneySettings::startDate().date(), QDate());
+      if (KMyMoneySettings::hideReconciledTransactions()
+          && !m_currentAccount.isIncomeExpense()) {
+        filter.addState((int)eMyMoney::TransactionFilter::State::NotReconciled);
+        filter.addState((int)eMyMoney::TransactionFilter::State::Cleared);
+      }
+    }
+    filter.setReportAllSplits(true);
+    return filter;
+  }
+
+  /**
+    * Forgets about the changes received from the engine since
+    * the register has been loaded or updated the last time
+    */
+  void resetPendingChanges()
+  {
+    m_pendingChanges = MyMoneyChanges();
+    m_pendingChangeSets = 0;
+  }
+
+  /**
+    * Applies the transactions added, modified and removed by the last
+    * engine transaction to the register instead of loading all items
+    * again with loadView(). The running balance is only recalculated
+    * for the items posted on or after the earliest changed date.
+    *
+    * @retval true the register has been updated
+    * @retval false the changes cannot be applied and loadView() is needed
+    */
+  bool updateView()
+  {
+    MYMONEYTRACER(tracer);
+    Q_Q(KGlobalLedgerView);
+
+    const auto changes = m_pendingChanges;
+    const auto changeSets = m_pendingChangeSets;
+    resetPendingChanges();
+
+    // the register of a reconciliation or an investment account or one that is
+    // not sorted by post date contains items which depend on all transactions
+    if (changeSets != 1
+        || m_newAccountLoaded
+        || m_currentAccount.id().isEmpty()
+        || isReconciliationAccount()
+        || m_currentAccount.accountType() == eMyMoney::Account::Type::Investment
+        || m_register->primarySortKey() != eWidgets::SortField::PostDate)
+      return false;
+
+    const auto transactionChanges = changes.count(File::Object::Transaction);
+    if (transactionChanges == 0
+        || transactionChanges > maxIncrementalTransactionChanges
+        || changes.contains(File::Object::Schedule))
+      return false;
+
+    // the existing items show the names of the objects they reference
+    for (const auto type : {File::Object::Account, File::Object::Payee, File::Object::Tag, File::Object::Security, File::Object::CostCenter}) {
+      if (!changes.ids(File::Mode::Modify, type).isEmpty()
+          || !changes.ids(File::Mode::Remove, type).isEmpty())
+        return false;
+    }
+
+    const auto file = MyMoneyFile::instance();
+    QSet<QString> changedIds;
+    QList<QPair<MyMoneyTransaction, MyMoneySplit> > addedSplits;
+    // all items on or after this date get a new balance. The items in the
+    // future are always visited to determine the actual balance.
+    QDate firstDate = QDate::currentDate().addDays(1);
+    try {
+      auto filter = transactionFilter();
+      for (const auto mode : {File::Mode::Add, File::Mode::Modify, File::Mode::Remove}) {
+        foreach (const auto id, changes.ids(mode, File::Object::Transaction)) {
+          changedIds.insert(id);
+          if (mode == File::Mode::Remove)
+            continue;
+          const auto t = file->transaction(id);
+          foreach (const auto split, filter.matchingSplits(t)) {
+            addedSplits.append(qMakePair(t, split));
+            if (t.postDate() < firstDate)
+              firstDate = t.postDate();
+          }
+        }
+      }
+    } catch (const MyMoneyException &) {
+      return false;
+    }
+
+    // remember the item that has the focus and the one that has the selection anchor
+    QString focusItemId;
+    QString backUpFocusItemId;
+    QString anchorItemId;
+    QString backUpAnchorItemId;
+    storeId(m_register->focusItem(), focusItemId, backUpFocusItemId);
+    storeId(m_register->anchorItem(), anchorItemId, backUpAnchorItemId);
+
+    // remove the items of the changed transactions, the empty entry
+    // for new transactions and the group markers, which are created
+    // again below
+    QSet<QString> isSelected;
+    KMyMoneyRegister::RegisterItem* p = m_register->firstItem();
+    while (p) {
+      KMyMoneyRegister::RegisterItem* item = p;
+      p = p->nextItem();
+      auto t = dynamic_cast<KMyMoneyRegister::Transaction*>(item);
+      if (t) {
+        const auto& id = t->transaction().id();
+        if (t->isScheduled() || (!id.isEmpty() && !changedIds.contains(id)))
+          continue;
+        if (!id.isEmpty() && t->transaction().postDate() < firstDate)
+          firstDate = t->transaction().postDate();
+        if (t->isSelected())
+          isSelected.insert(t->id());
+      } else if (!dynamic_cast<KMyMoneyRegister::GroupMarker*>(item)) {
+        continue;
+      }
+      delete item;
+    }
+
+    // create the items of the added and modified transactions
+    // and the group markers and sort them into the register
+    KMyMoneyRegister::RegisterItem* lastItem = m_register->lastItem();
+    QMap<QString, int> uniqueMap;
+    QList<QPair<MyMoneyTransaction, MyMoneySplit> >::const_iterator it;
+    for (it = addedSplits.constBegin(); it != addedSplits.constEnd(); ++it) {
+      KMyMoneyRegister::Transaction* t = KMyMoneyRegister::Register::transactionFactory(m_register, (*it).first, (*it).second, ++uniqueMap[(*it).first.id()]);
+      if (isSelected.contains(t->id()))
+        t->setSelected(true);
+    }
+    m_register->addGroupMarkers();
+
+    QSet<KMyMoneyRegister::RegisterItem*> newItems;
+    for (p = lastItem ? lastItem->nextItem() : m_register->firstItem(); p; p = p->nextItem())
+      newItems.insert(p);
+    m_register->sortItems(newItems);
+    m_register->removeUnwantedGroupMarkers();
+
+    MyMoneyMoney factor(1, 1);
+    if (m_currentAccount.accountGroup() == eMyMoney::Account::Type::Liability
+        || m_currentAccount.accountGroup() == eMyMoney::Account::Type::Equity)
+      factor = -factor;
+
+    // take care of the scheduled transactions (bump up the future balance)
+    const auto accountId = m_currentAccount.id();
+    MyMoneyMoney actBalance = file->balance(accountId) * factor;
+    MyMoneyMoney balance = actBalance;
+    for (p = m_register->lastItem(); p; p = p->prevItem()) {
+      KMyMoneyRegister::Transaction* t = dynamic_cast<KMyMoneyRegister::Transaction*>(p);
+      if (t && t->isScheduled() && p->isSelectable()) {
+        const MyMoneySplit& split = t->split();
+        // if this split is a stock split, we can't just add the amount of shares
+        if (t->transaction().isStockSplit()) {
+          balance = balance * split.shares();
+        } else {
+          balance += split.shares() * factor;
+        }
+      }
+    }
+
+    // the balances of the items posted before the first changed
+    // date are not affected by the changes
+    for (p = m_register->lastItem(); p; p = p->prevItem()) {
+      KMyMoneyRegister::Transaction* t = dynamic_cast<KMyMoneyRegister::Transaction*>(p);
+      if (!t)
+        continue;
+      if (!t->isScheduled() && t->transaction().postDate() < firstDate)
+        break;
+
+      const MyMoneySplit& split = t->split();
+      t->setBalance(balance);
+
+      // if this split is a stock split, we can't just add the amount of shares
+      if (t->transaction().isStockSplit()) {
+        balance /= split.shares();
+      } else {
+        balance -= split.shares() * factor;
+      }
+
+      if (!t->isScheduled() && t->transaction().postDate() > QDate::currentDate()) {
+        tracer.printf("Reducing actual balance by %s because %s/%s(%s) is in the future", qPrintable((split.shares() * factor).formatMoney("", 2)), qPrintable(t->transaction().id()), qPrintable(split.id()), qPrintable(t->transaction().postDate().toString(Qt::ISODate)));
+        actBalance -= split.shares() * factor;
+      }
+    }
+
+    // add a last empty entry for new transactions
+    // leave some information about the current account
+    MyMoneySplit split;
+    split.setReconcileFlag(eMyMoney::Split::State::NotReconciled);
+    MyMoneyTransaction emptyTransaction;
+    emptyTransaction.setCommodity(m_currentAccount.currencyId());
+    KMyMoneyRegister::Register::transactionFactory(m_register, emptyTransaction, split, 0);
+
+    m_register->updateRegister(true);
+
+    // find the focus and anchor items again if they have been removed
+    KMyMoneyRegister::RegisterItem* focusItem = m_register->focusItem();
+    KMyMoneyRegister::RegisterItem* anchorItem = m_register->anchorItem();
+    if (!focusItem || !anchorItem) {
+      KMyMoneyRegister::RegisterItem* newFocusItem = 0;
+      KMyMoneyRegister::RegisterItem* newAnchorItem = 0;
+      for (p = m_register->lastItem(); p; p = p->prevItem()) {
+        KMyMoneyRegister::Transaction* t = dynamic_cast<KMyMoneyRegister::Transaction*>(p);
+        if (t) {
+          matchItemById(&newFocusItem, t, focusItemId, backUpFocusItemId);
+          matchItemById(&newAnchorItem, t, anchorItemId, backUpAnchorItemId);
+        }
+      }
+      if (!anchorItem)
+        anchorItem = newAnchorItem;
+      if (!focusItem) {
+        focusItem = newFocusItem ? newFocusItem : m_register->lastItem();
+        if (anchorItem && (anchorItem != focusItem)) {
+          m_register->setFocusItem(focusItem);
+          m_register->setAnchorItem(anchorItem);
+        } else
+          m_register->selectItem(focusItem, true);
+      } else if (anchorItem) {
+        m_register->setAnchorItem(anchorItem);
+      }
+    }
+
+    QMap<QString, MyMoneyMoney> actBalances, clearedBalances;
+    actBalances[accountId] = actBalance;
+    clearedBalances[accountId] = file->clearedBalance(accountId, m_reconciliationDate);
+    updateSummaryLine(actBalances, clearedBalances);
+
+    // and tell everyone what's selected
+    KMyMoneyRegister::SelectedTransactions actualSelection(m_register);
+    emit q->selectByVariant(QVariantList {QVariant::fromValue(actualSelection)}, eView::Intent::SelectRegisterTransactions);
+    return true;
+  }
+
   void selectTransaction(const QString& id)
   {
     if (!id.isEmpty()) {
@@ -1646,6 +1896,14 @@ public:
   bool                            m_newAccountLoaded;
   bool                            m_inEditMode;
 
+  /**
+    * The changes received from the engine since the register
+    * has been loaded or updated the last time and the number
+    * of engine transactions they have been collected from
+    */
+  MyMoneyChanges                  m_pendingChanges;
+  int                             m_pendingChangeSets;
+
   QWidgetList                     m_tabOrderWidgets;
   QPoint                          m_tooltipPosn;
   KMyMoneyRegister::SelectedTransactions m_selectedTransactions;
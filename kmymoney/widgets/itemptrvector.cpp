@@ -22,6 +22,7 @@
 // QT Includes
 
 #include <QDate>
+#include <QSet>
 
 // ----------------------------------------------------------------------------
 // KDE Includes
@@ -56,6 +57,17 @@ void ItemPtrVector::sort()
   }
 }
 
+void ItemPtrVector::sortIn(const QSet<RegisterItem*>& items)
+{
+  // get rid of 0 pointers and take out the items to be sorted in
+  erase(std::remove_if(begin(), end(), [&](RegisterItem* item) {
+    return !item || items.contains(item);
+  }), end());
+
+  foreach (const auto item, items)
+    insert(std::upper_bound(begin(), end(), item, item_cmp), item);
+}
+
 bool ItemPtrVector::item_cmp(RegisterItem* i1, RegisterItem* i2)
 {
   const QList<SortField>& sortOrder = i1->getParent()->sortOrder();
@@ -24,6 +24,8 @@
 
 #include <QVector>
 
+template <class T> class QSet;
+
 // ----------------------------------------------------------------------------
 // KDE Includes
 
@@ -38,6 +40,14 @@ namespace KMyMoneyRegister
   public:
     void sort();
 
+    /**
+    * Inserts the @a items, which must already be contained in the
+    * vector, at their sorted position. All other items must be
+    * sorted already. This is cheaper than sort() if only a few
+    * items have been added.
+    */
+    void sortIn(const QSet<RegisterItem*>& items);
+
   protected:
     /**
     * sorter's compare routine. Returns true if i1 < i2
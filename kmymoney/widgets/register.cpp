@@ -27,6 +27,7 @@
 #include <QToolTip>
 #include <QMouseEvent>
 #include <QList>
+#include <QSet>
 #include <QKeyEvent>
 #include <QEvent>
 #include <QFrame>
@@ -97,6 +98,49 @@ namespace KMyMoneyRegister
     {
     }
 
+    /**
+    * Rebuilds the next/prev item chains from the order in m_items
+    * and updates the balance visibility of the transactions
+    */
+    void linkItems()
+    {
+      // update the next/prev item chains
+      RegisterItem* prev = 0;
+      RegisterItem* item;
+      m_firstItem = m_lastItem = 0;
+      for (QVector<RegisterItem*>::size_type i = 0; i < m_items.size(); ++i) {
+        item = m_items[i];
+        if (!item)
+          continue;
+
+        if (!m_firstItem)
+          m_firstItem = item;
+        m_lastItem = item;
+        if (prev)
+          prev->setNextItem(item);
+        item->setPrevItem(prev);
+        item->setNextItem(0);
+        prev = item;
+      }
+
+      // update the balance visibility settings
+      item = m_lastItem;
+      bool showBalance = true;
+      while (item) {
+        auto t = dynamic_cast<Transaction*>(item);
+        if (t) {
+          t->setShowBalance(showBalance);
+          if (!t->isVisible()) {
+            showBalance = false;
+          }
+        }
+        item = item->prevItem();
+      }
+
+      // force update of the item index (row to item array)
+      m_listsDirty = true;
+    }
+
     ItemPtrVector                m_items;
     QVector<RegisterItem*>       m_itemIndex;
     RegisterItem*                m_selectAnchor;
@@ -370,41 +414,19 @@ namespace KMyMoneyRegister
     // sort the array of pointers to the transactions
     d->m_items.sort();
 
-    // update the next/prev item chains
-    RegisterItem* prev = 0;
-    RegisterItem* item;
-    d->m_firstItem = d->m_lastItem = 0;
-    for (QVector<RegisterItem*>::size_type i = 0; i < d->m_items.size(); ++i) {
-      item = d->m_items[i];
-      if (!item)
-        continue;
+    d->linkItems();
+  }
 
-      if (!d->m_firstItem)
-        d->m_firstItem = item;
-      d->m_lastItem = item;
-      if (prev)
-        prev->setNextItem(item);
-      item->setPrevItem(prev);
-      item->setNextItem(0);
-      prev = item;
-    }
+  void Register::sortItems(const QSet<RegisterItem*>& items)
+  {
+    Q_D(Register);
+    if (items.isEmpty())
+      return;
 
-    // update the balance visibility settings
-    item = d->m_lastItem;
-    bool showBalance = true;
-    while (item) {
-      auto t = dynamic_cast<Transaction*>(item);
-      if (t) {
-        t->setShowBalance(showBalance);
-        if (!t->isVisible()) {
-          showBalance = false;
-        }
-      }
-      item = item->prevItem();
-    }
+    // sort the new items into the already sorted array
+    d->m_items.sortIn(items);
 
-    // force update of the item index (row to item array)
-    d->m_listsDirty = true;
+    d->linkItems();
   }
 
   eTransaction::Column Register::lastCol() const
@@ -518,6 +540,18 @@ namespace KMyMoneyRegister
     p->setNextItem(0);
     p->setPrevItem(0);
 
+    // don't keep references to the item
+    if (p == d->m_focusItem)
+      d->m_focusItem = 0;
+    if (p == d->m_selectAnchor)
+      d->m_selectAnchor = 0;
+    if (p == d->m_ensureVisibleItem)
+      d->m_ensureVisibleItem = 0;
+    if (p == d->m_firstErroneous)
+      d->m_firstErroneous = 0;
+    if (p == d->m_lastErroneous)
+      d->m_lastErroneous = 0;
+
     // remove it from the m_items array
     int i = d->m_items.indexOf(p);
     if (-1 != i) {
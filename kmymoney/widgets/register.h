@@ -40,6 +40,7 @@ namespace eWidgets { enum class SortField;
 namespace eMyMoney { namespace Account { enum class Type; } }
 
 template <typename T> class QList;
+template <class T> class QSet;
 
 namespace KMyMoneyRegister
 {
@@ -167,6 +168,12 @@ namespace KMyMoneyRegister
     eWidgets::SortField primarySortKey() const;
     void sortItems();
 
+    /**
+    * Sorts the @a items, which have been added to the register after
+    * the last call to sortItems(), into the already sorted list.
+    */
+    void sortItems(const QSet<RegisterItem*>& items);
+
     /**
     * This member returns the last visible column that is used by the register
     * after it has been setup using setupRegister().